@@ -0,0 +1,219 @@
+// -*-Mode: C++;-*-
+
+#ifndef FRAGMENTINDEX_HH
+#define FRAGMENTINDEX_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentIndex.hh
+ *  @brief    An index of the fragments in a binary file, kept in a
+ *            sidecar file
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added the indexed file's inode and modification time,
+                  checked by load along with its size
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/TpcStreamUnpack.hh"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+struct stat;
+
+
+/* ====================================================================== */
+/* INTERFACE: FragmentIndex                                               */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentIndex
+  \brief The location and identification of each fragment in a file
+
+  \par
+   The index is built by walking the file once.  It is saved in a
+   sidecar file, by default the file's name with ".idx" appended, so
+   later jobs can find the fragments they want without walking the
+   file again.  A fragment is then read by seeking a FragmentReader
+   to the entry's offset.  The sidecar records the file's size, inode
+   and modification time, and load rebuilds the index if any differ.
+
+  \par
+   The walk stops at the first fragment with a bad header or that is
+   truncated, since the fragments following it cannot be located.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentIndex
+{
+public:
+   static const int MaxStreams = 2;
+
+   /* ------------------------------------------------------------------- *//*!
+
+     \class Entry
+     \brief The index entry of one fragment.  This is also its layout in
+            the sidecar file.
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   class Entry
+   {
+   public:
+      enum Flags
+      {
+         BadTrailer = 1  /*!< The trailer does not match the header       */
+      };
+
+   public:
+      TpcStreamUnpack::Identifier
+                  getIdentifier (int istream) const;
+      TpcStreamUnpack::DataFormatType
+                  getFormat     (int istream) const;
+      bool        hasFiber      (uint32_t   crate,
+                                 uint32_t    slot,
+                                 uint32_t   fiber) const;
+
+   public:
+      uint64_t              m_offset; /*!< Byte offset of the fragment    */
+      uint64_t           m_timestamp; /*!< The Identifier's timestamp     */
+      uint32_t            m_sequence; /*!< The Identifier's sequence      */
+      uint32_t                 m_n64; /*!< Length, in 64-bit words        */
+      uint8_t                 m_type; /*!< The fragment type              */
+      uint8_t              m_subtype; /*!< The fragment subtype           */
+      uint8_t             m_nstreams; /*!< The number of TPC streams      */
+      uint8_t                m_flags; /*!< Flags                          */
+      uint16_t    m_csfs[MaxStreams]; /*!< Each stream's crate.slot.fiber */
+      uint8_t   m_format[MaxStreams]; /*!< Each stream's data format      */
+      uint8_t              m_rsvd[6]; /*!< Reserved, must be 0            */
+   };
+   /* ------------------------------------------------------------------- */
+
+public:
+   FragmentIndex ();
+
+   int            build     (char const *filename);
+   int            write     (char const *idxname) const;
+   int            read      (char const *idxname);
+   int            load      (char const *filename);
+
+   static std::string
+                  getSidecarName (char const *filename);
+
+   int            getCount  () const;
+   uint64_t       getFileSize () const;
+   Entry const   &getEntry  (int index) const;
+
+   int            findSequence  (uint32_t  sequence) const;
+   int            findTimestamp (uint64_t timestamp) const;
+   int            findFiber     (uint32_t     crate,
+                                 uint32_t      slot,
+                                 uint32_t     fiber,
+                                 int          start = 0) const;
+
+private:
+   bool           isCurrent (struct stat const &st) const;
+
+private:
+   std::vector<Entry> m_entries; /*!< The entries, in file order          */
+   uint64_t          m_fileSize; /*!< The size of the indexed file        */
+   uint64_t             m_inode; /*!< Its inode number                    */
+   int64_t           m_mtimeSec; /*!< Its modification time, seconds      */
+   uint32_t         m_mtimeNsec; /*!< and nanoseconds                     */
+};
+/* ---------------------------------------------------------------------- */
+/* INTERFACE: FragmentIndex                                               */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION: FragmentIndex                                          */
+/* ---------------------------------------------------------------------- */
+inline int FragmentIndex::getCount () const
+{
+   return m_entries.size ();
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the size of the indexed file, in bytes
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t FragmentIndex::getFileSize () const
+{
+   return m_fileSize;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline FragmentIndex::Entry const &FragmentIndex::getEntry (int index) const
+{
+   return m_entries[index];
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline TpcStreamUnpack::Identifier
+       FragmentIndex::Entry::getIdentifier (int istream) const
+{
+   return TpcStreamUnpack::Identifier (m_csfs[istream]);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline TpcStreamUnpack::DataFormatType
+       FragmentIndex::Entry::getFormat (int istream) const
+{
+   // Stored as a byte, the sign restores Unknown
+   int8_t format = m_format[istream];
+   return static_cast<TpcStreamUnpack::DataFormatType>(format);
+}
+/* ---------------------------------------------------------------------- */
+/* IMPLEMENTATION: FragmentIndex                                          */
+/* ====================================================================== */
+
+
+#endif
@@ -0,0 +1,202 @@
+// -*-Mode: C++;-*-
+
+#ifndef FRAGMENTPIPELINE_HH
+#define FRAGMENTPIPELINE_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentPipeline.hh
+ *  @brief    Reads, unpacks and processes the fragments of a file on a
+ *            set of threads, delivering the results in file order
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The delivered fragments are released by the reading
+                  thread
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentReader.hh"
+#include "dam/TpcFragmentUnpack.hh"
+
+#include <cinttypes>
+#include <vector>
+
+
+/* ====================================================================== */
+/* INTERFACE: FragmentPipeline                                            */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentPipeline
+  \brief A reader stage, a pool of unpacking workers and an ordered
+         delivery stage
+
+  \par
+   One thread reads the fragments.  Each fragment is handed to one of
+   the workers, which unpacks the trimmed ADCs of its TPC streams and
+   then calls the Processor's \a process method.  The finished items
+   are given, in file order, to the Processor's \a deliver method on
+   the thread that called \a run.  The delivered fragments are released
+   by the reading thread, so the reader is never called concurrently.
+
+  \par
+   The number of items, and hence of fragments and ADC buffers, in the
+   pipeline at any time is fixed by its depth.  When all are in use,
+   the reader waits for the delivery stage to give one back, so a slow
+   consumer holds back the reader rather than letting the memory grow.
+   The items, and their buffers, are reused from one fragment to the
+   next and from one run to the next.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentPipeline
+{
+public:
+   static const int MaxStreams = pdd::access::TpcFragment::MaxTpcStreams;
+
+   /* ------------------------------------------------------------------- *//*!
+
+     \class Item
+     \brief One fragment and the result of unpacking it
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   class Item
+   {
+   public:
+      uint64_t                      m_index; /*!< The fragment's ordinal
+                                                  number in the file      */
+      FragmentReader::Fragment   m_fragment; /*!< The fragment            */
+      FragmentReader::Status       m_status; /*!< Its read status, Okay
+                                                  or BadTrailer           */
+      int                        m_nstreams; /*!< The number of streams
+                                                  unpacked, 0 if not a
+                                                  TPC fragment or if not
+                                                  unpacking               */
+      int                          m_nticks; /*!< The number of elements
+                                                  per channel in m_adcs   */
+      bool                           m_okay; /*!< All the streams were
+                                                  successfully unpacked   */
+      TpcFragmentUnpack::StreamStatus
+                      m_streams[MaxStreams]; /*!< Each stream's status    */
+      std::vector<int16_t>           m_adcs; /*!< The ADCs, laid out as
+                                                  [m_nstreams * 128]
+                                                  [m_nticks]              */
+      void                          *m_user; /*!< For the Processor's use,
+                                                  kept with the item      */
+   };
+   /* ------------------------------------------------------------------- */
+
+
+   /* ------------------------------------------------------------------- *//*!
+
+     \class Processor
+     \brief The user's processing of the items
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   class Processor
+   {
+   public:
+      virtual ~Processor () { return; }
+
+      // Called on a worker thread after the item has been unpacked.
+      // Different items are processed concurrently.
+      virtual void process (Item &item);
+
+      // Called in file order on the thread calling run, returning
+      // false stops the pipeline
+      virtual bool deliver (Item &item) = 0;
+   };
+   /* ------------------------------------------------------------------- */
+
+
+public:
+   FragmentPipeline (int nworkers = 0,
+                     int    depth = 0,
+                     bool  unpack = true);
+
+   FragmentReader::Status run (FragmentReader  &reader,
+                               Processor    &processor,
+                               int              nticks = 0);
+
+   int                    getNWorkers () const;
+   int                    getDepth    () const;
+
+private:
+   int                 m_nworkers; /*!< The number of worker threads      */
+   int                    m_depth; /*!< The number of items               */
+   bool                  m_unpack; /*!< Unpack the TPC streams            */
+   std::vector<Item>      m_items; /*!< The items                         */
+};
+/* ---------------------------------------------------------------------- */
+/* INTERFACE: FragmentPipeline                                            */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION: FragmentPipeline                                       */
+/* ---------------------------------------------------------------------- */
+inline int FragmentPipeline::getNWorkers () const
+{
+   return m_nworkers;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline int FragmentPipeline::getDepth () const
+{
+   return m_depth;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The default processing does nothing beyond the unpacking
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void FragmentPipeline::Processor::process (Item &)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* IMPLEMENTATION: FragmentPipeline                                       */
+/* ====================================================================== */
+
+
+#endif
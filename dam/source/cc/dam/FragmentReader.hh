@@ -0,0 +1,194 @@
+// -*-Mode: C++;-*-
+
+#ifndef FRAGMENTREADER_HH
+#define FRAGMENTREADER_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentReader.hh
+ *  @brief    Interface to read RCE fragments from a binary file
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Documented that the methods, release included, need not
+                  be safe to call concurrently
+   2026.10.16 agt Added seek, positioning the reader at a fragment whose
+                  offset is known, e.g. from a FragmentIndex
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include <cinttypes>
+#include <cstddef>
+
+
+/* ====================================================================== */
+/* INTERFACE: FragmentReader                                              */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentReader
+  \brief Interface to read the fragments of a binary file in file order
+
+  \par
+   Each fragment is returned as a view, i.e. a pointer to the fragment
+   in memory owned by the reader.  The view remains valid until it is
+   given back with \a release.  Fragments whose offset is known can be
+   read directly by seeking to them first.
+
+  \par
+   Unless an implementation states otherwise, its methods, \a release
+   included, must not be called concurrently.  In particular, a view
+   must not be released on one thread while another is inside \a read.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentReader
+{
+public:
+   /* ------------------------------------------------------------------- *//*!
+
+     \enum  class Status
+     \brief The outcome of a read
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   enum class Status
+   {
+      Okay       = 0, /*!< A fragment was read                            */
+      EndOfFile  = 1, /*!< There are no more fragments                    */
+      BadHeader  = 2, /*!< The header is not that of a fragment           */
+      Truncated  = 3, /*!< The fragment extends past the end of the file  */
+      BadTrailer = 4, /*!< The trailer does not match the header, the
+                           fragment is still returned                     */
+      IoError    = 5, /*!< The file could not be read                     */
+      BadSeek    = 6  /*!< The seek offset is misaligned or past the end  */
+   };
+   /* ------------------------------------------------------------------- */
+
+
+   /* ------------------------------------------------------------------- *//*!
+
+     \class Fragment
+     \brief A view of one fragment
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   class Fragment
+   {
+   public:
+      uint64_t const    *m_buf; /*!< The fragment                         */
+      uint64_t        m_offset; /*!< Its byte offset in the file          */
+      uint32_t           m_n64; /*!< Its length, in 64-bit words          */
+      int               m_slot; /*!< The reader's handle, used by release */
+   };
+   /* ------------------------------------------------------------------- */
+
+
+public:
+   FragmentReader (char const *filename);
+   virtual ~FragmentReader () { return; }
+
+   virtual int      open    () = 0;
+   virtual Status   read    (Fragment           *fragment) = 0;
+   virtual void     release (Fragment const     &fragment) = 0;
+   virtual Status   seek    (uint64_t              offset) = 0;
+   virtual int      close   () = 0;
+
+   char const      *getFilename () const;
+
+   static char const *getStatusString (Status status);
+
+protected:
+   char const *m_filename; /*!< The file name                             */
+};
+/* ---------------------------------------------------------------------- */
+/* INTERFACE: FragmentReader                                              */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION: FragmentReader                                         */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Sets the file to be read, but does not open it
+
+  \param[in] filename  The name of the file to read
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline FragmentReader::FragmentReader (char const *filename) :
+   m_filename (filename)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline char const *FragmentReader::getFilename () const
+{
+   return m_filename;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns a short description of a read status
+  \return The description
+
+  \param[in] status  The status to describe
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline char const *FragmentReader::getStatusString (Status status)
+{
+   switch (status)
+   {
+      case Status::Okay:       return "Okay";
+      case Status::EndOfFile:  return "End of file";
+      case Status::BadHeader:  return "Bad fragment header";
+      case Status::Truncated:  return "Truncated fragment";
+      case Status::BadTrailer: return "Trailer does not match header";
+      case Status::IoError:    return "I/O error";
+      case Status::BadSeek:    return "Bad seek offset";
+   }
+
+   return "Unknown";
+}
+/* ---------------------------------------------------------------------- */
+/* IMPLEMENTATION: FragmentReader                                         */
+/* ====================================================================== */
+
+
+#endif
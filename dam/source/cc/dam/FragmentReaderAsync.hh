@@ -0,0 +1,175 @@
+// -*-Mode: C++;-*-
+
+#ifndef FRAGMENTREADERASYNC_HH
+#define FRAGMENTREADERASYNC_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentReaderAsync.hh
+ *  @brief    Reads the RCE fragments of a binary file with the reads
+ *            issued ahead of the consumer
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added seek
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentReader.hh"
+
+
+/* ====================================================================== */
+/* INTERFACE: FragmentReaderAsync                                         */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentReaderAsync
+  \brief Reads a binary file with a number of reads kept in flight
+
+  \par
+   The file is read as consecutive chunks into a pool of page aligned
+   buffers, the slots.  Up to one read per slot is kept in flight ahead
+   of the fragment being consumed, so the I/O overlaps the processing
+   of the fragments already returned.  The reads are done either with
+   io_uring or, where that is not available, by a small set of I/O
+   threads.
+
+  \par
+   The fragments are returned in file order.  A fragment that lies
+   within one chunk is returned as a view into its slot; the slot is
+   not reused until all such views have been released.  A fragment
+   that spans chunks is assembled into a buffer of its own, which is
+   freed when it is released.  Views may be released from any thread,
+   but \a read must be called from one thread at a time.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentReaderAsync : public FragmentReader
+{
+public:
+   /* ------------------------------------------------------------------- *//*!
+
+     \enum  class Backend
+     \brief The method used to do the reads
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   enum class Backend
+   {
+      Auto    = 0, /*!< io_uring if available, else threads               */
+      IoUring = 1, /*!< io_uring, fails to open if not available          */
+      Threads = 2  /*!< A set of I/O threads doing synchronous reads      */
+   };
+   /* ------------------------------------------------------------------- */
+
+   static const int    DefaultNSlots    = 8;
+   static const size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+public:
+   FragmentReaderAsync (char const *filename,
+                        int           nslots = DefaultNSlots,
+                        size_t     chunkSize = DefaultChunkSize,
+                        Backend      backend = Backend::Auto);
+  ~FragmentReaderAsync ();
+
+   virtual int      open    ();
+   virtual Status   read    (Fragment       *fragment);
+   virtual void     release (Fragment const &fragment);
+   virtual Status   seek    (uint64_t         offset);
+   virtual int      close   ();
+
+   Backend          getBackend () const;
+   uint64_t         getOffset  () const;
+
+public:
+   class Slot;
+   class Engine;
+
+private:
+   Slot            *acquire   (uint64_t chunk);
+   void             issue     ();
+   uint64_t const  *assemble  (uint64_t offset, uint64_t nbytes);
+
+private:
+   FragmentReaderAsync (FragmentReaderAsync const &)             = delete;
+   FragmentReaderAsync &operator = (FragmentReaderAsync const &) = delete;
+
+private:
+   int                    m_fd; /*!< The file descriptor                  */
+   uint64_t             m_size; /*!< The size of the file, in bytes       */
+   uint64_t           m_offset; /*!< Byte offset of the next fragment     */
+   uint64_t        m_nextChunk; /*!< The next chunk to be issued          */
+   size_t          m_chunkSize; /*!< The size of a chunk, in bytes        */
+   int                m_nslots; /*!< The number of slots                  */
+   Backend         m_requested; /*!< The requested backend                */
+   Backend           m_backend; /*!< The backend in use                   */
+   Slot               *m_slots; /*!< The slots                            */
+   Engine            *m_engine; /*!< Does the reads                       */
+};
+/* ---------------------------------------------------------------------- */
+/* INTERFACE: FragmentReaderAsync                                         */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION: FragmentReaderAsync                                    */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the backend doing the reads.  Before the file is
+          opened, this is the requested backend.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline FragmentReaderAsync::Backend FragmentReaderAsync::getBackend () const
+{
+   return m_backend;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the byte offset of the next fragment to be read
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t FragmentReaderAsync::getOffset () const
+{
+   return m_offset;
+}
+/* ---------------------------------------------------------------------- */
+/* IMPLEMENTATION: FragmentReaderAsync                                    */
+/* ====================================================================== */
+
+
+#endif
@@ -0,0 +1,147 @@
+// -*-Mode: C++;-*-
+
+#ifndef FRAGMENTREADERMAPPED_HH
+#define FRAGMENTREADERMAPPED_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentReaderMapped.hh
+ *  @brief    Reads the RCE fragments of a binary file by mapping it
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added seek
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentReader.hh"
+
+
+/* ====================================================================== */
+/* INTERFACE: FragmentReaderMapped                                        */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentReaderMapped
+  \brief Reads a binary file by mapping it into memory
+
+  \par
+   The fragments are returned as views directly into the mapping, so
+   no data is ever copied.  The kernel is told the file is read
+   sequentially and is asked to bring in the next \a readAhead bytes
+   ahead of the fragment being read.  The views remain valid until the
+   file is closed, so \a release does nothing.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentReaderMapped : public FragmentReader
+{
+public:
+   static const size_t DefaultReadAhead = 32 * 1024 * 1024;
+
+public:
+   FragmentReaderMapped (char const *filename,
+                         size_t      readAhead = DefaultReadAhead);
+  ~FragmentReaderMapped ();
+
+   virtual int      open    ();
+   virtual Status   read    (Fragment       *fragment);
+   virtual void     release (Fragment const &fragment);
+   virtual Status   seek    (uint64_t         offset);
+   virtual int      close   ();
+
+   uint64_t const  *getData   () const;
+   size_t           getSize   () const;
+   uint64_t         getOffset () const;
+
+private:
+   void             advise    (uint64_t offset);
+
+private:
+   int                    m_fd; /*!< The file descriptor                  */
+   uint64_t const       *m_map; /*!< The mapping of the file              */
+   size_t               m_size; /*!< The size of the file, in bytes       */
+   uint64_t           m_offset; /*!< Byte offset of the next fragment     */
+   uint64_t          m_advised; /*!< End of the region asked to be read   */
+   size_t          m_readAhead; /*!< Size of the read ahead region        */
+};
+/* ---------------------------------------------------------------------- */
+/* INTERFACE: FragmentReaderMapped                                        */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION: FragmentReaderMapped                                   */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the mapping of the file, NULL if it is not open
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t const *FragmentReaderMapped::getData () const
+{
+   return m_map;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the size of the file, in bytes
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline size_t FragmentReaderMapped::getSize () const
+{
+   return m_size;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the byte offset of the next fragment to be read
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t FragmentReaderMapped::getOffset () const
+{
+   return m_offset;
+}
+/* ---------------------------------------------------------------------- */
+/* IMPLEMENTATION: FragmentReaderMapped                                   */
+/* ====================================================================== */
+
+
+#endif
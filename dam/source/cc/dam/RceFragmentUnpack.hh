@@ -40,6 +40,7 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added missing inline to the constructor
    2018.09.10 jjr Created
   
 \* ---------------------------------------------------------------------- */
@@ -90,7 +91,7 @@ private:
    \param[in] buf The 64-bit pointer
                                                                           */
 /* ---------------------------------------------------------------------- */
-RceFragmentUnpack::RceFragmentUnpack (uint64_t const *buf) :
+inline RceFragmentUnpack::RceFragmentUnpack (uint64_t const *buf) :
    m_buf (buf)
 {
    return;
@@ -43,6 +43,8 @@
   
    DATE       WHO WHAT
    ---------- --- -------------------------------------------------------
+   2026.10.16 agt Added getMultiChannelData, unpacking all the streams of
+                  the fragment, concurrently, on an Executor
    2017.10.06 jjr Changed name of the, as to-date, empty print method 
                   from void Print () -> void print () const to conform
                   to the established
@@ -94,6 +96,75 @@ class TpcFragmentUnpack
    int                    getNStreams ()            const;
    TpcStreamUnpack const *getStream   (int istream) const;
 
+
+   /* ------------------------------------------------------------------ *//*!
+
+     \class Executor
+     \brief Executes a set of independent tasks, returning only when all
+            have completed.
+
+     \par
+      This allows the streams of a fragment to be unpacked on whatever
+      threading facility the caller uses.  By default the streams are 
+      unpacked on the library's pool, whose size is set by 
+      pdd::access::TpcCompressed::setNThreads.
+                                                                         */
+   /* ------------------------------------------------------------------ */
+   class Executor
+   {
+   public:
+      // The task, to be called once for each itask = 0, ntasks - 1
+      typedef void (*Task) (void *ctx, int itask);
+
+   public:
+      virtual     ~Executor () { return; }
+      virtual void run       (Task task, void *ctx, int ntasks) = 0;
+   };
+   /* ------------------------------------------------------------------ */
+
+
+   /* ------------------------------------------------------------------ *//*!
+
+     \class StreamStatus
+     \brief The result of unpacking one stream
+                                                                         */
+   /* ------------------------------------------------------------------ */
+   class StreamStatus
+   {
+   public:
+      uint32_t    m_status; /*!< The stream's status, getStatus          */
+      uint32_t    m_nticks; /*!< The stream's number of ticks, getNTicks */
+      uint32_t m_nunpacked; /*!< The number of ticks unpacked. This is
+                                 the lesser of m_nticks and the number
+                                 of elements per channel                 */
+      bool          m_okay; /*!< The stream was successfully unpacked    */
+   };
+   /* ------------------------------------------------------------------ */
+
+
+   // ------------------------------------------------------------------
+   // Unpack the trimmed data of all the streams, each stream's channels
+   // have nticks elements and are placed either
+   //    -# in one contiguous array, essentially
+   //       adcs[getNStreams () * NChannels][nticks]
+   //    -# in per stream arrays, adcs[istream] is essentially
+   //       [NChannels][nticks]
+   //
+   // The streams are unpacked concurrently by the executor, or by the
+   // library's pool if executor is NULL. If status is not NULL, it
+   // must have getNStreams () entries. Returns true if all the streams
+   // were successfully unpacked.
+   // ------------------------------------------------------------------
+   bool getMultiChannelData (int16_t             *adcs,
+                             int                 nticks,
+                             StreamStatus       *status   = 0,
+                             Executor           *executor = 0) const;
+
+   bool getMultiChannelData (int16_t      *const *adcs,
+                             int                 nticks,
+                             StreamStatus       *status   = 0,
+                             Executor           *executor = 0) const;
+
 private:
    pdd::access::TpcFragment  m_tpc; /*!< Low Level access classs          */
 };
@@ -42,6 +42,18 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt transposeAndAssess transposes each block with a caller
+                  supplied Transpose hook, rather than always into 128
+                  contiguous channel arrays
+   2026.10.16 agt The compressed packets are assessed too, from their
+                  expanded header words
+   2026.10.16 agt Added the run length records, Run.  Consecutive frames
+                  with the same errors are coalesced into one run, so a
+                  link in error for a whole readout costs one run rather
+                  than a record per frame.  The per frame records can be
+                  dropped by constructing with keepRecords = false.
+   2026.10.16 agt Added transposeAndAssess, assesses the WIB frames in the
+                  same pass that transposes their ADCs
    2018.10.11 jjr Created
   
 \* ---------------------------------------------------------------------- */
@@ -68,7 +80,7 @@ namespace access {
 class TpcStreamAssessor 
 {
 public:
-   TpcStreamAssessor  ()         { return; }
+   TpcStreamAssessor  (bool keepRecords = true);
   ~TpcStreamAssessor  ();
 
 
@@ -182,6 +194,37 @@ public:
    /* --------------------------------------------------------------------- */
 
 
+
+   /* ------------------------------------------------------------------- *//*!
+
+      \brief A run of consecutive frames with the same error mask
+
+      \par
+       The first and last records of the run are kept, giving the values
+       at either end, e.g. the timestamps and convert counts.  For a run
+       of one frame, these are the same record.
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   class Run
+   {
+   public:
+      Run () { return; }
+      Run (Record const &rec);
+
+      bool extendedBy (Record const &rec) const;
+
+   public:
+      uint32_t     m_smpNum; /*!< The sample number of the first frame     */
+      uint32_t      m_count; /*!< The number of frames in the run          */
+      Record::Error_t
+                   m_errors; /*!< The error mask common to all the frames  */
+      uint32_t        m_pad; /*!< Pad to 64-bit boundary                   */
+      Record        m_first; /*!< The record of the first frame            */
+      Record         m_last; /*!< The record of the last  frame            */
+   };
+   /* --------------------------------------------------------------------- */
+
+
 public:
    typedef Record::Error_t  Error_t;
 
@@ -221,17 +264,40 @@ public:
    Error_t assessTrimmed   (TpcStreamUnpack const *tpc);
    Error_t assessTrimmed   (TpcStreamUnpack const &tpc);
 
+   // ------------------------------------------------------------------
+   // The transposition transposeAndAssess does on each block of frames,
+   // after assessing it.  iframe is the index of the block's first frame
+   // in the assessed range.
+   // ------------------------------------------------------------------
+   typedef void (*Transpose) (void                           *ctx,
+                              pdd::access::WibFrame const *frames,
+                              int                          iframe,
+                              int                         nframes);
+
+   Error_t transposeAndAssess (TpcStreamUnpack const &tpc,
+                               int                  itick,
+                               int                nframes,
+                               Transpose        transpose,
+                               void                   *ctx);
+
    void    add             (TpcStreamAssessor::Record const &&rec);
 
    TpcStreamAssessor::Record const *get (unsigned int idx) const;
    TpcStreamAssessor::Record const *get (unsigned int idx, Error_t filter) const;
 
+   unsigned int                  getNRuns () const;
+   TpcStreamAssessor::Run const *getRun   (unsigned int idx) const;
+   TpcStreamAssessor::Run const *getRun   (unsigned int idx, Error_t filter) const;
+
 
-   void    report (Error_t filter) const;
-   void    report ()               const;
+   void    report     (Error_t filter) const;
+   void    report     ()               const;
+   void    reportRuns (Error_t filter) const;
 
 public:
    std::vector<Record> m_recs;
+   std::vector<Run>    m_runs;
+   bool         m_keepRecords;
    unsigned char      m_crate;
    unsigned char       m_slot;
    unsigned char      m_fiber;
@@ -299,6 +365,54 @@ inline TpcStreamAssessor::Record const *
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the number of error runs
+  \return The number of error runs
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline unsigned int TpcStreamAssessor::getNRuns () const
+{
+   return m_runs.size ();
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the next error run starting at the specified index
+  \retval Pointer to the run or NULL if none
+
+  \param[in] idx  The index to start the search at 
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline TpcStreamAssessor::Run const *
+       TpcStreamAssessor::getRun (unsigned int idx) const
+{
+   return getRun (idx, FLT_M_ALL);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Tests whether a record continues the run
+  \retval true  if it is the next frame and has the same errors
+  \retval false otherwise
+
+  \param[in] rec  The record
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline bool TpcStreamAssessor::Run::extendedBy (Record const &rec) const
+{
+   return rec.m_smpNum == m_smpNum + m_count && rec.m_errors == m_errors;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief Report all errors
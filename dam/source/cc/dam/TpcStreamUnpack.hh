@@ -43,6 +43,42 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Replaced the getMultiChannelData(Untrimmed) variants
+                  taking an assessor, a ChannelMask, a Store or AdcStats
+                  by those taking Options, which may combine them.  A
+                  NULL argument no longer selects between overloads.
+   2026.10.16 agt Summary's m_npkts is back to 16 bits so the summary fits
+                  in the 4 words the TpcStream always reserved.
+   2026.10.16 agt Summary's m_begOff and m_npkts are now 32 bits, and
+                  getSummary returns by value.  Documented that the first
+                  fill of the summary is not thread-safe.
+   2026.10.16 agt Added Roi and getRois(Untrimmed), the zero-suppressed
+                  unpacking into regions of interest.
+   2026.10.16 agt Added the getMultiChannelData(Untrimmed) variants
+                  returning the AdcStats of each channel.
+   2026.10.16 agt Added Store and the getMultiChannelData(Untrimmed)
+                  variants taking one, to unpack with non-temporal stores.
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) variants producing
+                  pedestal subtracted, gain corrected floats.
+   2026.10.16 agt Added ChannelMask and the getMultiChannelData(Untrimmed)
+                  variants that unpack only the selected channels.
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) variants taking a
+                  TpcStreamAssessor.  The WIB frames are assessed in the 
+                  same pass that transposes them.
+
+   2026.10.16 agt Added getMultiChannelData (int16_t *adcs, int nadcs), the
+                  contiguous unpacking with a caller specified number of
+                  elements per channel.  This is the method that was 
+                  promised in the 2017.10.04 entry.
+
+   2026.10.16 agt Added the Summary, the lazily computed trimmed range,
+                  status, data format and number of packets.  This is 
+                  shared by the accessors, so the trimmed range search is
+                  done once per stream rather than once per call.  Since 
+                  a TpcStreamUnpack is an overlay of an access::TpcStream,
+                  it cannot have members of its own, so the summary is
+                  kept in the TpcStream's cache.
+
    2018.10.20 jjr Replaced getTimestamps(Untrimmed) with getRange(Untrimmed)
                   This method adds the number of ticks in the trimmed/
                   untrimmed ranges in addition to their timestamps
@@ -83,12 +119,16 @@
 
 #include "dam/access/TpcStream.hh"
 #include "dam/TpcAdcVector.hh"
+#include "dam/access/AdcStats.hh"
 
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
 
+class TpcStreamAssessor;
+
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Unpacks and accesses the data in one TPC Stream.  A TPC stream
@@ -209,7 +249,8 @@ class TpcStreamUnpack
    bool hasCaptureError () const; 
 
    // true if stream has any checksum error
-   // Not implemented
+   // Not implemented.  The record layout gives the cold data checksum
+   // fields of the WIB frames, but not the algorithm behind them.
    bool hasChecksumError() const; 
 
 
@@ -238,6 +279,117 @@ class TpcStreamUnpack
    // Identifier class to retrieve the crate, slot and fiber.
    // ------------------------------------------------------------------
    Identifier getIdentifier  () const;
+
+
+   // ------------------------------------------------------------------
+   // Channel selection
+   // Selects a subset of the 128 channels of a stream, channel n by
+   // bit n % 64 of m_bits[n / 64].  By default no channel is selected.
+   // ------------------------------------------------------------------
+   class ChannelMask
+   {
+   public:
+      ChannelMask () : m_bits { 0, 0 } { return; }
+
+      void     set          (int ichan);
+      void     set          (int ichan, int nchans);
+      void     clear        (int ichan);
+      bool     isSet        (int ichan) const;
+      int      getNSelected () const;
+
+      uint64_t const *getBits () const { return m_bits; }
+
+      uint64_t m_bits[2];
+   };
+
+
+   /* ------------------------------------------------------------------ *//*!
+
+      \brief Enumerates how the unpacked ADCs are stored
+                                                                         */
+   /* ------------------------------------------------------------------ */
+   enum class Store
+   {
+      Cached     = 0, /*!< Ordinary stores, the output is left in the
+                           cache, ready to be read back                  */
+      Streaming  = 1  /*!< Non-temporal stores, the output bypasses the
+                           cache so it does not evict the working set of
+                           other threads sharing it.  For output that is
+                           not read soon after it is unpacked.           */
+   };
+
+
+   // ------------------------------------------------------------------
+   // Unpacking options
+   // The optional work done by getMultiChannelData(Untrimmed) (int16_t *,
+   // int, Options const &) while it unpacks.  Each is off by default
+   // and is turned on by its setter.  The setters return the options,
+   // so they can be chained, e.g.
+   //
+   //    Options ().select (mask).stats (stats)
+   //
+   //    select  Only the channels selected by the mask are unpacked.
+   //            They are stored one after the other, in increasing
+   //            channel order, so adcs is essentially
+   //            [mask.getNSelected ()][nadcs].  For compressed data the
+   //            unselected channels are not even decoded.
+   //    stats   The statistics of each channel, stats[n] being channel
+   //            n's, are reset and accumulated over the unpacked ticks
+   //            while the ADCs are still in the cache.  stats must have
+   //            128 entries.  Those of channels not unpacked stay reset.
+   //    assess  The WIB frames are assessed as they are transposed, the
+   //            error records being added to the assessor, as by its
+   //            assessUntrimmed but for the unpacked frames only.
+   //            Compressed data is unpacked without being assessed.
+   //    store   How the ADCs are stored.  This is a hint: Streaming is
+   //            only honored when nothing else reads the output back,
+   //            i.e. when neither select nor stats is set.
+   //
+   // Any combination may be given.  Where there is no single kernel for
+   // it, e.g. select with stats, the extra work is done on each block
+   // of output while it is still in the cache.
+   // ------------------------------------------------------------------
+   class Options
+   {
+   public:
+      Options () :
+         m_mask     (NULL),
+         m_stats    (NULL),
+         m_assessor (NULL),
+         m_store    (Store::Cached)
+      {
+         return;
+      }
+
+      Options &select (ChannelMask const       &mask);
+      Options &stats  (pdd::access::AdcStats  *stats);
+      Options &assess (TpcStreamAssessor   *assessor);
+      Options &store  (Store                  store);
+
+   public:
+      ChannelMask const        *m_mask; /*!< The selected channels or NULL */
+      pdd::access::AdcStats   *m_stats; /*!< The channel statistics or NULL*/
+      TpcStreamAssessor    *m_assessor; /*!< The assessor or NULL          */
+      Store                    m_store; /*!< How the ADCs are stored       */
+   };
+
+
+   // ------------------------------------------------------------------
+   // Region of interest
+   // A run of one channel's ADCs kept by the zero-suppressed unpacking,
+   // see getRois.  Its m_nsamples ADCs are samples[m_offset] onwards of
+   // the samples vector it was returned with.
+   // ------------------------------------------------------------------
+   class Roi
+   {
+   public:
+      uint32_t     m_chan; /*!< The channel                               */
+      uint32_t     m_tick; /*!< Its first tick, counted from the first
+                                unpacked tick                             */
+      uint32_t m_nsamples; /*!< The number of ADCs                        */
+      uint32_t   m_offset; /*!< The index of its first ADC in samples     */
+   };
+
    uint32_t   getStatus      () const;
 
 
@@ -292,10 +444,62 @@ class TpcStreamUnpack
    bool getMultiChannelData          (int16_t                  **adcs) const;
    bool getMultiChannelData          (std::vector<TpcAdcVector> &adcs) const;
 
+   // Contiguous, but with nadcs elements per channel, which may differ
+   // from getNTicks.  At most nadcs ticks are unpacked.
+   bool getMultiChannelData          (int16_t   *adcs,     int  nadcs) const;
+
    bool getMultiChannelDataUntrimmed (int16_t   *adcs,     int nticks) const;
    bool getMultiChannelDataUntrimmed (int16_t  **adcs,     int nticks) const;
    bool getMultiChannelDataUntrimmed (std::vector<TpcAdcVector> &adcs) const;
 
+   // Contiguous, with the optional work of options done in the same
+   // pass, see Options.  With the default options this is the same as
+   // getMultiChannelData (int16_t *, int).
+   bool getMultiChannelData          (int16_t                   *adcs,
+                                      int                        nadcs,
+                                      Options const           &options) const;
+
+   bool getMultiChannelDataUntrimmed (int16_t                   *adcs,
+                                      int                       nticks,
+                                      Options const           &options) const;
+
+   // Contiguous, as pedestal subtracted, gain corrected floats.  Channel
+   // n's values are (adc - peds[n]) * gains[n], the gains being 1 if
+   // NULL.  The conversion is done as the data is unpacked, rather than
+   // as a second pass over the output.
+   bool getMultiChannelData          (float                     *adcs,
+                                      int                        nadcs,
+                                      float const                *peds,
+                                      float const               *gains) const;
+
+   bool getMultiChannelDataUntrimmed (float                     *adcs,
+                                      int                       nticks,
+                                      float const                *peds,
+                                      float const               *gains) const;
+
+   // Zero-suppressed.  Only the runs of channel n's ticks where
+   // |adc - peds[n]| > thresholds[n], widened by npre ticks before and
+   // npost after, are kept.  Runs that then overlap or touch are merged.
+   // The runs are returned in rois, by channel and then by tick, and
+   // their ADCs, as is, one run after the other in samples.  peds and
+   // thresholds must have 128 entries.  The stream is unpacked a block
+   // at a time, so the full channels x ticks array is never allocated.
+   // A run never covers the ticks of a compressed packet that does not
+   // have its channel.
+   bool getRois                      (std::vector<Roi>          &rois,
+                                      std::vector<int16_t>   &samples,
+                                      int16_t const             *peds,
+                                      int16_t const       *thresholds,
+                                      int                        npre,
+                                      int                       npost) const;
+
+   bool getRoisUntrimmed             (std::vector<Roi>          &rois,
+                                      std::vector<int16_t>   &samples,
+                                      int16_t const             *peds,
+                                      int16_t const       *thresholds,
+                                      int                        npre,
+                                      int                       npost) const;
+
    // -----------------------
    // Mainly for internal use
    // -----------------------
@@ -303,6 +507,49 @@ public:
    pdd::access::TpcStream const *getStream ()       { return &m_stream; }
    pdd::access::TpcStream const &getStream () const { return  m_stream; }
 
+private:
+   /* ------------------------------------------------------------------ *//*!
+
+      \brief The quantities that are expensive or used by several of the
+             accessors. It is computed on first use and kept in the 
+             TpcStream's cache.
+
+      \warning
+       Because the first call to any accessor that needs the summary
+       fills the cache, that call is not thread-safe.  If a
+       TpcStreamUnpack is to be shared by several threads, call one of
+       its accessors, e.g. getNTicks, before handing it out.
+
+      \par
+       The event window and untrimmed ranges are read directly from the
+       TpcRanges record, so there is nothing gained by keeping them here.
+                                                                         */
+   /* ------------------------------------------------------------------ */
+   class Summary
+   {
+   public:
+      enum Flags
+      {
+         Valid      = 1, /*!< The summary has been computed              */
+         TpcNormal  = 2, /*!< The result of isTpcNormal                  */
+         TpcDamaged = 4  /*!< The result of isTpcDamaged                 */
+      };
+
+   public:
+      timestamp_t  m_begTs; /*!< Timestamp of the first trimmed frame    */
+      timestamp_t  m_endTs; /*!< Timestamp of the last  trimmed frame    */
+      uint32_t    m_status; /*!< The stream's status, see getStatus      */
+      uint32_t    m_nticks; /*!< Number of ticks in the trimmed data     */
+      int32_t     m_begOff; /*!< Offset of the first trimmed frame       */
+      uint16_t     m_npkts; /*!< Number of packet descriptors, an 8-bit
+                                 field of the TOC header                 */
+      int8_t      m_format; /*!< The DataFormatType                      */
+      uint8_t      m_flags; /*!< The Flags                               */
+   };
+   /* ------------------------------------------------------------------ */
+
+   Summary getSummary () const;
+
 private:
    pdd::access::TpcStream const m_stream;
 };
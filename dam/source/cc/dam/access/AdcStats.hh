@@ -0,0 +1,330 @@
+// -*-Mode: C++;-*-
+
+#ifndef ACCESS_ADCSTATS_HH
+#define ACCESS_ADCSTATS_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     access/AdcStats.hh
+ *  @brief    The statistics of one channel's ADCs, accumulated while
+ *            they are unpacked
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include <cinttypes>
+#include <cmath>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/* ====================================================================== */
+/* class AdcStats                                                         */
+/* ---------------------------------------------------------------------- */
+namespace pdd    {
+namespace access {
+/* ---------------------------------------------------------------------- *//*!
+
+  \class AdcStats
+  \brief The sum, sum of squares, minimum, maximum and number of sticky
+         codes of one channel's ADCs
+
+  \par
+   A sticky code is an ADC whose low 6 bits are all 0 or all 1, 0x00 or
+   0x3f, the values at which the cold ADCs are known to stick.
+
+  \par
+   The ADCs are summed, 8 at a time with SSE2, over blocks of up to
+   MaxBlock ADCs, small enough that the partial sums and counts cannot
+   overflow their lanes, before being added to the 64-bit totals.  The
+   squares are summed in 64-bit lanes, so nothing is assumed about the
+   range of the ADCs, which, from corrupted compressed data, need not
+   be 12-bit values.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class AdcStats
+{
+public:
+   static const int MaxBlock = 256;
+
+public:
+   AdcStats () { reset (); }
+
+   void     reset      ();
+   void     accumulate (int16_t const *adcs, int nadcs);
+   void     add        (AdcStats const &stats);
+
+   uint32_t getN       () const;
+   int64_t  getSum     () const;
+   uint64_t getSum2    () const;
+   int      getMin     () const;
+   int      getMax     () const;
+   uint32_t getNSticky () const;
+   double   getMean    () const;
+   double   getRms     () const;
+
+   static bool isSticky (int adc);
+
+public:
+   int64_t      m_sum; /*!< The sum of the ADCs                           */
+   uint64_t    m_sum2; /*!< The sum of their squares                      */
+   uint32_t       m_n; /*!< The number of ADCs                            */
+   uint32_t m_nsticky; /*!< The number with a sticky code                 */
+   int16_t      m_min; /*!< The smallest, INT16_MAX if there are none     */
+   int16_t      m_max; /*!< The largest,  INT16_MIN if there are none     */
+};
+/* ---------------------------------------------------------------------- */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* IMPLEMENTATION : AdcStats                                              */
+/* ---------------------------------------------------------------------- */
+namespace pdd     {
+namespace access  {
+
+/* ---------------------------------------------------------------------- */
+inline void AdcStats::reset ()
+{
+   m_sum     = 0;
+   m_sum2    = 0;
+   m_n       = 0;
+   m_nsticky = 0;
+   m_min     = INT16_MAX;
+   m_max     = INT16_MIN;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Adds a run of the channel's ADCs to the statistics
+
+  \param[in]  adcs  The ADCs
+  \param[in] nadcs  The number of ADCs
+
+  \par
+   This is meant to be called on ADCs that are still in the cache,
+   having just been stored, so that the statistics do not cost a second
+   pass over memory.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void AdcStats::accumulate (int16_t const *adcs, int nadcs)
+{
+   int16_t vmin = m_min;
+   int16_t vmax = m_max;
+
+   for (int iadc = 0; iadc < nadcs; iadc += MaxBlock)
+   {
+      int nblock = nadcs - iadc;
+      if (nblock > MaxBlock) nblock = MaxBlock;
+
+      int16_t const *src     = adcs + iadc;
+      int64_t        sum     = 0;
+      uint64_t       sum2    = 0;
+      int32_t        nsticky = 0;
+      int            idx     = 0;
+
+#if defined (__SSE2__)
+      // -----------------------------------------------------------
+      // 8 ADCs at a time.  The sums are of pairs, by pmaddwd, each
+      // pair of squares being at most 2**31, so these are widened
+      // to 64 bits as unsigned.  The sticky codes are counted by
+      // subtracting the -1 of each match, 16 bits being plenty for
+      // MaxBlock / 8 per lane.
+      // -----------------------------------------------------------
+      __m128i const   ones = _mm_set1_epi16  (1);
+      __m128i const   mask = _mm_set1_epi16  (0x3e);
+      __m128i const   zero = _mm_setzero_si128 ();
+      __m128i        vsum  = zero;
+      __m128i        vsum2 = zero;
+      __m128i        vstck = zero;
+      __m128i        vlo   = _mm_set1_epi16  (vmin);
+      __m128i        vhi   = _mm_set1_epi16  (vmax);
+
+      for (; idx + 8 <= nblock; idx += 8)
+      {
+         __m128i v  = _mm_loadu_si128 (reinterpret_cast<__m128i const *>(src + idx));
+         __m128i sq = _mm_madd_epi16  (v, v);
+
+         vsum  = _mm_add_epi32 (vsum,  _mm_madd_epi16 (v, ones));
+         vsum2 = _mm_add_epi64 (vsum2, _mm_unpacklo_epi32 (sq, zero));
+         vsum2 = _mm_add_epi64 (vsum2, _mm_unpackhi_epi32 (sq, zero));
+
+         // The low 6 bits of adc + 1 are 0 or 1 only for 0x3f and 0x00
+         __m128i low = _mm_and_si128 (_mm_add_epi16 (v, ones), mask);
+         vstck = _mm_sub_epi16 (vstck, _mm_cmpeq_epi16 (low, zero));
+
+         vlo   = _mm_min_epi16 (vlo, v);
+         vhi   = _mm_max_epi16 (vhi, v);
+      }
+
+      int32_t  lsum[4];
+      uint64_t lsum2[2];
+      int16_t  lstck[8], llo[8], lhi[8];
+      _mm_storeu_si128 (reinterpret_cast<__m128i *>(lsum),  vsum);
+      _mm_storeu_si128 (reinterpret_cast<__m128i *>(lsum2), vsum2);
+      _mm_storeu_si128 (reinterpret_cast<__m128i *>(lstck), vstck);
+      _mm_storeu_si128 (reinterpret_cast<__m128i *>(llo),   vlo);
+      _mm_storeu_si128 (reinterpret_cast<__m128i *>(lhi),   vhi);
+
+      sum  = static_cast<int64_t>(lsum[0]) + lsum[1] + lsum[2] + lsum[3];
+      sum2 = lsum2[0] + lsum2[1];
+      for (int ilane = 0; ilane < 8; ilane++)
+      {
+         nsticky += lstck[ilane];
+         if (llo[ilane] < vmin) vmin = llo[ilane];
+         if (lhi[ilane] > vmax) vmax = lhi[ilane];
+      }
+#endif
+
+      for (; idx < nblock; idx++)
+      {
+         int32_t adc = src[idx];
+         sum        += adc;
+         sum2       += static_cast<uint32_t>(adc * adc);
+         nsticky    += ((adc + 1) & 0x3e) == 0;
+         if (adc < vmin) vmin = adc;
+         if (adc > vmax) vmax = adc;
+      }
+
+      m_sum     += sum;
+      m_sum2    += sum2;
+      m_nsticky += nsticky;
+   }
+
+   m_n   += nadcs;
+   m_min  = vmin;
+   m_max  = vmax;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Adds the statistics of another piece of the same channel
+
+  \param[in] stats  The other piece's statistics
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void AdcStats::add (AdcStats const &stats)
+{
+   m_sum     += stats.m_sum;
+   m_sum2    += stats.m_sum2;
+   m_n       += stats.m_n;
+   m_nsticky += stats.m_nsticky;
+   if (stats.m_min < m_min) m_min = stats.m_min;
+   if (stats.m_max > m_max) m_max = stats.m_max;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- */
+inline uint32_t AdcStats::getN       () const { return m_n;       }
+inline int64_t  AdcStats::getSum     () const { return m_sum;     }
+inline uint64_t AdcStats::getSum2    () const { return m_sum2;    }
+inline int      AdcStats::getMin     () const { return m_min;     }
+inline int      AdcStats::getMax     () const { return m_max;     }
+inline uint32_t AdcStats::getNSticky () const { return m_nsticky; }
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the mean of the ADCs
+  \return The mean, 0 if there are none
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline double AdcStats::getMean () const
+{
+   return m_n ? static_cast<double>(m_sum) / m_n : 0.0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the RMS of the ADCs about their mean
+  \return The RMS, 0 if there are none
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline double AdcStats::getRms () const
+{
+   if (m_n == 0) return 0.0;
+
+   double mean = getMean ();
+   double  var = static_cast<double>(m_sum2) / m_n - mean * mean;
+   return var > 0 ? std::sqrt (var) : 0.0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return whether an ADC is a sticky code
+  \retval true, if its low 6 bits are 0x00 or 0x3f
+
+  \param[in] adc  The ADC
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline bool AdcStats::isSticky (int adc)
+{
+   int low = adc & 0x3f;
+   return low == 0 || low == 0x3f;
+}
+/* ---------------------------------------------------------------------- */
+
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+#endif
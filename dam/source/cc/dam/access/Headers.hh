@@ -40,6 +40,9 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Header3's bridge follows the 16-bit length field, as the
+                  field sizes, 4 + 4 + 16 + 40 = 64, require.  Its offset
+                  was given as 8, that of the length field
    2018.07.11 jjr Added definition of Header3
    2017.08.12 jjr Created
   
@@ -388,7 +391,7 @@ public:
       Format    =  0, /*!< Offset of the format field                    */
       Type      =  4, /*!< Offset of the frame type field                */
       N64       =  8, /*!< Offset of the length field                    */
-      Bridge    =  8  /*!< Offset of the bridge word field               */
+      Bridge    = 24  /*!< Offset of the bridge word field               */
    };
    /* ------------------------------------------------------------------ */
 
@@ -44,6 +44,23 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Documented that the frames decompressWibFrames rebuilds
+                  carry no checksums
+   2026.10.16 agt Added the decompress and decompressChannels that
+                  accumulate each channel's AdcStats
+   2026.10.16 agt Added the streaming decompress and decompressChannels
+   2026.10.16 agt Added the float decompress and decompressChannels
+   2026.10.16 agt Added the channel mask decompress and the channel list
+                  decompressChannels
+   2026.10.16 agt Added TpcCompressedWibHdrs, expands the seed and
+                  exception words into the WIB/ColdData header words of
+                  each frame
+   2026.10.16 agt Added decompressWibFrames
+   2026.10.16 agt Added decompressChannels and the interleaved decoder
+                  controls getDecoder, selectDecoder and getNInterleaved
+   2026.10.16 agt Added decompressChannel, getNDecompressed and the
+                  setNThreads/getNThreads controls of multi-threaded
+                  decompression
    2018.10.22 jjr Added getTocTrailer () method to TpcCompressed
    2018.07.11 jjr Created
   
@@ -70,6 +87,11 @@ namespace record {
 
    class    TpcCompressed;
 }
+
+namespace access {
+
+   class    AdcStats;
+}
 }
 /* ====================================================================== */
 
@@ -233,6 +255,69 @@ private:
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \class TpcCompressedWibHdrs
+  \brief Expands the TPC Compressed Header record into the WIB/ColdData
+         header words of each frame of the packet
+
+  \par
+   The header words start as the seeds, those of the first frame. From
+   one frame to the next, the timestamp advances by 25 and the convert
+   counts of the two cold data links by 1; the other words are constant.
+   At the frame of each exception, the words flagged in its mask are
+   replaced by the next of the record's header words.  Only the header
+   words are expanded, the ADCs are not touched.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class TpcCompressedWibHdrs
+{
+public:
+   /* ------------------------------------------------------------------- *//*!
+
+     \enum  Index
+     \brief The header words, in the order of the exception mask bits
+                                                                          */
+   /* ------------------------------------------------------------------- */
+   enum Index
+   {
+      Wib0       = 0, /*!< WIB word 0, comma, version, id, errors         */
+      Timestamp  = 1, /*!< WIB word 1, the timestamp                      */
+      ColdData00 = 2, /*!< Cold data link 0, word 0, with convert count   */
+      ColdData01 = 3, /*!< Cold data link 0, word 1                       */
+      ColdData10 = 4, /*!< Cold data link 1, word 0, with convert count   */
+      ColdData11 = 5, /*!< Cold data link 1, word 1                       */
+      NWords     = 6  /*!< The number of header words                     */
+   };
+   /* ------------------------------------------------------------------- */
+
+public:
+   TpcCompressedWibHdrs (pdd::record::TpcCompressedHdr const *hdr);
+
+public:
+   int             getFrame         () const;
+   int             getNextException () const;
+   uint64_t const *getWords         () const;
+   uint64_t        getWord          (Index idx) const;
+
+   void            advance          (int nframes);
+   void            fill             (uint64_t *frame) const;
+
+private:
+   void            predict          (int nframes);
+
+private:
+   uint64_t   m_words[NWords]; /*!< The header words of the current frame */
+   uint16_t const      *m_exc; /*!< The next exception                    */
+   uint16_t const   *m_excEnd; /*!< The end of the exceptions             */
+   uint64_t const      *m_hdr; /*!< The next exception header word        */
+   uint64_t const   *m_hdrEnd; /*!< The end of the header words           */
+   int                m_frame; /*!< The current frame number              */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
 
 /* ---------------------------------------------------------------------- *//*!
 
@@ -334,6 +419,40 @@ public:
                         int           nadcs, 
                         int          nticks);
 
+   // Decompression of the channels selected by chanMask, channel n
+   // by bit n % 64 of chanMask[n / 64], into a pseudo 2-D array of
+   // the selected channels.  The others are not decoded.
+   uint32_t decompress (int16_t       *adcs,
+                        int           nadcs,
+                        int           itick,
+                        int          nticks,
+                        uint64_t const chanMask[2]);
+
+   // Decompression into a pseudo 2-D array of floats, channel n's
+   // values being (adc - peds[n]) * gains[n], gains 1 if NULL
+   uint32_t decompress (float         *adcs,
+                        int           nadcs,
+                        int           itick,
+                        int          nticks,
+                        float const   *peds,
+                        float const  *gains);
+
+   // Decompression into a pseudo 2-D ADC array, if stream is true
+   // with non-temporal stores that bypass the caches
+   uint32_t decompress (int16_t       *adcs,
+                        int           nadcs,
+                        int           itick,
+                        int          nticks,
+                        bool         stream);
+
+   // Decompression into a pseudo 2-D ADC array, adding channel n's
+   // ADCs to stats[n]
+   uint32_t decompress (int16_t       *adcs,
+                        int           nadcs,
+                        int           itick,
+                        int          nticks,
+                        AdcStats     *stats);
+
 
    // Decompression into an array of channel pointers
    uint32_t decompress (int16_t  *const *adcs, 
@@ -346,6 +465,95 @@ public:
                         int            nticks);
 
 
+   // Decompression of a single channel
+   uint32_t decompressChannel (int16_t       *adcs,
+                               int           ichan,
+                               int           itick,
+                               int          nticks) const;
+
+   // Decompression of a group of channels, decoded in lockstep
+   void     decompressChannels (int16_t *const *adcs,
+                                int            ichan,
+                                int           nchans,
+                                int            itick,
+                                int           nticks) const;
+
+   // Decompression of a list of channels, decoded in lockstep
+   void     decompressChannels (int16_t *const *adcs,
+                                int const    *ichans,
+                                int           nchans,
+                                int            itick,
+                                int           nticks) const;
+
+   // Decompression of a group of channels into floats, as above
+   void     decompressChannels (float   *const *adcs,
+                                int            ichan,
+                                int           nchans,
+                                int            itick,
+                                int           nticks,
+                                float const    *peds,
+                                float const   *gains) const;
+
+   // Decompression of a group of channels, as above, if stream is
+   // true with non-temporal stores that bypass the caches
+   void     decompressChannels (int16_t *const *adcs,
+                                int            ichan,
+                                int           nchans,
+                                int            itick,
+                                int           nticks,
+                                bool          stream) const;
+
+   // Decompression of a group of channels, as above, adding channel
+   // ichan + idx's ADCs to stats[idx]
+   void     decompressChannels (int16_t *const *adcs,
+                                int            ichan,
+                                int           nchans,
+                                int            itick,
+                                int           nticks,
+                                AdcStats      *stats) const;
+
+   // Decompression back into WibFrames, headers and ADCs.  The cold
+   // data checksum fields of the rebuilt frames are 0, the compression
+   // does not preserve them, so they must not be verified.
+   int      decompressWibFrames (uint64_t     *frames,
+                                 int            itick,
+                                 int           nticks);
+
+   // Number of ADCs/channel decompress would return, no decoding done
+   int      getNDecompressed  (int           itick,
+                               int          nticks) const;
+
+
+   // ----------------------------------------------------------------
+   // Multi-threaded decompression
+   // ----------------------------
+   // The channels are independently decodable, so the decompress
+   // methods, and the extraction of compressed data in TpcStream
+   // unpacking, split the channels across a pool of worker threads.
+   // Each channel is written by exactly one thread, so the output
+   // does not depend on the number of threads.  By default 1 thread,
+   // i.e. the caller, is used.
+   // ----------------------------------------------------------------
+   static void setNThreads (int nthreads);
+   static int  getNThreads ();
+
+
+   // ----------------------------------------------------------------
+   // Interleaved decoding
+   // --------------------
+   // The decompress methods decode the channels in groups of
+   // getNInterleaved, advancing the channels of a group in lockstep
+   // so that their latencies overlap.  The decoder, serial, gen or
+   // avx2, is selected at load time to suit the executing cpu, but
+   // can be overridden by the environment variable
+   // PDD_TPCCOMPRESSED_DECODER or selectDecoder. All the decoders
+   // produce identical output.
+   // ----------------------------------------------------------------
+   static char const *getDecoder      ();
+   static bool        selectDecoder   (char const *name);
+   static int         getNInterleaved ();
+
+
 
 private:
    pdd::record::TpcCompressedHdr        const    *m_hdr;
@@ -846,6 +1054,55 @@ inline void TpcCompressedHdr::print () const
 
 
 
+/* ====================================================================== */
+/* IMPLEMENTATION: pdd::access::TpcCompressedWibHdrs                      */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the number of the frame whose header words are current
+  \return The frame number, counting from the beginning of the packet
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline int TpcCompressedWibHdrs::getFrame () const
+{
+   return m_frame;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the current frame's header words
+  \return The NWords header words, indexed by Index
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t const *TpcCompressedWibHdrs::getWords () const
+{
+   return m_words;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns one of the current frame's header words
+  \return The header word
+
+  \param[in] idx  Which header word
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint64_t TpcCompressedWibHdrs::getWord (Index idx) const
+{
+   return m_words[idx];
+}
+/* ---------------------------------------------------------------------- */
+/* pdd::access::TpcCompressedWibHdrs                                      */
+/* ====================================================================== */
+
+
+
+
 /* ====================================================================== */
 /* IMPPLEMENTATION::TpcCompressedTocTrailer                               */
 /* ---------------------------------------------------------------------- *//*!
@@ -967,6 +1224,22 @@ inline uint32_t  TpcCompressedTocTrailer::getNSamples () const
    return   nsamples;
 }
 /* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief   Returns the bit offsets of the channels' compressed data
+  \return  The bit offsets of the channels' compressed data
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline uint32_t const *TpcCompressedTocTrailer::getOffsets () const
+{
+   uint32_t const *offsets = getOffsets (m_trailer);
+   return          offsets;
+}
+/* ---------------------------------------------------------------------- */
 /* pdd::access::TpcCompressedTocTrailer                                   */
 /* ====================================================================== */
 
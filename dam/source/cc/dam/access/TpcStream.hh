@@ -29,6 +29,15 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The cache is back to the 4 reserved words, so the size
+                  of a TpcStream, and with it of a TpcFragment, is that of
+                  the released library.  getCache is now private and only
+                  available to TpcStreamUnpack.
+   2026.10.16 agt Enlarged the cache to 5 words so that the TpcStreamUnpack
+                  summary can carry 32-bit offsets.
+   2026.10.16 agt The 4 reserved words are now a cache, getCache, where the
+                  higher level accessors keep quantities derived from the
+                  record.  It is cleared by construct.
    2018.09.11 jjr Added
                     isTpcNormal  ()
                     isTpcDamaged ()
@@ -66,6 +75,8 @@ namespace record {
    class          TpcToc;
    class       TpcPacket;
 }}
+
+class TpcStreamUnpack;
 /* ====================================================================== */
 
 
@@ -106,7 +117,16 @@ public:
    bool       isTpcDamaged  () const;
 
 private:
-   void                         const *getReserved (int idx) const;
+   // --------------------------------------------------------------
+   // Scratch space for quantities that TpcStreamUnpack derives from
+   // the record. It is zeroed when the record is constructed and is
+   // otherwise owned by TpcStreamUnpack.  It occupies the 4 words
+   // that were reserved for future use, so it may not grow without
+   // changing the size of the class.
+   // --------------------------------------------------------------
+   friend class ::TpcStreamUnpack;
+   static const int NCache64 = 4;
+   uint64_t                           *getCache  () const;
 
 
 private:
@@ -114,7 +134,7 @@ private:
    pdd::record::TpcRanges       const   *m_ranges; /*!< Time/Packet Ranges*/
    pdd::record::TpcToc          const      *m_toc; /*!< Table of Contents */
    pdd::record::TpcPacket       const   *m_packet; /*!< The data packets  */
-   void                         const  *m_rsvd[4]; /*!< Future use        */
+   mutable uint64_t          m_cache[NCache64]; /*!< Derived quantities*/
 };
 /* ---------------------------------------------------------------------- */
 } /* END: namespace access                                                */
@@ -149,8 +169,8 @@ inline pdd::record::TpcToc          const *TpcStream::getToc    () const
 inline pdd::record::TpcPacket       const *TpcStream::getPacket () const
  { return  m_packet; }
 
-inline void                      const  *TpcStream::getReserved (int idx) const
-{ return m_rsvd[idx]; }
+inline uint64_t                          *TpcStream::getCache  () const
+{ return m_cache; }
 /* ---------------------------------------------------------------------- */
 /*   END: TpcStream                                                       */
 /* ---------------------------------------------------------------------- */
@@ -40,6 +40,23 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added the transposeAdcs128xN that accumulates each
+                  channel's AdcStats as it transposes
+   2026.10.16 agt The x 8N, x 16N and x 32N transposers take any number
+                  of frames
+   2026.10.16 agt Added transposeAdcs128xN_stream, the blocked transposer
+                  with non-temporal stores
+   2026.10.16 agt Added transposeAdcs128xN_blocked, the tiled transposer
+                  for long readout windows
+   2026.10.16 agt Added the float transposeAdcs128xN, producing pedestal
+                  subtracted, gain corrected values
+   2026.10.16 agt Added transposeAdcsMasked128xN, transposes only the
+                  selected channels
+   2026.10.16 agt Added packAdcs128xN, the inverse of transposeAdcs128xN
+   2026.10.16 agt Added countInSequence, the vectorized check of a run of
+                  frames against the expected, error free, sequence.
+   2026.10.16 agt Added getKernels and selectKernels.  The expansion and
+                  transposition kernels are now selected at load time.
    2017.10.18 jjr Separate defintion from implementation
    ---------- --  --------------------------------------
    2017.10.05 jjr Added transposeAdcs128xN. These are methods that optimize
@@ -65,6 +82,9 @@ namespace pdd    {
 namespace access {
 
 
+class AdcStats;
+
+
 class WibColdData : public pdd::record::WibColdData
 {
 public:
@@ -249,25 +269,28 @@ public:
    //-------------------------------
 
    // Transpose any arbitrary number of frames using the mose
-   // optimal technique
+   // optimal technique.  The x 8N, x 16N and x 32N transposers
+   // also take any number of frames, transposing the remainder
+   // that is not a multiple of 8 by overlapping the last group
+   // of 8 with the preceding frames.
    static void transposeAdcs128xN   (int16_t              *dst,
                                      int            ndstStride,
                                      WibFrame const    *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 8 time samples
+   // Transpose 128 adcs x 8 time samples at a time
    static void transposeAdcs128x8N  (int16_t              *dst,
                                      int            ndstStride,
                                      WibFrame const    *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 16*N time samples
+   // Transpose 128 adcs x 16 time samples at a time
    static void transposeAdcs128x16N (int16_t              *dst,
                                      int            ndstStride,
                                      WibFrame const    *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 32*N time samples
+   // Transpose 128 adcs x 32 time samples at a time
    static void transposeAdcs128x32N (int16_t              *dst,
                                      int            ndstStride,
                                      WibFrame const    *frames,
@@ -286,23 +309,166 @@ public:
                                      WibFrame  const   *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 8 time samples
+   // Transpose 128 adcs x 8 time samples at a time
    static void transposeAdcs128x8N  (int16_t  *const  dst[128],
                                      int            ndstStride,
                                      WibFrame  const   *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 16*N time samples
+   // Transpose 128 adcs x 16 time samples at a time
    static void transposeAdcs128x16N (int16_t  *const  dst[128],
                                      int            ndstStride,
                                      WibFrame  const   *frames,
                                      int               nframes);
 
-   // Transpose 128 adcs x 32*N time samples
+   // Transpose 128 adcs x 32 time samples at a time
    static void transposeAdcs128x32N (int16_t  *const  dst[128],
                                      int            ndstStride,
                                      WibFrame  const   *frames,
                                      int               nframes);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Masked transposition
+   // --------------------
+   // Transpose only the channels selected by chanMask, channel
+   // n by bit n % 64 of chanMask[n / 64].  The selected channels
+   // are stored one after the other, in increasing channel order,
+   // i.e. as dst[nselected][ndstStride].  Groups of 16 channels
+   // with none selected are not unpacked.
+   // ----------------------------------------------------------
+   static void transposeAdcsMasked128xN
+                                    (int16_t              *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes,
+                                     uint64_t const chanMask[2]);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Calibrated transposition
+   // ------------------------
+   // Transpose into floats, channel n's value being
+   // (adc - peds[n]) * gains[n], gains being 1 if NULL.  The
+   // conversion is done on cache resident blocks, so this is
+   // one pass over the output, not two.
+   // ----------------------------------------------------------
+   static void transposeAdcs128xN   (float                *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes,
+                                     float const         *peds,
+                                     float const        *gains);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Transposition with statistics
+   // -----------------------------
+   // Transpose, as above, adding channel n's ADCs to stats[n].
+   // Each block of 32 time samples is added while it is still
+   // in the cache, so this is one pass over the output, not two.
+   // The statistics are added to, not reset.
+   // ----------------------------------------------------------
+   static void transposeAdcs128xN   (int16_t              *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes,
+                                     AdcStats           *stats);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Blocked transposition
+   // ---------------------
+   // Transpose into a cache resident tile of ntile time samples,
+   // then store each channel's piece of the tile contiguously.
+   // If ntile is 0, DefTransposeTile is used.  This pays when
+   // ndstStride is a multiple of BlockedTransposeStride, 4 KBytes,
+   // so that all 128 channels map onto the same cache sets.  With
+   // the avx and avx2 kernels it is then 1.2 to 1.7 times faster,
+   // for strides of 2048 to 98304, but up to 1.5 times slower for
+   // strides that are not.  transposeAdcs128xN uses it itself only
+   // in that case, and only if the kernels do not already store
+   // whole cache lines.
+   // ----------------------------------------------------------
+   static const int MaxTransposeTile       =  256;
+   static const int DefTransposeTile       =  256;
+   static const int BlockedTransposeStride = 2048;
+
+   static void transposeAdcs128xN_blocked
+                                    (int16_t              *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes,
+                                     int                 ntile = 0);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Streaming transposition
+   // -----------------------
+   // The blocked transposition, but storing the tiles with
+   // non-temporal stores that bypass the caches.  Use it when
+   // the output is not going to be read soon, so that it does
+   // not evict what the other cores sharing the cache are
+   // working on.
+   // ----------------------------------------------------------
+   static void transposeAdcs128xN_stream
+                                    (int16_t              *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Packers: the inverse of the contiguous memory transposers
+   //----------------------------------------------------------
+   static void packAdcs128xN        (WibFrame             *frames,
+                                     int               nframes,
+                                     int16_t const        *src,
+                                     int            nsrcStride);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Assessment
+   // ----------
+   // Count the leading frames that are error free and continue
+   // the expected sequence: the same version and id, the 
+   // timestamp advancing by 25 and the convert counts by 1 each
+   // frame.
+   // ----------------------------------------------------------
+   static int countInSequence      (WibFrame  const   *frames,
+                                    int               nframes,
+                                    unsigned int      version,
+                                    unsigned int           id,
+                                    uint64_t        timestamp,
+                                    unsigned int      cvtcnt0,
+                                    unsigned int      cvtcnt1);
+   // ----------------------------------------------------------
+
+
+   // ----------------------------------------------------------
+   // Kernel selection
+   // ----------------
+   // The expansion and transposition kernels are selected when
+   // the library is loaded, using the most capable instruction
+   // set (gen, avx, avx2, avx512) supported by the executing cpu.
+   // This may be overridden by setting the environment variable
+   // PDD_WIBFRAME_KERNELS to the name of one of these variants.
+   // ----------------------------------------------------------
+
+   // Name of the kernels in use
+   static char const *getKernels    ();
+
+   // Override the selection, intended for testing/benchmarking
+   static bool        selectKernels (char const *name);
+   // ----------------------------------------------------------
+
 public:
 #if 0
    uint64_t               m_header; /*!< W16  0 -  3, the WIB header word */
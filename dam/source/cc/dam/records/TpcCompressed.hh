@@ -54,6 +54,9 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The ExcCount and Status bridge masks now match their
+                  declared sizes, 8 and 32 bits, which together fill the
+                  40-bit Header3 bridge
    2017.07.11 jjr Created
 
 \* ---------------------------------------------------------------------- */
@@ -149,8 +152,8 @@ public:
       /* ---------------------------------------------------------------- */
       enum class Mask: uint32_t
       {
-         ExcCount = 0x0000000f,  /*!< Mask of the exception word count    */
-         Status   = 0x000000ff   /*!< Mask of the status word             */
+         ExcCount = 0x000000ff,  /*!< Mask of the exception word count    */
+         Status   = 0xffffffff   /*!< Mask of the status word             */
       };
       /* ---------------------------------------------------------------- */
    };
@@ -0,0 +1,461 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdApdLookupTest.cc
+ *  @brief    Tests the integrity and performance of the arithmetic
+ *            decoder's symbol lookup table against the table search it
+ *            replaces
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   The channels are synthesized.  Each uses a table whose bins fall
+ *   off exponentially with the ADC difference, as do those of real
+ *   data, and a stream of random bits.  Since decoding random bits
+ *   yields symbols distributed as the table, this exercises the search
+ *   as real data would.
+ *
+ *   The integrity checks compare
+ *     -# lookup_lut with lookup_bot for every cumulative probability of
+ *        well formed and of garbage tables
+ *     -# APD_decode_lut with APD_decode, symbol by symbol, and the
+ *        number of bits each consumes
+ *
+ *   The performance check times decoding the channels with each.  The
+ *   time for APD_decode_lut includes building the lookup table.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include "../src/AP-Decode.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+
+#define NSAMPLES  1024                   /* Samples per channel           */
+#define NSYMBOLS  (NSAMPLES - 1)         /* Encoded symbols per channel   */
+#define NWORDS    256                    /* 64-bit words per channel      */
+#define NBINS     128                    /* Maximum number of bins        */
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   int     m_nchannels; /*!< Number of channels per trial                 */
+   int       m_ntrials; /*!< Number of timing trials                      */
+   double      m_width; /*!< Width of the ADC differences, 0 = a sweep    */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_nchannels (256),
+   m_ntrials   (  9),
+   m_width     (  0)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "c:n:w:")) != -1)
+   {
+      switch (c)
+      {
+      case 'c': { m_nchannels = strtoul (optarg, NULL, 0); break; }
+      case 'n': { m_ntrials   = strtoul (optarg, NULL, 0); break; }
+      case 'w': { m_width     = strtod  (optarg, NULL);    break; }
+      }
+   }
+
+   if (m_nchannels < 1) m_nchannels = 1;
+   if (m_ntrials   < 1) m_ntrials   = 1;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline uint64_t xorshift (uint64_t &state)
+{
+   state ^= state << 13;
+   state ^= state >>  7;
+   state ^= state << 17;
+   return state;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Build a table whose bins fall off exponentially with the ADC
+          difference they represent
+  \return The number of bins
+
+  \param[out] table  The table, in the format produced by the compressor
+  \param[in]  width  The 1/e width of the ADC differences
+
+   Symbol 0 is the overflow, symbols 2n and 2n-1 are the differences
+   +n and -n.  The counts sum to NSYMBOLS, as they do for real data.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int make_table (APD_table_t *table, double width)
+{
+   int    cnts[NBINS];
+   int    nbins = 1;
+   int    total = 1;
+
+   // The overflow bin gets a token count
+   cnts[0] = 1;
+   for (int ibin = 1; ibin < NBINS; ibin++)
+   {
+      int    diff = ibin >> 1;
+      int     cnt = NSYMBOLS * exp (-diff / width) / (2 * width);
+      if (cnt > NSYMBOLS - total) cnt = NSYMBOLS - total;
+      if (cnt == 0) break;
+
+      cnts[ibin] = cnt;
+      total     += cnt;
+      nbins      = ibin + 1;
+   }
+
+   // The remainder goes to the most probable, 0 difference, bin
+   if (nbins > 1) cnts[1] += NSYMBOLS - total;
+   else           cnts[0] += NSYMBOLS - total;
+
+   table[0]  = nbins;
+   table[1]  = 0;
+   total     = 0;
+   for (int ibin = 0; ibin < nbins; ibin++)
+   {
+      total         += cnts[ibin];
+      table[ibin+2]  = total;
+   }
+
+   return nbins;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Compare lookup_lut with lookup_bot for every cumulative
+          probability
+  \return The number of mismatches
+
+  \param[in] table  The table to check
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int check_lookup (APD_table_t const *table)
+{
+   APD_lut_t lut[APD_K_LUT_SIZE];
+   APD_lut_build (lut, table);
+
+   unsigned int cnt = table[0] - 1;
+   int        nerrs = 0;
+
+   for (unsigned int cum = 0; cum < 0x10000; cum++)
+   {
+      int bot = lookup_bot (cum, table + 1, cnt);
+      int lkp = lookup_lut (cum, table + 1, cnt, lut);
+      if (bot != lkp)
+      {
+         if (nerrs < 8)
+         {
+            printf ("Error: cum %4x lookup_bot %3d lookup_lut %3d\n",
+                    cum, bot, lkp);
+         }
+         nerrs += 1;
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Compare APD_decode_lut with APD_decode on every channel
+  \return The number of mismatches
+
+  \param[in]       table  The table
+  \param[in]         buf  The channels' bit streams
+  \param[in]   nchannels  The number of channels
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int check_decode (APD_table_t const *table,
+                         uint64_t const      *buf,
+                         int            nchannels)
+{
+   APD_lut_t lut[APD_K_LUT_SIZE];
+   APD_lut_build (lut, table);
+
+   int nerrs = 0;
+
+   for (int ichan = 0; ichan < nchannels; ichan++)
+   {
+      APD_dtx bot;
+      APD_dtx lkp;
+
+      APD_start (&bot, buf + ichan * NWORDS, 0);
+      APD_start (&lkp, buf + ichan * NWORDS, 0);
+
+      for (int isym = 0; isym < NSYMBOLS; isym++)
+      {
+         unsigned int sbot = APD_decode     (&bot, table);
+         unsigned int slkp = APD_decode_lut (&lkp, table, lut);
+         if (sbot != slkp)
+         {
+            if (nerrs < 8)
+            {
+               printf ("Error: chan %3d sym %4d APD_decode %3u "
+                       "APD_decode_lut %3u\n", ichan, isym, sbot, slkp);
+            }
+            nerrs += 1;
+         }
+      }
+
+      if (APD_finish (&bot) != APD_finish (&lkp)) nerrs += 1;
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static uint64_t elapsed (struct timeval const *beg, struct timeval const *end)
+{
+   struct timeval dif;
+   timersub (end, beg, &dif);
+   return dif.tv_sec * 1000000 + dif.tv_usec;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Time decoding the channels by searching the table
+  \return The best trial's elapsed time, in microseconds
+
+  \param[in]       table  The table
+  \param[in]         buf  The channels' bit streams
+  \param[in]   nchannels  The number of channels
+  \param[in]     ntrials  The number of trials
+  \param[out]        sum  A checksum of the symbols, this keeps the
+                          compiler from discarding the decoding
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint64_t time_search (APD_table_t const *table,
+                             uint64_t const      *buf,
+                             int            nchannels,
+                             int              ntrials,
+                             unsigned int        &sum)
+{
+   uint64_t best = ~0ULL;
+
+   for (int itrial = 0; itrial < ntrials; itrial++)
+   {
+      struct timeval beg, end;
+      gettimeofday (&beg, NULL);
+
+      for (int ichan = 0; ichan < nchannels; ichan++)
+      {
+         APD_dtx dtx;
+         APD_start (&dtx, buf + ichan * NWORDS, 0);
+         for (int isym = 0; isym < NSYMBOLS; isym++)
+         {
+            sum += APD_decode (&dtx, table);
+         }
+      }
+
+      gettimeofday (&end, NULL);
+      uint64_t usecs = elapsed (&beg, &end);
+      if (usecs < best) best = usecs;
+   }
+
+   return best;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Time decoding the channels using the symbol lookup table,
+          including the time to build it for each channel
+  \return The best trial's elapsed time, in microseconds
+
+  \param[in]       table  The table
+  \param[in]         buf  The channels' bit streams
+  \param[in]   nchannels  The number of channels
+  \param[in]     ntrials  The number of trials
+  \param[out]        sum  A checksum of the symbols
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint64_t time_lookup (APD_table_t const *table,
+                             uint64_t const      *buf,
+                             int            nchannels,
+                             int              ntrials,
+                             unsigned int        &sum)
+{
+   uint64_t best = ~0ULL;
+
+   for (int itrial = 0; itrial < ntrials; itrial++)
+   {
+      struct timeval beg, end;
+      gettimeofday (&beg, NULL);
+
+      for (int ichan = 0; ichan < nchannels; ichan++)
+      {
+         APD_lut_t lut[APD_K_LUT_SIZE];
+         APD_lut_build (lut, table);
+
+         APD_dtx dtx;
+         APD_start (&dtx, buf + ichan * NWORDS, 0);
+         for (int isym = 0; isym < NSYMBOLS; isym++)
+         {
+            sum += APD_decode_lut (&dtx, table, lut);
+         }
+      }
+
+      gettimeofday (&end, NULL);
+      uint64_t usecs = elapsed (&beg, &end);
+      if (usecs < best) best = usecs;
+   }
+
+   return best;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   Prms prms (argc, argv);
+
+   static double const Widths[] = { 0.25, 0.5, 1, 1.5, 2, 3, 4, 8, 16, 32 };
+   int                 nwidths  = sizeof (Widths) / sizeof (*Widths);
+   double const        *widths  = Widths;
+   if (prms.m_width > 0)
+   {
+      widths  = &prms.m_width;
+      nwidths = 1;
+   }
+
+   int        nchannels = prms.m_nchannels;
+   int          ntrials = prms.m_ntrials;
+   uint64_t        *buf = (uint64_t *)malloc (sizeof (*buf)
+                                            * NWORDS * nchannels);
+   uint64_t        seed = 0x9e3779b97f4a7c15ULL;
+   int            nerrs = 0;
+   unsigned int     sum = 0;
+
+   for (int idx = 0; idx < NWORDS * nchannels; idx++)
+   {
+      buf[idx] = xorshift (seed);
+   }
+
+
+   // -------------------------------------------------------
+   // Garbage tables, as a corrupted stream might produce,
+   // need not be monotonic nor sum to the expected total
+   // -------------------------------------------------------
+   for (int itable = 0; itable < 256; itable++)
+   {
+      APD_table_t table[NBINS + 2];
+      int         nbins = 1 + xorshift (seed) % NBINS;
+      table[0]          = nbins;
+      table[1]          = 0;
+      for (int ibin = 0; ibin < nbins; ibin++)
+      {
+         table[ibin + 2] = xorshift (seed) & (itable & 1 ? 0x7ff : 0xffff);
+      }
+      nerrs += check_lookup (table);
+   }
+   printf ("Integrity check of garbage tables: error count = %d\n", nerrs);
+
+
+   printf ("\n"
+           "Width Bins  Errors  Search ns/sym  Lookup ns/sym  Speedup\n"
+           "----- ----  ------  -------------  -------------  -------\n");
+
+   for (int iwidth = 0; iwidth < nwidths; iwidth++)
+   {
+      APD_table_t table[NBINS + 2];
+      int         nbins = make_table (table, widths[iwidth]);
+
+      int errs = check_lookup (table)
+               + check_decode (table, buf, nchannels);
+
+      uint64_t usearch = time_search (table, buf, nchannels, ntrials, sum);
+      uint64_t ulookup = time_lookup (table, buf, nchannels, ntrials, sum);
+
+      double nsyms  = (double)nchannels * NSYMBOLS;
+      printf ("%5.2f %4d  %6d  %13.2f  %13.2f  %7.2f\n",
+              widths[iwidth], nbins, errs,
+              1.e3 * usearch / nsyms,
+              1.e3 * ulookup / nsyms,
+              ulookup ? (double)usearch / ulookup : 0.0);
+
+      nerrs += errs;
+   }
+
+   printf ("\nChecksum %8.8x, total error count = %d\n", sum, nerrs);
+   free (buf);
+
+   return nerrs ? 1 : 0;
+}
+/* ---------------------------------------------------------------------- */
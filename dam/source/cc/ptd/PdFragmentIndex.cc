@@ -0,0 +1,313 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdFragmentIndex.cc
+ *  @brief    Builds, lists and searches the fragment index of binary files
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentIndex.hh"
+#include "dam/FragmentReaderMapped.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcFragmentUnpack.hh"
+#include "dam/TpcStreamUnpack.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <cstdio>
+#include <unistd.h>
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   enum class Find
+   {
+      All       = 0, /*!< List all the entries                            */
+      Sequence  = 1, /*!< Find by sequence number                         */
+      Timestamp = 2, /*!< Find by timestamp                               */
+      Fiber     = 3  /*!< Find all by WIB crate.slot.fiber                */
+   };
+
+public:
+   Find              m_find; /*!< What to search for                      */
+   uint64_t         m_value; /*!< The sequence number or timestamp        */
+   uint32_t         m_crate; /*!< The WIB crate                           */
+   uint32_t          m_slot; /*!< The WIB slot                            */
+   uint32_t         m_fiber; /*!< The WIB fiber                           */
+   bool           m_rebuild; /*!< Rebuild the index, ignoring the sidecar */
+   int           m_ifilecnt; /*!< Input  file name count                  */
+   char *const *m_ifilenames; /*!< Input  file names                      */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_find       (Find::All),
+   m_value      (0),
+   m_crate      (0),
+   m_slot       (0),
+   m_fiber      (0),
+   m_rebuild    (false),
+   m_ifilecnt   (0),
+   m_ifilenames (NULL)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "rs:t:f:")) != -1)
+   {
+      switch (c)
+      {
+      case 'r': { m_rebuild = true;                             break; }
+      case 's': { m_find    = Find::Sequence;
+                  m_value   = strtoull (optarg, NULL, 0);       break; }
+      case 't': { m_find    = Find::Timestamp;
+                  m_value   = strtoull (optarg, NULL, 0);       break; }
+      case 'f':
+      {
+         m_find = Find::Fiber;
+         if (sscanf (optarg, "%u.%u.%u", &m_crate, &m_slot, &m_fiber) != 3)
+         {
+            fprintf (stderr, "Error: -f expects crate.slot.fiber\n");
+            exit (-1);
+         }
+         break;
+      }
+      }
+   }
+
+   if (optind < argc)
+   {
+      m_ifilenames = &argv[optind];
+      m_ifilecnt   = argc - optind;
+   }
+   else
+   {
+      fprintf (stderr,
+               "Usage: PdFragmentIndex [-r] [-s sequence | -t timestamp |"
+               " -f crate.slot.fiber] file ...\n");
+      exit (-1);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static void print_entry (int idx, FragmentIndex::Entry const &entry)
+{
+   printf ("%6d offset %12" PRIu64 " n64 %8u type %u.%u seq %10u"
+           " ts %16.16" PRIx64,
+           idx,
+           entry.m_offset,
+           entry.m_n64,
+           entry.m_type,
+           entry.m_subtype,
+           entry.m_sequence,
+           entry.m_timestamp);
+
+   for (int istream = 0; istream < entry.m_nstreams; istream++)
+   {
+      TpcStreamUnpack::Identifier id = entry.getIdentifier (istream);
+      printf (" wib %u.%u.%u fmt %d",
+              id.getCrate (), id.getSlot (), id.getFiber (),
+              static_cast<int>(entry.getFormat (istream)));
+   }
+
+   if (entry.m_flags & FragmentIndex::Entry::BadTrailer)
+   {
+      printf (" (bad trailer)");
+   }
+
+   putchar ('\n');
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Reads a found fragment directly, by seeking to it, and prints a
+         short summary of its streams
+
+  \param[in] reader  The reader of the indexed file
+  \param[in]  entry  The fragment's entry
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void print_fragment (FragmentReader                   &reader,
+                            FragmentIndex::Entry const        &entry)
+{
+   FragmentReader::Fragment fragment;
+   FragmentReader::Status     status = reader.seek (entry.m_offset);
+
+   if (status == FragmentReader::Status::Okay)
+   {
+      status = reader.read (&fragment);
+   }
+
+   if (status != FragmentReader::Status::Okay)
+   {
+      printf ("       Error: %s\n", FragmentReader::getStatusString (status));
+      if (status != FragmentReader::Status::BadTrailer) return;
+   }
+
+   if (entry.m_nstreams)
+   {
+      DataFragmentUnpack df (fragment.m_buf);
+      TpcFragmentUnpack tpc (df);
+
+      for (int istream = 0; istream < tpc.getNStreams (); istream++)
+      {
+         TpcStreamUnpack const *stream = tpc.getStream (istream);
+         printf ("       stream %d nticks %zu ts %16.16" PRIx64 "\n",
+                 istream,
+                 stream->getNTicks (),
+                 stream->getTimeStamp ());
+      }
+   }
+
+   reader.release (fragment);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   Prms prms (argc, argv);
+   int   ret = 0;
+
+   for (int ifile = 0; ifile < prms.m_ifilecnt; ifile++)
+   {
+      char const *filename = prms.m_ifilenames[ifile];
+      FragmentIndex   index;
+
+      int err;
+      if (prms.m_rebuild)
+      {
+         err = index.build (filename);
+         if (err == 0)
+         {
+            index.write (FragmentIndex::getSidecarName (filename).c_str ());
+         }
+      }
+      else
+      {
+         err = index.load (filename);
+      }
+
+      if (err)
+      {
+         printf ("Error : could not index file: %s\n"
+                 "        Error = %d: %s\n",
+                 filename, err, strerror (err));
+         ret = -1;
+         continue;
+      }
+
+      printf ("File: %s, %d fragments\n", filename, index.getCount ());
+
+
+      FragmentReaderMapped reader (filename, 0);
+      if (prms.m_find != Prms::Find::All && (err = reader.open ()) != 0)
+      {
+         printf ("Error : could not open file: %s\n", filename);
+         ret = -1;
+         continue;
+      }
+
+      switch (prms.m_find)
+      {
+      case Prms::Find::All:
+      {
+         for (int idx = 0; idx < index.getCount (); idx++)
+         {
+            print_entry (idx, index.getEntry (idx));
+         }
+         break;
+      }
+
+      case Prms::Find::Sequence:
+      case Prms::Find::Timestamp:
+      {
+         int idx = prms.m_find == Prms::Find::Sequence
+                 ? index.findSequence  (prms.m_value)
+                 : index.findTimestamp (prms.m_value);
+         if (idx < 0)
+         {
+            printf ("Not found\n");
+            break;
+         }
+
+         print_entry    (idx, index.getEntry (idx));
+         print_fragment (reader, index.getEntry (idx));
+         break;
+      }
+
+      case Prms::Find::Fiber:
+      {
+         int idx = 0;
+         while ((idx = index.findFiber (prms.m_crate,
+                                        prms.m_slot,
+                                        prms.m_fiber, idx)) >= 0)
+         {
+            print_entry    (idx, index.getEntry (idx));
+            print_fragment (reader, index.getEntry (idx));
+            idx += 1;
+         }
+         break;
+      }
+      }
+   }
+
+   return ret;
+}
+/* ---------------------------------------------------------------------- */
@@ -0,0 +1,1132 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdFragmentReaderTest.cc
+ *  @brief    Tests the fragment readers, the index and the pipeline on a
+ *            file of synthesized fragments
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   A temporary file of data fragments of random sizes, each of a WIB
+ *   stream and its compressed twin synthesized by TpcSynth, see
+ *   TpcSynth.hh, is written.  One fragment has a bad trailer and, in
+ *   every other trial, the file ends with a truncated fragment.  The
+ *   checks are
+ *     -# each reader, ReaderBinary, the stream reader of the tools,
+ *        FragmentReaderMapped and FragmentReaderAsync with each of its
+ *        backends and a range of slots and chunk sizes, must return
+ *        exactly the fragments written, in the order written, with
+ *        their offsets and statuses.  A view is kept until the next
+ *        fragment has been read, so a slot reused too early is seen.
+ *     -# FragmentIndex must have an entry for each of the fragments,
+ *        find them by sequence, timestamp and fiber, and survive the
+ *        round trip through its sidecar file.  Seeking each reader to
+ *        the entries, in a random order, must return those fragments.
+ *        load must use the sidecar only while the file is unchanged,
+ *        not after its modification time changes or it is replaced by
+ *        a copy of the same size and modification time.
+ *     -# FragmentPipeline, with a range of workers and depths, must
+ *        deliver every fragment in file order, its ADCs those of
+ *        unpacking it serially, although the processing of the
+ *        fragments finishes out of order, and must stop when asked.
+ *        It must release every fragment it read and never call the
+ *        reader while another call to it is in progress.
+ *
+ *   The program exits with a non-zero status if any check fails.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt checkPipeline checks that the pipeline's calls to the
+                  reader never overlap and that it releases every fragment
+   2026.10.16 agt Added checkStale, load's rejection of a stale sidecar
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include "TpcSynth.hh"
+#include "Reader.hh"
+#include "dam/RceFragmentUnpack.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcFragmentUnpack.hh"
+#include "dam/TpcStreamUnpack.hh"
+#include "dam/FragmentReaderMapped.hh"
+#include "dam/FragmentReaderAsync.hh"
+#include "dam/FragmentIndex.hh"
+#include "dam/FragmentPipeline.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace TpcSynth;
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   int       m_ntrials; /*!< Number of trials of each check               */
+   uint64_t     m_seed; /*!< Seed of the random numbers                   */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_ntrials (2),
+   m_seed    (0xd1b54a32d192ed03ULL)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "n:s:")) != -1)
+   {
+      switch (c)
+      {
+      case 'n': { m_ntrials = strtoul  (optarg, NULL, 0); break; }
+      case 's': { m_seed    = strtoull (optarg, NULL, 0); break; }
+      }
+   }
+
+   if (m_ntrials < 1) m_ntrials = 1;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Written
+  \brief  A fragment as it was written to the file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Written
+{
+public:
+   std::vector<uint64_t>  m_w64; /*!< The fragment                        */
+   uint64_t            m_offset; /*!< Its byte offset in the file         */
+   uint32_t          m_sequence; /*!< Its sequence number                 */
+   uint64_t         m_timestamp; /*!< Its timestamp                       */
+   bool            m_badTrailer; /*!< Its trailer was corrupted           */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  File
+  \brief  The temporary file and what was written to it
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class File
+{
+public:
+   File  (Rng &rng, bool truncate);
+  ~File  ();
+
+public:
+   std::string              m_name; /*!< The file's name                  */
+   std::vector<Written>     m_frags; /*!< The complete fragments          */
+   bool                 m_truncated; /*!< It ends with a truncated one    */
+   bool                      m_okay; /*!< It was successfully written     */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Write a file of synthesized fragments
+
+  \param[in,out]      rng  The random number generator
+  \param[in]     truncate  If true, the file ends with a truncated
+                           fragment
+                                                                          */
+/* ---------------------------------------------------------------------- */
+File::File (Rng &rng, bool truncate) :
+   m_truncated (truncate),
+   m_okay      (false)
+{
+   char const *tmpdir = getenv ("TMPDIR");
+   std::string   name = std::string (tmpdir ? tmpdir : "/tmp")
+                      + "/PdFragmentReaderTest.XXXXXX";
+   std::vector<char> path (name.begin (), name.end ());
+   path.push_back (0);
+
+   int fd = mkstemp (path.data ());
+   if (fd < 0)
+   {
+      perror ("mkstemp");
+      return;
+   }
+   m_name = path.data ();
+
+
+   // -----------------------------------------------------------
+   // The fragments, of 64 to 2048 frames per stream, from random
+   // fibers, their sequence numbers and timestamps increasing
+   // -----------------------------------------------------------
+   int nfrags = 12 + rng () % 12;
+   int ibad   = rng () % (nfrags - 1);
+   uint64_t offset = 0;
+   bool       okay = true;
+
+   for (int ifrag = 0; ifrag < nfrags + truncate; ifrag++)
+   {
+      StreamSpec spec;
+      spec.m_npkts    = 1  + rng () % 2;
+      spec.m_nframes  = 64 + rng () % 961;
+      spec.m_begFrame = spec.m_npkts * spec.m_nframes / 8;
+      spec.m_endFrame = spec.m_npkts * spec.m_nframes - spec.m_begFrame;
+      spec.m_csf      = rng () & 0xfff;
+      spec.m_left     = 1;
+      spec.m_seed     = rng.next ();
+
+      std::vector<uint64_t> frames;
+      std::vector<uint64_t> wib = wibStream      (spec, NULL, &frames);
+      std::vector<uint64_t> cmp = compressStream (rng, spec, wib, frames);
+
+      Written written;
+      written.m_sequence   = 1000 + 3 * ifrag;
+      written.m_timestamp  = 0x10000000ull + 0x10000ull * ifrag
+                           + rng () % 0x100;
+      written.m_w64        = fragment ({ wib, cmp }, 2, written.m_sequence,
+                                       written.m_timestamp);
+      written.m_offset     = offset;
+      written.m_badTrailer = ifrag == ibad;
+      if (written.m_badTrailer) written.m_w64.back () ^= 1;
+
+      size_t nbytes = written.m_w64.size () * sizeof (uint64_t);
+      if (ifrag == nfrags) nbytes /= 2;
+
+      okay &= ::write (fd, written.m_w64.data (), nbytes) == (ssize_t)nbytes;
+      offset += nbytes;
+
+      if (ifrag < nfrags) m_frags.push_back (written);
+   }
+
+   m_okay = ::close (fd) == 0 && okay;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+File::~File ()
+{
+   if (m_name.size ())
+   {
+      unlink (m_name.c_str ());
+      unlink (FragmentIndex::getSidecarName (m_name.c_str ()).c_str ());
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check that a fragment is the one written
+  \return The number of mismatches, 0 or 1
+
+  \param[in]  written  The fragment written
+  \param[in] fragment  The fragment read
+  \param[in]   status  Its read status
+  \param[in]     what  The reader, for the message
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int check (Written                  const  &written,
+                  FragmentReader::Fragment const &fragment,
+                  FragmentReader::Status           status,
+                  char                     const     *what)
+{
+   FragmentReader::Status expected = written.m_badTrailer
+                                   ? FragmentReader::Status::BadTrailer
+                                   : FragmentReader::Status::Okay;
+
+   if (status          != expected                  ||
+       fragment.m_offset != written.m_offset         ||
+       fragment.m_n64    != written.m_w64.size ()    ||
+       memcmp (fragment.m_buf, written.m_w64.data (),
+               written.m_w64.size () * sizeof (uint64_t)))
+   {
+      printf ("%s: fragment at %" PRIu64 " status %s, n64 %u,"
+              " expected %s at %" PRIu64 " n64 %zu\n",
+              what, fragment.m_offset,
+              FragmentReader::getStatusString (status), fragment.m_n64,
+              FragmentReader::getStatusString (expected), written.m_offset,
+              written.m_w64.size ());
+      return 1;
+   }
+
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the stream reader of the tools
+  \return The number of mismatches
+
+  \param[in] file  The file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkBinary (File const &file)
+{
+   ReaderBinary reader (file.m_name.c_str ());
+   if (reader.open ())
+   {
+      printf ("Binary: cannot open %s\n", file.m_name.c_str ());
+      return 1;
+   }
+
+   int                   nerrs = 0;
+   uint64_t             offset = 0;
+   std::vector<uint64_t>   buf (16 * 1024 * 1024 / sizeof (uint64_t));
+
+   for (size_t ifrag = 0; ; ifrag++)
+   {
+      HeaderFragmentUnpack *header = HeaderFragmentUnpack::assign (buf.data ());
+      ssize_t               nbytes = reader.read (header);
+      if (nbytes <= 0) break;
+
+      uint64_t n64   = header->getN64 ();
+      ssize_t  nread = n64 <= buf.size ()
+                     ? reader.read (buf.data (), n64, nbytes) : -1;
+      if (nread <= 0)
+      {
+         if (!file.m_truncated || ifrag != file.m_frags.size ())
+         {
+            printf ("Binary: fragment %zu cannot be read\n", ifrag);
+            nerrs++;
+         }
+         break;
+      }
+
+      if (ifrag >= file.m_frags.size ())
+      {
+         printf ("Binary: fragment %zu was not written\n", ifrag);
+         nerrs++;
+         break;
+      }
+
+      FragmentReader::Fragment fragment;
+      fragment.m_buf    = buf.data ();
+      fragment.m_offset = offset;
+      fragment.m_n64    = n64;
+      fragment.m_slot   = 0;
+      offset           += n64 * sizeof (uint64_t);
+
+      bool okay = RceFragmentUnpack::isOkay (buf.data (),
+                                             n64 * sizeof (uint64_t));
+      nerrs += check (file.m_frags[ifrag], fragment,
+                      okay ? FragmentReader::Status::Okay
+                           : FragmentReader::Status::BadTrailer, "Binary");
+   }
+
+   if (offset != file.m_frags.back ().m_offset
+               + file.m_frags.back ().m_w64.size () * sizeof (uint64_t))
+   {
+      printf ("Binary: stopped at %" PRIu64 "\n", offset);
+      nerrs++;
+   }
+
+   reader.close ();
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check a reader reading the file from beginning to end
+  \return The number of mismatches
+
+  \param[in]    file  The file
+  \param[in]  reader  The reader, which is opened and closed
+  \param[in]    what  The reader, for the messages
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkSequential (File const     &file,
+                            FragmentReader &reader,
+                            char const       *what)
+{
+   int err = reader.open ();
+   if (err)
+   {
+      printf ("%s: cannot open, %s\n", what, strerror (err));
+      return 1;
+   }
+
+   int                      nerrs = 0;
+   bool                      held = false;
+   FragmentReader::Fragment  prv;
+   size_t                   ifrag = 0;
+   FragmentReader::Status  status;
+
+   while (1)
+   {
+      FragmentReader::Fragment fragment;
+      status = reader.read (&fragment);
+      if (status != FragmentReader::Status::Okay &&
+          status != FragmentReader::Status::BadTrailer)
+      {
+         break;
+      }
+
+      if (ifrag >= file.m_frags.size ())
+      {
+         printf ("%s: fragment %zu was not written\n", what, ifrag);
+         reader.release (fragment);
+         nerrs++;
+         break;
+      }
+
+      nerrs += check (file.m_frags[ifrag], fragment, status, what);
+
+
+      // -------------------------------------------------------
+      // The previous view must be intact after the next read
+      // -------------------------------------------------------
+      if (held)
+      {
+         nerrs += check (file.m_frags[ifrag - 1], prv,
+                         file.m_frags[ifrag - 1].m_badTrailer
+                         ? FragmentReader::Status::BadTrailer
+                         : FragmentReader::Status::Okay, what);
+         reader.release (prv);
+      }
+
+      prv  = fragment;
+      held = true;
+      ifrag++;
+   }
+
+   if (held) reader.release (prv);
+
+   FragmentReader::Status expected = file.m_truncated
+                                   ? FragmentReader::Status::Truncated
+                                   : FragmentReader::Status::EndOfFile;
+   if (ifrag != file.m_frags.size () || status != expected)
+   {
+      printf ("%s: %zu fragments, ended with %s, expected %zu %s\n",
+              what, ifrag, FragmentReader::getStatusString (status),
+              file.m_frags.size (), FragmentReader::getStatusString (expected));
+      nerrs++;
+   }
+
+   reader.close ();
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the index of the file
+  \return The number of mismatches
+
+  \param[in]  file  The file
+  \param[out] index  The index
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkIndex (File const &file, FragmentIndex *index)
+{
+   int nerrs = 0;
+
+   if (index->build (file.m_name.c_str ()) ||
+       index->getCount () != (int)file.m_frags.size ())
+   {
+      printf ("Index: %d entries, expected %zu\n",
+              index->getCount (), file.m_frags.size ());
+      return 1;
+   }
+
+
+   // --------------------------------------------------
+   // Each entry, against what was written and unpacked
+   // --------------------------------------------------
+   for (int idx = 0; idx < index->getCount (); idx++)
+   {
+      FragmentIndex::Entry const &entry   = index->getEntry (idx);
+      Written              const &written = file.m_frags[idx];
+      DataFragmentUnpack          df (written.m_w64.data ());
+      TpcFragmentUnpack           tpc (df);
+
+      bool okay = entry.m_offset    == written.m_offset
+               && entry.m_n64       == written.m_w64.size ()
+               && entry.m_sequence  == written.m_sequence
+               && entry.m_timestamp == written.m_timestamp
+               && entry.m_nstreams  == tpc.getNStreams ()
+               && !(entry.m_flags & FragmentIndex::Entry::BadTrailer)
+                                    == !written.m_badTrailer;
+
+      for (int istream = 0; okay && istream < entry.m_nstreams; istream++)
+      {
+         TpcStreamUnpack const *stream = tpc.getStream (istream);
+         okay = entry.m_csfs[istream]
+             == static_cast<uint16_t>(stream->getIdentifier ().m_w32)
+             && entry.getFormat (istream) == stream->getDataFormatType ();
+      }
+
+      if (!okay && nerrs++ < 8)
+      {
+         printf ("Index: entry %d offset %" PRIu64 " sequence %u timestamp %"
+                 PRIx64 " flags %x\n", idx, entry.m_offset, entry.m_sequence,
+                 entry.m_timestamp, entry.m_flags);
+      }
+
+
+      // -------------------------------------------------------
+      // The searches.  The timestamps increase, with gaps, and
+      // the fibers repeat rarely, if at all.
+      // -------------------------------------------------------
+      TpcStreamUnpack::Identifier id = entry.getIdentifier (0);
+      int ifiber = index->findFiber (id.getCrate (), id.getSlot (),
+                                     id.getFiber ());
+
+      if ((index->findSequence  (written.m_sequence)      != idx ||
+           index->findTimestamp (written.m_timestamp)     != idx ||
+           index->findTimestamp (written.m_timestamp + 1) != idx ||
+           ifiber < 0 || ifiber > idx ||
+           !index->getEntry (ifiber).hasFiber (id.getCrate (),
+                                               id.getSlot  (),
+                                               id.getFiber ()))
+          && nerrs++ < 8)
+      {
+         printf ("Index: entry %d not found\n", idx);
+      }
+   }
+
+   if (index->findSequence  (file.m_frags[0].m_sequence + 1)  != -1 ||
+       index->findTimestamp (file.m_frags[0].m_timestamp - 1) != -1)
+   {
+      printf ("Index: found what was not written\n");
+      nerrs++;
+   }
+
+
+   // ---------------------------------------------
+   // The round trip through the sidecar, which is
+   // then what load uses
+   // ---------------------------------------------
+   std::string   idxname = FragmentIndex::getSidecarName (file.m_name.c_str ());
+   FragmentIndex copy;
+   FragmentIndex loaded;
+   if (index->write (idxname.c_str ())        ||
+       copy.read    (idxname.c_str ())        ||
+       loaded.load  (file.m_name.c_str ())    ||
+       copy  .getCount    () != index->getCount    () ||
+       loaded.getCount    () != index->getCount    () ||
+       copy  .getFileSize () != index->getFileSize ())
+   {
+      printf ("Index: the sidecar round trip failed\n");
+      return nerrs + 1;
+   }
+
+   for (int idx = 0; idx < index->getCount (); idx++)
+   {
+      if (memcmp (&copy  .getEntry (idx), &index->getEntry (idx),
+                  sizeof (FragmentIndex::Entry)) ||
+          memcmp (&loaded.getEntry (idx), &index->getEntry (idx),
+                  sizeof (FragmentIndex::Entry)))
+      {
+         printf ("Index: sidecar entry %d differs\n", idx);
+         nerrs++;
+         break;
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Corrupt the sequence number of the first entry of a sidecar
+  \return true if successful
+
+  \param[in] idxname  The sidecar
+  \param[in]   count  Its number of entries, which end the file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static bool corrupt (std::string const &idxname, int count)
+{
+   int fd = open (idxname.c_str (), O_RDWR);
+   if (fd < 0) return false;
+
+   struct stat st;
+   uint32_t   seq;
+   bool      okay = fstat (fd, &st) == 0;
+   off_t       at = st.st_size - count * sizeof (FragmentIndex::Entry)
+                  + offsetof (FragmentIndex::Entry, m_sequence);
+
+   okay = okay && pread  (fd, &seq, sizeof (seq), at) == sizeof (seq);
+   seq  = ~seq;
+   okay = okay && pwrite (fd, &seq, sizeof (seq), at) == sizeof (seq);
+
+   return close (fd) == 0 && okay;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check that load uses the sidecar only while the file is
+          unchanged
+  \return The number of mismatches
+
+  \param[in]  file  The file
+  \param[in] index  Its index
+
+  \par
+   The sidecar is written with its first entry corrupted, so an index
+   loaded from it is told from one rebuilt from the file.  The file is
+   then left as is, given a later modification time, and replaced by a
+   copy with the same size and modification time, but another inode.
+   Only the first may load the corrupted entry.  The file's contents
+   are unchanged throughout.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkStale (File const &file, FragmentIndex const &index)
+{
+   static char const *const Changes[3] = { "unchanged", "touched",
+                                           "replaced" };
+
+   char const *name    = file.m_name.c_str ();
+   std::string idxname = FragmentIndex::getSidecarName (name);
+   std::string tmpname = file.m_name + ".tmp";
+   int         nerrs   = 0;
+
+   for (int ichange = 0; ichange < 3; ichange++)
+   {
+      struct stat st;
+      if (index.write (idxname.c_str ())          ||
+          !corrupt    (idxname, index.getCount ()) ||
+          stat        (name, &st) != 0)
+      {
+         printf ("Index: the corrupted sidecar was not written\n");
+         return nerrs + 1;
+      }
+
+      struct timespec times[2] = { st.st_atim, st.st_mtim };
+      bool               okay  = true;
+      if (ichange == 1)
+      {
+         times[1].tv_sec += 1;
+         okay = utimensat (AT_FDCWD, name, times, 0) == 0;
+      }
+      else if (ichange == 2)
+      {
+         std::vector<char> bytes (st.st_size);
+         FILE *in  = fopen (name,            "rb");
+         FILE *out = fopen (tmpname.c_str (), "wb");
+         okay = in && out
+             && fread  (bytes.data (), 1, bytes.size (), in)  == bytes.size ()
+             && fwrite (bytes.data (), 1, bytes.size (), out) == bytes.size ();
+         if (in)  fclose (in);
+         if (out) okay &= fclose (out) == 0;
+
+         okay = okay
+             && utimensat (AT_FDCWD, tmpname.c_str (), times, 0) == 0
+             && rename    (tmpname.c_str (), name)              == 0;
+         if (!okay) unlink (tmpname.c_str ());
+      }
+
+      if (!okay)
+      {
+         printf ("Index: the file could not be %s\n", Changes[ichange]);
+         nerrs++;
+         continue;
+      }
+
+      FragmentIndex loaded;
+      if (loaded.load (name) || loaded.getCount () != index.getCount ())
+      {
+         printf ("Index: the %s file's index did not load\n",
+                 Changes[ichange]);
+         nerrs++;
+         continue;
+      }
+
+      bool used = loaded.getEntry (0).m_sequence
+               != index .getEntry (0).m_sequence;
+      if (used != (ichange == 0))
+      {
+         printf ("Index: the sidecar of the %s file was %s\n",
+                 Changes[ichange], used ? "used" : "not used");
+         nerrs++;
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check a reader seeking to the indexed fragments
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator
+  \param[in]     file  The file
+  \param[in]    index  Its index
+  \param[in]   reader  The reader, which is opened and closed
+  \param[in]     what  The reader, for the messages
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkSeek (Rng                 &rng,
+                      File          const &file,
+                      FragmentIndex const &index,
+                      FragmentReader    &reader,
+                      char          const  *what)
+{
+   if (reader.open ())
+   {
+      printf ("%s: cannot open\n", what);
+      return 1;
+   }
+
+   int nerrs = 0;
+   for (int iseek = 0; iseek < 2 * index.getCount (); iseek++)
+   {
+      int                         idx = rng () % index.getCount ();
+      FragmentIndex::Entry const &entry = index.getEntry (idx);
+      FragmentReader::Fragment    fragment;
+
+      FragmentReader::Status status = reader.seek (entry.m_offset);
+      if (status != FragmentReader::Status::Okay)
+      {
+         printf ("%s: seek to %" PRIu64 " %s\n", what, entry.m_offset,
+                 FragmentReader::getStatusString (status));
+         nerrs++;
+         continue;
+      }
+
+      status = reader.read (&fragment);
+      if (fragment.m_buf == 0)
+      {
+         printf ("%s: seek to %" PRIu64 " read %s\n", what, entry.m_offset,
+                 FragmentReader::getStatusString (status));
+         nerrs++;
+         continue;
+      }
+
+      nerrs += check (file.m_frags[idx], fragment, status, what);
+      reader.release (fragment);
+   }
+
+   if (reader.seek (file.m_frags[0].m_offset + 4) !=
+                                      FragmentReader::Status::BadSeek ||
+       reader.seek (index.getFileSize () + 8)     !=
+                                      FragmentReader::Status::BadSeek)
+   {
+      printf ("%s: a bad seek was accepted\n", what);
+      nerrs++;
+   }
+
+   reader.close ();
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Exclusive
+  \brief  Wraps a reader, counting the calls that overlap another and
+          the fragments read and released
+
+  \par
+   A read is slowed down a little, so that a release made while it is
+   in progress is likely to be seen.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Exclusive : public FragmentReader
+{
+public:
+   Exclusive (FragmentReader &reader) :
+      FragmentReader (reader.getFilename ()),
+      m_reader       (reader),
+      m_inside       (0),
+      m_overlaps     (0),
+      m_reads        (0),
+      m_releases     (0)
+   {
+      return;
+   }
+
+   virtual int open ()
+   {
+      enter ();
+      int err = m_reader.open ();
+      leave ();
+      return err;
+   }
+
+   virtual Status read (Fragment *fragment)
+   {
+      enter ();
+      usleep (100);
+      Status status = m_reader.read (fragment);
+      if (status == Status::Okay || status == Status::BadTrailer) m_reads++;
+      leave ();
+      return status;
+   }
+
+   virtual void release (Fragment const &fragment)
+   {
+      enter ();
+      m_reader.release (fragment);
+      m_releases++;
+      leave ();
+      return;
+   }
+
+   virtual Status seek (uint64_t offset)
+   {
+      enter ();
+      Status status = m_reader.seek (offset);
+      leave ();
+      return status;
+   }
+
+   virtual int close ()
+   {
+      enter ();
+      int err = m_reader.close ();
+      leave ();
+      return err;
+   }
+
+private:
+   void enter () { if (m_inside++) m_overlaps++; }
+   void leave () { m_inside--; }
+
+public:
+   FragmentReader     &m_reader; /*!< The wrapped reader                  */
+   std::atomic<int>    m_inside; /*!< The number of calls in progress     */
+   std::atomic<int>  m_overlaps; /*!< The calls that overlapped another   */
+   std::atomic<int>     m_reads; /*!< The fragments read                  */
+   std::atomic<int>  m_releases; /*!< The fragments released              */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Delivery
+  \brief  Checks the items delivered by the pipeline
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Delivery : public FragmentPipeline::Processor
+{
+public:
+   Delivery (File const &file, int stop) :
+      m_file  (file),
+      m_stop  (stop),
+      m_next  (0),
+      m_nerrs (0)
+   {
+      return;
+   }
+
+   virtual void process (FragmentPipeline::Item &item);
+   virtual bool deliver (FragmentPipeline::Item &item);
+
+public:
+   File const          &m_file; /*!< The file                             */
+   int                  m_stop; /*!< The item to stop at, -1 for none     */
+   int                  m_next; /*!< The index of the next item           */
+   int                 m_nerrs; /*!< The number of mismatches             */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Delays the processing of some items, so they finish out of
+          order
+
+  \param[in,out] item  The item
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void Delivery::process (FragmentPipeline::Item &item)
+{
+   usleep (((item.m_index * 7919) % 5) * 500);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Checks the item is the next fragment and was unpacked
+  \retval true,  to continue
+  \retval false, to stop at the requested item
+
+  \param[in] item  The item
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool Delivery::deliver (FragmentPipeline::Item &item)
+{
+   if (item.m_index != static_cast<uint64_t>(m_next) ||
+       m_next >= (int)m_file.m_frags.size ())
+   {
+      printf ("Pipeline: item %" PRIu64 " delivered, expected %d\n",
+              item.m_index, m_next);
+      m_nerrs++;
+      return false;
+   }
+
+   Written const &written = m_file.m_frags[m_next];
+   m_nerrs += check (written, item.m_fragment, item.m_status, "Pipeline");
+
+
+   // ---------------------------------------------------
+   // The ADCs, as unpacked serially, stream by stream
+   // ---------------------------------------------------
+   DataFragmentUnpack df (written.m_w64.data ());
+   TpcFragmentUnpack  tpc (df);
+   int                nticks = 0;
+   for (int istream = 0; istream < tpc.getNStreams (); istream++)
+   {
+      int n = tpc.getStream (istream)->getNTicks ();
+      if (n > nticks) nticks = n;
+   }
+
+   size_t               nadcs = 128 * static_cast<size_t>(nticks);
+   std::vector<int16_t> ref (tpc.getNStreams () * nadcs);
+   for (int istream = 0; istream < tpc.getNStreams (); istream++)
+   {
+      tpc.getStream (istream)->getMultiChannelData (&ref[istream * nadcs],
+                                                    nticks);
+   }
+
+   if (!item.m_okay                            ||
+       item.m_nstreams != tpc.getNStreams ()   ||
+       item.m_nticks   != nticks               ||
+       item.m_adcs.size () < ref.size ()       ||
+       memcmp (item.m_adcs.data (), ref.data (),
+               ref.size () * sizeof (int16_t)))
+   {
+      printf ("Pipeline: item %d, %d streams of %d ticks, okay %d differs\n",
+              m_next, item.m_nstreams, item.m_nticks, item.m_okay);
+      m_nerrs++;
+   }
+
+   return m_next++ != m_stop;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the pipeline
+  \return The number of mismatches
+
+  \param[in,out] rng  The random number generator
+  \param[in]    file  The file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkPipeline (Rng &rng, File const &file)
+{
+   int nerrs = 0;
+
+   for (int irun = 0; irun < 4; irun++)
+   {
+      int nworkers = 1 + rng () % 4;
+      int depth    = 1 + rng () % 8;
+      int nfrags   = file.m_frags.size ();
+      int stop     = irun == 3 ? rng () % nfrags : -1;
+
+      FragmentPipeline    pipeline (nworkers, depth);
+      FragmentReaderMapped  mapped (file.m_name.c_str ());
+      FragmentReaderAsync    async (file.m_name.c_str (), 4, 256 * 1024,
+                                    FragmentReaderAsync::Backend::Threads);
+      FragmentReader       &reader = irun & 1
+                                   ? static_cast<FragmentReader &>(async)
+                                   : static_cast<FragmentReader &>(mapped);
+
+      if (reader.open ())
+      {
+         printf ("Pipeline: cannot open\n");
+         nerrs++;
+         continue;
+      }
+
+      Exclusive exclusive (reader);
+      Delivery  delivery  (file, stop);
+      FragmentReader::Status status = pipeline.run (exclusive, delivery);
+      reader.close ();
+
+      if (exclusive.m_overlaps || exclusive.m_reads != exclusive.m_releases)
+      {
+         printf ("Pipeline: %d overlapping reader calls, %d fragments read"
+                 " and %d released\n", exclusive.m_overlaps.load (),
+                 exclusive.m_reads.load (), exclusive.m_releases.load ());
+         nerrs++;
+      }
+
+      int expected = stop < 0 ? nfrags : stop + 1;
+      FragmentReader::Status final = file.m_truncated
+                                   ? FragmentReader::Status::Truncated
+                                   : FragmentReader::Status::EndOfFile;
+      if (delivery.m_next != expected || (stop < 0 && status != final))
+      {
+         printf ("Pipeline: %d workers depth %d, %d delivered ending %s,"
+                 " expected %d\n", nworkers, depth, delivery.m_next,
+                 FragmentReader::getStatusString (status), expected);
+         nerrs++;
+      }
+
+      nerrs += delivery.m_nerrs;
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   static size_t const ChunkSizes[] = { 4096, 64 * 1024, 1024 * 1024 };
+
+   Prms prms (argc, argv);
+   Rng   rng (prms.m_seed);
+
+   int nrd    = 0;
+   int nidx   = 0;
+   int npipe  = 0;
+   bool uring = false;
+
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      File file (rng, itrial & 1);
+      if (!file.m_okay)
+      {
+         printf ("Cannot write the file\n");
+         return 1;
+      }
+
+
+      // ---------------------------------------------------
+      // The sequential reads, the async reader with each
+      // backend and a random number of slots of each size
+      // ---------------------------------------------------
+      nrd += checkBinary (file);
+
+      FragmentReaderMapped mapped (file.m_name.c_str ());
+      nrd += checkSequential (file, mapped, "Mapped");
+
+      for (size_t chunkSize : ChunkSizes)
+      {
+         int nslots = 2 + rng () % 7;
+         FragmentReaderAsync threads (file.m_name.c_str (), nslots, chunkSize,
+                                      FragmentReaderAsync::Backend::Threads);
+         nrd += checkSequential (file, threads, "Async:threads");
+
+         FragmentReaderAsync ring (file.m_name.c_str (), nslots, chunkSize,
+                                   FragmentReaderAsync::Backend::IoUring);
+         if (ring.open () == 0)
+         {
+            ring.close ();
+            uring = true;
+            nrd  += checkSequential (file, ring, "Async:io_uring");
+         }
+      }
+
+
+      // ------------------------------------------
+      // The index and seeking to what it indexes
+      // ------------------------------------------
+      FragmentIndex index;
+      int           n = checkIndex (file, &index);
+      if (n == 0)
+      {
+         FragmentReaderAsync threads (file.m_name.c_str (), 4, 64 * 1024,
+                                      FragmentReaderAsync::Backend::Threads);
+         n += checkSeek (rng, file, index, mapped,  "Seek:mapped");
+         n += checkSeek (rng, file, index, threads, "Seek:async");
+         n += checkStale (file, index);
+      }
+      nidx += n;
+
+      npipe += checkPipeline (rng, file);
+   }
+
+   printf ("Readers       : %d trials, %d errors%s\n", prms.m_ntrials, nrd,
+           uring ? "" : ", io_uring not available");
+   printf ("Index         : %d trials, %d errors\n", prms.m_ntrials, nidx);
+   printf ("Pipeline      : %d trials, %d errors\n", prms.m_ntrials, npipe);
+
+   return nrd + nidx + npipe ? 1 : 0;
+}
+/* ---------------------------------------------------------------------- */
@@ -0,0 +1,685 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdTpcAssessTest.cc
+ *  @brief    Tests the assessment of synthesized TpcStreams
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   The streams are synthesized by TpcSynth, see TpcSynth.hh, with
+ *   glitched header words, dropped frames and runs of frames with the
+ *   same header error.  The checks are
+ *     -# WibFrame::countInSequence, with each set of kernels the cpu
+ *        supports.  An error is injected into one frame of an otherwise
+ *        error free sequence, for every position in sequences of every
+ *        length up to several times the widest batch, at each frame
+ *        alignment, with the convert counts wrapping.  The count must
+ *        be the position of the error.
+ *     -# the assessments against a frame by frame reference, written
+ *        here from the WibFrame accessors alone.  These are those of
+ *        assessUntrimmed of a WIB stream and of its compressed twin,
+ *        and of getMultiChannelData with the assessing option, which
+ *        assesses the trimmed frames as it transposes them.  The
+ *        records, the runs they are coalesced into and the filtered
+ *        searches of both must be those of the reference, with and
+ *        without keeping the records.
+ *
+ *   The program exits with a non-zero status if any check fails.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include "TpcSynth.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcFragmentUnpack.hh"
+#include "dam/TpcStreamUnpack.hh"
+#include "dam/TpcStreamAssessor.hh"
+#include <dam/access/WibFrame.hh>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+
+
+using namespace pdd::access;
+using namespace TpcSynth;
+
+
+static int const NWords = sizeof (WibFrame) / sizeof (uint64_t);
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   int       m_ntrials; /*!< Number of trials of each check               */
+   uint64_t     m_seed; /*!< Seed of the random numbers                   */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_ntrials (8),
+   m_seed    (0x9e3779b97f4a7c15ULL)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "n:s:")) != -1)
+   {
+      switch (c)
+      {
+      case 'n': { m_ntrials = strtoul  (optarg, NULL, 0); break; }
+      case 's': { m_seed    = strtoull (optarg, NULL, 0); break; }
+      }
+   }
+
+   if (m_ntrials < 1) m_ntrials = 1;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Injects an error into one of the assessed header fields
+
+  \param[in,out] rng  The random number generator
+  \param[in,out]   w  The frame's words
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void inject (Rng &rng, uint64_t *w)
+{
+   int icd = rng () & 1 ? 16 : 2;
+
+   switch (rng () % 5)
+   {
+   case 0: { w[0]       ^= 1ull << (rng () % 64);      break; } // WIB header
+   case 1: { w[1]       ^= 1ull << (rng () % 64);      break; } // Timestamp
+   case 2: { w[icd]     ^= 1ull << (48 + rng () % 16); break; } // Convert count
+   case 3: { w[icd]     ^= 1ull << (rng () % 16);      break; } // Stream errors
+   case 4: { w[icd + 1] ^= 1ull << (rng () % 8);       break; } // Error register
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check WibFrame::countInSequence at every boundary of its batches
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkSequence (Rng &rng)
+{
+   static char const *const Kernels[] = { "gen", "avx", "avx2", "avx512" };
+   static int const         MaxFrames = 40;
+   static int const         MaxOffset = 4;
+
+   // -------------------------------------------------------------
+   // An error free sequence whose convert counts wrap in its midst
+   // -------------------------------------------------------------
+   StreamSpec spec;
+   spec.m_npkts   = 1;
+   spec.m_nframes = MaxFrames + MaxOffset;
+   spec.m_seed    = rng.next ();
+
+   std::vector<uint64_t> clean;
+   wibStream (spec, NULL, &clean);
+
+   unsigned int cvt0 = 0xffff - rng () % spec.m_nframes;
+   unsigned int cvt1 = rng () & 0xffff;
+   for (int iframe = 0; iframe < spec.m_nframes; iframe++)
+   {
+      uint64_t *w = &clean[iframe * NWords];
+      w[ 2] = (w[ 2] & ~(0xffffull << 48))
+            | (static_cast<uint64_t>((cvt0 + iframe) & 0xffff) << 48);
+      w[16] = (w[16] & ~(0xffffull << 48))
+            | (static_cast<uint64_t>((cvt1 + iframe) & 0xffff) << 48);
+   }
+
+
+   char const *original = WibFrame::getKernels ();
+   int            nerrs = 0;
+
+   for (char const *kernels : Kernels)
+   {
+      if (!WibFrame::selectKernels (kernels)) continue;
+
+      for (int nframes = 0; nframes <= MaxFrames; nframes++)
+      {
+         for (int ierr = 0; ierr <= nframes; ierr++)
+         {
+            // -----------------------------------------------------
+            // The error, if any, at ierr and perhaps a second later
+            // -----------------------------------------------------
+            int                   off = rng () % MaxOffset;
+            std::vector<uint64_t> w (clean);
+            if (ierr < nframes)
+            {
+               inject (rng, &w[(off + ierr) * NWords]);
+               if (ierr + 1 < nframes && rng () & 1)
+               {
+                  int isecond = ierr + 1 + rng () % (nframes - ierr - 1);
+                  inject (rng, &w[(off + isecond) * NWords]);
+               }
+            }
+
+            WibFrame const *ref = reinterpret_cast<WibFrame const *>
+                                  (clean.data ()) + off;
+            WibFrame const *wf  = reinterpret_cast<WibFrame const *>
+                                  (w.data ())     + off;
+
+            int n = WibFrame::countInSequence (wf, nframes,
+                                               ref->getVersion   (),
+                                               ref->getId        (),
+                                               ref->getTimestamp (),
+                                               ref->getColdData ()[0]
+                                                   .getConvertCount (),
+                                               ref->getColdData ()[1]
+                                                   .getConvertCount ());
+            if (n != ierr && nerrs++ < 8)
+            {
+               printf ("Sequence[%s]: %d of %d frames at offset %d,"
+                       " expected %d\n", kernels, n, nframes, off, ierr);
+            }
+         }
+      }
+   }
+
+   WibFrame::selectKernels (original);
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Expected
+  \brief  The reference's predictions of the next frame
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Expected
+{
+public:
+   Expected () : m_valid (false) { return; }
+
+public:
+   bool           m_valid; /*!< The predictions have been seeded          */
+   unsigned int m_version; /*!< The version                               */
+   unsigned int      m_id; /*!< The WIB id                                */
+   uint64_t   m_timestamp; /*!< The timestamp                             */
+   uint16_t   m_cvtcnt[2]; /*!< The convert counts of each stream         */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Ref
+  \brief  The reference's record of a frame in error
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Ref
+{
+public:
+   uint32_t       m_smpNum; /*!< The sample number                        */
+   uint32_t       m_errors; /*!< The error mask                           */
+   uint64_t    m_timestamp; /*!< The frame's timestamp                    */
+   uint16_t    m_cvtcnt[2]; /*!< The frame's convert counts               */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Assess the frames one at a time, as documented for
+          TpcStreamAssessor::Record
+  \return The records of the frames in error
+
+  \param[in]  frames  The frames
+  \param[in]  iframe  The first frame to assess, its sample number
+  \param[in] nframes  The number of frames to assess
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static std::vector<Ref> assess (std::vector<uint64_t> const &frames,
+                                int                          iframe,
+                                int                         nframes)
+{
+   typedef TpcStreamAssessor::Record Record;
+
+   std::vector<Ref> refs;
+   Expected         expected;
+
+   WibFrame const *wf = reinterpret_cast<WibFrame const *>(frames.data ());
+   for (int ismp = iframe; ismp < iframe + nframes; ismp++)
+   {
+      WibFrame const &f = wf[ismp];
+      Ref           ref;
+      uint32_t     errs = 0;
+
+      for (int icd = 0; icd < 2; icd++)
+      {
+         WibColdData const &cd = f.getColdData ()[icd];
+         int             shift = icd ? Record::ERR_V_CD1_BEG
+                                     : Record::ERR_V_CD0_BEG;
+
+         if (cd.getStreamErrs  ()) errs |= Record::ERR_M_CD_STRERR << shift;
+         if (cd.getErrRegister ()) errs |= Record::ERR_M_CD_ERRREG << shift;
+         ref.m_cvtcnt[icd] = cd.getConvertCount ();
+      }
+
+      ref.m_timestamp = f.getTimestamp ();
+      if (f.getCommaChar () != 0xbc) errs |= Record::ERR_M_WIB_COMMA;
+      if (f.getWibErrors ())         errs |= Record::ERR_M_WIB_ERRORS;
+      if (f.getReserved  ())         errs |= Record::ERR_M_WIB_RSVD;
+
+      if (expected.m_valid)
+      {
+         if (f.getVersion () != expected.m_version)
+                                     errs |= Record::ERR_M_WIB_VERSION;
+         if (f.getId      () != expected.m_id)
+                                     errs |= Record::ERR_M_WIB_ID;
+         if (ref.m_timestamp != expected.m_timestamp)
+                                     errs |= Record::ERR_M_WIB_TIMESTAMP;
+         if (ref.m_cvtcnt[0] != expected.m_cvtcnt[0])
+                                     errs |= Record::ERR_M_CD0_CVTCNT;
+         if (ref.m_cvtcnt[1] != expected.m_cvtcnt[1])
+                                     errs |= Record::ERR_M_CD1_CVTCNT;
+      }
+      else
+      {
+         expected.m_valid   = true;
+         expected.m_version = f.getVersion ();
+         expected.m_id      = f.getId      ();
+      }
+
+      expected.m_timestamp = ref.m_timestamp + 25;
+      expected.m_cvtcnt[0] = ref.m_cvtcnt[0] + 1;
+      expected.m_cvtcnt[1] = ref.m_cvtcnt[1] + 1;
+
+      if (errs)
+      {
+         ref.m_smpNum = ismp;
+         ref.m_errors = errs;
+         refs.push_back (ref);
+      }
+   }
+
+   return refs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check an assessment against the reference
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator, for the filters
+  \param[in]      asr  The assessor
+  \param[in]     refs  The reference's records
+  \param[in]     what  What was assessed, for the messages
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int compare (Rng                          &rng,
+                    TpcStreamAssessor const      &asr,
+                    std::vector<Ref>      const &refs,
+                    char                  const *what)
+{
+   int nerrs = 0;
+
+
+   // -----------
+   // The summary
+   // -----------
+   uint32_t summary = 0;
+   for (Ref const &ref : refs) summary |= ref.m_errors;
+   if (asr.m_errsummary != summary)
+   {
+      printf ("Assess[%s]: summary %8.8x expected %8.8x\n",
+              what, asr.m_errsummary, summary);
+      nerrs++;
+   }
+
+
+   // -------------------------------------------
+   // The records, only if they were asked for
+   // -------------------------------------------
+   size_t nrecs = asr.m_keepRecords ? refs.size () : 0;
+   if (asr.m_recs.size () != nrecs)
+   {
+      printf ("Assess[%s]: %zu records expected %zu\n",
+              what, asr.m_recs.size (), nrecs);
+      return nerrs + 1;
+   }
+
+   for (size_t irec = 0; irec < nrecs; irec++)
+   {
+      TpcStreamAssessor::Record const &rec = asr.m_recs[irec];
+      Ref                       const &ref = refs[irec];
+      if ((rec.m_smpNum        != ref.m_smpNum         ||
+           rec.m_errors        != ref.m_errors         ||
+           rec.m_pktNum        != ref.m_smpNum / 1024  ||
+           rec.m_frmNum        != ref.m_smpNum % 1024  ||
+           rec.m_wibtimestamp  != ref.m_timestamp      ||
+           rec.m_cd[0].m_cvtcnt != ref.m_cvtcnt[0]     ||
+           rec.m_cd[1].m_cvtcnt != ref.m_cvtcnt[1]) && nerrs++ < 8)
+      {
+         printf ("Assess[%s]: record %zu sample %u errors %8.8x,"
+                 " expected %u %8.8x\n",
+                 what, irec, rec.m_smpNum, rec.m_errors,
+                 ref.m_smpNum, ref.m_errors);
+      }
+   }
+
+
+   // --------------------------------------------------------
+   // The runs, consecutive frames with the same errors
+   // --------------------------------------------------------
+   std::vector<size_t> firsts;
+   for (size_t iref = 0; iref < refs.size (); iref++)
+   {
+      if (iref == 0
+       || refs[iref].m_smpNum != refs[iref - 1].m_smpNum + 1
+       || refs[iref].m_errors != refs[iref - 1].m_errors)
+      {
+         firsts.push_back (iref);
+      }
+   }
+
+   if (asr.getNRuns () != firsts.size ())
+   {
+      printf ("Assess[%s]: %u runs expected %zu\n",
+              what, asr.getNRuns (), firsts.size ());
+      return nerrs + 1;
+   }
+
+   for (size_t irun = 0; irun < firsts.size (); irun++)
+   {
+      size_t ifirst = firsts[irun];
+      size_t ilast  = irun + 1 < firsts.size () ? firsts[irun + 1] - 1
+                                                : refs.size ()     - 1;
+
+      TpcStreamAssessor::Run const *run = asr.getRun (irun);
+      if ((run->m_smpNum                != refs[ifirst].m_smpNum    ||
+           run->m_count                 != ilast - ifirst + 1       ||
+           run->m_errors                != refs[ifirst].m_errors    ||
+           run->m_first.m_smpNum        != refs[ifirst].m_smpNum    ||
+           run->m_last .m_smpNum        != refs[ilast ].m_smpNum    ||
+           run->m_first.m_wibtimestamp  != refs[ifirst].m_timestamp ||
+           run->m_last .m_wibtimestamp  != refs[ilast ].m_timestamp ||
+           run->m_last .m_cd[0].m_cvtcnt != refs[ilast].m_cvtcnt[0] ||
+           run->m_last .m_cd[1].m_cvtcnt != refs[ilast].m_cvtcnt[1])
+          && nerrs++ < 8)
+      {
+         printf ("Assess[%s]: run %zu sample %u count %u errors %8.8x,"
+                 " expected %u %zu %8.8x\n",
+                 what, irun, run->m_smpNum, run->m_count, run->m_errors,
+                 refs[ifirst].m_smpNum, ilast - ifirst + 1,
+                 refs[ifirst].m_errors);
+      }
+   }
+
+
+   // ----------------------------------------------------------
+   // The filtered searches.  get walks the records if they were
+   // kept, otherwise the runs, returning their first records.
+   // ----------------------------------------------------------
+   uint32_t const filters[] =
+   {
+      TpcStreamAssessor::FLT_M_ALL,
+      TpcStreamAssessor::FLT_M_TIMING,
+      TpcStreamAssessor::FLT_M_CD_STRERRS,
+      rng () & rng ()
+   };
+
+   for (uint32_t filter : filters)
+   {
+      // What get must find, the indices of the records or runs
+      std::vector<size_t> found;
+      if (asr.m_keepRecords)
+      {
+         for (size_t iref = 0; iref < refs.size (); iref++)
+         {
+            if (refs[iref].m_errors & filter) found.push_back (iref);
+         }
+      }
+      else
+      {
+         for (size_t irun = 0; irun < firsts.size (); irun++)
+         {
+            if (refs[firsts[irun]].m_errors & filter) found.push_back (irun);
+         }
+      }
+
+      unsigned int idx = 0;
+      for (size_t ifound = 0; ifound <= found.size (); ifound++)
+      {
+         TpcStreamAssessor::Record const *rec = asr.get (idx, filter);
+         TpcStreamAssessor::Record const *exp = NULL;
+         if (ifound < found.size ())
+         {
+            exp = asr.m_keepRecords ? &asr.m_recs[found[ifound]]
+                                    : &asr.m_runs[found[ifound]].m_first;
+         }
+
+         if (rec != exp)
+         {
+            printf ("Assess[%s]: filter %8.8x, search %zu found %p"
+                    " expected %p\n", what, filter, ifound,
+                    (void const *)rec, (void const *)exp);
+            nerrs++;
+            break;
+         }
+
+         if (exp) idx = found[ifound] + 1;
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the assessments of a synthesized fragment
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkAssess (Rng &rng)
+{
+   // ------------------------------------------------------------
+   // Glitches, drops and runs of header errors: error bits set
+   // in the WIB header or an error register, or a convert count
+   // or timestamp that stops advancing
+   // ------------------------------------------------------------
+   StreamSpec spec;
+   spec.m_seed     = rng.next ();
+   spec.m_glitches = 16 + rng () % 64;
+   spec.m_left     = 1;
+   int nframes     = spec.m_npkts * spec.m_nframes;
+   for (int idrop = rng () % 8; idrop > 0; idrop--)
+   {
+      spec.m_drop.push_back (1 + rng () % (nframes - 1));
+   }
+
+   for (int ifault = 1 + rng () % 3; ifault > 0; ifault--)
+   {
+      Fault fault;
+      fault.m_frame   = rng () % nframes;
+      fault.m_nframes = 1 + rng () % 256;
+      fault.m_set     = 0;
+      fault.m_hold    = false;
+
+      int icd = rng () & 1 ? 16 : 2;
+      switch (rng () % 4)
+      {
+      case 0: { fault.m_word = 0;
+                fault.m_set  = (1 + rng () % 0xffffull) << 48;  break; }
+      case 1: { fault.m_word = icd + 1;
+                fault.m_set  = 1ull << (rng () % 8);            break; }
+      case 2: { fault.m_word = icd;  fault.m_hold = true;       break; }
+      case 3: { fault.m_word = 1;    fault.m_hold = true;       break; }
+      }
+
+      // A timestamp that stops at either end of the trimmed range
+      // would leave the range unfound
+      if (fault.m_word == 1)
+      {
+         fault.m_frame = spec.m_begFrame + 100
+                       + rng () % (spec.m_endFrame - spec.m_begFrame - 456);
+      }
+      spec.m_faults.push_back (fault);
+   }
+
+   std::vector<uint64_t> frames;
+   std::vector<uint64_t> wib  = wibStream      (spec, NULL, &frames);
+   std::vector<uint64_t> cmp  = compressStream (rng, spec, wib, frames);
+   std::vector<uint64_t> frag = fragment ({ wib, cmp });
+
+   DataFragmentUnpack df (frag.data ());
+   TpcFragmentUnpack  tpcFragment (df);
+   TpcStreamUnpack const *tpcWib = tpcFragment.getStream (0);
+   TpcStreamUnpack const *tpcCmp = tpcFragment.getStream (1);
+
+   std::vector<Ref> refs = assess (frames, 0, nframes);
+   if (refs.empty ())
+   {
+      printf ("Assess: no errors to assess\n");
+      return 1;
+   }
+
+
+   int nerrs = 0;
+   for (int keep = 0; keep < 2; keep++)
+   {
+      // --------------------------------------------
+      // The standalone assessment of both streams...
+      // --------------------------------------------
+      TpcStreamAssessor asrWib (keep);
+      asrWib.assessUntrimmed (tpcWib);
+      nerrs += compare (rng, asrWib, refs, keep ? "wib:keep" : "wib");
+
+      TpcStreamAssessor asrCmp (keep);
+      asrCmp.assessUntrimmed (tpcCmp);
+      nerrs += compare (rng, asrCmp, refs, keep ? "cmp:keep" : "cmp");
+
+
+      // -------------------------------------------------------
+      // ...and the assessment fused with the transposition.  It
+      // assesses the trimmed frames, the first seeding it.
+      // -------------------------------------------------------
+      int                  nticks = tpcWib->getNTicks ();
+      std::vector<int16_t>   adcs (128 * nticks);
+      TpcStreamAssessor  asrFused (keep);
+
+      int      begOff = 0;
+      uint64_t begTs  = tpcWib->getTimeStamp ();
+      while (begOff < nframes && frames[begOff * NWords + 1] != begTs)
+      {
+         begOff++;
+      }
+
+      if (!tpcWib->getMultiChannelData (adcs.data (), nticks,
+                                        TpcStreamUnpack::Options ()
+                                        .assess (&asrFused)))
+      {
+         printf ("Assess[fused]: the unpacking failed\n");
+         nerrs++;
+         continue;
+      }
+
+      std::vector<Ref> trimmed = assess (frames, begOff, nticks);
+      nerrs += compare (rng, asrFused, trimmed, keep ? "fused:keep" : "fused");
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   Prms prms (argc, argv);
+   Rng   rng (prms.m_seed);
+   int nerrs = 0;
+
+   int nseq = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nseq += checkSequence (rng);
+   }
+   printf ("Sequence      : %d trials, %d errors, kernels %s\n",
+           prms.m_ntrials, nseq, WibFrame::getKernels ());
+   nerrs += nseq;
+
+   int nasr = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nasr += checkAssess (rng);
+   }
+   printf ("Assess        : %d trials, %d errors\n", prms.m_ntrials, nasr);
+   nerrs += nasr;
+
+   return nerrs ? 1 : 0;
+}
+/* ---------------------------------------------------------------------- */
@@ -0,0 +1,421 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdTpcCompressedTest.cc
+ *  @brief    Tests the decompression of synthesized compressed packets
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   The packets are synthesized by TpcSynth, see TpcSynth.hh.  The
+ *   checks are
+ *     -# the round trip of WIB frames through the compression of their
+ *        headers and decompressWibFrames.  The rebuilt frames must equal
+ *        the originals, less the cold data checksums, which must be 0,
+ *        and their ADCs must equal those of decompress.
+ *     -# the decoders against one another.  Packets of a random number
+ *        of channels and samples are decoded, by decompress, by
+ *        decompressChannels of a random list of channels and into
+ *        floats, with each of the decoders that the executing cpu
+ *        supports, serial, gen and avx2, as selected by selectDecoder,
+ *        the same selection that PDD_TPCCOMPRESSED_DECODER makes.  The
+ *        results must be identical, bit for bit, to those of serial
+ *        and to decompressChannel.  The channels have overflows, the
+ *        decoders' exception path, and in every other trial are cut
+ *        short, so the symbols are decoded from the bits of the
+ *        following channels and, for the last, from beyond the packet.
+ *
+ *   The program exits with a non-zero status if any check fails.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added checkDecoders, the decoders against one another
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include "TpcSynth.hh"
+#include <dam/access/TpcCompressed.hh>
+#include <dam/access/WibFrame.hh>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+
+using namespace pdd::access;
+using namespace TpcSynth;
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   int       m_ntrials; /*!< Number of trials of each check               */
+   uint64_t     m_seed; /*!< Seed of the random numbers                   */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_ntrials (16),
+   m_seed    (0x9e3779b97f4a7c15ULL)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "n:s:")) != -1)
+   {
+      switch (c)
+      {
+      case 'n': { m_ntrials = strtoul  (optarg, NULL, 0); break; }
+      case 's': { m_seed    = strtoull (optarg, NULL, 0); break; }
+      }
+   }
+
+   if (m_ntrials < 1) m_ntrials = 1;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the round trip of WIB frames through the compression of
+          their headers and decompressWibFrames
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator
+  \param[in]   itrial  The trial number, the first rebuilds the whole
+                       packet, the others a random range of it
+
+   The ADCs of the original frames are not compressed, the ADC record
+   is synthesized, so the rebuilt frames' ADCs are checked against those
+   decompress produces from it.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkRoundTrip (Rng &rng, int itrial)
+{
+   int const nwords = sizeof (WibFrame) / sizeof (uint64_t);
+   int const Idx[6] = { 0, 1, 2, 3, 16, 17 };
+
+   uint64_t const cksums =
+            static_cast<uint64_t>(WibColdData::Mask0::CheckSums)
+         << static_cast<int>     (WibColdData::Offset0::CheckSums);
+
+
+   // ------------------------------------------------------
+   // One packet, frames dropped and header words glitched
+   // so that there are exceptions of every kind, but no more
+   // than the 255 exception words the header record allows
+   // ------------------------------------------------------
+   StreamSpec spec;
+   spec.m_npkts    = 1;
+   spec.m_seed     = rng.next ();
+   spec.m_glitches = 8 + rng () % 64;
+   for (int idrop = rng () % 8; idrop > 0; idrop--)
+   {
+      spec.m_drop.push_back (1 + rng () % (spec.m_nframes - 1));
+   }
+
+   std::vector<uint64_t> frames;
+   wibStream (spec, NULL, &frames);
+
+   int nframes = spec.m_nframes;
+   std::vector<uint64_t> pkt = compressedPacket (rng, frames.data (), nframes);
+   TpcCompressed         cmp (pkt.data (), pkt.size ());
+
+   int itick  = itrial ? rng () % nframes : 0;
+   int nticks = itrial ? 1 + rng () % (nframes - itick) : nframes;
+
+   std::vector<uint64_t> rebuilt (nticks * nwords, 0);
+   int n = cmp.decompressWibFrames (rebuilt.data (), itick, nticks);
+   if (n != nticks)
+   {
+      printf ("RoundTrip[%d]: rebuilt %d frames, expected %d\n",
+              itrial, n, nticks);
+      return 1;
+   }
+
+
+   // -------------------------------------------------------
+   // The headers, the rebuilt checksum fields must be 0
+   // -------------------------------------------------------
+   int nerrs = 0;
+   for (int iframe = 0; iframe < nticks; iframe++)
+   {
+      uint64_t const *org = &frames [(itick + iframe) * nwords];
+      uint64_t const *rbt = &rebuilt[          iframe  * nwords];
+      for (int idx : Idx)
+      {
+         uint64_t expected = org[idx];
+         if (idx == 2 || idx == 16) expected &= ~cksums;
+         if (rbt[idx] != expected && nerrs++ < 8)
+         {
+            printf ("RoundTrip[%d]: frame %d word %2d %16.16" PRIx64
+                    " expected %16.16" PRIx64 "\n",
+                    itrial, itick + iframe, idx, rbt[idx], expected);
+         }
+      }
+   }
+
+
+   // ---------------------------------------------
+   // The ADCs, as 12-bit values in the WIB frames
+   // ---------------------------------------------
+   std::vector<int16_t> adcs    (128 * nticks, 0);
+   std::vector<int16_t> unpacked(128 * nticks, 0);
+   cmp.decompress (adcs.data (), nticks, itick, nticks);
+   WibFrame::transposeAdcs128xN (unpacked.data (), nticks,
+                                 reinterpret_cast<WibFrame const *>
+                                 (rebuilt.data ()),
+                                 nticks);
+
+   for (size_t idx = 0; idx < adcs.size (); idx++)
+   {
+      if ((adcs[idx] & 0xfff) != unpacked[idx] && nerrs++ < 8)
+      {
+         printf ("RoundTrip[%d]: chan %3zu tick %4zu adc %4.4x expected"
+                 " %4.4x\n",
+                 itrial, idx / nticks, itick + idx % nticks,
+                 unpacked[idx], adcs[idx] & 0xfff);
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Decoded
+  \brief  The output of one decoder
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Decoded
+{
+public:
+   std::vector<int16_t>   m_adcs; /*!< decompress                         */
+   std::vector<int16_t>   m_list; /*!< decompressChannels of the list     */
+   std::vector<float>    m_fadcs; /*!< decompress into floats             */
+   uint32_t                  m_n; /*!< The number decompress returned     */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the decoders against one another
+  \return The number of mismatches
+
+  \param[in,out]  rng  The random number generator
+  \param[in]   itrial  The trial number, the odd ones have channels that
+                       are cut short
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkDecoders (Rng &rng, int itrial)
+{
+   static char const *const Decoders[] = { "serial", "gen", "avx2" };
+   static int const         NDecoders  = sizeof (Decoders)
+                                       / sizeof (Decoders[0]);
+
+
+   // ----------------------------------------------------------
+   // A packet of a random shape.  Its copy is followed by enough
+   // padding for channels cut short to be decoded beyond it.
+   // ----------------------------------------------------------
+   StreamSpec spec;
+   spec.m_npkts   = 1;
+   spec.m_nframes = 1 + rng () % 1024;
+   spec.m_seed    = rng.next ();
+
+   std::vector<uint64_t> frames;
+   wibStream (spec, NULL, &frames);
+
+   int nframes = spec.m_nframes;
+   int  nchans = 1 + rng () % 128;
+   int   nbits = itrial & 1 ? rng () % 256 : 14000;
+   std::vector<uint64_t> pkt = compressedPacket (rng, frames.data (), nframes,
+                                                 nchans, nbits);
+   size_t n64 = pkt.size ();
+   for (int idx = 0; idx < 8192; idx++) pkt.push_back (rng.next ());
+   TpcCompressed cmp (pkt.data (), n64);
+
+   int itick  = rng () % nframes;
+   int nticks = 1 + rng () % (nframes - itick);
+   int nadcs  = nticks + rng () % 8;
+
+   int ichans[128];
+   int nlist = 0;
+   for (int ichan = 0; ichan < nchans; ichan++)
+   {
+      if (rng () % 3 == 0) ichans[nlist++] = ichan;
+   }
+
+   float peds [128];
+   float gains[128];
+   for (int ichan = 0; ichan < 128; ichan++)
+   {
+      peds [ichan] = (rng () & 0xfff) * 0.25f;
+      gains[ichan] = 0.5f + (rng () & 0xff) / 256.0f;
+   }
+
+
+   // ------------------------------------------
+   // Decode with each decoder the cpu supports
+   // ------------------------------------------
+   char const *original = TpcCompressed::getDecoder ();
+   Decoded     decoded[NDecoders];
+   bool        present[NDecoders];
+
+   for (int idec = 0; idec < NDecoders; idec++)
+   {
+      present[idec] = TpcCompressed::selectDecoder (Decoders[idec]);
+      if (!present[idec]) continue;
+
+      Decoded &d = decoded[idec];
+      d.m_adcs .assign (nchans * nadcs, 0x5a5a);
+      d.m_list .assign (nlist  * nadcs, 0x5a5a);
+      d.m_fadcs.assign (nchans * nadcs, -1.0f);
+
+      d.m_n = cmp.decompress (d.m_adcs.data (), nadcs, itick, nticks);
+
+      int16_t *list[128];
+      for (int idx = 0; idx < nlist; idx++) list[idx] = &d.m_list[idx * nadcs];
+      cmp.decompressChannels (list, ichans, nlist, itick, nticks);
+
+      cmp.decompress (d.m_fadcs.data (), nadcs, itick, nticks, peds, gains);
+   }
+
+   TpcCompressed::selectDecoder (original);
+
+
+   // ---------------------------------------------------------
+   // The reference, the one channel at a time serial decoding
+   // ---------------------------------------------------------
+   int nerrs = 0;
+   std::vector<int16_t> ref (nchans * nadcs, 0x5a5a);
+   for (int ichan = 0; ichan < nchans; ichan++)
+   {
+      cmp.decompressChannel (&ref[ichan * nadcs], ichan, itick, nticks);
+   }
+
+   if (decoded[0].m_n != static_cast<uint32_t>
+                       (cmp.getNDecompressed (itick, nticks)))
+   {
+      printf ("Decoders[%d]: decompress returned %u, getNDecompressed %d\n",
+              itrial, decoded[0].m_n, cmp.getNDecompressed (itick, nticks));
+      nerrs++;
+   }
+
+   for (int idec = 0; idec < NDecoders; idec++)
+   {
+      if (!present[idec]) continue;
+
+      Decoded const &d = decoded[idec];
+      Decoded const &s = decoded[0];
+
+      for (size_t idx = 0; idx < ref.size (); idx++)
+      {
+         if (d.m_adcs[idx] != ref[idx] && nerrs++ < 8)
+         {
+            printf ("Decoders[%d]: %-6s chan %3zu adc %4zu %4.4x expected"
+                    " %4.4x, %d chans %d bits\n",
+                    itrial, Decoders[idec], idx / nadcs, idx % nadcs,
+                    d.m_adcs[idx] & 0xffff, ref[idx] & 0xffff, nchans,
+                    nbits);
+         }
+      }
+
+      for (int idx = 0; idx < nlist; idx++)
+      {
+         if (memcmp (&d.m_list[idx * nadcs], &ref[ichans[idx] * nadcs],
+                     nadcs * sizeof (int16_t)) && nerrs++ < 8)
+         {
+            printf ("Decoders[%d]: %-6s listed chan %3d differs\n",
+                    itrial, Decoders[idec], ichans[idx]);
+         }
+      }
+
+      if (memcmp (d.m_fadcs.data (), s.m_fadcs.data (),
+                  d.m_fadcs.size () * sizeof (float)) && nerrs++ < 8)
+      {
+         printf ("Decoders[%d]: %-6s floats differ from serial\n",
+                 itrial, Decoders[idec]);
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   Prms prms (argc, argv);
+   Rng   rng (prms.m_seed);
+   int nerrs = 0;
+
+   int nrt = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nrt += checkRoundTrip (rng, itrial);
+   }
+   printf ("RoundTrip     : %d trials, %d errors\n", prms.m_ntrials, nrt);
+   nerrs += nrt;
+
+   int ndec = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      ndec += checkDecoders (rng, itrial);
+   }
+   printf ("Decoders      : %d trials, %d errors\n", prms.m_ntrials, ndec);
+   nerrs += ndec;
+
+   return nerrs ? 1 : 0;
+}
+/* ---------------------------------------------------------------------- */
@@ -0,0 +1,806 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     PdTpcUnpackTest.cc
+ *  @brief    Tests the unpacking of synthesized TpcStreams
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   A fragment of two streams, one of WIB frames and one of the same
+ *   frames compressed, is synthesized by TpcSynth, see TpcSynth.hh.  The
+ *   checks are
+ *     -# every combination of the TpcStreamUnpack::Options against the
+ *        plain getMultiChannelData.  The ADCs must be those of the plain
+ *        unpacking, the statistics those computed from them and the
+ *        assessment that of the assessing option alone.
+ *     -# TpcFragmentUnpack::getMultiChannelData, which unpacks the
+ *        streams concurrently, against unpacking them one after the
+ *        other.  It is run on the library's pool with several numbers
+ *        of threads, which also decompress the channels, and on an
+ *        executor giving each stream a thread of its own, into both
+ *        the contiguous and the per stream arrays.
+ *     -# getRois and getRoisUntrimmed against a brute force search of
+ *        the unpacked ADCs, with paddings from none to longer than a
+ *        block or a packet, so that regions cross and merge across
+ *        their boundaries.  This is repeated with the compressed
+ *        packets having differing numbers of channels.
+ *
+ *   The program exits with a non-zero status if any check fails.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt checkRois is repeated with compressed packets having
+                  differing numbers of channels
+   2026.10.16 agt Added checkRois, the regions of interest against a brute
+                  force search of the unpacked ADCs
+   2026.10.16 agt Added checkFragment, the concurrent unpacking of the
+                  streams of a fragment against the serial
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include "TpcSynth.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcFragmentUnpack.hh"
+#include "dam/TpcStreamUnpack.hh"
+#include "dam/TpcStreamAssessor.hh"
+#include <dam/access/AdcStats.hh>
+#include <dam/access/TpcCompressed.hh>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+
+using namespace pdd::access;
+using namespace TpcSynth;
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Prms
+  \brief  The configuration parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Prms
+{
+public:
+   Prms (int argc, char *const argv[]);
+
+public:
+   int       m_ntrials; /*!< Number of trials of each check               */
+   uint64_t     m_seed; /*!< Seed of the random numbers                   */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor to extract the command line parameters
+
+  \param[in] argc The count  of the command line parameters
+  \param[in] argv The vector of the command line parameters
+                                                                          */
+/* ---------------------------------------------------------------------- */
+Prms::Prms (int argc, char *const argv[]) :
+   m_ntrials (4),
+   m_seed    (0x2545f4914f6cdd1dULL)
+{
+   int c;
+   while ( (c = getopt (argc, argv, "n:s:")) != -1)
+   {
+      switch (c)
+      {
+      case 'n': { m_ntrials = strtoul  (optarg, NULL, 0); break; }
+      case 's': { m_seed    = strtoull (optarg, NULL, 0); break; }
+      }
+   }
+
+   if (m_ntrials < 1) m_ntrials = 1;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synthesize a fragment of a WIB stream and its compressed twin
+  \return The fragment
+
+  \param[in,out]  rng  The random number generator
+  \param[in]    mixed  If true, the frames are spread over more packets
+                       and each compressed packet has its own number of
+                       channels
+
+   The headers are glitched and frames dropped, so that the WIB stream
+   has errors for the assessor to find.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static std::vector<uint64_t> synthesize (Rng &rng, bool mixed = false)
+{
+   StreamSpec spec;
+   spec.m_seed     = rng.next ();
+   spec.m_glitches = 8 + rng () % 64;
+   spec.m_left     = 1;
+   if (mixed)
+   {
+      spec.m_npkts    = 3 + rng () % 4;
+      spec.m_endFrame = spec.m_npkts * spec.m_nframes - 148;
+   }
+   for (int idrop = rng () % 8; idrop > 0; idrop--)
+   {
+      spec.m_drop.push_back (1 + rng () % (spec.m_npkts * spec.m_nframes - 1));
+   }
+
+   std::vector<uint64_t> frames;
+   std::vector<uint64_t> wib = wibStream (spec, NULL, &frames);
+   if (!mixed)
+   {
+      std::vector<uint64_t> cmp = compressStream (rng, spec, wib, frames);
+      return fragment ({ wib, cmp });
+   }
+
+
+   // About a third of the packets have all 128 channels
+   int const nwords = sizeof (pdd::access::WibFrame) / sizeof (uint64_t);
+   std::vector<std::vector<uint64_t>> pkts;
+   for (int ipkt = 0; ipkt < spec.m_npkts; ipkt++)
+   {
+      int nchans = rng () % 3 ? 1 + rng () % 127 : 128;
+      pkts.push_back (compressedPacket (rng,
+                                        &frames[ipkt * spec.m_nframes * nwords],
+                                        spec.m_nframes, nchans));
+   }
+
+   return fragment ({ wib, compressedStream (pkts, wib) });
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check one combination of the options against the plain
+          unpacking
+  \return The number of mismatches
+
+  \param[in]    tpc  The stream
+  \param[in]  nadcs  The channel stride
+  \param[in]    ref  The plain unpacking, 128 x nadcs
+  \param[in] refAsr  The assessment of the assessing option alone
+  \param[in]   mask  The channel mask used by the select option
+  \param[in]  combo  The options, bit 0 select, 1 stats, 2 assess and
+                     3 Store::Streaming
+  \param[in]   name  The stream's name, for the messages
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkCombo (TpcStreamUnpack               const *tpc,
+                       int                                nadcs,
+                       std::vector<int16_t>          const  &ref,
+                       TpcStreamAssessor             const &refAsr,
+                       TpcStreamUnpack::ChannelMask  const   &mask,
+                       int                                combo,
+                       char                          const  *name)
+{
+   int const         nticks = tpc->getNTicks ();
+   AdcStats          stats[128];
+   TpcStreamAssessor assessor (true);
+
+   TpcStreamUnpack::Options options;
+   if (combo & 1) options.select (mask);
+   if (combo & 2) options.stats  (stats);
+   if (combo & 4) options.assess (&assessor);
+   if (combo & 8) options.store  (TpcStreamUnpack::Store::Streaming);
+
+   std::vector<int16_t> adcs (128 * nadcs, 0x5a5a);
+   if (!tpc->getMultiChannelData (adcs.data (), nadcs, options))
+   {
+      printf ("Options[%s:%x]: unpacking failed\n", name, combo);
+      return 1;
+   }
+
+
+   // ----------------------------------------------------------
+   // The ADCs, row n being that of the n'th unpacked channel.
+   // The rest of each row and the rows not unpacked are intact.
+   // ----------------------------------------------------------
+   int nerrs = 0;
+   int  irow = 0;
+   for (int ichan = 0; ichan < 128; ichan++)
+   {
+      bool unpacked = !(combo & 1) || mask.isSet (ichan);
+      if (!unpacked) continue;
+
+      int16_t const *exp = &ref [ichan * nadcs];
+      int16_t const *got = &adcs[irow  * nadcs];
+      for (int idx = 0; idx < nadcs; idx++)
+      {
+         int16_t expected = idx < nticks ? exp[idx] : 0x5a5a;
+         if (got[idx] != expected && nerrs++ < 4)
+         {
+            printf ("Options[%s:%x]: chan %3d adc %4d %4.4x expected %4.4x\n",
+                    name, combo, ichan, idx, got[idx] & 0xffff,
+                    expected & 0xffff);
+         }
+      }
+
+
+      // -----------------------------------------------------
+      // The statistics, of exactly the unpacked ADCs
+      // -----------------------------------------------------
+      if (combo & 2)
+      {
+         AdcStats expected;
+         expected.accumulate (exp, nticks);
+         AdcStats const &s = stats[ichan];
+         if ((s.getN   () != expected.getN    () ||
+              s.getSum () != expected.getSum  () ||
+              s.getSum2() != expected.getSum2 () ||
+              s.getMin () != expected.getMin  () ||
+              s.getMax () != expected.getMax  () ||
+              s.getNSticky () != expected.getNSticky ()) && nerrs++ < 4)
+         {
+            printf ("Options[%s:%x]: chan %3d stats n %u sum %" PRId64
+                    " expected n %u sum %" PRId64 "\n",
+                    name, combo, ichan, s.getN (), s.getSum (),
+                    expected.getN (), expected.getSum ());
+         }
+      }
+
+      irow++;
+   }
+
+   for (int idx = irow * nadcs; idx < 128 * nadcs; idx++)
+   {
+      if (adcs[idx] != 0x5a5a && nerrs++ < 4)
+      {
+         printf ("Options[%s:%x]: row %d written\n", name, combo, idx / nadcs);
+      }
+   }
+
+   if (combo & 2)
+   {
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         if (!mask.isSet (ichan) && (combo & 1) && stats[ichan].getN ()
+          && nerrs++ < 4)
+         {
+            printf ("Options[%s:%x]: chan %3d not selected, has stats\n",
+                    name, combo, ichan);
+         }
+      }
+   }
+
+
+   // ----------------------------------------------------------
+   // The assessment must not depend on what it is combined with
+   // ----------------------------------------------------------
+   if (combo & 4)
+   {
+      bool same = assessor.m_errsummary  == refAsr.m_errsummary
+               && assessor.m_recs.size () == refAsr.m_recs.size ()
+               && assessor.getNRuns ()    == refAsr.getNRuns ();
+
+      for (size_t irec = 0; same && irec < assessor.m_recs.size (); irec++)
+      {
+         same = assessor.m_recs[irec].m_smpNum == refAsr.m_recs[irec].m_smpNum
+             && assessor.m_recs[irec].m_errors == refAsr.m_recs[irec].m_errors;
+      }
+
+      if (!same && nerrs++ < 4)
+      {
+         printf ("Options[%s:%x]: %zu records %u runs, expected %zu %u\n",
+                 name, combo, assessor.m_recs.size (), assessor.getNRuns (),
+                 refAsr.m_recs.size (), refAsr.getNRuns ());
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check every combination of the unpacking options
+  \return The number of mismatches
+
+  \param[in,out] rng  The random number generator
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkOptions (Rng &rng)
+{
+   std::vector<uint64_t> frag = synthesize (rng);
+   DataFragmentUnpack    df (frag.data ());
+   TpcFragmentUnpack     tpcFragment (df);
+
+   static char const *const Names[2] = { "wib", "cmp" };
+
+   int nerrs = 0;
+   for (int istream = 0; istream < tpcFragment.getNStreams (); istream++)
+   {
+      TpcStreamUnpack const *tpc = tpcFragment.getStream (istream);
+      char const           *name = Names[istream & 1];
+
+      // A stride that is not a multiple of anything, with room to spare
+      int nticks = tpc->getNTicks ();
+      int nadcs  = nticks + 1 + rng () % 13;
+
+      std::vector<int16_t> ref (128 * nadcs, 0x5a5a);
+      TpcStreamAssessor    refAsr (true);
+      if (!tpc->getMultiChannelData (ref.data (), nadcs) ||
+          !tpc->getMultiChannelData (ref.data (), nadcs,
+                                     TpcStreamUnpack::Options ()
+                                     .assess (&refAsr)))
+      {
+         printf ("Options[%s]: the plain unpacking failed\n", name);
+         nerrs++;
+         continue;
+      }
+
+      if (istream == 0 && refAsr.m_recs.empty ())
+      {
+         printf ("Options[%s]: no errors to assess\n", name);
+         nerrs++;
+      }
+
+      // -------------------------------------------------------
+      // A random selection that includes both sparse groups of
+      // 16 channels and empty ones
+      // -------------------------------------------------------
+      TpcStreamUnpack::ChannelMask mask;
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         if ((ichan & 0x30) != 0x10 && rng () % 3 == 0) mask.set (ichan);
+      }
+      mask.set (127);
+
+      for (int combo = 0; combo < 16; combo++)
+      {
+         nerrs += checkCombo (tpc, nadcs, ref, refAsr, mask, combo, name);
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  ThreadExecutor
+  \brief  Runs each task on a thread of its own, started in the reverse
+          order
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class ThreadExecutor : public TpcFragmentUnpack::Executor
+{
+public:
+   virtual void run (Task task, void *ctx, int ntasks)
+   {
+      std::vector<std::thread> threads;
+      for (int itask = ntasks - 1; itask >= 0; itask--)
+      {
+         threads.emplace_back (task, ctx, itask);
+      }
+
+      for (std::thread &thread : threads) thread.join ();
+      return;
+   }
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the concurrent unpacking of a fragment's streams against
+          unpacking them one after the other
+  \return The number of mismatches
+
+  \param[in,out] rng  The random number generator
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkFragment (Rng &rng)
+{
+   static int const NThreads[] = { 1, 2, 3, 8 };
+
+   std::vector<uint64_t> frag = synthesize (rng);
+   DataFragmentUnpack    df (frag.data ());
+   TpcFragmentUnpack     tpcFragment (df);
+   int                   nstreams = tpcFragment.getNStreams ();
+
+
+   // ------------------------------------------------------------
+   // Sometimes fewer elements per channel than there are ticks,
+   // so the unpacking is limited, sometimes more
+   // ------------------------------------------------------------
+   int nticks = 0;
+   for (int istream = 0; istream < nstreams; istream++)
+   {
+      int n = tpcFragment.getStream (istream)->getNTicks ();
+      if (n > nticks) nticks = n;
+   }
+   nticks += rng () & 1 ? rng () % 7 : -static_cast<int>(rng () % 64);
+
+   size_t               nadcs = 128 * static_cast<size_t>(nticks);
+   std::vector<int16_t> ref (nstreams * nadcs, 0x5a5a);
+   for (int istream = 0; istream < nstreams; istream++)
+   {
+      tpcFragment.getStream (istream)->getMultiChannelData
+                                       (&ref[istream * nadcs], nticks);
+   }
+
+
+   int            nerrs = 0;
+   int         original = TpcCompressed::getNThreads ();
+   ThreadExecutor threads;
+
+   for (int nthreads : NThreads)
+   {
+      TpcCompressed::setNThreads (nthreads);
+
+      for (int icombo = 0; icombo < 4; icombo++)
+      {
+         TpcFragmentUnpack::Executor *executor = icombo & 1 ? &threads : 0;
+         bool                      perStream = icombo & 2;
+
+         std::vector<int16_t> adcs (nstreams * nadcs, 0x5a5a);
+         int16_t                 *sadcs[TpcFragment::MaxTpcStreams];
+         TpcFragmentUnpack::StreamStatus
+                                status[TpcFragment::MaxTpcStreams];
+         memset (status, 0xff, sizeof (status));
+
+         // The per stream arrays in the reverse order of the streams
+         for (int istream = 0; istream < nstreams; istream++)
+         {
+            sadcs[istream] = &adcs[(nstreams - 1 - istream) * nadcs];
+         }
+
+         bool okay = perStream
+                   ? tpcFragment.getMultiChannelData (sadcs,        nticks,
+                                                      status, executor)
+                   : tpcFragment.getMultiChannelData (adcs.data (), nticks,
+                                                      status, executor);
+         if (!okay)
+         {
+            printf ("Fragment[%d:%x]: unpacking failed\n", nthreads, icombo);
+            nerrs++;
+            continue;
+         }
+
+         for (int istream = 0; istream < nstreams; istream++)
+         {
+            TpcStreamUnpack const *tpc = tpcFragment.getStream (istream);
+            int16_t const         *got = perStream
+                                       ? sadcs[istream]
+                                       : &adcs[istream * nadcs];
+
+            if (memcmp (got, &ref[istream * nadcs], nadcs * sizeof (*got)))
+            {
+               printf ("Fragment[%d:%x]: stream %d differs\n",
+                       nthreads, icombo, istream);
+               nerrs++;
+            }
+
+            uint32_t available = tpc->getNTicks ();
+            uint32_t nunpacked = available < static_cast<uint32_t>(nticks)
+                               ? available : nticks;
+            TpcFragmentUnpack::StreamStatus const &st = status[istream];
+            if (st.m_status    != tpc->getStatus () ||
+                st.m_nticks    != available         ||
+                st.m_nunpacked != nunpacked         ||
+               !st.m_okay)
+            {
+               printf ("Fragment[%d:%x]: stream %d status %x ticks %u"
+                       " unpacked %u okay %d\n", nthreads, icombo, istream,
+                       st.m_status, st.m_nticks, st.m_nunpacked, st.m_okay);
+               nerrs++;
+            }
+         }
+      }
+   }
+
+   TpcCompressed::setNThreads (original);
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Find the regions of interest of an unpacked channels x ticks
+          array by brute force
+
+  \param[out]      rois  The regions, by channel and then by tick
+  \param[out]   samples  Their ADCs
+  \param[in]       adcs  The ADCs, 128 x nticks
+  \param[in]       have  Non-zero for the ticks that have an ADC, 128 x
+                         nticks
+  \param[in]     nticks  The number of ticks
+  \param[in]       peds  The pedestal  of each channel
+  \param[in] thresholds  The threshold of each channel
+  \param[in]       npre  The number of ticks of padding before a hit
+  \param[in]      npost  The number of ticks of padding after  a hit
+
+  Every tick within the padding of a hit is marked and each run of
+  marked ticks is a region, which is what merging the overlapping or
+  touching padded hits leaves.  The padding of a hit does not reach
+  beyond the ticks with ADCs around it.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void findRois (std::vector<TpcStreamUnpack::Roi> &rois,
+                      std::vector<int16_t>           &samples,
+                      int16_t const                     *adcs,
+                      char const                        *have,
+                      int                              nticks,
+                      int16_t const                     *peds,
+                      int16_t const               *thresholds,
+                      int                                npre,
+                      int                               npost)
+{
+   rois   .clear ();
+   samples.clear ();
+
+   std::vector<char> kept (nticks);
+   for (int ichan = 0; ichan < 128; ichan++)
+   {
+      int16_t const *row = adcs + ichan * static_cast<size_t>(nticks);
+      char    const *has = have + ichan * static_cast<size_t>(nticks);
+
+      // The padding stays within the run of ticks with ADCs, [first, last)
+      std::fill (kept.begin (), kept.end (), 0);
+      for (int first = 0, last = 0; first < nticks; first = last)
+      {
+         if (!has[first]) { last = first + 1; continue; }
+         while (last < nticks && has[last]) last++;
+
+         for (int itick = first; itick < last; itick++)
+         {
+            int d = row[itick] - peds[ichan];
+            if (d > thresholds[ichan] || -d > thresholds[ichan])
+            {
+               int beg = itick - npre      < first ? first : itick - npre;
+               int end = itick + npost + 1 > last  ? last  : itick + npost + 1;
+               std::fill (&kept[beg], &kept[0] + end, 1);
+            }
+         }
+      }
+
+      for (int itick = 0; itick < nticks; )
+      {
+         if (!kept[itick]) { itick++; continue; }
+
+         TpcStreamUnpack::Roi roi;
+         roi.m_chan   = ichan;
+         roi.m_tick   = itick;
+         roi.m_offset = samples.size ();
+         while (itick < nticks && kept[itick]) itick++;
+         roi.m_nsamples = itick - roi.m_tick;
+
+         samples.insert (samples.end (), row + roi.m_tick, row + itick);
+         rois.push_back (roi);
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Check the zero-suppressed unpacking against the brute force
+          search of the unpacked ADCs
+  \return The number of mismatches
+
+  \param[in,out]   rng  The random number generator
+  \param[in]     mixed  If true, the compressed packets each have their
+                        own number of channels, see synthesize
+
+  \par
+   The thresholds are set from each channel's own ADCs so that a few
+   ticks in a thousand are hits, with some channels having none and some
+   having every tick over threshold.  The padding ranges from none to
+   more than a block or a packet, so regions are widened, merged and
+   clipped across the block and packet boundaries.
+
+  \par
+   A channel absent from a compressed packet has no ADCs for its ticks.
+   The ticks each channel has ADCs for are those the unpacking writes,
+   found by unpacking into two differently filled arrays.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int checkRois (Rng &rng, bool mixed)
+{
+   static char const *const Names[3] = { "wib", "cmp", "mix" };
+
+   std::vector<uint64_t> frag = synthesize (rng, mixed);
+   DataFragmentUnpack    df (frag.data ());
+   TpcFragmentUnpack     tpcFragment (df);
+
+   int nerrs = 0;
+   for (int istream = 0; istream < tpcFragment.getNStreams (); istream++)
+   {
+      TpcStreamUnpack const *tpc  = tpcFragment.getStream (istream);
+      char            const *name = Names[istream ? 1 + mixed : 0];
+
+      for (int untrimmed = 0; untrimmed < 2; untrimmed++)
+      {
+         int nticks = untrimmed ? tpc->getNTicksUntrimmed ()
+                                : tpc->getNTicks          ();
+
+         size_t const         nadcs = 128 * static_cast<size_t>(nticks);
+         std::vector<int16_t> adcs  (nadcs,  0x5555);
+         std::vector<int16_t> other (nadcs, -0x5556);
+         bool okay = untrimmed
+                   ? tpc->getMultiChannelDataUntrimmed (adcs .data (), nticks)
+                  && tpc->getMultiChannelDataUntrimmed (other.data (), nticks)
+                   : tpc->getMultiChannelData          (adcs .data (), nticks)
+                  && tpc->getMultiChannelData          (other.data (), nticks);
+         if (!okay)
+         {
+            printf ("Rois[%s]: the unpacking failed\n", name);
+            nerrs++;
+            continue;
+         }
+
+         std::vector<char> have (nadcs);
+         for (size_t idx = 0; idx < nadcs; idx++)
+         {
+            have[idx] = adcs[idx] == other[idx];
+         }
+
+
+         // ----------------------------------------------------
+         // Each channel's pedestal is one of its ADCs and its
+         // threshold a high quantile of the deviations from it
+         // ----------------------------------------------------
+         int16_t peds[128];
+         int16_t thresholds[128];
+         std::vector<int> dev (nticks);
+         for (int ichan = 0; ichan < 128; ichan++)
+         {
+            int16_t const *row = &adcs[ichan * static_cast<size_t>(nticks)];
+            peds[ichan] = row[rng () % nticks];
+
+            for (int itick = 0; itick < nticks; itick++)
+            {
+               dev[itick] = abs (row[itick] - peds[ichan]);
+            }
+
+            int iq = nticks - 1 - (nticks * (1 + rng () % 20)) / 1000;
+            std::nth_element (dev.begin (), dev.begin () + iq, dev.end ());
+            thresholds[ichan] = ichan % 17 == 3 ?  0x7fff
+                              : ichan % 23 == 5 ? -1
+                              :                   dev[iq];
+         }
+
+         for (int ipad = 0; ipad < 4; ipad++)
+         {
+            static int const MaxPad[4] = { 1, 8, 200, 2000 };
+            int npre  = rng () % MaxPad[ipad];
+            int npost = rng () % MaxPad[ipad];
+
+            std::vector<TpcStreamUnpack::Roi> refRois;
+            std::vector<int16_t>              refSamples;
+            findRois (refRois, refSamples, adcs.data (), have.data (),
+                      nticks, peds, thresholds, npre, npost);
+
+            std::vector<TpcStreamUnpack::Roi> rois (3);
+            std::vector<int16_t>              samples (5);
+            okay = untrimmed
+                 ? tpc->getRoisUntrimmed (rois, samples, peds, thresholds,
+                                          npre, npost)
+                 : tpc->getRois          (rois, samples, peds, thresholds,
+                                          npre, npost);
+
+            bool same = okay
+                     && rois   .size () == refRois   .size ()
+                     && samples.size () == refSamples.size ()
+                     && std::equal (samples.begin (), samples.end (),
+                                    refSamples.begin ());
+            for (size_t iroi = 0; same && iroi < rois.size (); iroi++)
+            {
+               same = rois[iroi].m_chan     == refRois[iroi].m_chan
+                   && rois[iroi].m_tick     == refRois[iroi].m_tick
+                   && rois[iroi].m_nsamples == refRois[iroi].m_nsamples
+                   && rois[iroi].m_offset   == refRois[iroi].m_offset;
+            }
+
+            if (!same)
+            {
+               printf ("Rois[%s%s]: pad %d,%d okay %d, %zu regions of %zu"
+                       " samples, expected %zu of %zu\n",
+                       name, untrimmed ? ":untrimmed" : "",
+                       npre, npost, okay, rois.size (), samples.size (),
+                       refRois.size (), refSamples.size ());
+               nerrs++;
+            }
+         }
+
+
+         // A negative padding is refused
+         std::vector<TpcStreamUnpack::Roi> rois;
+         std::vector<int16_t>              samples;
+         if (tpc->getRois (rois, samples, peds, thresholds, -1, 0))
+         {
+            printf ("Rois[%s]: a negative padding was accepted\n", name);
+            nerrs++;
+         }
+      }
+   }
+
+   return nerrs;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+int main (int argc, char *const argv[])
+{
+   Prms prms (argc, argv);
+   Rng   rng (prms.m_seed);
+   int nerrs = 0;
+
+   int nopt = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nopt += checkOptions (rng);
+   }
+   printf ("Options       : %d trials, %d errors\n", prms.m_ntrials, nopt);
+   nerrs += nopt;
+
+   int nfrag = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nfrag += checkFragment (rng);
+   }
+   printf ("Fragment      : %d trials, %d errors\n", prms.m_ntrials, nfrag);
+   nerrs += nfrag;
+
+   int nroi = 0;
+   for (int itrial = 0; itrial < prms.m_ntrials; itrial++)
+   {
+      nroi += checkRois (rng, false);
+      nroi += checkRois (rng, true);
+   }
+   printf ("Rois          : %d trials, %d errors\n", prms.m_ntrials, nroi);
+   nerrs += nroi;
+
+   return nerrs ? 1 : 0;
+}
+/* ---------------------------------------------------------------------- */
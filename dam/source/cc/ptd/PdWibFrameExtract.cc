@@ -25,6 +25,8 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Compressed packets are decompressed back into WibFrames
+                  and written like the uncompressed ones
    2018.08.30 jjr Added check for TpcEmpty data fragments.
    2017.08.14 jjr Created
   
@@ -43,6 +45,7 @@
 #include <cstring>
 #include <cinttypes>
 #include <cstdio>
+#include <vector>
 
 
 static void print_summary   (TpcStreamUnpack  const *tpcStream,
@@ -151,6 +154,7 @@ public:
    int    m_nframes;
    int      m_ntogo;
    uint64_t  *m_buf;
+   std::vector<uint64_t> m_frames;  /*!< Frames rebuilt from compressed data */
 };
 /* ---------------------------------------------------------------------- */
 
@@ -435,6 +439,7 @@ bool WibFrameExtracter::writeFragment ()
 #include "dam/access/TpcRanges.hh"
 #include "dam/access/TpcToc.hh"
 #include "dam/access/TpcPacket.hh"
+#include "dam/access/TpcCompressed.hh"
 
 
 /* ---------------------------------------------------------------------- *//*!
@@ -502,7 +507,21 @@ bool WibFrameExtracter::writeTpcStream (TpcStreamUnpack const *tpcStream)
       }
       else if (pktDsc.isCompressed ())
       {
-         fprintf (stderr, "Error: Can't handle compressed frames yet\n");
+         // Rebuild the original WibFrames, headers and ADCs
+         TpcCompressed           cmp (ptr, pktDsc.getLen64 ());
+         TpcCompressedTocTrailer tlr (cmp.getTocTrailer ());
+         int                nsamples = tlr.getNSamples ();
+
+         m_frames.resize (nsamples * sizeof (WibFrame) / sizeof (uint64_t));
+         unsigned nWibFrames = cmp.decompressWibFrames (m_frames.data (),
+                                                        0, nsamples);
+
+         m_ntogo -= nWibFrames;
+         if (m_ntogo < 0) { putchar ('\n'); return false; }
+
+         print_summary (tpcStream, m_nframes - m_ntogo,m_nframes);
+
+         ::write (fd, m_frames.data (), nWibFrames * sizeof (WibFrame));
       }
    }
 
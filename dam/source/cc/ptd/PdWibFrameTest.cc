@@ -25,6 +25,12 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Extended the stride performance check to more multiples
+                  of 4 KBytes and the strides near them
+   2026.10.16 agt Added the streaming performance check, the effect of the
+                  non-temporal stores on a concurrent consumer
+   2026.10.16 agt Added the stride performance check comparing the direct
+                  and blocked transposers for long readout windows
    2017.10.31 jjr Added documentation. Name -> PdWibFrameTest.  The 
                   previous name, wibFrame_test was to generic
    2017.07.27 jjr Created
@@ -40,11 +46,15 @@
 #include <cinttypes>
 #include <cstdio>
 #include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
 #include <stdlib.h>
 #include <cstring>
 #include <cstdlib>
 #include <vector>
 #include <iostream>
+#include <atomic>
+#include <thread>
 
 
 
@@ -88,6 +98,10 @@ static void test_performance       (int16_t                  *dstBuf,
                                               __attribute__((unused));
 
 
+static void test_performanceStride ();
+static void test_performanceStream ();
+
+
 static void test_integrityPtrArray (int16_t        *const  *dstPtrs, 
                                     WibFrame        const   *frames,
                                     int           nframes_per_trial,
@@ -375,6 +389,20 @@ int main (int argc, char *const argv[])
    }
 
 
+   // ----------------------------------------------------------------------
+   // Performance check: long readout windows
+   // ---------------------------------------
+   test_performanceStride ();
+   // ----------------------------------------------------------------------
+
+
+   // ----------------------------------------------------------------------
+   // Performance check: non-temporal stores and a concurrent consumer
+   // ----------------------------------------------------------------
+   test_performanceStream ();
+   // ----------------------------------------------------------------------
+
+
    return 0;
 }
 /* ---------------------------------------------------------------------- */
@@ -563,6 +591,331 @@ static void test_performance (int16_t          *dstBuf,
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the best of \a ntimes transpositions in microseconds
+
+  \param[out]     dst  The destination
+  \param[in]   stride  The number of entries of each channel
+  \param[in]   frames  The frames
+  \param[in]  nframes  The number of frames, a multiple of 32
+  \param[in]    ntile  If less than 0, transpose directly, else the
+                       tile size of the blocked transposer
+  \param[in]   ntimes  The number of times to transpose
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static unsigned int time_transpose (int16_t          *dst,
+                                    int            stride,
+                                    WibFrame const *frames,
+                                    int           nframes,
+                                    int             ntile,
+                                    int            ntimes)
+{
+   unsigned int best = ~0u;
+
+   for (int itime = 0; itime < ntimes; ++itime)
+   {
+      struct timeval beg, end, dif;
+      gettimeofday (&beg, NULL);
+
+      if (ntile < 0) WibFrame::transposeAdcs128x32N       (dst, stride, frames, nframes);
+      else           WibFrame::transposeAdcs128xN_blocked (dst, stride, frames, nframes, ntile);
+
+      gettimeofday (&end, NULL);
+      timersub     (&end, &beg, &dif);
+
+      unsigned int usecs = dif.tv_sec * 1000000 + dif.tv_usec;
+      if (usecs < best) best = usecs;
+   }
+
+   return best;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Compares the direct x 32 transposer with the blocked transposer
+         for readout windows, and hence destination strides, of 1K to
+         100K time samples
+
+  \par
+   The number of frames transposed is the stride rounded down to a
+   multiple of 32.  The blocked transposer's results are checked
+   against the direct transposer's.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void test_performanceStride ()
+{
+   static int const Strides[] =
+   {
+        1024,   2048,   4096,   6000,   6144,   8192,  10240,  12288,
+       16384,  20000,  24576,  32768,  49152,  65536,  98304, 100000
+   };
+   int const NTiles = 3;
+   static int const Tiles[NTiles] = { 64, 128, WibFrame::DefTransposeTile };
+   int const  MaxStride = 100000;
+
+
+   int16_t  *patterns = (int16_t  *)memAlign (64, sizeof (*patterns) * 128 * MaxStride);
+   int16_t   *direct  = (int16_t  *)memAlign (64, sizeof (*direct)   * 128 * MaxStride);
+   int16_t   *blocked = (int16_t  *)memAlign (64, sizeof (*blocked)  * 128 * MaxStride);
+   WibFrame   *frames = (WibFrame *)memAlign (64, sizeof (*frames)         * MaxStride);
+
+   create_random (patterns, 128 * MaxStride);
+   fill          (frames,   MaxStride, patterns);
+   memset (direct,  0, sizeof (*direct)  * 128 * MaxStride);
+   memset (blocked, 0, sizeof (*blocked) * 128 * MaxStride);
+
+   printf ("\nPerformance check stride: best of 5, microseconds\n"
+           "  stride  nframes   direct");
+   for (int itile = 0; itile < NTiles; ++itile) printf (" tile %3d", Tiles[itile]);
+   printf ("  errors\n");
+
+
+   for (unsigned int idx = 0; idx < sizeof (Strides) / sizeof (*Strides); ++idx)
+   {
+      int  stride = Strides[idx];
+      int nframes = stride & ~0x1f;
+
+      printf ("%8d %8d %8u", stride, nframes,
+              time_transpose (direct, stride, frames, nframes, -1, 5));
+
+      int nerrs = 0;
+      for (int itile = 0; itile < NTiles; ++itile)
+      {
+         printf (" %8u", time_transpose (blocked, stride, frames, nframes,
+                                         Tiles[itile], 5));
+
+         for (int ichan = 0; ichan < 128; ++ichan)
+         {
+            nerrs += memcmp (direct  + ichan * stride,
+                             blocked + ichan * stride,
+                             nframes * sizeof (*direct)) != 0;
+         }
+      }
+
+      printf ("  %6d\n", nerrs);
+   }
+
+
+   free (frames);
+   free (blocked);
+   free (direct);
+   free (patterns);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the CPU time used by the calling thread in microseconds
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint64_t thread_usecs ()
+{
+   struct timespec ts;
+   clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+   return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class Consumer
+  \brief Stands in for another module, repeatedly reading a working set
+         that fits in the last level cache.  Its size must be a power of
+         2 number of cache lines.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Consumer
+{
+public:
+   Consumer (uint64_t const *data, size_t n64) :
+      m_data   (data),
+      m_n64    (n64),
+      m_stop   (0),
+      m_npass  (0),
+      m_usecs  (0),
+      m_sum    (0)
+   {
+      return;
+   }
+
+   void   run      ();
+   void   stop     ()       { m_stop.store (1); }
+   double getUsecs () const { return m_npass ? (double)m_usecs / m_npass : 0; }
+
+private:
+   uint64_t const    *m_data; /*!< The working set                        */
+   size_t              m_n64; /*!< Its size, in 64-bit words              */
+   std::atomic<int>   m_stop; /*!< Set to stop reading                    */
+   int               m_npass; /*!< The number of passes over it           */
+   uint64_t          m_usecs; /*!< The thread CPU time of these passes    */
+   uint64_t volatile   m_sum; /*!< Keeps the reads from being optimized   */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Reads the working set until stopped, at least once
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void Consumer::run ()
+{
+   uint64_t beg = thread_usecs ();
+
+   do
+   {
+      // ---------------------------------------------------------
+      // Visit each cache line once, in an order the prefetchers
+      // cannot follow, so that each miss costs the full latency.
+      // The number of lines is a power of 2, so any odd step will
+      // visit them all.
+      // ---------------------------------------------------------
+      size_t   nlines = m_n64 / 8;
+      size_t    iline = 0;
+      uint64_t    sum = 0;
+      for (size_t idx = 0; idx < nlines; ++idx)
+      {
+         sum  += m_data[iline * 8];
+         iline = (iline + 40503) & (nlines - 1);
+      }
+      m_sum  += sum;
+      m_npass += 1;
+   }
+   while (!m_stop.load ());
+
+   m_usecs = thread_usecs () - beg;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Measures the effect of the non-temporal stores on a consumer
+         running alongside the unpacking
+
+  \par
+   The frames of several fibers of 6000 time samples are transposed,
+   the output being larger than the consumer's working set, while a
+   second thread repeatedly reads that working set.  The consumer's CPU
+   time per pass is given alone, while the output is written with
+   ordinary stores and while it is written with non-temporal stores.
+   The ordinary stores fill the cache with output that will not be read
+   for a while, evicting the consumer's working set, which it then must
+   read from memory.  The CPU times, rather than elapsed times, are used
+   so that the comparison still means something when the two threads
+   share a core.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void test_performanceStream ()
+{
+   int    const   NFibers = 10;
+   int    const    NTicks = 6000;
+   int    const   NRounds = 10;
+   size_t const  NConsume = (8 << 20) / sizeof (uint64_t);
+
+   size_t         nframes = (size_t)NFibers * NTicks;
+   size_t           nadcs = (size_t)NRounds * NFibers * NTicks * 128;
+
+   int16_t  *patterns = (int16_t  *)memAlign (64, sizeof (*patterns) * 128 * NTicks);
+   int16_t     *adcs  = (int16_t  *)memAlign (64, sizeof (*adcs)     * nadcs);
+   int16_t     *check = (int16_t  *)memAlign (64, sizeof (*check)    * 128 * NTicks);
+   WibFrame   *frames = (WibFrame *)memAlign (64, sizeof (*frames)   * nframes);
+   uint64_t     *data = (uint64_t *)memAlign (64, sizeof (*data)     * NConsume);
+
+   create_random (patterns, 128 * NTicks);
+   for (int ifiber = 0; ifiber < NFibers; ++ifiber)
+   {
+      fill (frames + ifiber * NTicks, NTicks, patterns);
+   }
+   memset (adcs, 0, sizeof (*adcs) * nadcs);
+   for (size_t i64 = 0; i64 < NConsume; ++i64) data[i64] = i64;
+
+
+   printf ("\nPerformance check streaming: %d fibers x %d ticks, consumer"
+           " working set %zu MBytes\n"
+           "  stores     unpack us/fiber  consumer us/pass  errors\n",
+           NFibers, NTicks, NConsume * sizeof (*data) >> 20);
+
+   {
+      Consumer consumer (data, NConsume);
+      std::thread thread (&Consumer::run, &consumer);
+      usleep (200000);
+      consumer.stop ();
+      thread.join   ();
+      printf ("  none      %16s  %16.0f\n", "", consumer.getUsecs ());
+   }
+
+
+   for (int istream = 0; istream < 2; ++istream)
+   {
+      Consumer consumer (data, NConsume);
+      std::thread thread (&Consumer::run, &consumer);
+
+      uint64_t beg = thread_usecs ();
+      for (int iround = 0; iround < NRounds; ++iround)
+      {
+         for (int ifiber = 0; ifiber < NFibers; ++ifiber)
+         {
+            int16_t            *dst = adcs   + ((size_t)iround * NFibers + ifiber)
+                                                 * NTicks * 128;
+            WibFrame const     *src = frames + (size_t)ifiber * NTicks;
+
+            if (istream) WibFrame::transposeAdcs128xN_stream (dst, NTicks, src, NTicks);
+            else         WibFrame::transposeAdcs128xN        (dst, NTicks, src, NTicks);
+         }
+      }
+      uint64_t usecs = thread_usecs () - beg;
+
+      consumer.stop ();
+      thread.join   ();
+
+
+      // -------------------------------------------------
+      // Check each fiber against an ordinary transposition
+      // -------------------------------------------------
+      WibFrame::transposeAdcs128xN (check, NTicks, frames, NTicks);
+
+      int nerrs = 0;
+      for (int ifiber = 0; ifiber < NRounds * NFibers; ++ifiber)
+      {
+         nerrs += memcmp (check, adcs + (size_t)ifiber * NTicks * 128,
+                          sizeof (*check) * 128 * NTicks) != 0;
+      }
+
+      printf ("  %-9s %16.0f  %16.0f  %6d\n",
+              istream ? "streaming" : "cached",
+              (double)usecs / (NRounds * NFibers),
+              consumer.getUsecs (),
+              nerrs);
+   }
+
+
+   free (data);
+   free (frames);
+   free (check);
+   free (adcs);
+   free (patterns);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 
 
 /* ---------------------------------------------------------------------- *//*!
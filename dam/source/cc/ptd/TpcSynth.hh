@@ -0,0 +1,718 @@
+#ifndef TPCSYNTH_HH
+#define TPCSYNTH_HH
+
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     TpcSynth.hh
+ *  @brief    Synthesizes TpcStream records and data fragments for the
+ *            tests
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par
+ *   The WIB frames have well formed, error free headers, the timestamps
+ *   advance by 25 and the cold data convert counts by 1 except where
+ *   frames are dropped, a header word is glitched or a fault is
+ *   injected, and random ADCs.
+ *
+ *   The compressed packets have a header record built from such frames
+ *   and an ADC record with well formed tables but random symbol bits.
+ *   Decoding random bits yields symbols distributed as the tables, so
+ *   the ADCs are random, but every decoder must produce the same ones.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The WIB and cold data headers are error free, they were
+                  random, and added the Fault, runs of frames with the
+                  same header error
+   2026.10.16 agt compressedPacket takes the number of symbol bits of each
+                  channel, to synthesize channels that are cut short
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+
+#include <dam/access/WibFrame.hh>
+#include <cinttypes>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+
+
+namespace TpcSynth
+{
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Rng
+  \brief  A xorshift random number generator, reproducible everywhere
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Rng
+{
+public:
+   explicit Rng (uint64_t seed) : m_state (seed | 1) { return; }
+
+   uint64_t next ()
+   {
+      m_state ^= m_state << 13;
+      m_state ^= m_state >>  7;
+      m_state ^= m_state << 17;
+      return m_state;
+   }
+
+   uint32_t operator () () { return next () >> 32; }
+
+public:
+   uint64_t m_state;
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+/* Record headers                                                         */
+/* ---------------------------------------------------------------------- */
+static inline uint64_t header1 (int format, int type, int n64, uint32_t bridge)
+{
+   return  static_cast<uint64_t>(format & 0xf)
+        | (static_cast<uint64_t>(type   & 0xf)      <<  4)
+        | (static_cast<uint64_t>(n64    & 0xffffff) <<  8)
+        | (static_cast<uint64_t>(bridge)            << 32);
+}
+
+static inline uint32_t header2 (int format, int type, int n64, int bridge)
+{
+   return  (format & 0xf)
+        | ((type   & 0xf)   <<  4)
+        | ((n64    & 0xfff) <<  8)
+        | (static_cast<uint32_t>(bridge & 0xfff) << 20);
+}
+
+static inline void append (std::vector<uint64_t>       &out,
+                           std::vector<uint8_t>  const &bytes)
+{
+   for (size_t idx = 0; idx < bytes.size (); idx += sizeof (uint64_t))
+   {
+      uint64_t w64;
+      memcpy (&w64, &bytes[idx], sizeof (w64));
+      out.push_back (w64);
+   }
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  Fault
+  \brief  A run of frames whose header word has the same error
+
+  \par
+   Word m_word of each frame of the run has the bits of m_set set.  If
+   m_hold, the word keeps the value it has in the run's first frame, so
+   a convert count or timestamp stops advancing.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class Fault
+{
+public:
+   int          m_frame; /*!< The run's first frame, counting the frames
+                              synthesized, not the ideal sequence        */
+   int        m_nframes; /*!< The number of frames in the run            */
+   int           m_word; /*!< The header word, 0 the WIB header, 1 the
+                              timestamp, 2,3 and 16,17 the cold data     */
+   uint64_t       m_set; /*!< The bits set                                */
+   bool          m_hold; /*!< The word holds its first value              */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  StreamSpec
+  \brief  The parameters of a synthesized WIB TpcStream
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class StreamSpec
+{
+public:
+   StreamSpec () :
+      m_npkts    (2),
+      m_nframes  (1024),
+      m_ts0      (0x100000),
+      m_begFrame (100),
+      m_endFrame (1900),
+      m_type     (2),
+      m_status   (0),
+      m_csf      (0x123),
+      m_left     (0),
+      m_glitches (0),
+      m_seed     (1),
+      m_badIndices (false)
+   {
+      return;
+   }
+
+public:
+   int                  m_npkts; /*!< Number of packets                   */
+   int                m_nframes; /*!< Number of frames per packet         */
+   uint64_t               m_ts0; /*!< Timestamp of the first frame        */
+   int               m_begFrame; /*!< Trimmed begin, ignoring drops       */
+   int               m_endFrame; /*!< Trimmed end,   ignoring drops       */
+   int                   m_type; /*!< 2 = TpcNormal, 3 = TpcDamaged       */
+   int                 m_status; /*!< Stream status                       */
+   int                    m_csf; /*!< Crate.Slot.Fiber                    */
+   int                   m_left; /*!< Number of streams following         */
+   int               m_glitches; /*!< 1 in m_glitches frames has a header
+                                      word glitched, 0 for none          */
+   uint64_t              m_seed; /*!< Seed of the random numbers          */
+   bool            m_badIndices; /*!< Write a begin index of -1           */
+   std::vector<int>      m_drop; /*!< Frames of the ideal sequence that
+                                      are dropped                        */
+   std::vector<Fault>  m_faults; /*!< Runs of frames with header errors  */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synthesize a WIB TpcStream record
+  \return The record
+
+  \param[in]       spec  The stream parameters
+  \param[out]        ts  If not NULL, the timestamps of the frames
+  \param[out]    frames  If not NULL, the frames
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t>
+wibStream (StreamSpec            const &spec,
+           std::vector<uint64_t>         *ts = NULL,
+           std::vector<uint64_t>     *frames = NULL)
+{
+   int const nwords = sizeof (pdd::access::WibFrame) / sizeof (uint64_t);
+   int const nframes = spec.m_npkts * spec.m_nframes;
+   Rng             rng (spec.m_seed);
+
+
+   // --------------------------------------
+   // The frame timestamps, less the dropped
+   // --------------------------------------
+   std::vector<uint64_t> stamps;
+   for (int iframe = 0; static_cast<int>(stamps.size ()) < nframes; iframe++)
+   {
+      bool dropped = false;
+      for (int drop : spec.m_drop) if (drop == iframe) dropped = true;
+      if (!dropped) stamps.push_back (spec.m_ts0 + 25 * (uint64_t)iframe);
+   }
+
+   std::vector<uint64_t> out (1, 0);
+
+
+   // --------------------------------------------------------
+   // The ranges, a 4 byte header and 52 byte body, 7 words.
+   // The indices are those predicted assuming no drops.
+   // --------------------------------------------------------
+   {
+      std::vector<uint8_t> r (56, 0);
+      uint32_t hdr = header2 (2, 2, 7, 0);
+      uint32_t  bi = spec.m_badIndices
+                   ? 0xffffffff
+                   : ((spec.m_begFrame / spec.m_nframes) << 16)
+                   |  (spec.m_begFrame % spec.m_nframes);
+      uint32_t  ei = ((spec.m_endFrame / spec.m_nframes) << 16)
+                   |  (spec.m_endFrame % spec.m_nframes);
+      uint64_t  tb = stamps.front ();
+      uint64_t  te = stamps.back  ();
+      uint64_t  wb = spec.m_ts0 + 25 * (uint64_t)spec.m_begFrame + 3;
+      uint64_t  we = spec.m_ts0 + 25 * (uint64_t)spec.m_endFrame + 3;
+      uint64_t  wt = (wb + we) / 2;
+
+      memcpy (&r[ 0], &hdr, 4);
+      memcpy (&r[ 4], &bi,  4);
+      memcpy (&r[ 8], &ei,  4);
+      memcpy (&r[12], &bi,  4);
+      memcpy (&r[16], &tb,  8);
+      memcpy (&r[24], &te,  8);
+      memcpy (&r[32], &wb,  8);
+      memcpy (&r[40], &we,  8);
+      memcpy (&r[48], &wt,  8);
+      append (out, r);
+   }
+
+
+   // ------------------------------------------
+   // The table of contents, 1 WIB packet each
+   // ------------------------------------------
+   {
+      int nbytes = 4 + 4 * (spec.m_npkts + 1);
+      int    n64 = (nbytes + 7) / 8;
+      std::vector<uint8_t> r (n64 * 8, 0);
+      uint32_t hdr = header2 (2, 1, n64, spec.m_npkts << 4);
+      memcpy (&r[0], &hdr, 4);
+      for (int ipkt = 0; ipkt <= spec.m_npkts; ipkt++)
+      {
+         uint32_t dsc = (1 << 4) | ((ipkt * spec.m_nframes * nwords) << 8);
+         memcpy (&r[4 + 4 * ipkt], &dsc, 4);
+      }
+      append (out, r);
+   }
+
+
+   // -----------------------------------------------------------
+   // The packets, the headers follow the predictions of the
+   // compression, save for the drops and the glitches
+   // -----------------------------------------------------------
+   {
+      out.push_back (header1 (1, 3, 1 + nframes * nwords, 0));
+      size_t base = out.size ();
+      out.resize (base + nframes * nwords);
+
+      // ----------------------------------------------------------
+      // The WIB header has the comma character and no errors, the
+      // cold data headers no stream errors and no error registers.
+      // The checksums and the rest are random.
+      // ----------------------------------------------------------
+      uint64_t wib0 = 0xbc | ((rng () & 0x1f) << 8) | ((rng () & 0x7ff) << 13);
+      uint64_t cd00 = rng.next () & ~0xffffull;
+      uint64_t cd01 = rng.next () & ~0xffffull;
+      uint64_t cd10 = rng.next () & ~0xffffull;
+      uint64_t cd11 = rng.next () & ~0xffffull;
+      uint64_t *w   = &out[base];
+      for (int iframe = 0; iframe < nframes; iframe++, w += nwords)
+      {
+         for (int iw = 0; iw < nwords; iw++) w[iw] = rng.next ();
+
+         w[ 0] = wib0;
+         w[ 1] = stamps[iframe];
+         w[ 2] = cd00 + ((uint64_t)iframe << 48);
+         w[ 3] = cd01;
+         w[16] = cd10 + ((uint64_t)iframe << 48);
+         w[17] = cd11;
+
+         if (spec.m_glitches && rng () % spec.m_glitches == 0)
+         {
+            static int const Idx[] = { 0, 2, 3, 16, 17 };
+            w[Idx[rng () % 5]] ^= rng.next ();
+         }
+      }
+
+      for (Fault const &fault : spec.m_faults)
+      {
+         uint64_t *f = &out[base + fault.m_frame * nwords];
+         uint64_t  v = f[fault.m_word];
+         for (int iframe = fault.m_frame;
+              iframe < fault.m_frame + fault.m_nframes && iframe < nframes;
+              iframe++, f += nwords)
+         {
+            if (fault.m_hold) f[fault.m_word]  = v;
+            f[fault.m_word] |= fault.m_set;
+         }
+      }
+
+      if (frames) frames->assign (out.begin () + base, out.end ());
+   }
+
+   uint32_t bridge = ((spec.m_csf  & 0xfff) <<  4)
+                   | ((spec.m_left & 0xff)  << 16)
+                   | ((uint32_t)(spec.m_status & 0xff) << 24);
+   out[0] = header1 (1, spec.m_type, out.size (), bridge);
+
+   if (ts) *ts = stamps;
+   return out;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Compress the headers of a packet's frames
+  \return The compressed header record
+
+  \param[in]  frames The frames
+  \param[in] nframes The number of frames
+
+   The seeds are the first frame's header words and the last frame's
+   timestamp.  Each frame whose words differ from those predicted from
+   the previous frame is an exception, its differing words follow the
+   exception list.  The record has room for 255 words of exceptions,
+   4 per word including the terminating 0, so there must be no more
+   than 1019 exceptions.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t> compressHdrs (uint64_t const *frames,
+                                                  int            nframes)
+{
+   static int const Idx[6] = { 0, 1, 2, 3, 16, 17 };
+   int const     nwords = sizeof (pdd::access::WibFrame) / sizeof (uint64_t);
+
+   std::vector<uint16_t> excs;
+   std::vector<uint64_t> hdrs;
+   uint64_t prv[6];
+   for (int idx = 0; idx < 6; idx++) prv[idx] = frames[Idx[idx]];
+
+   for (int iframe = 1; iframe < nframes; iframe++)
+   {
+      uint64_t const *w = frames + iframe * nwords;
+      uint64_t pred[6] = { prv[0], prv[1] + 25, prv[2] + (1ull << 48),
+                           prv[3], prv[4] + (1ull << 48), prv[5] };
+      unsigned  mask   = 0;
+      for (int idx = 0; idx < 6; idx++)
+      {
+         uint64_t cur = w[Idx[idx]];
+         if (cur != pred[idx])
+         {
+            mask |= 1 << idx;
+            hdrs.push_back (cur);
+         }
+         prv[idx] = cur;
+      }
+
+      if (mask) excs.push_back ((mask << 10) | iframe);
+   }
+
+   // The exceptions are 0 terminated, in whole 64-bit words
+   do excs.push_back (0); while (excs.size () % 4);
+   int nexcw = excs.size () / 4;
+
+   std::vector<uint64_t> out;
+   int n64 = 1 + 7 + nexcw + hdrs.size ();
+   out.push_back (0x1 | (1 << 4) | ((uint64_t)n64   <<  8)
+                                 | ((uint64_t)nexcw << 24)
+                                 | (0xabull         << 32));
+   for (int idx = 0; idx < 6; idx++)
+   {
+      out.push_back (frames[Idx[idx]]);
+      if (idx == 1) out.push_back (frames[(nframes - 1) * nwords + 1]);
+   }
+
+   for (int iexcw = 0; iexcw < nexcw; iexcw++)
+   {
+      uint64_t w64;
+      memcpy (&w64, &excs[4 * iexcw], sizeof (w64));
+      out.push_back (w64);
+   }
+
+   out.insert (out.end (), hdrs.begin (), hdrs.end ());
+   return out;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class  BitWriter
+  \brief  Writes big-endian bit fields, as the compressed ADCs are read
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class BitWriter
+{
+public:
+   BitWriter (std::vector<uint64_t> &w64, uint64_t position) :
+      m_w64      (w64),
+      m_position (position)
+   {
+      return;
+   }
+
+   void put (uint32_t value, int nbits)
+   {
+      for (int ibit = nbits - 1; ibit >= 0; ibit--, m_position++)
+      {
+         size_t idx = m_position >> 6;
+         if (idx >= m_w64.size ()) m_w64.resize (idx + 1, 0);
+         m_w64[idx] |= (uint64_t)((value >> ibit) & 1)
+                    << (63 - (m_position & 63));
+      }
+   }
+
+public:
+   std::vector<uint64_t>      &m_w64;
+   uint64_t               m_position;
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synthesize a compressed ADC record
+  \return The record
+
+  \param[in,out]   rng  The random number generator
+  \param[in]    nchans  The number of channels
+  \param[in]  nsamples  The number of samples per channel
+  \param[in]      skew  Larger values concentrate the tables' counts in
+                        the low bins, i.e. the small ADC differences
+  \param[in]     nbits  The number of random bits following each
+                        channel's table, its overflows and symbols
+  \param[in]      nhdr  The number of 64-bit words preceding the record
+                        in its packet, i.e. the size of the header record
+
+   Each channel has a header, a table and random bits.  A table of
+   contents of the bit offsets of the channels, measured from the
+   start of the packet, and a trailer follow.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t> adcRecord (Rng    &rng,
+                                               int  nchans,
+                                               int nsamples,
+                                               double  skew,
+                                               int    nbits,
+                                               int     nhdr)
+{
+   std::vector<uint64_t> w64 (1, 0);
+   std::vector<uint32_t> offsets;
+   uint64_t             position = 64;
+
+   for (int ichan = 0; ichan < nchans; ichan++)
+   {
+      offsets.push_back (position + 64 * nhdr);
+      BitWriter bw (w64, position);
+
+      int   nbins = 1 + rng () % 128;
+      int   mbits = 11;
+      int   first = rng () & 0xfff;
+      int novrflw = rng () % 5 ? 1 + rng () % 12 : 0;
+
+      // The counts of the bins, the last taking the remainder
+      std::vector<int> counts;
+      for (int left = nsamples - 1; left; )
+      {
+         int ibin = counts.size ();
+         int  cnt = left;
+         if (ibin < nbins - 1)
+         {
+            double f = std::exp (-skew * ibin / nbins);
+            cnt      = (rng () % 1000) / 1000.0 * f * left * 0.6;
+            if (ibin == 0 && skew >= 10) cnt = rng () % 8;
+            if (cnt > left - 1)          cnt = left - 1;
+         }
+
+         counts.push_back (cnt);
+         left -= cnt;
+      }
+
+      // An encoder's table ends with the last symbol used
+      while (counts.size () > 1 && counts.back () == 0) counts.pop_back ();
+      nbins = counts.size ();
+
+      bw.put (0,         4);
+      bw.put (nbins - 1, 8);
+      bw.put (mbits,     4);
+      bw.put (first,    12);
+      bw.put (novrflw,   4);
+
+      int left  = nsamples - 1;
+      int cbits = mbits;
+      for (int cnt : counts)
+      {
+         bw.put (cnt, cbits);
+         left -= cnt;
+         cbits = left ? 32 - __builtin_clz (left) : 0;
+         if (cbits > mbits) cbits = mbits;
+      }
+
+      for (int ibit = 0; ibit < nbits; ibit += 32) bw.put (rng (), 32);
+      position = bw.m_position;
+   }
+
+   // Pad with random bits, should a decoder read beyond the end
+   size_t n64 = (position >> 6) + 4;
+   w64.resize (n64, 0);
+   for (size_t idx = (position >> 6) + 1; idx < n64; idx++)
+   {
+      w64[idx] = rng.next ();
+   }
+
+   if (offsets.size () & 1) offsets.push_back (0);
+   for (size_t idx = 0; idx < offsets.size (); idx += 2)
+   {
+      w64.push_back ((uint64_t)offsets[idx] | ((uint64_t)offsets[idx+1] << 32));
+   }
+
+   uint64_t tocn64 = offsets.size () / 2 + 1;
+   w64.push_back ( (tocn64                  <<  8)
+                 | ((uint64_t)(nsamples - 1) << 28)
+                 | ((uint64_t)(nchans   - 1) << 40));
+   return w64;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synthesize a compressed packet from a WIB packet's frames
+  \return The packet, its header record followed by its ADC record
+
+  \param[in,out]     rng  The random number generator
+  \param[in]      frames  The frames, only the headers are used
+  \param[in]     nframes  The number of frames
+  \param[in]      nchans  The number of channels
+  \param[in]       nbits  The number of bits of overflows and symbols of
+                          each channel.  With fewer than its symbols need,
+                          a channel's decoding runs on into the following
+                          channels and, for the last, beyond the packet.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t> compressedPacket (Rng             &rng,
+                                                      uint64_t const *frames,
+                                                      int            nframes,
+                                                      int             nchans = 128,
+                                                      int              nbits = 14000)
+{
+   std::vector<uint64_t> pkt  = compressHdrs (frames, nframes);
+   std::vector<uint64_t> adcs = adcRecord    (rng, nchans, nframes,
+                                              1 + rng () % 30, nbits,
+                                              pkt.size ());
+   pkt.insert (pkt.end (), adcs.begin (), adcs.end ());
+   return pkt;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synthesize a compressed TpcStream record
+  \return The record
+
+  \param[in]      pkts  The compressed packets
+  \param[in]       wib  The WIB stream that was compressed, its header
+                        and ranges are copied
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t>
+compressedStream (std::vector<std::vector<uint64_t>> const &pkts,
+                  std::vector<uint64_t>              const  &wib)
+{
+   std::vector<uint64_t> out (wib.begin (), wib.begin () + 8);
+   int  npkts = pkts.size ();
+   int nbytes = 4 + 4 * (npkts + 1);
+   int    n64 = (nbytes + 7) / 8;
+
+   std::vector<uint8_t> r (n64 * 8, 0);
+   uint32_t hdr = header2 (2, 1, n64, npkts << 4);
+   memcpy (&r[0], &hdr, 4);
+
+   uint32_t offset = 0;
+   for (int ipkt = 0; ipkt <= npkts; ipkt++)
+   {
+      uint32_t dsc = (3 << 4) | (offset << 8);
+      memcpy (&r[4 + 4 * ipkt], &dsc, 4);
+      if (ipkt < npkts) offset += pkts[ipkt].size ();
+   }
+   append (out, r);
+
+   out.push_back (header1 (1, 3, 1 + offset, 0));
+   for (auto const &pkt : pkts) out.insert (out.end (), pkt.begin (), pkt.end ());
+
+   out[0] = (out[0] & ~(0xffffffull << 8)) | ((uint64_t)out.size () << 8);
+   return out;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Compress a WIB TpcStream record
+  \return The compressed TpcStream record
+
+  \param[in,out]  rng  The random number generator
+  \param[in]     spec  The parameters the WIB stream was synthesized with
+  \param[in]      wib  The WIB stream
+  \param[in]   frames  Its frames
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t>
+compressStream (Rng                         &rng,
+                StreamSpec            const &spec,
+                std::vector<uint64_t> const  &wib,
+                std::vector<uint64_t> const &frames)
+{
+   int const nwords = sizeof (pdd::access::WibFrame) / sizeof (uint64_t);
+   std::vector<std::vector<uint64_t>> pkts;
+   for (int ipkt = 0; ipkt < spec.m_npkts; ipkt++)
+   {
+      pkts.push_back (compressedPacket (rng,
+                                        &frames[ipkt * spec.m_nframes * nwords],
+                                        spec.m_nframes));
+   }
+
+   return compressedStream (pkts, wib);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Wrap TpcStream records in a data fragment
+  \return The fragment
+
+  \param[in] streams  The TpcStream records
+  \param[in] subtype  The fragment's subtype
+  \param[in]     seq  The sequence number
+  \param[in]      ts  The timestamp
+
+   The fragment passes the checks of RceFragmentUnpack, the header's
+   pattern is set and the trailer is its complement.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline std::vector<uint64_t>
+fragment (std::vector<std::vector<uint64_t>> const &streams,
+          int                                       subtype = 2,
+          uint32_t                                      seq = 0,
+          uint64_t                                       ts = 0)
+{
+   // Header, identifier (2 words), originator
+   std::vector<uint64_t> out (4, 0);
+   for (auto const &stream : streams)
+   {
+      out.insert (out.end (), stream.begin (), stream.end ());
+   }
+   out.push_back (0);
+
+   uint64_t n64 = out.size ();
+   out[0]       = (2ull << 4)
+                | ((n64 & 0xffffff)      <<  8)
+                | (2ull                  << 32)
+                | ((uint64_t)subtype     << 36)
+                | (0x8b309eull           << 40);
+   out[1]       = (uint64_t)seq << 32;
+   out[2]       = ts;
+   out[3]       = header2 (2, 1, 1, 0);
+   out.back ()  = ~out[0];
+   return out;
+}
+/* ---------------------------------------------------------------------- */
+
+}
+
+#endif
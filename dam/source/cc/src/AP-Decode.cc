@@ -53,6 +53,9 @@
  *
  * DATE       WHO WHAT
  * ---------- --- ---------------------------------------------------------
+ * 2026.10.16 agt Added APD_lut_build and APD_decode_lut, decoding with
+ *                a direct cumulative probability to symbol lookup table
+ * 2026.10.16 agt Moved scale_m1 and lookup_bot to AP-Decode.h
  * 2018.08.17 jjr Added unused attribute to the lookup routines
  * 2016.05.19 jjr Adapted for dune usage
  *
@@ -62,6 +65,7 @@
 
 
 #include "AP-Decode.h"
+#include <string.h>
 #define ENDIANNESS_IS_LITTLE 1
 
 
@@ -79,11 +83,6 @@ static __inline int lookup_top (APD_cv_t             cum,
                                 unsigned int         cnt)
                                   __attribute__((unused));
 
-static __inline int lookup_bot (APD_cv_t             cum,
-                                APD_table_t const *table,
-                                unsigned int         cnt)
-                                  __attribute__((unused));
-
 
 /* ---------------------------------------------------------------------- *//*!
 
@@ -155,6 +154,29 @@ static __inline int lookup_bot (APD_cv_t             cum,
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \fn      unsigned int  APD_decode_lut (APD_dtx             *dtx,
+                                         APD_table_t const *table,
+                                         APD_lut_t   const   *lut)
+  \brief   Decodes the next symbol using a symbol lookup table
+  \return  The decoded symbol
+
+  \param   dtx   The decoding context
+  \param table   The table to use in the decoding
+  \param   lut   The symbol lookup table built from \a table by
+                  APD_lut_build
+
+  \par
+   This is identical to APD_decode, except the symbol is found with a
+   single lookup, rather than by searching \a table.  This pays off when
+   the same table is used for many symbols.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \fn     int APD_finish (APD_dtx *dtx)
@@ -257,45 +279,6 @@ static __inline int lookup_bot (APD_cv_t             cum,
 
 
 
-
-
-
-
-
-/* ---------------------------------------------------------------------- *//*!
-
-  \static __inline unsigned int scale_m1 (uint32_t num,
-                                          uint32_t den)
-  \brief  Does a scaling equivalent to  ((\a num << 32) - 1) / \a den.
-  \return The scaled value
-
-  \param  num  The numerator/value to scale
-  \param  den  The denominator/scaling factor
-
-  \par
-   The scaling is of equivalent to  ((\a num << 32) - 1) / \a den.
-   If \a den is 0, this really a sentinal value indicating that
-   it's value is really 1. Due to a finite number of bits, 1 must
-   be represented as 0.
-                                                                          */
-/* ---------------------------------------------------------------------- */
-static __inline APD_cv_t scale_m1 (APD_cv_t num,
-                                   APD_cv_t den)
-{
-  uint32_t q;
-
-  //num64 = (num << 32) - 1;
-
-  q  = ((num << APC_K_NORM_NBITS) - 1)/ den;
-
-  // printf ("%16.16llx << 32 - 1 / %8.8x = %8.8x\n", n, den, a);
-
-  return q;
-}
-/* ---------------------------------------------------------------------- */
-
-
-
 /* ---------------------------------------------------------------------- *//*!
 
   \fn    static __inline int lookup (uint32_t             cum,
@@ -409,53 +392,50 @@ static __inline int lookup_top (APD_cv_t             cum,
 
 
 
-
 /* ---------------------------------------------------------------------- *//*!
 
-  \fn    static __inline int lookup_bot (uint32_t          cum,
-                                         uint32_t const *table,
-                                         unsigned int      cnt)
-  \brief  Lookups the interval containing the specified cumulative
-          probability by doing a linear search from the bottom of the table
-          to the top
-  \return The index of the interval
+  \fn    void APD_lut_build (APD_lut_t            *lut,
+                             APD_table_t const  *table)
+  \brief Builds the symbol lookup table for \a table
 
-  \par      cum  The target cumulative probability
-  \par    table  The table of cumulative probabilities
-  \par      cnt  The number of intervals in the table
+  \param   lut  The symbol lookup table, APD_K_LUT_SIZE entries
+  \param table  The decoding table
 
   \par
-   The table is search from the bottom to top using a linear search. For
-   small tables, this may be the most efficient way to search, avoiding
-   the overhead of more sophisiticated methods
+   Entry \e cum of the lookup table is the symbol lookup_bot returns for
+   \e cum.  Since lookup_bot returns the index preceding the first entry
+   above \e cum, the entries are assigned in runs, each ending at the
+   running maximum of the cumulative probabilities. This reproduces
+   lookup_bot even for a table that is not monotonic, as can happen with
+   a corrupted stream.
                                                                           */
 /* ---------------------------------------------------------------------- */
-static __inline int lookup_bot (APD_cv_t             cum,
-                                APD_table_t const *table,
-                                unsigned int        cnt)
+extern void APD_lut_build (APD_lut_t          *lut,
+                           APD_table_t const *table)
 {
-    int symbol;
+    unsigned int cnt = table[0] - 1;
+    unsigned int top;
+    unsigned int beg = 0;
+    unsigned int   j;
 
-    // Check if in the top bin
-    if (table[cnt] <= cum)
-    {
-        symbol = cnt;
-    }
-    else
+    table = table + 1;
+
+    /* The linear search from the bottom */
+    for (j = 1; j <= cnt; j++)
     {
-        APD_table_t const *p = table + 1;
-        while (1)
+        top = table[j] < APD_K_LUT_SIZE ? table[j] : APD_K_LUT_SIZE;
+        if (top > beg)
         {
-            //printf (" %x >= %x\n", *p, cum);
-            if (*p > cum) break;
-            p++;
+            memset (lut + beg, j - 1, top - beg);
+            beg = top;
         }
-
-        symbol = p - table - 1;
-        //printf ("Symbol = %d\n", symbol);
     }
 
-    return symbol;
+    /* The top bin check, this takes precedence */
+    beg = table[cnt] < APD_K_LUT_SIZE ? table[cnt] : APD_K_LUT_SIZE;
+    memset (lut + beg, cnt, APD_K_LUT_SIZE - beg);
+
+    return;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -479,6 +459,7 @@ static __inline int lookup_bot (APD_cv_t             cum,
 /* Define the routine interface names */
 #define   apd_start       APD_start
 #define   apd_decode      APD_decode
+#define   apd_decode_lut  APD_decode_lut
 #define   apd_bdecompress APD_bdecompress
 #define   apd_finish      APD_finish
 #include "apdtemplate.h"
@@ -67,6 +67,12 @@
  *
  * DATE       WHO WHAT
  * ---------- --- ---------------------------------------------------------
+ * 2026.10.16 agt Added renormalize, the closed form renormalization, and
+ *                renormalize_bitwise, the original loop, as its fallback
+ * 2026.10.16 agt Added the symbol lookup table, APD_lut_build and
+ *                APD_decode_lut
+ * 2026.10.16 agt Moved scale_m1 and lookup_bot here from AP-Decode.cc so
+ *                that the interleaved decoders can share them
  * 2016.05.19 jjr Adapted for dune usage
  *
 \* ---------------------------------------------------------------------- */
@@ -243,6 +249,293 @@ static __inline APD_cv_t scale_lo (APD_cv_t       lo,
 }
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \static __inline unsigned int scale_m1 (uint32_t num,
+                                          uint32_t den)
+  \brief  Does a scaling equivalent to  ((\a num << 32) - 1) / \a den.
+  \return The scaled value
+
+  \param  num  The numerator/value to scale
+  \param  den  The denominator/scaling factor
+
+  \par
+   The scaling is of equivalent to  ((\a num << 32) - 1) / \a den.
+   If \a den is 0, this really a sentinal value indicating that
+   it's value is really 1. Due to a finite number of bits, 1 must
+   be represented as 0.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static __inline APD_cv_t scale_m1 (APD_cv_t num,
+                                   APD_cv_t den)
+{
+  uint32_t q;
+
+  //num64 = (num << 32) - 1;
+
+  q  = ((num << APC_K_NORM_NBITS) - 1)/ den;
+
+  // printf ("%16.16llx << 32 - 1 / %8.8x = %8.8x\n", n, den, a);
+
+  return q;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \fn    static __inline int lookup_bot (uint32_t          cum,
+                                         uint32_t const *table,
+                                         unsigned int      cnt)
+  \brief  Lookups the interval containing the specified cumulative
+          probability by doing a linear search from the bottom of the table
+          to the top
+  \return The index of the interval
+
+  \par      cum  The target cumulative probability
+  \par    table  The table of cumulative probabilities
+  \par      cnt  The number of intervals in the table
+
+  \par
+   The table is search from the bottom to top using a linear search. For
+   small tables, this may be the most efficient way to search, avoiding
+   the overhead of more sophisiticated methods
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static __inline int lookup_bot (APD_cv_t             cum,
+                                APD_table_t const *table,
+                                unsigned int        cnt)
+{
+    int symbol;
+
+    // Check if in the top bin
+    if (table[cnt] <= cum)
+    {
+        symbol = cnt;
+    }
+    else
+    {
+        APD_table_t const *p = table + 1;
+        while (1)
+        {
+            //printf (" %x >= %x\n", *p, cum);
+            if (*p > cum) break;
+            p++;
+        }
+
+        symbol = p - table - 1;
+        //printf ("Symbol = %d\n", symbol);
+    }
+
+    return symbol;
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \def    APD_K_LUT_SIZE
+  \brief  The number of entries in a symbol lookup table, one for each
+          possible scaled cumulative probability
+                                                                          *//*!
+  \typedef APD_lut_t
+  \brief   The type of a symbol lookup table entry
+
+  \par
+   A symbol lookup table maps the scaled cumulative probability directly
+   to the symbol that lookup_bot would find.  It is built once per
+   decoding table by APD_lut_build and used by APD_decode_lut.  Since
+   a table has at most 256 bins, a symbol fits in a byte, so a lookup
+   table is only 1024 bytes.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+#define APD_K_LUT_SIZE  (1 << APC_K_NORM_NBITS)
+typedef uint8_t         APD_lut_t;
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \def    APD_K_LUT_MINBINS
+  \brief  The minimum number of bins for which a symbol lookup table
+          beats searching the table
+
+  \par
+   For a table with few bins, the search usually stops at the first
+   bin.  That branch is well predicted, so the symbol is known before
+   it is computed, whereas the lookup must wait on the load.  Measured
+   with PdApdLookupTest, the two break even at about 6 bins.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+#define APD_K_LUT_MINBINS  8
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \fn    static __inline int lookup_lut (uint32_t          cum,
+                                         APD_table_t const *table,
+                                         unsigned int        cnt,
+                                         APD_lut_t   const   *lut)
+  \brief  Lookups the interval containing the specified cumulative
+          probability using the symbol lookup table
+  \return The index of the interval
+
+  \par      cum  The target cumulative probability
+  \par    table  The table of cumulative probabilities
+  \par      cnt  The number of intervals in the table
+  \par      lut  The symbol lookup table built from \a table
+
+  \par
+   A cumulative probability beyond the lookup table can only come from
+   a corrupted stream.  It is handed to lookup_bot so that the result
+   is the same in all cases.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static __inline int lookup_lut (APD_cv_t             cum,
+                                APD_table_t const *table,
+                                unsigned int         cnt,
+                                APD_lut_t   const   *lut)
+{
+    if (cum < APD_K_LUT_SIZE) return lut[cum];
+    else                      return lookup_bot (cum, table, cnt);
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \fn    static __inline unsigned int renormalize_bitwise (APD_cv_t *lo,
+                                                          APD_cv_t *hi)
+  \brief  Renormalizes the code range one bit at a time
+  \return The number of bits shifted out, \e i.e. the number of input bits
+          the value must take in
+
+  \param[in,out] lo  The code range's lo limit
+  \param[in,out] hi  The code range's hi limit
+
+  \par
+   This is the classic loop, kept for code ranges that renormalize
+   cannot handle.  The value is not updated.  Since it undergoes the
+   same subtractions and shifts as \a lo, value - lo only accumulates
+   the input bits, so the caller can update it all at once.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static __inline unsigned int renormalize_bitwise (APD_cv_t *plo,
+                                                  APD_cv_t *phi)
+{
+    APD_cv_t     lo = *plo;
+    APD_cv_t     hi = *phi;
+    unsigned int  k = 0;
+
+    while (1)
+    {
+        if      (hi <  APC_K_HALF)
+        {
+            /* Expand low half.         */
+        }
+        else if (lo >= APC_K_HALF)
+        {
+            /* Expand high half, subtract offset to top.*/
+            lo    -= APC_K_HALF;
+            hi    -= APC_K_HALF;
+        }
+        else if (lo >= APC_K_Q1 && hi < APC_K_Q3)
+        {
+            /* Expand middle half, subtract offset to middle*/
+            lo    -= APC_K_Q1;
+            hi    -= APC_K_Q1;
+        }
+        else
+        {
+            /* Otherwise exit loop.     */
+            break;
+        }
+
+        /* Scale up code range.     */
+        lo <<= 1;
+        hi <<= 1;
+        hi  |= 1;
+
+        lo &= APC_M_CV_ALL;
+        hi &= APC_M_CV_ALL;
+        k  += 1;
+    }
+
+   *plo = lo;
+   *phi = hi;
+
+    return k;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \fn    static __inline unsigned int renormalize (APD_cv_t *lo,
+                                                  APD_cv_t *hi)
+  \brief  Renormalizes the code range, shifting out all the bits at once
+  \return The number of bits shifted out, \e i.e. the number of input bits
+          the value must take in
+
+  \param[in,out] lo  The code range's lo limit
+  \param[in,out] hi  The code range's hi limit
+
+  \par
+   This produces exactly what renormalize_bitwise does, but in closed
+   form.  Every expansion of the low or high half drops the top bit of
+   \a lo and \a hi, shifting in a 0 and 1 respectively.  These continue
+   until the top bits of \a lo and \a hi are 0 and 1, so their number
+   is the count of leading zeros of ~lo & hi.  Thereafter, each
+   expansion of the middle half drops the bit following the top bit
+   while it is 1 in \a lo and 0 in \a hi, so their number is the count
+   of leading ones of lo & ~hi, starting at that bit.
+
+  \par
+   As with renormalize_bitwise, the value is not updated.  Code limits
+   wider than APC_K_NBITS, which only a corrupted table can produce, are
+   handed to renormalize_bitwise.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static __inline unsigned int renormalize (APD_cv_t *plo,
+                                          APD_cv_t *phi)
+{
+    uint32_t     lo = *plo;
+    uint32_t     hi = *phi;
+    unsigned int  n;
+    unsigned int  m;
+
+    if ((lo | hi) > APC_M_CV_ALL) return renormalize_bitwise (plo, phi);
+
+    /*
+     | Expansions of the low and high halves, the sentinel bit following
+     | the APC_K_NBITS code bits limits the count when ~lo & hi is 0.
+    */
+    n  = __builtin_clz (((~lo & hi) << (32 - APC_K_NBITS))
+                       | (1 << (31 - APC_K_NBITS)));
+    lo =  (lo << n)                    & APC_M_CV_ALL;
+    hi = ((hi << n) | ((1 << n) - 1))  & APC_M_CV_ALL;
+
+    /*
+     | Expansions of the middle half, the top bits are now lo = 0, hi = 1.
+     | The bits shifted in above are lo = 0, hi = 1, so limit the count.
+    */
+    m  = __builtin_clz (~((lo & ~hi) << (33 - APC_K_NBITS)));
+    lo =               ((lo << m) & (APC_K_HALF - 1));
+    hi = APC_K_HALF |  ((hi << m) & (APC_K_HALF - 1)) | ((1 << m) - 1);
+
+   *plo = lo;
+   *phi = hi;
+
+    return n + m;
+}
+/* ---------------------------------------------------------------------- */
+
+
 #if APD_DUMP
 #define APD_dumpStatement(_statement) _statement
 #else
@@ -259,6 +552,13 @@ extern void           APD_start         (APD_dtx              *dtx,
 extern unsigned int   APD_decode        (APD_dtx              *dtx,
                                          APD_table_t const  *table);
 
+extern void           APD_lut_build     (APD_lut_t            *lut,
+                                         APD_table_t const  *table);
+
+extern unsigned int   APD_decode_lut    (APD_dtx              *dtx,
+                                         APD_table_t const  *table,
+                                         APD_lut_t   const    *lut);
+
 extern int            APD_bdecompress   (uint8_t              *dst,
                                          int                   cnt,
                                          const void           *src,
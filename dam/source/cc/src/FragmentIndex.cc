@@ -0,0 +1,519 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentIndex.cc
+ *  @brief    An index of the fragments in a binary file, kept in a
+ *            sidecar file
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The sidecar, now version 2, records the inode and the
+                  modification time of the indexed file as well as its
+                  size.  load rebuilds the index if any of them changed.
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentIndex.hh"
+#include "dam/FragmentReaderMapped.hh"
+#include "dam/HeaderFragmentUnpack.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcFragmentUnpack.hh"
+#include "dam/access/Identifier.hh"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class SidecarHeader
+  \brief The header of the sidecar file, followed by the entries
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class SidecarHeader
+{
+public:
+   static const uint64_t Magic   = 0x3158444946444450; // "PDDFIDX1"
+   static const uint32_t Version = 2;
+
+public:
+   uint64_t        m_magic; /*!< Identifies the file as an index          */
+   uint32_t      m_version; /*!< The layout version                       */
+   uint32_t    m_entrySize; /*!< The size of an entry, in bytes           */
+   uint64_t        m_count; /*!< The number of entries                    */
+   uint64_t     m_fileSize; /*!< The size of the indexed file, in bytes   */
+   uint64_t        m_inode; /*!< Its inode number                         */
+   int64_t      m_mtimeSec; /*!< Its modification time, seconds           */
+   uint32_t    m_mtimeNsec; /*!< and nanoseconds                          */
+   uint32_t         m_rsvd; /*!< Reserved, must be 0                      */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+FragmentIndex::FragmentIndex () :
+   m_fileSize  (0),
+   m_inode     (0),
+   m_mtimeSec  (0),
+   m_mtimeNsec (0)
+{
+   static_assert (sizeof (Entry) == 40, "FragmentIndex::Entry layout");
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the default name of the sidecar of \a filename
+  \return The sidecar name
+
+  \param[in] filename  The name of the indexed file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+std::string FragmentIndex::getSidecarName (char const *filename)
+{
+   return std::string (filename) + ".idx";
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Fills an index entry from a fragment
+  \param[out]    entry  The entry
+  \param[in]  fragment  The fragment
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void fill (FragmentIndex::Entry                    *entry,
+                  FragmentReader::Fragment const       &fragment)
+{
+   memset (entry, 0, sizeof (*entry));
+
+   auto const *header = HeaderFragmentUnpack::assign (fragment.m_buf);
+   entry->m_offset    = fragment.m_offset;
+   entry->m_n64       = fragment.m_n64;
+   entry->m_type      = header->getType    ();
+   entry->m_subtype   = header->getSubtype ();
+
+   if (!header->isData ())
+   {
+      return;
+   }
+
+
+   DataFragmentUnpack       df (fragment.m_buf);
+   pdd::record::Identifier const *id = df.getIdentifier ();
+   entry->m_sequence  = pdd::access::Identifier::getSequence  (id);
+   entry->m_timestamp = pdd::access::Identifier::getTimestamp (id);
+
+   if (!df.isTpcNormal () && !df.isTpcDamaged ())
+   {
+      return;
+   }
+
+
+   TpcFragmentUnpack tpc (df);
+   int          nstreams = tpc.getNStreams ();
+   if (nstreams > FragmentIndex::MaxStreams)
+   {
+      nstreams = FragmentIndex::MaxStreams;
+   }
+
+   entry->m_nstreams = nstreams;
+   for (int istream = 0; istream < nstreams; istream++)
+   {
+      TpcStreamUnpack const *stream = tpc.getStream (istream);
+      int8_t                 format = static_cast<int8_t>
+                                     (stream->getDataFormatType ());
+
+      entry->m_csfs  [istream] = stream->getIdentifier ().m_w32;
+      entry->m_format[istream] = format;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns true if the status of a file matches the one the index
+          was built from
+
+  \param[in] st  The file's status
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool FragmentIndex::isCurrent (struct stat const &st) const
+{
+   return m_fileSize  == (uint64_t)st.st_size
+       && m_inode     == (uint64_t)st.st_ino
+       && m_mtimeSec  ==  (int64_t)st.st_mtim.tv_sec
+       && m_mtimeNsec == (uint32_t)st.st_mtim.tv_nsec;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Builds the index by walking the file
+  \return 0 if successful, else the Unix error number
+
+  \param[in] filename  The file to index
+
+  \par
+   The file's inode and modification time are taken before the walk, so
+   that, should the file change during it, the index is older than the
+   file and is rebuilt by the next load.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::build (char const *filename)
+{
+   FragmentReaderMapped reader (filename);
+
+   m_entries.clear ();
+   m_fileSize  = 0;
+   m_inode     = 0;
+   m_mtimeSec  = 0;
+   m_mtimeNsec = 0;
+
+   struct stat st;
+   if (stat (filename, &st) != 0) return errno;
+
+   int err = reader.open ();
+   if (err) return err;
+
+   m_inode     = st.st_ino;
+   m_mtimeSec  = st.st_mtim.tv_sec;
+   m_mtimeNsec = st.st_mtim.tv_nsec;
+
+   m_fileSize = reader.getSize ();
+
+   while (1)
+   {
+      FragmentReader::Fragment  fragment;
+      FragmentReader::Status      status = reader.read (&fragment);
+
+      if (status != FragmentReader::Status::Okay &&
+          status != FragmentReader::Status::BadTrailer)
+      {
+         break;
+      }
+
+      Entry entry;
+      fill (&entry, fragment);
+      if (status == FragmentReader::Status::BadTrailer)
+      {
+         entry.m_flags |= Entry::BadTrailer;
+      }
+
+      m_entries.push_back (entry);
+      reader.release (fragment);
+   }
+
+   reader.close ();
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Writes the index to a sidecar file
+  \return 0 if successful, else the Unix error number
+
+  \param[in] idxname  The name of the sidecar file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::write (char const *idxname) const
+{
+   FILE *file = fopen (idxname, "wb");
+   if (file == 0) return errno;
+
+   SidecarHeader header;
+   header.m_magic     = SidecarHeader::Magic;
+   header.m_version   = SidecarHeader::Version;
+   header.m_entrySize = sizeof (Entry);
+   header.m_count     = m_entries.size ();
+   header.m_fileSize  = m_fileSize;
+   header.m_inode     = m_inode;
+   header.m_mtimeSec  = m_mtimeSec;
+   header.m_mtimeNsec = m_mtimeNsec;
+   header.m_rsvd      = 0;
+
+   bool okay = fwrite (&header, sizeof (header), 1, file) == 1;
+   if (okay && header.m_count)
+   {
+      okay = fwrite (m_entries.data (), sizeof (Entry), header.m_count, file)
+          == header.m_count;
+   }
+
+   int err = okay ? 0 : errno;
+   if (fclose (file) != 0 && err == 0) err = errno;
+
+   if (err) remove (idxname);
+   return err;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Reads the index from a sidecar file
+  \return 0 if successful, else the Unix error number. EINVAL is
+          returned if the file is not a sidecar of this version.
+
+  \param[in] idxname  The name of the sidecar file
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::read (char const *idxname)
+{
+   m_entries.clear ();
+   m_fileSize  = 0;
+   m_inode     = 0;
+   m_mtimeSec  = 0;
+   m_mtimeNsec = 0;
+
+   FILE *file = fopen (idxname, "rb");
+   if (file == 0) return errno;
+
+   SidecarHeader header;
+   int              err = 0;
+
+   if (fread (&header, sizeof (header), 1, file) != 1 ||
+       header.m_magic     != SidecarHeader::Magic     ||
+       header.m_version   != SidecarHeader::Version   ||
+       header.m_entrySize != sizeof (Entry))
+   {
+      err = EINVAL;
+   }
+   else
+   {
+      m_entries.resize (header.m_count);
+      if (header.m_count &&
+          fread (m_entries.data (), sizeof (Entry), header.m_count, file)
+                                                 != header.m_count)
+      {
+         m_entries.clear ();
+         err = EINVAL;
+      }
+      else
+      {
+         m_fileSize  = header.m_fileSize;
+         m_inode     = header.m_inode;
+         m_mtimeSec  = header.m_mtimeSec;
+         m_mtimeNsec = header.m_mtimeNsec;
+      }
+   }
+
+   fclose (file);
+   return err;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Gets the index of a file from its sidecar, building and saving
+          it if the sidecar does not exist or is stale.
+  \return 0 if successful, else the Unix error number
+
+  \param[in] filename  The indexed file
+
+  \par
+   The sidecar is considered stale if the size, inode or modification
+   time of the file has changed.  The size alone misses a file rewritten
+   in place or replaced by another of the same size.
+   Failing to save the sidecar, e.g. for lack of permission, is not an
+   error; the index is still usable.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::load (char const *filename)
+{
+   struct stat st;
+   if (stat (filename, &st) != 0) return errno;
+
+   std::string idxname = getSidecarName (filename);
+   if (read (idxname.c_str ()) == 0 && isCurrent (st))
+   {
+      return 0;
+   }
+
+   int err = build (filename);
+   if (err) return err;
+
+   write (idxname.c_str ());
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Finds the fragment with the specified sequence number
+  \return Its index, -1 if there is none
+
+  \param[in] sequence  The Identifier's sequence number
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::findSequence (uint32_t sequence) const
+{
+   int count = m_entries.size ();
+   for (int idx = 0; idx < count; idx++)
+   {
+      Entry const &entry = m_entries[idx];
+      if (entry.m_sequence == sequence && entry.m_type ==
+          static_cast<uint8_t>(pdd::fragment::Type::Data))
+      {
+         return idx;
+      }
+   }
+
+   return -1;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Finds the fragment covering the specified time, that is the
+          data fragment with the latest timestamp not after it
+  \return Its index, -1 if there is none
+
+  \param[in] timestamp  The time, in the units of Identifier::getTimestamp
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::findTimestamp (uint64_t timestamp) const
+{
+   int   found = -1;
+   int   count = m_entries.size ();
+
+   for (int idx = 0; idx < count; idx++)
+   {
+      Entry const &entry = m_entries[idx];
+      if (entry.m_type != static_cast<uint8_t>(pdd::fragment::Type::Data) ||
+          entry.m_timestamp > timestamp)
+      {
+         continue;
+      }
+
+      if (found < 0 || entry.m_timestamp > m_entries[found].m_timestamp)
+      {
+         found = idx;
+      }
+   }
+
+   return found;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Tests whether one of the entry's streams is from the specified
+          WIB fiber
+  \retval true  if a stream is from the fiber
+  \retval false if no stream is from the fiber
+
+  \param[in] crate  The WIB crate
+  \param[in]  slot  The WIB slot
+  \param[in] fiber  The WIB fiber
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool FragmentIndex::Entry::hasFiber (uint32_t crate,
+                                     uint32_t  slot,
+                                     uint32_t fiber) const
+{
+   for (int istream = 0; istream < m_nstreams; istream++)
+   {
+      TpcStreamUnpack::Identifier id = getIdentifier (istream);
+      if (id.getCrate () == crate &&
+          id.getSlot  () == slot  &&
+          id.getFiber () == fiber)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Finds the next fragment with a stream from the specified WIB
+          fiber
+  \return Its index, -1 if there is none
+
+  \param[in] crate  The WIB crate
+  \param[in]  slot  The WIB slot
+  \param[in] fiber  The WIB fiber
+  \param[in] start  The index to start the search at
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentIndex::findFiber (uint32_t crate,
+                              uint32_t  slot,
+                              uint32_t fiber,
+                              int      start) const
+{
+   int count = m_entries.size ();
+   for (int idx = start < 0 ? 0 : start; idx < count; idx++)
+   {
+      if (m_entries[idx].hasFiber (crate, slot, fiber))
+      {
+         return idx;
+      }
+   }
+
+   return -1;
+}
+/* ---------------------------------------------------------------------- */
@@ -0,0 +1,503 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentPipeline.cc
+ *  @brief    Reads, unpacks and processes the fragments of a file on a
+ *            set of threads, delivering the results in file order
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The delivered fragments are queued for the reader thread,
+                  which releases them before its next read.  release is
+                  no longer called while the reader is inside read.
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentPipeline.hh"
+#include "dam/HeaderFragmentUnpack.hh"
+#include "dam/DataFragmentUnpack.hh"
+#include "dam/TpcStreamUnpack.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class SerialExecutor
+  \brief Runs the tasks in the calling thread.
+
+  \par
+   The workers already run one fragment each, so the streams of a
+   fragment are unpacked one after the other rather than competing for
+   the library's pool.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class SerialExecutor : public TpcFragmentUnpack::Executor
+{
+public:
+   virtual void run (Task task, void *ctx, int ntasks)
+   {
+      for (int itask = 0; itask < ntasks; itask++) task (ctx, itask);
+      return;
+   }
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class PipelineRun
+  \brief The queues and threads of one run of the pipeline
+
+  \par
+   The item with ordinal number \e n is placed in ready slot \e n modulo
+   the depth.  Since at most depth items are in the pipeline and they
+   are read in order, no two can map to the same slot.
+
+  \par
+   A FragmentReader need not allow \a release to be called while \a read
+   is in progress, so, while the reader thread runs, it alone calls the
+   reader.  The delivered fragments are queued and released by it before
+   its next read.  What remains is released once it has been joined.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class PipelineRun
+{
+public:
+   typedef FragmentPipeline::Item      Item;
+   typedef FragmentPipeline::Processor Processor;
+   typedef FragmentReader::Status      Status;
+
+public:
+   PipelineRun (std::vector<Item> &items,
+                FragmentReader   &reader,
+                Processor     &processor,
+                int               nticks,
+                bool              unpack);
+
+   Status run   (int nworkers);
+
+private:
+   void   read   ();
+   void   work   ();
+   void   unpack (Item *item);
+
+private:
+   FragmentReader          &m_reader; /*!< The reader                     */
+   Processor            &m_processor; /*!< The user's processing          */
+   int                      m_nticks; /*!< Requested ticks, 0 = as needed */
+   bool                     m_unpack; /*!< Unpack the TPC streams         */
+   int                       m_depth; /*!< The number of items            */
+
+   std::mutex                 m_lock; /*!< Protects the following         */
+   std::condition_variable    m_free; /*!< Signals a free item            */
+   std::condition_variable    m_work; /*!< Signals a fragment to unpack   */
+   std::condition_variable    m_done; /*!< Signals an unpacked item       */
+   std::vector<Item *>    m_freeList; /*!< The free items                 */
+   std::deque<Item *>        m_queue; /*!< The items to be unpacked       */
+   std::vector<Item *>       m_ready; /*!< The unpacked items, by ordinal */
+   std::vector<FragmentReader::Fragment>
+                          m_released; /*!< The delivered fragments, to be
+                                           released by the reader thread  */
+   uint64_t                  m_nread; /*!< The number of fragments read   */
+   uint64_t                   m_next; /*!< The next ordinal to deliver    */
+   bool                   m_readDone; /*!< The reader has finished        */
+   bool                       m_stop; /*!< Stop, requested by deliver     */
+   Status                    m_final; /*!< The reader's final status      */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+PipelineRun::PipelineRun (std::vector<Item> &items,
+                          FragmentReader   &reader,
+                          Processor     &processor,
+                          int               nticks,
+                          bool              unpack) :
+   m_reader    (reader),
+   m_processor (processor),
+   m_nticks    (nticks),
+   m_unpack    (unpack),
+   m_depth     (items.size ()),
+   m_ready     (items.size (), 0),
+   m_nread     (0),
+   m_next      (0),
+   m_readDone  (false),
+   m_stop      (false),
+   m_final     (Status::EndOfFile)
+{
+   for (auto &item : items) m_freeList.push_back (&item);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Runs the reader and workers, delivering on the calling thread
+  \return The reader's final status, EndOfFile if the whole file was
+          read, or Okay if delivery stopped the pipeline
+
+  \param[in] nworkers  The number of worker threads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+PipelineRun::Status PipelineRun::run (int nworkers)
+{
+   std::thread              reader (&PipelineRun::read, this);
+   std::vector<std::thread> workers;
+
+   for (int iworker = 0; iworker < nworkers; iworker++)
+   {
+      workers.emplace_back (&PipelineRun::work, this);
+   }
+
+
+   // ------------------------------------------------
+   // Deliver in order until the last item or a stop
+   // ------------------------------------------------
+   bool more = true;
+   while (more)
+   {
+      Item *item;
+      {
+         std::unique_lock<std::mutex> lock (m_lock);
+         int islot = m_next % m_depth;
+
+         m_done.wait (lock, [this, islot]
+                      { return m_ready[islot] != 0 ||
+                               (m_readDone && m_next == m_nread); });
+
+         item = m_ready[islot];
+         if (item == 0) break;
+
+         m_ready[islot] = 0;
+      }
+
+      more = m_processor.deliver (*item);
+
+      {
+         std::lock_guard<std::mutex> lock (m_lock);
+         m_released.push_back (item->m_fragment);
+         m_freeList.push_back (item);
+         m_next += 1;
+         if (!more) m_stop = true;
+      }
+
+      m_free.notify_one ();
+   }
+
+   if (!more)
+   {
+      m_free.notify_all ();
+   }
+
+
+   reader.join ();
+   for (auto &worker : workers) worker.join ();
+
+
+   // -----------------------------------------------------
+   // Give back what was delivered after the reader's last
+   // read and, after a stop, what was not delivered
+   // -----------------------------------------------------
+   for (auto const &fragment : m_released)
+   {
+      m_reader.release (fragment);
+   }
+   m_released.clear ();
+
+   for (auto item : m_ready)
+   {
+      if (item) m_reader.release (item->m_fragment);
+   }
+
+   return m_stop ? Status::Okay : m_final;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The reader stage, reading the fragments into free items until
+         the end of the file, an error or a stop
+
+  \par
+   The fragments delivered since the last read are released first, all
+   of them rather than just the one of the item being reused, so that
+   their chunks are free for the reader to read ahead into.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void PipelineRun::read ()
+{
+   std::vector<FragmentReader::Fragment> released;
+
+   while (1)
+   {
+      Item *item;
+      {
+         std::unique_lock<std::mutex> lock (m_lock);
+         m_free.wait (lock, [this] { return m_stop || !m_freeList.empty (); });
+         if (m_stop) break;
+
+         item = m_freeList.back ();
+         m_freeList.pop_back ();
+         released.swap (m_released);
+      }
+
+      for (auto const &fragment : released)
+      {
+         m_reader.release (fragment);
+      }
+      released.clear ();
+
+      Status status = m_reader.read (&item->m_fragment);
+      if (status != Status::Okay && status != Status::BadTrailer)
+      {
+         std::lock_guard<std::mutex> lock (m_lock);
+         m_freeList.push_back (item);
+         m_final = status;
+         break;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock (m_lock);
+         item->m_index  = m_nread++;
+         item->m_status = status;
+         m_queue.push_back (item);
+      }
+
+      m_work.notify_one ();
+   }
+
+
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_readDone = true;
+   }
+
+   m_work.notify_all ();
+   m_done.notify_all ();
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief A worker, unpacking and processing items until the reader has
+         finished and there are no more.
+
+  \par
+   Items already read are still processed after a stop, so that every
+   fragment ends up in the ready slots and can be released.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void PipelineRun::work ()
+{
+   while (1)
+   {
+      Item *item;
+      {
+         std::unique_lock<std::mutex> lock (m_lock);
+         m_work.wait (lock, [this] { return m_readDone || !m_queue.empty (); });
+         if (m_queue.empty ()) break;
+
+         item = m_queue.front ();
+         m_queue.pop_front ();
+      }
+
+      unpack (item);
+      m_processor.process (*item);
+
+      {
+         std::lock_guard<std::mutex> lock (m_lock);
+         m_ready[item->m_index % m_depth] = item;
+      }
+
+      m_done.notify_all ();
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Unpacks the trimmed ADCs of an item's TPC streams
+
+  \param[in,out] item  The item
+
+  \par
+   Unless a fixed number of ticks was requested, each channel is given
+   as many elements as the longest stream of the fragment has ticks.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void PipelineRun::unpack (Item *item)
+{
+   item->m_nstreams = 0;
+   item->m_nticks   = 0;
+   item->m_okay     = true;
+
+   if (!m_unpack)
+   {
+      return;
+   }
+
+   uint64_t const *buf = item->m_fragment.m_buf;
+   if (!HeaderFragmentUnpack::assign (buf)->isData ())
+   {
+      return;
+   }
+
+   DataFragmentUnpack df (buf);
+   if (!df.isTpcNormal () && !df.isTpcDamaged ())
+   {
+      return;
+   }
+
+
+   TpcFragmentUnpack tpc (df);
+   int          nstreams = tpc.getNStreams ();
+   int            nticks = m_nticks;
+
+   if (nticks <= 0)
+   {
+      for (int istream = 0; istream < nstreams; istream++)
+      {
+         int n = tpc.getStream (istream)->getNTicks ();
+         if (n > nticks) nticks = n;
+      }
+   }
+
+   size_t nadcs = (size_t)nstreams * 128 * nticks;
+   if (item->m_adcs.size () < nadcs)
+   {
+      item->m_adcs.resize (nadcs);
+   }
+
+   SerialExecutor serial;
+   item->m_nstreams = nstreams;
+   item->m_nticks   = nticks;
+   item->m_okay     = tpc.getMultiChannelData (item->m_adcs.data (),
+                                               nticks,
+                                               item->m_streams,
+                                               &serial);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ====================================================================== */
+/* FragmentPipeline                                                       */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor
+
+  \param[in] nworkers  The number of worker threads, if 0 or less the
+                       number of hardware threads
+  \param[in]    depth  The number of items, i.e. the maximum number of
+                       fragments in the pipeline.  If 0 or less, twice
+                       the number of workers
+  \param[in]   unpack  If true, the TPC streams are unpacked before the
+                       items are processed
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentPipeline::FragmentPipeline (int nworkers,
+                                    int    depth,
+                                    bool  unpack) :
+   m_nworkers (nworkers),
+   m_depth    (depth),
+   m_unpack   (unpack)
+{
+   if (m_nworkers <= 0)
+   {
+      m_nworkers = std::thread::hardware_concurrency ();
+      if (m_nworkers <= 0) m_nworkers = 1;
+   }
+
+   if (m_depth <= 0)
+   {
+      m_depth = 2 * m_nworkers;
+   }
+
+   m_items.resize (m_depth);
+   for (auto &item : m_items) item.m_user = 0;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Runs the fragments of a file through the pipeline
+  \return The reader's final status: EndOfFile if the whole file was
+          read, the error that stopped the reader, or Okay if the
+          processor's deliver method stopped the pipeline
+
+  \param[in]    reader  An opened reader, positioned at the first
+                        fragment to be read
+  \param[in] processor  The user's processing
+  \param[in]    nticks  The number of elements per channel to unpack.
+                        If 0 or less, as many as the longest stream
+                        of each fragment has.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReader::Status FragmentPipeline::run (FragmentReader &reader,
+                                              Processor   &processor,
+                                              int             nticks)
+{
+   PipelineRun pipeline (m_items, reader, processor, nticks, m_unpack);
+   return pipeline.run  (m_nworkers);
+}
+/* ---------------------------------------------------------------------- */
+/* FragmentPipeline                                                       */
+/* ====================================================================== */
@@ -0,0 +1,1176 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentReaderAsync.cc
+ *  @brief    Reads the RCE fragments of a binary file with the reads
+ *            issued ahead of the consumer
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  The io_uring backend talks to the kernel directly through the
+ *  io_uring_setup and io_uring_enter system calls, so there is no
+ *  dependence on liburing.  If the kernel or its headers do not
+ *  support io_uring, the thread backend is used.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt UringEngine::enter submits the queued reads for both
+                  submit and reap, retrying an interrupted or refused
+                  submission.  The resubmission of short reads in reap
+                  ignored the outcome, so a failed one left its slots
+                  pending forever.  Reads that cannot be submitted are
+                  done synchronously.
+   2026.10.16 agt Added seek. A chunk still held in its slot is not
+                  read again
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentReaderAsync.hh"
+#include "dam/HeaderFragmentUnpack.hh"
+#include "dam/RceFragmentUnpack.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+
+#if defined (__linux__) && defined (__has_include)
+#if __has_include (<linux/io_uring.h>) && defined (__NR_io_uring_setup)
+#define PDD_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#endif
+#endif
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentReaderAsync::Slot
+  \brief A buffer holding one chunk of the file and the state of its read
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentReaderAsync::Slot
+{
+public:
+   enum State
+   {
+      Free    = 0, /*!< Has never been read into                          */
+      Pending = 1, /*!< A read is in flight                               */
+      Ready   = 2, /*!< The read is complete                              */
+      Failed  = 3  /*!< The read failed                                   */
+   };
+
+public:
+   uint8_t                *m_buf; /*!< The page aligned buffer            */
+   uint64_t              m_chunk; /*!< The chunk held or being read       */
+   uint64_t             m_offset; /*!< The chunk's byte offset in the file*/
+   size_t               m_nbytes; /*!< The number of bytes to read        */
+   size_t                 m_done; /*!< The number of bytes read so far    */
+   int                     m_err; /*!< The Unix error if the read failed  */
+   struct iovec            m_iov; /*!< The remainder, for io_uring        */
+   std::atomic<int>      m_state; /*!< The State                          */
+   std::atomic<int>       m_refs; /*!< The number of unreleased views     */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentReaderAsync::Engine
+  \brief Interface to the method doing the reads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentReaderAsync::Engine
+{
+public:
+   virtual ~Engine () { return; }
+
+   // Start reading the slot, its state has been set to Pending
+   virtual void submit (Slot *slot) = 0;
+
+   // Wait until the slot's read is no longer Pending
+   virtual void wait   (Slot *slot) = 0;
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Synchronously reads the remainder of a slot's chunk
+  \return The Slot::State after the read
+
+  \param[in]     fd  The file descriptor
+  \param[in,out] slot  The slot
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int readSlot (int fd, FragmentReaderAsync::Slot *slot)
+{
+   while (slot->m_done < slot->m_nbytes)
+   {
+      ssize_t n = pread (fd,
+                         slot->m_buf    + slot->m_done,
+                         slot->m_nbytes - slot->m_done,
+                         slot->m_offset + slot->m_done);
+      if (n < 0)
+      {
+         if (errno == EINTR) continue;
+         slot->m_err = errno;
+         return FragmentReaderAsync::Slot::Failed;
+      }
+
+      // End of file, the file has shrunk
+      if (n == 0) break;
+
+      slot->m_done += n;
+   }
+
+   return FragmentReaderAsync::Slot::Ready;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ====================================================================== */
+/* ThreadEngine                                                           */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class ThreadEngine
+  \brief Reads the slots with a set of I/O threads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class ThreadEngine : public FragmentReaderAsync::Engine
+{
+public:
+   typedef FragmentReaderAsync::Slot Slot;
+
+public:
+   ThreadEngine (int fd, int nthreads);
+   virtual ~ThreadEngine ();
+
+   virtual void submit (Slot *slot);
+   virtual void wait   (Slot *slot);
+
+private:
+   void         work   ();
+
+private:
+   int                           m_fd; /*!< The file descriptor           */
+   std::mutex                  m_lock; /*!< Protects the following        */
+   std::condition_variable     m_work; /*!< Signals a queued read         */
+   std::condition_variable     m_done; /*!< Signals a completed read      */
+   std::deque<Slot *>         m_queue; /*!< The queued reads              */
+   std::vector<std::thread> m_threads; /*!< The I/O threads               */
+   bool                        m_quit; /*!< The threads should exit       */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+ThreadEngine::ThreadEngine (int fd, int nthreads) :
+   m_fd   (fd),
+   m_quit (false)
+{
+   for (int idx = 0; idx < nthreads; idx++)
+   {
+      m_threads.emplace_back (&ThreadEngine::work, this);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Destructor. The queued reads are completed before the threads
+         exit, since they are into buffers that are about to be freed.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+ThreadEngine::~ThreadEngine ()
+{
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_quit = true;
+   }
+
+   m_work.notify_all ();
+   for (auto &thread : m_threads) thread.join ();
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+void ThreadEngine::submit (Slot *slot)
+{
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_queue.push_back (slot);
+   }
+
+   m_work.notify_one ();
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+void ThreadEngine::wait (Slot *slot)
+{
+   std::unique_lock<std::mutex> lock (m_lock);
+   m_done.wait (lock, [slot] { return slot->m_state != Slot::Pending; });
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+void ThreadEngine::work ()
+{
+   std::unique_lock<std::mutex> lock (m_lock);
+
+   while (1)
+   {
+      m_work.wait (lock, [this] { return m_quit || !m_queue.empty (); });
+      if (m_queue.empty ())
+      {
+         break;
+      }
+
+      Slot *slot = m_queue.front ();
+      m_queue.pop_front ();
+
+      lock.unlock ();
+      int state = readSlot (m_fd, slot);
+      lock.lock   ();
+
+      slot->m_state = state;
+      m_done.notify_all ();
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* ThreadEngine                                                           */
+/* ====================================================================== */
+
+
+
+
+#ifdef PDD_HAVE_IO_URING
+/* ====================================================================== */
+/* UringEngine                                                            */
+/* ---------------------------------------------------------------------- *//*!
+
+  \class UringEngine
+  \brief Reads the slots with io_uring
+
+  \par
+   Only the thread calling \a read submits and reaps, so the rings need
+   no locking beyond the ordering of the head and tail updates.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class UringEngine : public FragmentReaderAsync::Engine
+{
+public:
+   typedef FragmentReaderAsync::Slot Slot;
+
+public:
+   UringEngine ();
+   virtual ~UringEngine ();
+
+   int          open   (int fd, unsigned int nentries);
+   virtual void submit (Slot *slot);
+   virtual void wait   (Slot *slot);
+
+private:
+   void         queue  (Slot *slot);
+   void         enter  (unsigned int n);
+   void         reap   ();
+
+private:
+   int                  m_fd; /*!< The file being read                    */
+   int                m_ring; /*!< The io_uring file descriptor           */
+   int            m_inflight; /*!< The number of reads in flight          */
+   void              *m_sqMap; /*!< The mapping of the submission ring    */
+   size_t            m_sqSize; /*!< Its size                              */
+   void              *m_cqMap; /*!< The mapping of the completion ring    */
+   size_t            m_cqSize; /*!< Its size                              */
+   io_uring_sqe       *m_sqes; /*!< The submission entries                */
+   size_t          m_sqesSize; /*!< Their size                            */
+   unsigned          *m_sqTail; /*!< Submission ring tail                 */
+   unsigned          *m_sqMask; /*!< Submission ring mask                 */
+   unsigned         *m_sqArray; /*!< Submission ring index array          */
+   unsigned          *m_cqHead; /*!< Completion ring head                 */
+   unsigned          *m_cqTail; /*!< Completion ring tail                 */
+   unsigned          *m_cqMask; /*!< Completion ring mask                 */
+   io_uring_cqe       *m_cqes; /*!< The completion entries                */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+UringEngine::UringEngine () :
+   m_fd       (-1),
+   m_ring     (-1),
+   m_inflight (0),
+   m_sqMap    (MAP_FAILED),
+   m_sqSize   (0),
+   m_cqMap    (MAP_FAILED),
+   m_cqSize   (0),
+   m_sqes     (reinterpret_cast<io_uring_sqe *>(MAP_FAILED)),
+   m_sqesSize (0)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Destructor. The reads in flight are completed first, since they
+         are into buffers that are about to be freed.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+UringEngine::~UringEngine ()
+{
+   while (m_inflight > 0)
+   {
+      reap ();
+      if (m_inflight > 0)
+      {
+         syscall (__NR_io_uring_enter, m_ring, 0, 1,
+                  IORING_ENTER_GETEVENTS, NULL, 0);
+      }
+   }
+
+   if (m_sqes  != MAP_FAILED) munmap (m_sqes,  m_sqesSize);
+   if (m_cqMap != MAP_FAILED && m_cqMap != m_sqMap) munmap (m_cqMap, m_cqSize);
+   if (m_sqMap != MAP_FAILED) munmap (m_sqMap, m_sqSize);
+   if (m_ring  >= 0)          ::close (m_ring);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Creates the ring
+  \return 0 if successful, else the Unix error number
+
+  \param[in]       fd  The file to be read
+  \param[in] nentries  The maximum number of reads in flight
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int UringEngine::open (int fd, unsigned int nentries)
+{
+   io_uring_params params;
+   memset (&params, 0, sizeof (params));
+
+   m_fd   = fd;
+   m_ring = syscall (__NR_io_uring_setup, nentries, &params);
+   if (m_ring < 0) return errno;
+
+
+   m_sqSize   = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+   m_cqSize   = params.cq_off.cqes  + params.cq_entries * sizeof (io_uring_cqe);
+   m_sqesSize = params.sq_entries   * sizeof (io_uring_sqe);
+
+   bool single = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+   single = params.features & IORING_FEAT_SINGLE_MMAP;
+   if (single)
+   {
+      if (m_cqSize > m_sqSize) m_sqSize = m_cqSize;
+      m_cqSize = m_sqSize;
+   }
+#endif
+
+   m_sqMap = mmap (0, m_sqSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+   if (m_sqMap == MAP_FAILED) return errno;
+
+   m_cqMap = single
+           ? m_sqMap
+           : mmap (0, m_cqSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+   if (m_cqMap == MAP_FAILED) return errno;
+
+   void *sqes = mmap (0, m_sqesSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+   if (sqes == MAP_FAILED) return errno;
+
+
+   uint8_t *sq = reinterpret_cast<uint8_t *>(m_sqMap);
+   uint8_t *cq = reinterpret_cast<uint8_t *>(m_cqMap);
+
+   m_sqes     = reinterpret_cast<io_uring_sqe *>(sqes);
+   m_sqTail   = reinterpret_cast<unsigned *>    (sq + params.sq_off.tail);
+   m_sqMask   = reinterpret_cast<unsigned *>    (sq + params.sq_off.ring_mask);
+   m_sqArray  = reinterpret_cast<unsigned *>    (sq + params.sq_off.array);
+   m_cqHead   = reinterpret_cast<unsigned *>    (cq + params.cq_off.head);
+   m_cqTail   = reinterpret_cast<unsigned *>    (cq + params.cq_off.tail);
+   m_cqMask   = reinterpret_cast<unsigned *>    (cq + params.cq_off.ring_mask);
+   m_cqes     = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Places a read of the remainder of a slot's chunk on the
+         submission ring
+
+  \param[in] slot  The slot
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void UringEngine::queue (Slot *slot)
+{
+   slot->m_iov.iov_base = slot->m_buf    + slot->m_done;
+   slot->m_iov.iov_len  = slot->m_nbytes - slot->m_done;
+
+   unsigned     tail = *m_sqTail;
+   unsigned      idx = tail & *m_sqMask;
+   io_uring_sqe *sqe = m_sqes + idx;
+
+   memset (sqe, 0, sizeof (*sqe));
+   sqe->opcode    = IORING_OP_READV;
+   sqe->fd        = m_fd;
+   sqe->addr      = reinterpret_cast<uint64_t>(&slot->m_iov);
+   sqe->len       = 1;
+   sqe->off       = slot->m_offset + slot->m_done;
+   sqe->user_data = reinterpret_cast<uint64_t>(slot);
+
+   m_sqArray[idx] = idx;
+   __atomic_store_n (m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+   m_inflight += 1;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Submits the last \a n entries placed on the submission ring
+
+  \param[in] n  The number of entries
+
+  \par
+   A submission that is interrupted, or refused for lack of resources
+   or because completions are waiting to be reaped, is retried.  Should
+   it fail otherwise, the entries not yet submitted are taken back and
+   their reads are done here, synchronously, so that no slot is left
+   pending without a read in flight.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void UringEngine::enter (unsigned int n)
+{
+   while (n > 0)
+   {
+      int nsubmitted = syscall (__NR_io_uring_enter, m_ring, n, 0, 0, NULL, 0);
+      if (nsubmitted > 0)
+      {
+         n -= nsubmitted;
+         continue;
+      }
+
+      if (nsubmitted < 0 &&
+          (errno == EINTR || errno == EAGAIN || errno == EBUSY)) continue;
+
+      break;
+   }
+
+
+   // -----------------------------------------------------
+   // Could not submit, take the entries back, the last
+   // ones queued being those the kernel has not consumed,
+   // and read them here
+   // -----------------------------------------------------
+   for (; n > 0; n--)
+   {
+      unsigned  tail = *m_sqTail - 1;
+      Slot     *slot = reinterpret_cast<Slot *>
+                       (m_sqes[m_sqArray[tail & *m_sqMask]].user_data);
+
+      __atomic_store_n (m_sqTail, tail, __ATOMIC_RELEASE);
+      m_inflight   -= 1;
+      slot->m_state = readSlot (m_fd, slot);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+void UringEngine::submit (Slot *slot)
+{
+   queue (slot);
+   enter (1);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Processes the completed reads.  A short read is resubmitted
+         for the remainder, unless it hit the end of the file.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void UringEngine::reap ()
+{
+   unsigned head = *m_cqHead;
+   unsigned tail = __atomic_load_n (m_cqTail, __ATOMIC_ACQUIRE);
+   int resubmit  = 0;
+
+   while (head != tail)
+   {
+      io_uring_cqe const *cqe = m_cqes + (head & *m_cqMask);
+      Slot              *slot = reinterpret_cast<Slot *>(cqe->user_data);
+      int                 res = cqe->res;
+
+      head       += 1;
+      m_inflight -= 1;
+
+      if (res > 0)
+      {
+         slot->m_done += res;
+         if (slot->m_done < slot->m_nbytes)
+         {
+            queue (slot);
+            resubmit += 1;
+         }
+         else
+         {
+            slot->m_state = Slot::Ready;
+         }
+      }
+      else if (res == 0)
+      {
+         slot->m_state = Slot::Ready;
+      }
+      else if (res == -EINTR || res == -EAGAIN)
+      {
+         queue (slot);
+         resubmit += 1;
+      }
+      else
+      {
+         slot->m_err   = -res;
+         slot->m_state = Slot::Failed;
+      }
+   }
+
+   __atomic_store_n (m_cqHead, head, __ATOMIC_RELEASE);
+
+   if (resubmit)
+   {
+      enter (resubmit);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+void UringEngine::wait (Slot *slot)
+{
+   while (1)
+   {
+      reap ();
+      if (slot->m_state != Slot::Pending)
+      {
+         break;
+      }
+
+      syscall (__NR_io_uring_enter, m_ring, 0, 1,
+               IORING_ENTER_GETEVENTS, NULL, 0);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* UringEngine                                                            */
+/* ====================================================================== */
+#endif
+
+
+
+
+/* ====================================================================== */
+/* FragmentReaderAsync                                                    */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Sets the file to be read, but does not open it
+
+  \param[in]  filename  The name of the file to read
+  \param[in]    nslots  The number of chunk buffers, this is also the
+                        maximum number of reads in flight
+  \param[in] chunkSize  The size of a chunk, rounded up to a multiple
+                        of the page size
+  \param[in]   backend  The method used to do the reads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReaderAsync::FragmentReaderAsync (char const *filename,
+                                          int           nslots,
+                                          size_t     chunkSize,
+                                          Backend      backend) :
+   FragmentReader (filename),
+   m_fd           (-1),
+   m_size         (0),
+   m_offset       (0),
+   m_nextChunk    (0),
+   m_chunkSize    (chunkSize),
+   m_nslots       (nslots < 2 ? 2 : nslots),
+   m_requested    (backend),
+   m_backend      (backend),
+   m_slots        (0),
+   m_engine       (0)
+{
+   long pagesize = sysconf (_SC_PAGESIZE);
+   m_chunkSize   = (m_chunkSize + pagesize - 1) / pagesize * pagesize;
+   if (m_chunkSize == 0) m_chunkSize = pagesize;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+FragmentReaderAsync::~FragmentReaderAsync ()
+{
+   close ();
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Opens the file, allocates the slots and starts the reads
+  \return 0 if successful, else the Unix error number
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentReaderAsync::open ()
+{
+   m_fd = ::open (m_filename, O_RDONLY);
+   if (m_fd < 0) return errno;
+
+   struct stat st;
+   if (fstat (m_fd, &st) != 0)
+   {
+      int err = errno;
+      close ();
+      return err;
+   }
+
+   m_size      = st.st_size;
+   m_offset    = 0;
+   m_nextChunk = 0;
+   posix_fadvise (m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+
+   // --------------------------------------------
+   // Page aligned buffers, suitable for any kind
+   // of I/O, including unbuffered.
+   // --------------------------------------------
+   long pagesize = sysconf (_SC_PAGESIZE);
+   m_slots       = new Slot[m_nslots];
+   for (int islot = 0; islot < m_nslots; islot++)
+   {
+      Slot &slot   = m_slots[islot];
+      void  *buf   = 0;
+      slot.m_buf   = 0;
+      slot.m_chunk = ~(uint64_t)0;
+      slot.m_state = Slot::Free;
+      slot.m_refs  = 0;
+
+      if (posix_memalign (&buf, pagesize, m_chunkSize) != 0)
+      {
+         close ();
+         return ENOMEM;
+      }
+
+      slot.m_buf = reinterpret_cast<uint8_t *>(buf);
+   }
+
+
+   // -------------------------------------------
+   // Use io_uring if available and not declined
+   // -------------------------------------------
+   int err = ENOSYS;
+#  ifdef PDD_HAVE_IO_URING
+   if (m_requested != Backend::Threads)
+   {
+      UringEngine *engine = new UringEngine;
+      err = engine->open (m_fd, m_nslots);
+      if (err == 0)
+      {
+         m_engine  = engine;
+         m_backend = Backend::IoUring;
+      }
+      else
+      {
+         delete engine;
+      }
+   }
+#  endif
+
+   if (m_engine == 0)
+   {
+      if (m_requested == Backend::IoUring)
+      {
+         close ();
+         return err;
+      }
+
+      int nthreads = m_nslots < 4 ? m_nslots : 4;
+      m_engine     = new ThreadEngine (m_fd, nthreads);
+      m_backend    = Backend::Threads;
+   }
+
+   issue ();
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Starts the reads of the chunks following the one being
+         consumed, as far as there are slots to hold them.
+
+  \par
+   A slot can be reused once the consumer has moved past its chunk,
+   its read has completed and all views into it have been released.
+   Any chunk the consumer has already moved past is not read.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void FragmentReaderAsync::issue ()
+{
+   uint64_t current = m_offset / m_chunkSize;
+   if (m_nextChunk < current) m_nextChunk = current;
+
+   while (m_nextChunk < current + m_nslots &&
+          m_nextChunk * m_chunkSize < m_size)
+   {
+      Slot &slot = m_slots[m_nextChunk % m_nslots];
+
+      // Already read or being read, e.g. after seeking backwards
+      if (slot.m_chunk == m_nextChunk && slot.m_state != Slot::Failed)
+      {
+         m_nextChunk += 1;
+         continue;
+      }
+
+      if (slot.m_state == Slot::Pending || slot.m_refs > 0)
+      {
+         break;
+      }
+
+      uint64_t offset = m_nextChunk * m_chunkSize;
+      uint64_t   left = m_size - offset;
+
+      slot.m_chunk    = m_nextChunk;
+      slot.m_offset   = offset;
+      slot.m_nbytes   = left < m_chunkSize ? left : m_chunkSize;
+      slot.m_done     = 0;
+      slot.m_err      = 0;
+      slot.m_state    = Slot::Pending;
+
+      m_engine->submit (&slot);
+      m_nextChunk += 1;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Waits for a chunk to be read
+  \return The slot holding the chunk, NULL if the chunk could not be
+          read.  This happens if its slot is still held by unreleased
+          views, or the read failed.
+
+  \param[in] chunk  The chunk
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReaderAsync::Slot *FragmentReaderAsync::acquire (uint64_t chunk)
+{
+   if (chunk >= m_nextChunk)
+   {
+      issue ();
+      if (chunk >= m_nextChunk) return 0;
+   }
+
+   Slot *slot = m_slots + chunk % m_nslots;
+   if (slot->m_chunk != chunk)
+   {
+      return 0;
+   }
+
+   if (slot->m_state == Slot::Pending)
+   {
+      m_engine->wait (slot);
+   }
+
+   return slot->m_state == Slot::Ready ? slot : 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Assembles a fragment into a buffer of its own
+  \return The buffer, NULL if the fragment could not be read
+
+  \param[in] offset  The byte offset of the fragment in the file
+  \param[in] nbytes  Its size, in bytes
+
+  \par
+   The pieces are copied from the chunks when they have been read,
+   otherwise they are read directly.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint64_t const *FragmentReaderAsync::assemble (uint64_t offset,
+                                               uint64_t nbytes)
+{
+   void *buf = 0;
+   if (posix_memalign (&buf, sizeof (uint64_t) * 8, nbytes) != 0)
+   {
+      return 0;
+   }
+
+   uint8_t *dst = reinterpret_cast<uint8_t *>(buf);
+   uint64_t end = offset + nbytes;
+
+   while (offset < end)
+   {
+      uint64_t  chunk = offset / m_chunkSize;
+      size_t      off = offset % m_chunkSize;
+      Slot      *slot = acquire (chunk);
+
+      if (slot && off < slot->m_done)
+      {
+         size_t n = slot->m_done - off;
+         if (n > end - offset) n = end - offset;
+
+         memcpy (dst, slot->m_buf + off, n);
+         dst    += n;
+         offset += n;
+         continue;
+      }
+
+      ssize_t n = pread (m_fd, dst, end - offset, offset);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0)
+      {
+         free (buf);
+         return 0;
+      }
+
+      dst    += n;
+      offset += n;
+   }
+
+   return reinterpret_cast<uint64_t const *>(buf);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns a view of the next fragment
+  \return The status of the read
+
+  \param[out] fragment  The view of the fragment
+
+  \par
+   When the header is bad or the fragment is truncated, there is no way
+   to find the next fragment, so the reader stays put and repeats the
+   same status.  When only the trailer is bad, the fragment is returned
+   and the reader moves to the next one.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReader::Status FragmentReaderAsync::read (Fragment *fragment)
+{
+   fragment->m_buf    = 0;
+   fragment->m_offset = m_offset;
+   fragment->m_n64    = 0;
+   fragment->m_slot   = -1;
+
+   if (m_fd < 0)
+   {
+      return Status::IoError;
+   }
+
+   uint64_t left = m_size - m_offset;
+   if (left == 0)
+   {
+      return Status::EndOfFile;
+   }
+
+   if (left < sizeof (uint64_t))
+   {
+      return Status::Truncated;
+   }
+
+
+   // -------------------------------------------------------
+   // Get the header.  Since both the fragments and the chunks
+   // are multiples of 64-bits, it never straddles two chunks.
+   // -------------------------------------------------------
+   uint64_t   chunk = m_offset / m_chunkSize;
+   size_t       off = m_offset % m_chunkSize;
+   Slot      *slot = acquire (chunk);
+   uint64_t header;
+
+   if (slot && off + sizeof (header) <= slot->m_done)
+   {
+      memcpy (&header, slot->m_buf + off, sizeof (header));
+   }
+   else if (pread (m_fd, &header, sizeof (header), m_offset)
+                                != sizeof (header))
+   {
+      return Status::IoError;
+   }
+
+
+   // ------------------------------------------------------
+   // Check the header before trusting its length. Anything
+   // shorter than a header plus a trailer cannot be right.
+   // ------------------------------------------------------
+   auto const     *hdr = HeaderFragmentUnpack::assign (&header);
+   uint32_t        n64 = hdr->getN64 ();
+   uint64_t     nbytes = n64 * sizeof (uint64_t);
+
+   if (!hdr->isOkay () || n64 < 2)
+   {
+      return Status::BadHeader;
+   }
+
+   if (nbytes > left)
+   {
+      return Status::Truncated;
+   }
+
+
+   // ----------------------------------------------------
+   // A view into the slot if it holds the whole fragment,
+   // else assemble it into its own buffer
+   // ----------------------------------------------------
+   uint64_t const *buf;
+   if (slot && off + nbytes <= slot->m_done)
+   {
+      slot->m_refs    += 1;
+      buf              = reinterpret_cast<uint64_t const *>(slot->m_buf + off);
+      fragment->m_slot = slot - m_slots;
+   }
+   else
+   {
+      buf = assemble (m_offset, nbytes);
+      if (buf == 0)
+      {
+         return Status::IoError;
+      }
+   }
+
+   fragment->m_buf = buf;
+   fragment->m_n64 = n64;
+   m_offset       += nbytes;
+
+   issue ();
+
+   bool okay = RceFragmentUnpack::isOkay (buf, nbytes);
+   return okay ? Status::Okay : Status::BadTrailer;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Gives back a fragment, allowing its slot to be reused.  This
+         may be called from any thread.
+
+  \param[in] fragment  The fragment
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void FragmentReaderAsync::release (Fragment const &fragment)
+{
+   if (fragment.m_buf == 0)
+   {
+      return;
+   }
+
+   if (fragment.m_slot >= 0)
+   {
+      m_slots[fragment.m_slot].m_refs -= 1;
+   }
+   else
+   {
+      free (const_cast<uint64_t *>(fragment.m_buf));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Positions the reader so the next read returns the fragment at
+          \a offset
+  \return Status::Okay, or Status::BadSeek if \a offset is not on a
+          64-bit boundary or is past the end of the file
+
+  \param[in] offset  The byte offset of the fragment in the file
+
+  \par
+   The reads ahead restart from the chunk holding \a offset.  Reads of
+   other chunks that are already in flight are left to complete.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReader::Status FragmentReaderAsync::seek (uint64_t offset)
+{
+   if (m_fd < 0)
+   {
+      return Status::IoError;
+   }
+
+   if (offset > m_size || (offset % sizeof (uint64_t)) != 0)
+   {
+      return Status::BadSeek;
+   }
+
+   m_offset    = offset;
+   m_nextChunk = offset / m_chunkSize;
+   issue ();
+
+   return Status::Okay;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Waits for the reads in flight, frees the slots and closes
+          the file
+  \return 0 if successful, else the Unix error number
+
+  \warning
+   Any views that have not been released become invalid.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentReaderAsync::close ()
+{
+   int err = 0;
+
+   delete m_engine;
+   m_engine = 0;
+
+   if (m_slots)
+   {
+      for (int islot = 0; islot < m_nslots; islot++)
+      {
+         free (m_slots[islot].m_buf);
+      }
+
+      delete [] m_slots;
+      m_slots = 0;
+   }
+
+   if (m_fd >= 0)
+   {
+      if (::close (m_fd) != 0) err = errno;
+      m_fd = -1;
+   }
+
+   m_size      = 0;
+   m_offset    = 0;
+   m_nextChunk = 0;
+   m_backend   = m_requested;
+
+   return err;
+}
+/* ---------------------------------------------------------------------- */
+/* FragmentReaderAsync                                                    */
+/* ====================================================================== */
@@ -0,0 +1,331 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     FragmentReaderMapped.cc
+ *  @brief    Reads the RCE fragments of a binary file by mapping it
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  proto-dune DAM
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added seek
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/FragmentReaderMapped.hh"
+#include "dam/HeaderFragmentUnpack.hh"
+#include "dam/RceFragmentUnpack.hh"
+
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Sets the file to be read, but does not open it
+
+  \param[in]  filename  The name of the file to read
+  \param[in] readAhead  The number of bytes beyond the fragment being
+                        read that the kernel is asked to bring in
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReaderMapped::FragmentReaderMapped (char const *filename,
+                                            size_t     readAhead) :
+   FragmentReader (filename),
+   m_fd           (-1),
+   m_map          (0),
+   m_size         (0),
+   m_offset       (0),
+   m_advised      (0),
+   m_readAhead    (readAhead)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+FragmentReaderMapped::~FragmentReaderMapped ()
+{
+   close ();
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Opens and maps the file
+  \return 0 if successful, else the Unix error number
+
+  \par
+   An empty file cannot be mapped; it is opened, but has no fragments.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentReaderMapped::open ()
+{
+   m_fd = ::open (m_filename, O_RDONLY);
+   if (m_fd < 0) return errno;
+
+   struct stat st;
+   if (fstat (m_fd, &st) != 0)
+   {
+      int err = errno;
+      close ();
+      return err;
+   }
+
+   m_size    = st.st_size;
+   m_offset  = 0;
+   m_advised = 0;
+
+   if (m_size == 0)
+   {
+      return 0;
+   }
+
+
+   void *map = mmap (0, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+   if (map == MAP_FAILED)
+   {
+      int err = errno;
+      close ();
+      return err;
+   }
+
+   // The hints are only advisory, so failures are not errors
+   m_map = reinterpret_cast<uint64_t const *>(map);
+   madvise (map, m_size, MADV_SEQUENTIAL);
+   advise  (0);
+
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns a view of the next fragment
+  \return The status of the read
+
+  \param[out] fragment  The view of the fragment
+
+  \par
+   When the header is bad or the fragment is truncated, there is no way
+   to find the next fragment, so the reader stays put and repeats the
+   same status.  When only the trailer is bad, the fragment is returned
+   and the reader moves to the next one.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReader::Status FragmentReaderMapped::read (Fragment *fragment)
+{
+   fragment->m_buf    = 0;
+   fragment->m_offset = m_offset;
+   fragment->m_n64    = 0;
+   fragment->m_slot   = 0;
+
+   if (m_fd < 0)
+   {
+      return Status::IoError;
+   }
+
+   uint64_t left = m_size - m_offset;
+   if (left == 0)
+   {
+      return Status::EndOfFile;
+   }
+
+   if (left < sizeof (uint64_t))
+   {
+      return Status::Truncated;
+   }
+
+
+   // ------------------------------------------------------
+   // Check the header before trusting its length. Anything
+   // shorter than a header plus a trailer cannot be right.
+   // ------------------------------------------------------
+   uint64_t const       *buf = m_map + m_offset / sizeof (uint64_t);
+   auto const        *header = HeaderFragmentUnpack::assign (buf);
+   uint32_t              n64 = header->getN64 ();
+   uint64_t           nbytes = n64 * sizeof (uint64_t);
+
+   if (!header->isOkay () || n64 < 2)
+   {
+      return Status::BadHeader;
+   }
+
+   if (nbytes > left)
+   {
+      return Status::Truncated;
+   }
+
+
+   advise (m_offset + nbytes);
+
+   fragment->m_buf = buf;
+   fragment->m_n64 = n64;
+   m_offset       += nbytes;
+
+   bool okay = RceFragmentUnpack::isOkay (buf, nbytes);
+   return okay ? Status::Okay : Status::BadTrailer;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Gives back a fragment. The views are valid until the file is
+          closed, so there is nothing to do.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void FragmentReaderMapped::release (Fragment const &)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Positions the reader so the next read returns the fragment at
+          \a offset
+  \return Status::Okay, or Status::BadSeek if \a offset is not on a
+          64-bit boundary or is past the end of the file
+
+  \param[in] offset  The byte offset of the fragment in the file
+
+  \par
+   The kernel is asked to bring in the read ahead region from the new
+   position.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+FragmentReader::Status FragmentReaderMapped::seek (uint64_t offset)
+{
+   if (m_fd < 0)
+   {
+      return Status::IoError;
+   }
+
+   if (offset > m_size || (offset % sizeof (uint64_t)) != 0)
+   {
+      return Status::BadSeek;
+   }
+
+   m_offset  = offset;
+   m_advised = offset;
+   advise (offset);
+
+   return Status::Okay;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Unmaps and closes the file
+  \return 0 if successful, else the Unix error number
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int FragmentReaderMapped::close ()
+{
+   int err = 0;
+
+   if (m_map)
+   {
+      if (munmap (const_cast<uint64_t *>(m_map), m_size) != 0) err = errno;
+      m_map = 0;
+   }
+
+   if (m_fd >= 0)
+   {
+      if (::close (m_fd) != 0 && err == 0) err = errno;
+      m_fd = -1;
+   }
+
+   m_size    = 0;
+   m_offset  = 0;
+   m_advised = 0;
+
+   return err;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Asks the kernel to bring in the read ahead region following
+         \a offset.
+
+  \param[in] offset  The byte offset the reader has reached
+
+  \par
+   The request is only renewed once half of the previously requested
+   region has been consumed, keeping the number of system calls small.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void FragmentReaderMapped::advise (uint64_t offset)
+{
+   if (m_readAhead == 0 || offset + m_readAhead / 2 < m_advised)
+   {
+      return;
+   }
+
+   uint64_t end = offset + m_readAhead;
+   if (end > m_size) end = m_size;
+   if (end <= m_advised) return;
+
+
+   // The address given to madvise must be page aligned
+   static long const pagesize = sysconf (_SC_PAGESIZE);
+   uint64_t               beg = m_advised & ~(uint64_t)(pagesize - 1);
+   uint8_t const         *map = reinterpret_cast<uint8_t const *>(m_map);
+
+   madvise (const_cast<uint8_t *>(map) + beg, end - beg, MADV_WILLNEED);
+   m_advised = end;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
@@ -46,6 +46,9 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt The exception words immediately follow the 7 seed words,
+                  as locateHdrWrds and getNHdrWrds already had it.
+                  locateExcWrds skipped one word too many
    2018.07.11 jjr Created
 
 \* ---------------------------------------------------------------------- */
@@ -439,7 +442,7 @@ TPCCOMPRESSED_IMPL uint16_t const *
 TpcCompressedHdr::locateExcWrds (pdd::record::TpcCompressedHdr const *rec)
 {
    uint16_t const *excWrds = 
-           reinterpret_cast<decltype(excWrds)>(rec->m_body.m_w64 + 8);
+           reinterpret_cast<decltype(excWrds)>(rec->m_body.m_w64 + 7);
    return excWrds;
 }
 
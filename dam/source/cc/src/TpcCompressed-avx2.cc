@@ -0,0 +1,482 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     TpcCompressed-avx2.cc
+ *  @brief    Interleaved decoding of the compressed ADCs - AVX2 version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  pdd
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  Eight channels are decoded in lockstep, one per 32-bit lane.  The
+ *  arithmetic of APD_decode is reproduced exactly, including its 16-bit
+ *  truncations, so the output is identical to the serial decoder.
+ *  The differences are in how the work is arranged
+ *
+ *    -# The scaling division is done in double precision. The dividend
+ *       is < 2**27 and the divisor < 2**13, so the truncated quotient
+ *       is exact.
+ *    -# The symbol is located with a binary search using gathers from
+ *       each lane's table, rather than a linear search.
+ *    -# The renormalization loop operates only on lo and hi, counting
+ *       the number of bits, k, each lane shifts.  Since value, lo and hi
+ *       undergo the same subtractions and shifts, value - lo only
+ *       accumulates the input bits.  So, modulo 2**12, the new value is
+ *       lo + ((value - lo) << k) + the next k input bits, all of which
+ *       are then fetched at once.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Renormalize in closed form, as renormalize does, rather
+                  than looping until the slowest lane is done
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "TpcCompressed-dispatch.hh"
+#include "AP-Decode.h"
+#include <immintrin.h>
+
+
+/*
+ | The intrinsics can only be inlined into functions compiled for the
+ | same instruction set, so the whole translation unit is compiled for
+ | AVX2.  The decoder is only selected if the executing cpu supports it.
+*/
+#pragma GCC push_options
+#pragma GCC target ("avx2")
+
+
+namespace pdd     {
+namespace access  {
+namespace tpcadcs {
+namespace avx2    {
+
+
+#define NLANES 8
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extract a right justified bit field from each lane
+  \return The bit fields
+
+  \param[in]      buf  The bit stream, big-endian bits in 64-bit words
+                       viewed as 32-bit words
+  \param[in] position  The bit position of each lane's left most bit
+  \param[in]    nbits  The width of each lane's field, 0-32
+
+   The stream is treated as big-endian 32-bit units. Logical unit j
+   is the 32-bit word j ^ 1, since the 64-bit words are little-endian.
+   The unit following the one containing the field is always read.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m256i extract (int const      *buf,
+                               __m256i    position,
+                               __m256i       nbits)
+{
+   __m256i const one = _mm256_set1_epi32 (1);
+   __m256i const n32 = _mm256_set1_epi32 (32);
+
+   __m256i    j = _mm256_srli_epi32  (position, 5);
+   __m256i    s = _mm256_and_si256   (position, _mm256_set1_epi32 (31));
+   __m256i   ja = _mm256_xor_si256   (j, one);
+   __m256i   jb = _mm256_xor_si256   (_mm256_add_epi32 (j, one), one);
+   __m256i    a = _mm256_i32gather_epi32 (buf, ja, 4);
+   __m256i    b = _mm256_i32gather_epi32 (buf, jb, 4);
+
+   // Left justify the field, count of 32 correctly produces 0
+   __m256i    w = _mm256_or_si256 (_mm256_sllv_epi32 (a, s),
+                                   _mm256_srlv_epi32 (b, _mm256_sub_epi32 (n32, s)));
+
+   return _mm256_srlv_epi32 (w, _mm256_sub_epi32 (n32, nbits));
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Gather a 16-bit table entry for each lane
+  \return The table entries
+
+  \param[in]   tables  The base of the lane tables, as 32-bit words
+  \param[in]    index  The index, in 16-bit units, of each lane's entry
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m256i lookup (int const *tables, __m256i index)
+{
+   __m256i t = _mm256_i32gather_epi32 (tables, index, 2);
+   return _mm256_and_si256 (t, _mm256_set1_epi32 (0xffff));
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the floor of the base 2 logarithm of each lane
+  \return The logarithms
+
+  \param[in] x  The values, each must be in the range 1 to 2**24 - 1
+
+   AVX2 has no count of leading zeros.  Since these values convert to
+   single precision exactly, the exponent serves instead.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m256i ilog2 (__m256i x)
+{
+   __m256i e = _mm256_castps_si256 (_mm256_cvtepi32_ps (x));
+   return _mm256_sub_epi32 (_mm256_srli_epi32 (e, 23), _mm256_set1_epi32 (127));
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Renormalize each lane's code range, this mirrors renormalize
+  \return The number of bits shifted out of each lane
+
+  \param[in,out] lo  The lanes' lo limits
+  \param[in,out] hi  The lanes' hi limits
+
+   The closed form of renormalize is used unless some lane's limits are
+   wider than APC_K_NBITS, which only a corrupted table can produce. The
+   lanes are then renormalized one bit at a time, as in
+   renormalize_bitwise.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m256i renormalize (__m256i &lo, __m256i &hi)
+{
+   __m256i const one  = _mm256_set1_epi32 (1);
+   __m256i const m11  = _mm256_set1_epi32 (APC_K_HALF - 1);
+   __m256i const m12  = _mm256_set1_epi32 (APC_M_CV_ALL);
+   __m256i const half = _mm256_set1_epi32 (APC_K_HALF);
+   __m256i const q1   = _mm256_set1_epi32 (APC_K_Q1);
+   __m256i const q3   = _mm256_set1_epi32 (APC_K_Q3);
+
+   __m256i  wide = _mm256_andnot_si256 (m12, _mm256_or_si256 (lo, hi));
+   if (_mm256_testz_si256 (wide, wide))
+   {
+      // -------------------------------------------------------
+      // Expansions of the low and high halves, n = the leading
+      // zeros of ~lo & hi, computed as 12 - log2 (2x + 1)
+      // -------------------------------------------------------
+      __m256i   x = _mm256_and_si256 (_mm256_andnot_si256 (lo, hi), m12);
+      x           = _mm256_or_si256  (_mm256_slli_epi32 (x, 1), one);
+      __m256i   n = _mm256_sub_epi32 (_mm256_set1_epi32 (APC_K_NBITS),
+                                      ilog2 (x));
+      __m256i  n1 = _mm256_sub_epi32 (_mm256_sllv_epi32 (one, n), one);
+      lo          = _mm256_and_si256 (_mm256_sllv_epi32 (lo, n), m12);
+      hi          = _mm256_and_si256 (_mm256_or_si256 (_mm256_sllv_epi32 (hi, n),
+                                                       n1),
+                                      m12);
+
+      // ------------------------------------------------------
+      // Expansions of the middle half, m = the leading ones of
+      // lo & ~hi below the top bit, i.e. the leading zeros of
+      // the 11 bits of ~(lo & ~hi), computed as for n
+      // ------------------------------------------------------
+      __m256i   z = _mm256_andnot_si256 (hi, lo);
+      __m256i   w = _mm256_andnot_si256 (z, m11);
+      w           = _mm256_or_si256  (_mm256_slli_epi32 (w, 1), one);
+      __m256i   m = _mm256_sub_epi32 (_mm256_set1_epi32 (APC_K_NBITS - 1),
+                                      ilog2 (w));
+      __m256i  m1 = _mm256_sub_epi32 (_mm256_sllv_epi32 (one, m), one);
+      lo          = _mm256_and_si256 (_mm256_sllv_epi32 (lo, m), m11);
+      hi          = _mm256_or_si256  (_mm256_and_si256 (_mm256_sllv_epi32 (hi, m),
+                                                        m11),
+                                      _mm256_or_si256 (half, m1));
+
+      return _mm256_add_epi32 (n, m);
+   }
+
+
+   __m256i     k = _mm256_setzero_si256 ();
+   while (1)
+   {
+      __m256i   hiLo = _mm256_cmpgt_epi32 (half, hi);
+      __m256i   loHi = _mm256_cmpgt_epi32 (lo, _mm256_sub_epi32 (half, one));
+      __m256i    e12 = _mm256_or_si256    (hiLo, loHi);
+      __m256i    mid = _mm256_and_si256   (_mm256_cmpgt_epi32 (lo, _mm256_sub_epi32 (q1, one)),
+                                           _mm256_cmpgt_epi32 (q3, hi));
+      __m256i     e3 = _mm256_andnot_si256 (e12, mid);
+      __m256i    act = _mm256_or_si256    (e12, e3);
+
+      if (_mm256_testz_si256 (act, act)) break;
+
+      __m256i    sub = _mm256_or_si256 (_mm256_and_si256 (_mm256_andnot_si256 (hiLo, loHi), half),
+                                        _mm256_and_si256 (e3, q1));
+      __m256i    nlo = _mm256_slli_epi32 (_mm256_sub_epi32 (lo, sub), 1);
+      __m256i    nhi = _mm256_slli_epi32 (_mm256_sub_epi32 (hi, sub), 1);
+      nlo            = _mm256_and_si256  (nlo, m12);
+      nhi            = _mm256_and_si256  (_mm256_or_si256 (nhi, one), m12);
+
+      lo             = _mm256_blendv_epi8 (lo, nlo, act);
+      hi             = _mm256_blendv_epi8 (hi, nhi, act);
+      k              = _mm256_sub_epi32   (k, act);
+   }
+
+   return k;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Decode the next symbol of each lane, this mirrors APD_decode
+  \return The decoded symbols
+
+  \param[in,out]     lo  The lanes' lo limits
+  \param[in,out]     hi  The lanes' hi limits
+  \param[in,out]  value  The lanes' values
+  \param[in,out]    pos  The bit position of the lanes' next input bit
+  \param[in]        buf  The bit stream
+  \param[in]     tables  The base of the lanes' tables
+  \param[in]      tbase  The index of each lane's cumulative counts
+  \param[in]        cnt  The lanes' table counts
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m256i decode (__m256i        &lo,
+                              __m256i        &hi,
+                              __m256i     &value,
+                              __m256i       &pos,
+                              int const     *buf,
+                              int const  *tables,
+                              __m256i      tbase,
+                              __m256i        cnt)
+{
+   __m256i const one  = _mm256_set1_epi32 (1);
+   __m256i const m16  = _mm256_set1_epi32 (0xffff);
+   __m256i const m12  = _mm256_set1_epi32 (APC_M_CV_ALL);
+
+
+   // -----------------------------------------------
+   // cum = scale_m1 (value - lo + 1, range)
+   // The numerator is truncated to 16 bits, as is
+   // the quotient, as in APD_decode.
+   // -----------------------------------------------
+   __m256i range = _mm256_add_epi32 (_mm256_sub_epi32 (hi, lo), one);
+   __m256i   num = _mm256_and_si256 (_mm256_add_epi32 (_mm256_sub_epi32 (value, lo), one), m16);
+   num           = _mm256_sub_epi32 (_mm256_slli_epi32 (num, APC_K_NORM_NBITS), one);
+
+   __m256d  nlo  = _mm256_cvtepi32_pd (_mm256_castsi256_si128   (num));
+   __m256d  nhi  = _mm256_cvtepi32_pd (_mm256_extracti128_si256 (num,   1));
+   __m256d  dlo  = _mm256_cvtepi32_pd (_mm256_castsi256_si128   (range));
+   __m256d  dhi  = _mm256_cvtepi32_pd (_mm256_extracti128_si256 (range, 1));
+   __m128i  qlo  = _mm256_cvttpd_epi32 (_mm256_div_pd (nlo, dlo));
+   __m128i  qhi  = _mm256_cvttpd_epi32 (_mm256_div_pd (nhi, dhi));
+   __m256i  cum  = _mm256_inserti128_si256 (_mm256_castsi128_si256 (qlo), qhi, 1);
+   cum           = _mm256_and_si256 (cum, m16);
+
+
+   // ----------------------------------------------------------
+   // symbol = lookup_bot (cum, table, cnt)
+   // This is the largest index, <= cnt, whose cumulative count
+   // is <= cum. Since the table is monotonic, a binary search
+   // finds the same index as the linear search.
+   // ----------------------------------------------------------
+   __m256i sym  = _mm256_setzero_si256 ();
+   __m256i cnt1 = _mm256_add_epi32 (cnt, one);
+   for (int step = 64; step; step >>= 1)
+   {
+      __m256i cand = _mm256_add_epi32 (sym, _mm256_set1_epi32 (step));
+      __m256i   ok = _mm256_cmpgt_epi32 (cnt1, cand);
+      __m256i    t = _mm256_mask_i32gather_epi32 (_mm256_setzero_si256 (),
+                                                  tables,
+                                                  _mm256_add_epi32 (tbase, cand),
+                                                  ok,
+                                                  2);
+      t            = _mm256_and_si256 (t, m16);
+      ok           = _mm256_andnot_si256 (_mm256_cmpgt_epi32 (t, cum), ok);
+      sym          = _mm256_blendv_epi8  (sym, cand, ok);
+   }
+
+
+   // --------------------------------------------
+   // Narrow the code range to that of the symbol
+   // --------------------------------------------
+   __m256i   idx = _mm256_add_epi32 (tbase, sym);
+   __m256i   tlo = lookup (tables, idx);
+   __m256i   thi = lookup (tables, _mm256_add_epi32 (idx, one));
+
+   __m256i   xhi = _mm256_slli_epi32 (_mm256_sub_epi32 (lo, one), APC_K_NORM_NBITS);
+   __m256i   xlo = _mm256_slli_epi32 (lo,                         APC_K_NORM_NBITS);
+   hi = _mm256_add_epi32 (_mm256_mullo_epi32 (range, thi), xhi);
+   lo = _mm256_add_epi32 (_mm256_mullo_epi32 (range, tlo), xlo);
+   hi = _mm256_and_si256 (_mm256_srli_epi32 (hi, APC_K_NORM_NBITS), m16);
+   lo = _mm256_and_si256 (_mm256_srli_epi32 (lo, APC_K_NORM_NBITS), m16);
+
+
+   // ----------------------------------------------
+   // Renormalize lo and hi, counting the shifts
+   // ----------------------------------------------
+   __m256i   lo0 = lo;
+   __m256i     k = renormalize (lo, hi);
+
+
+   // ------------------------------------------------------
+   // Shift the k input bits into value all at once
+   // ------------------------------------------------------
+   __m256i     d = _mm256_and_si256 (_mm256_sub_epi32 (value, lo0), m12);
+   __m256i  bits = extract (buf, pos, k);
+   value         = _mm256_add_epi32 (lo, _mm256_sllv_epi32 (d, k));
+   value         = _mm256_and_si256 (_mm256_add_epi32 (value, bits), m12);
+   pos           = _mm256_add_epi32 (pos, k);
+
+   return sym;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Decode the symbols of \a nlanes channels in lockstep
+
+  \param[in,out]  lanes  The decoding contexts of the channels
+  \param[in]     nlanes  The number of channels, at most 8
+  \param[in]        buf  The bit stream
+  \param[in]    begTick  The first tick to store
+  \param[in]    endTick  The tick after the last tick to store
+  \param[in]   nsymbols  The number of symbols, i.e. ticks, per channel
+
+   Unused lanes decode a copy of lane 0, their output is discarded.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void decode (TpcAdcsDecoder::Lane *lanes,
+                    int                  nlanes,
+                    uint64_t const         *buf,
+                    int                 begTick,
+                    int                 endTick,
+                    int                nsymbols)
+{
+   int const    *buf32 = reinterpret_cast<int const *>(buf);
+   int const   *tables = reinterpret_cast<int const *>(lanes[0].m_table);
+   int          stride = sizeof (TpcAdcsDecoder::Lane) / sizeof (uint16_t);
+
+   int16_t *adcs[NLANES];
+   int32_t  init[6][NLANES] __attribute__ ((aligned (32)));
+
+   for (int ilane = 0; ilane < NLANES; ilane++)
+   {
+      int                          jlane = ilane < nlanes ? ilane : 0;
+      TpcAdcsDecoder::Lane const   &lane = lanes[jlane];
+
+      adcs[ilane]    = lane.m_adcs;
+      init[0][ilane] = lane.m_ovrpos;
+      init[1][ilane] = lane.m_novrflw;
+      init[2][ilane] = lane.m_adc0;
+      init[3][ilane] = lane.m_table[0];
+      init[4][ilane] = jlane * stride + 1;
+      init[5][ilane] = lane.m_ovrpos + lane.m_novrflw * lane.m_table[2];
+   }
+
+   __m256i const one = _mm256_set1_epi32 (1);
+   __m256i   ovrpos  = _mm256_load_si256 ((__m256i const *)init[0]);
+   __m256i  novrflw  = _mm256_load_si256 ((__m256i const *)init[1]);
+   __m256i      adc  = _mm256_load_si256 ((__m256i const *)init[2]);
+   __m256i    nbins  = _mm256_load_si256 ((__m256i const *)init[3]);
+   __m256i    tbase  = _mm256_load_si256 ((__m256i const *)init[4]);
+   __m256i   sympos  = _mm256_load_si256 ((__m256i const *)init[5]);
+   __m256i      cnt  = _mm256_sub_epi32 (nbins, one);
+
+   __m256i       lo  = _mm256_setzero_si256 ();
+   __m256i       hi  = _mm256_set1_epi32 (APC_K_HI);
+   __m256i    value  = extract (buf32, sympos, _mm256_set1_epi32 (APC_K_NBITS));
+   __m256i      pos  = _mm256_add_epi32 (sympos, _mm256_set1_epi32 (APC_K_NBITS));
+
+
+   int32_t out[NLANES] __attribute__ ((aligned (32)));
+   for (int idy = 0; ; idy++)
+   {
+      if ( (idy >= begTick) && (idy < endTick) )
+      {
+         _mm256_store_si256 ((__m256i *)out, adc);
+         for (int ilane = 0; ilane < nlanes; ilane++)
+         {
+            *adcs[ilane]++ = out[ilane];
+         }
+      }
+
+      if (idy == nsymbols - 1)
+      {
+         break;
+      }
+
+      __m256i sym = decode (lo, hi, value, pos, buf32, tables, tbase, cnt);
+
+      // Have overflow?
+      __m256i ovr = _mm256_cmpeq_epi32 (sym, _mm256_setzero_si256 ());
+      if (!_mm256_testz_si256 (ovr, ovr))
+      {
+         __m256i bits = extract (buf32, ovrpos, novrflw);
+         sym          = _mm256_blendv_epi8 (sym, _mm256_add_epi32 (nbins, bits), ovr);
+         ovrpos       = _mm256_add_epi32   (ovrpos, _mm256_and_si256 (novrflw, ovr));
+      }
+
+      // adc += restore (sym), the sign is in the low bit
+      __m256i neg = _mm256_sub_epi32 (_mm256_setzero_si256 (),
+                                      _mm256_and_si256 (sym, one));
+      __m256i mag = _mm256_srli_epi32 (sym, 1);
+      adc         = _mm256_add_epi32  (adc, _mm256_sub_epi32 (_mm256_xor_si256 (mag, neg), neg));
+   }
+
+
+   // Same accounting as APD_finish + the final overflow position
+   __m256i position = _mm256_sub_epi32 (pos, sympos);
+   position         = _mm256_add_epi32 (position, _mm256_set1_epi32 (2 - APC_K_NBITS));
+   position         = _mm256_add_epi32 (position, ovrpos);
+   _mm256_store_si256 ((__m256i *)out, position);
+   for (int ilane = 0; ilane < nlanes; ilane++)
+   {
+      lanes[ilane].m_position = out[ilane];
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+TpcAdcsDecoder const Decoder = { "avx2", NLANES, decode };
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace avx2                                                  */
+} /* END: namespace tpcadcs                                               */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+#pragma GCC pop_options
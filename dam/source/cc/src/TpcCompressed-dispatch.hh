@@ -0,0 +1,144 @@
+// -*-Mode: C++;-*-
+
+#ifndef PDD_TPCCOMPRESSED_DISPATCH_HH
+#define PDD_TPCCOMPRESSED_DISPATCH_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     TpcCompressed-dispatch.hh
+ *  @brief    The interface to the instruction set specific, interleaved
+ *            decoders of the compressed ADCs
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  pdd
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  Decoding a channel's arithmetically encoded symbols is a long serial
+ *  chain, each symbol depends on the code range left by the previous
+ *  one. The channels of a packet are, however, independent.  These
+ *  decoders advance a group of channels in lockstep, one symbol from
+ *  each channel per step, so that the latencies of the channels overlap
+ *  and, for the SIMD variants, the arithmetic is done one channel per
+ *  vector lane.  The output is identical to that of the serial decoder.
+ *
+ *  Each variant is compiled into its own translation unit,
+ *  TpcCompressed-<variant>.cc.  TpcCompressed.cc selects the one to use.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include <cinttypes>
+
+
+namespace pdd    {
+namespace access {
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  An interleaved decoder of the compressed ADCs for one
+          instruction set variant
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class TpcAdcsDecoder
+{
+public:
+   enum
+   {
+      MaxLanes   =  16,     /*!< Maximum number of lanes of any variant   */
+      TableSize  = 128 + 4  /*!< The symbol table, plus padding so that it
+                                 can be read with 32-bit gathers          */
+   };
+
+   /* ------------------------------------------------------------------ *//*!
+
+     \brief The decoding context of one channel.
+
+      Everything up to and including the symbol table is set up by
+      the caller from the channel's table header.  m_position is
+      returned by the decoder.
+                                                                          */
+   /* ------------------------------------------------------------------ */
+   class Lane
+   {
+   public:
+      int16_t                *m_adcs; /*!< The destination               */
+      int32_t                 m_adc0; /*!< The first ADC                 */
+      int32_t               m_ovrpos; /*!< Bit position of the overflows */
+      int32_t              m_novrflw; /*!< Number of bits per overflow   */
+      int32_t             m_position; /*!< Returned, the bit position
+                                           following the channel         */
+      uint16_t    m_table[TableSize]; /*!< The symbol table              */
+   };
+   /* ------------------------------------------------------------------ */
+
+
+   // Decode the symbols of nlanes channels
+   typedef void (*Decode) (Lane               *lanes,
+                           int               nlanes,
+                           uint64_t const      *buf,
+                           int              begTick,
+                           int              endTick,
+                           int             nsymbols);
+
+public:
+   static TpcAdcsDecoder const *select ();
+   static TpcAdcsDecoder const *locate (char const *name);
+
+public:
+   char const  *m_name;  /*!< The variant name, serial, gen, avx2          */
+   int        m_nlanes;  /*!< The number of channels decoded in lockstep  */
+   Decode     m_decode;  /*!< The decoder                                 */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+/* The instruction set variants                                           */
+/* ---------------------------------------------------------------------- */
+namespace tpcadcs {
+namespace gen     { extern TpcAdcsDecoder const Decoder; }
+namespace avx2    { extern TpcAdcsDecoder const Decoder; }
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+
+#endif
@@ -0,0 +1,270 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     TpcCompressed-gen.cc
+ *  @brief    Interleaved decoding of the compressed ADCs - generic version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  pdd
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  This is a transliteration of APD_decode and the symbol loop of
+ *  TpcCompressed.cc's adcs_decode, with the state of each channel held
+ *  in its own lane.  The lanes are advanced in lockstep; since they are
+ *  independent, the processor is free to overlap them.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Renormalize with the closed form renormalize
+   2026.10.16 agt Created
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "TpcCompressed-dispatch.hh"
+#include "AP-Decode.h"
+
+
+namespace pdd     {
+namespace access  {
+namespace tpcadcs {
+namespace gen     {
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The decoding state of one lane
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class State
+{
+public:
+   APD_cv_t                     m_lo; /*!< Current lo limit               */
+   APD_cv_t                     m_hi; /*!< Current hi limit               */
+   APD_cv_t                  m_value; /*!< Current value                  */
+   int16_t                     m_adc; /*!< Current ADC                    */
+   int                    m_position; /*!< Bit position of the next input */
+   int                      m_ovrpos; /*!< Bit position of next overflow  */
+   int16_t                   *m_adcs; /*!< Next destination               */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extract a right justified bit field
+  \return The bit field
+
+  \param[in]      buf  The bit stream, big-endian bits in 64-bit words
+  \param[in] position  The bit position of the field's left most bit
+  \param[in]    nbits  The width of the field
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline unsigned int extract (uint64_t const *buf,
+                                    int        position,
+                                    int           nbits)
+{
+   if (nbits == 0) return 0;
+
+   int            bit = position & 0x3f;
+   int          avail = 64 - bit;
+   uint64_t const  *w = buf + (position >> 6);
+   uint64_t       val = w[0] << bit;
+
+   // Only touch the next word if the field crosses into it
+   if (avail < nbits) val |= w[1] >> avail;
+
+   return val >> (64 - nbits);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Decode the next symbol of one lane, this mirrors APD_decode
+  \return The decoded symbol
+
+  \param[in,out] s  The lane's state
+  \param[in] table  The lane's symbol table
+  \param[in]   buf  The bit stream
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline unsigned int decode (State                 &s,
+                                   APD_table_t const *table,
+                                   uint64_t const      *buf)
+{
+   APD_cv_t        lo = s.m_lo;
+   APD_cv_t        hi = s.m_hi;
+   APD_cv_t     value = s.m_value;
+   int       position = s.m_position;
+   unsigned int   cnt = table[0] - 1;
+
+   int    range = (hi - lo) + 1;
+   uint32_t cum = scale_m1 (value - lo + 1, range);
+   table        = table + 1;
+
+   int   symbol = lookup_bot (cum, table, cnt);
+
+   hi = scale_hi (lo, range, table[symbol+1]);
+   lo = scale_lo (lo, range, table[symbol  ]);
+
+
+   // -------------------------------------------------------
+   // Renormalize lo and hi, k is the number of shifts.
+   // Since value undergoes the same subtractions and shifts
+   // as lo, value - lo only accumulates the input bits. So,
+   // modulo 2**12, the new value is lo + ((value - lo) << k)
+   // plus the next k input bits, which are fetched at once.
+   // -------------------------------------------------------
+   unsigned int d = (value - lo) & APC_M_CV_ALL;
+   int          k = renormalize (&lo, &hi);
+
+   value     = (lo + (d << k) + extract (buf, position, k)) & APC_M_CV_ALL;
+   position += k;
+
+   s.m_lo       = lo;
+   s.m_hi       = hi;
+   s.m_value    = value;
+   s.m_position = position;
+
+   return symbol;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline int16_t restore (unsigned int sym)
+{
+   if (sym & 1)  return -(sym >> 1);
+   else          return  (sym >> 1);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Decode the symbols of \a nlanes channels in lockstep
+
+  \param[in,out]  lanes  The decoding contexts of the channels
+  \param[in]     nlanes  The number of channels, at most MaxLanes
+  \param[in]        buf  The bit stream
+  \param[in]    begTick  The first tick to store
+  \param[in]    endTick  The tick after the last tick to store
+  \param[in]   nsymbols  The number of symbols, i.e. ticks, per channel
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void decode (TpcAdcsDecoder::Lane *lanes,
+                    int                  nlanes,
+                    uint64_t const         *buf,
+                    int                 begTick,
+                    int                 endTick,
+                    int                nsymbols)
+{
+   State states[TpcAdcsDecoder::MaxLanes];
+   int   sympos[TpcAdcsDecoder::MaxLanes];
+
+   for (int ilane = 0; ilane < nlanes; ilane++)
+   {
+      TpcAdcsDecoder::Lane const &lane = lanes[ilane];
+      State                         &s = states[ilane];
+
+      sympos[ilane] = lane.m_ovrpos + lane.m_novrflw * lane.m_table[2];
+      s.m_lo        = 0;
+      s.m_hi        = APC_K_HI;
+      s.m_value     = extract (buf, sympos[ilane], APC_K_NBITS);
+      s.m_position  = sympos[ilane] + APC_K_NBITS;
+      s.m_ovrpos    = lane.m_ovrpos;
+      s.m_adc       = lane.m_adc0;
+      s.m_adcs      = lane.m_adcs;
+   }
+
+
+   for (int idy = 0; ; idy++)
+   {
+      if ( (idy >= begTick) && (idy < endTick) )
+      {
+         for (int ilane = 0; ilane < nlanes; ilane++)
+         {
+            *states[ilane].m_adcs++ = states[ilane].m_adc;
+         }
+      }
+
+      if (idy == nsymbols - 1)
+      {
+         break;
+      }
+
+      for (int ilane = 0; ilane < nlanes; ilane++)
+      {
+         TpcAdcsDecoder::Lane const &lane = lanes[ilane];
+         State                         &s = states[ilane];
+
+         unsigned int sym = decode (s, lane.m_table, buf);
+         if (sym == 0)
+         {
+            // Have overflow
+            int novrflw = lane.m_novrflw;
+            sym         = lane.m_table[0] + extract (buf, s.m_ovrpos, novrflw);
+            s.m_ovrpos += novrflw;
+         }
+
+         s.m_adc += restore (sym);
+      }
+   }
+
+
+   // Same accounting as APD_finish + the final overflow position
+   for (int ilane = 0; ilane < nlanes; ilane++)
+   {
+      State const &s = states[ilane];
+      lanes[ilane].m_position = s.m_position - sympos[ilane]
+                              - APC_K_NBITS  + 2
+                              + s.m_ovrpos;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+TpcAdcsDecoder const Decoder = { "gen", 4, decode };
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace gen                                                   */
+} /* END: namespace tpcadcs                                               */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
@@ -39,18 +39,52 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt decompressWibFrames clears the cold data checksum fields
+                  rather than leaving those of an earlier frame
+   2026.10.16 agt Added the decompress and decompressChannels that
+                  accumulate each channel's AdcStats as it is decoded
+   2026.10.16 agt Added the streaming decompress and decompressChannels,
+                  which store the ADCs with non-temporal stores
+   2026.10.16 agt Added the float decompress and decompressChannels, which
+                  store pedestal subtracted, gain corrected values
+   2026.10.16 agt Added the channel mask decompress and the channel list
+                  decompressChannels, decoding only the selected channels
+   2026.10.16 agt Added decompressWibFrames, rebuilding the WibFrames of
+                  a packet.  Removed the disabled header_decode, now
+                  superseded by TpcCompressedWibHdrs.
+   2026.10.16 agt Added TpcCompressedWibHdrs, the live version of the
+                  expansion done by the disabled header_decode
+   2026.10.16 agt adcs_decode finds the symbols with a lookup table built
+                  from the channel's table, rather than by searching it,
+                  if the table has at least APD_K_LUT_MINBINS bins.
+   2026.10.16 agt Groups of channels are decoded in lockstep by one of
+                  the interleaved decoders, TpcCompressed-<variant>.cc,
+                  selected at load time.  Added decompressChannels,
+                  getDecoder, selectDecoder and getNInterleaved.
+   2026.10.16 agt The channels are decompressed by the shared WorkerPool,
+                  potentially in parallel. Added decompressChannel and
+                  getNDecompressed. The four decompress methods now share
+                  one implementation.
    2018.07.11 jjr Created
   
 \* ---------------------------------------------------------------------- */
 
-#define   TPCCOMPRESSE_IMPL extern
+#define   TPCCOMPRESSED_IMPL extern
 
 
 #include "TpcCompressed-Impl.hh"
+#include "TpcCompressed-dispatch.hh"
+#include "dam/access/WibFrame.hh"
+#include "dam/access/AdcStats.hh"
+#include "WorkerPool.hh"
 #include "BFU.h"
 #include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
 #include  <iostream>
 #include  <iomanip>
+#include  <vector>
+#include  <immintrin.h>
 
 
 
@@ -250,47 +284,685 @@ static void print_decoded (uint16_t       sym,
 ///static int BegValue = 0;
 
 
+
+/* ====================================================================== */
+/* BEGIN: DECODER SELECTION                                               */
+/* ---------------------------------------------------------------------- */
+namespace tpcadcs {
+namespace serial  {
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Decode the symbols of \a nlanes channels, one at a time
+
+  \param[in,out]  lanes  The decoding contexts of the channels
+  \param[in]     nlanes  The number of channels
+  \param[in]        buf  The bit stream
+  \param[in]    begTick  The first tick to store
+  \param[in]    endTick  The tick after the last tick to store
+  \param[in]   nsymbols  The number of symbols, i.e. ticks, per channel
+
+   This is the original decoder, it is the reference the interleaved
+   decoders must reproduce.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void decode (TpcAdcsDecoder::Lane *lanes,
+                    int                  nlanes,
+                    uint64_t const         *buf,
+                    int                 begTick,
+                    int                 endTick,
+                    int                nsymbols)
+{
+   for (int ilane = 0; ilane < nlanes; ilane++)
+   {
+      TpcAdcsDecoder::Lane &lane = lanes[ilane];
+      BFU bfu;
+      _bfu_put (bfu, buf[lane.m_ovrpos>>6], lane.m_ovrpos);
+
+      lane.m_position = adcs_decode (lane.m_adcs, bfu, buf, lane.m_table,
+                                     begTick, endTick, lane.m_adc0,
+                                     lane.m_ovrpos, nsymbols,
+                                     lane.m_novrflw, false);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+TpcAdcsDecoder const Decoder = { "serial", 1, decode };
+}
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \var   Decoder
+  \brief The decoder in use.
+
+   This is set when the library is loaded.  Should a decompression
+   method be called by some other static initializer before this
+   happens, the selection is made then.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static TpcAdcsDecoder const *Decoder = TpcAdcsDecoder::select ();
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the decoder in use, selecting it if necessary
+  \return The decoder in use
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline TpcAdcsDecoder const &decoder ()
+{
+   TpcAdcsDecoder const *d = Decoder;
+   if (d == NULL) Decoder = d = TpcAdcsDecoder::select ();
+   return *d;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Locate the decoder by name
+  \return Pointer to the decoder if \a name is known and supported on
+          the executing cpu, else NULL.
+
+  \param[in] name The name of the decoder, serial, gen or avx2
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcAdcsDecoder const *TpcAdcsDecoder::locate (char const *name)
+{
+   __builtin_cpu_init ();
+
+   if (strcmp (name, tpcadcs::serial::Decoder.m_name) == 0)
+   {
+      return &tpcadcs::serial::Decoder;
+   }
+
+   if (strcmp (name, tpcadcs::gen::Decoder.m_name) == 0)
+   {
+      return &tpcadcs::gen::Decoder;
+   }
+
+   if (strcmp (name, tpcadcs::avx2::Decoder.m_name) == 0)
+   {
+      if (__builtin_cpu_supports ("avx2")) return &tpcadcs::avx2::Decoder;
+      return NULL;
+   }
+
+   return NULL;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Select the decoder best suited to the executing cpu
+  \return The selected decoder
+
+   If the environment variable PDD_TPCCOMPRESSED_DECODER is set to one
+   of serial, gen or avx2 and that variant is supported by the executing
+   cpu, it is used.  Otherwise avx2 is used if supported, else serial.
+   The scalar lockstep decoder, gen, is not the fallback; its symbol
+   loop is limited by branch mispredictions, not latency, so it gains
+   nothing over the serial decoder.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcAdcsDecoder const *TpcAdcsDecoder::select ()
+{
+   char const *name = getenv ("PDD_TPCCOMPRESSED_DECODER");
+   if (name)
+   {
+      TpcAdcsDecoder const *d = locate (name);
+      if (d) return d;
+
+      fprintf (stderr,
+               "PDD_TPCCOMPRESSED_DECODER=%s is not a supported variant, "
+               "ignoring\n",
+               name);
+   }
+
+   __builtin_cpu_init ();
+   if (__builtin_cpu_supports ("avx2")) return &tpcadcs::avx2::Decoder;
+
+   return &tpcadcs::serial::Decoder;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the name of the decoder in use
+  \return The name of the decoder in use, serial, gen or avx2
+                                                                          */
+/* ---------------------------------------------------------------------- */
+char const *TpcCompressed::getDecoder ()
+{
+   return decoder ().m_name;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Override the selection of the decoder
+  \retval true,  if successful
+  \retval false, if \a name is not a known variant or is not supported
+                 by the executing cpu. The selection is left unchanged.
+
+  \param[in] name The name of the decoder, serial, gen or avx2
+
+   All the decoders produce identical output, this is intended for
+   testing and benchmarking.  It should not be called while any other
+   thread is decompressing.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcCompressed::selectDecoder (char const *name)
+{
+   TpcAdcsDecoder const *d = TpcAdcsDecoder::locate (name);
+   if (d == NULL) return false;
+
+   Decoder = d;
+   return true;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the number of channels the decoder in use decodes in
+          lockstep
+  \return The number of channels decoded in lockstep
+
+   Callers dividing a packet's channels into groups, e.g. for
+   decompressChannels, should use multiples of this.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcCompressed::getNInterleaved ()
+{
+   return decoder ().m_nlanes;
+}
+/* ---------------------------------------------------------------------- */
+/* END: DECODER SELECTION                                                 */
+/* ====================================================================== */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class DecompressCtx
+  \brief The context needed to decompress one packet's channels,
+         one group of channels per WorkerPool task.
+
+   Only one of m_adcs or m_chans is used.  If m_adcs is non-NULL,
+   channel ichan is decompressed into m_adcs + ichan * m_nadcs, else
+   into m_chans[ichan] + m_nadcs.  If m_ichans is non-NULL, only the
+   channels it lists are decompressed, the n'th of these being stored
+   as if it were channel n.  If m_fadcs is non-NULL, it replaces m_adcs
+   as the destination, the channels being converted to floats using
+   m_peds and m_gains.  If m_stream is true, the contigious int16_t
+   destination is written with non-temporal stores.  If m_stats is
+   non-NULL, channel ichan's ADCs are added to m_stats[ichan].
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class DecompressCtx
+{
+public:
+   DecompressCtx (TpcCompressed const  &cmp,
+                  int16_t             *adcs,
+                  int16_t     *const *chans,
+                  int                 nadcs,
+                  int               begTick,
+                  int                nticks,
+                  int const         *ichans = NULL,
+                  int                nchans = 0) :
+      m_cmp       (cmp),
+      m_adcs      (adcs),
+      m_chans     (chans),
+      m_nadcs     (nadcs),
+      m_begTick   (begTick),
+      m_nticks    (nticks),
+      m_ichans    (ichans),
+      m_fadcs     (NULL),
+      m_peds      (NULL),
+      m_gains     (NULL),
+      m_stream    (false),
+      m_stats     (NULL),
+      m_nchannels (ichans ? nchans
+                          : TpcCompressedTocTrailer::getNChannels (cmp.getTocTrailer ())),
+      m_ngroup    (TpcCompressed::getNInterleaved ())
+   {
+      return;
+   }
+
+   int         getNTasks () const;
+   static void task      (void *ctx, int igroup);
+
+public:
+   TpcCompressed const    &m_cmp; /*!< The packet to decompress           */
+   int16_t               *m_adcs; /*!< Contigious destination or NULL     */
+   int16_t       *const *m_chans; /*!< Channel-by-channel destination     */
+   int                   m_nadcs; /*!< Channel stride or offset           */
+   int                 m_begTick; /*!< First tick to store                */
+   int                  m_nticks; /*!< Maximum number of ticks to store   */
+   int const           *m_ichans; /*!< The selected channels or NULL      */
+   float                *m_fadcs; /*!< Contigious float destination       */
+   float const           *m_peds; /*!< The pedestals, for m_fadcs         */
+   float const          *m_gains; /*!< The gains, for m_fadcs, or NULL    */
+   bool                 m_stream; /*!< Use non-temporal stores, m_adcs    */
+   AdcStats             *m_stats; /*!< The statistics, m_adcs, or NULL    */
+   int               m_nchannels; /*!< Number of channels                 */
+   int                  m_ngroup; /*!< Number of channels per task        */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the number of tasks, i.e. groups of channels
+  \return The number of tasks
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int DecompressCtx::getNTasks () const
+{
+   return (m_nchannels + m_ngroup - 1) / m_ngroup;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Decompress one group of channels, the WorkerPool task
+
+  \param[in]    ctx The decompression context, a DecompressCtx
+  \param[in] igroup The group of channels to decompress
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void DecompressCtx::task (void *ctx, int igroup)
+{
+   DecompressCtx const *dtx = reinterpret_cast<decltype (dtx)>(ctx);
+   int               ichan0 = igroup * dtx->m_ngroup;
+   int               nchans = dtx->m_nchannels - ichan0;
+   if (nchans > dtx->m_ngroup) nchans = dtx->m_ngroup;
+
+   if (dtx->m_fadcs)
+   {
+      float *fadcs[TpcAdcsDecoder::MaxLanes];
+      for (int idx = 0; idx < nchans; idx++)
+      {
+         fadcs[idx] = dtx->m_fadcs + (ichan0 + idx) * dtx->m_nadcs;
+      }
+
+      dtx->m_cmp.decompressChannels (fadcs, ichan0, nchans,
+                                     dtx->m_begTick, dtx->m_nticks,
+                                     dtx->m_peds,    dtx->m_gains);
+      return;
+   }
+
+   int16_t *adcs[TpcAdcsDecoder::MaxLanes];
+   for (int idx = 0; idx < nchans; idx++)
+   {
+      int ichan = ichan0 + idx;
+      adcs[idx] = dtx->m_adcs
+                ? dtx->m_adcs + ichan * dtx->m_nadcs
+                : dtx->m_chans[ichan] + dtx->m_nadcs;
+   }
+
+   if (dtx->m_ichans)
+   {
+      dtx->m_cmp.decompressChannels (adcs, dtx->m_ichans + ichan0, nchans,
+                                     dtx->m_begTick, dtx->m_nticks);
+   }
+   else if (dtx->m_stats)
+   {
+      dtx->m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                     dtx->m_begTick, dtx->m_nticks,
+                                     dtx->m_stats + ichan0);
+   }
+   else if (dtx->m_stream)
+   {
+      dtx->m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                     dtx->m_begTick, dtx->m_nticks, true);
+   }
+   else
+   {
+      dtx->m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                     dtx->m_begTick, dtx->m_nticks);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into a pseudo 2-D array of ADCs
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array to hold the decompressed ADCs
+   \param [in]  nadcs The number of elements to reserve for each channel,
+                      This is essentially the stride.
+   \param[in]  nticks The maximum number of ADCs to decode.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t       *adcs, 
+                                    int           nadcs,
+                                    int          nticks)
+{
+   return decompress (adcs, nadcs, 0, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
    \brief  Decompress into a pseudo 2-D array of ADCs
-   \retval == true if successful
-   \retval == false if not
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array to hold the decompressed ADCs
+   \param [in]  nadcs The number of elements to reserve for each channel,
+                      This is essentially the stride.
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t       *adcs, 
+                                    int           nadcs,
+                                    int         begTick,
+                                    int          nticks)
+{
+   DecompressCtx ctx (*this, adcs, NULL, nadcs, begTick, nticks);
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress the selected channels into a pseudo 2-D array of
+           ADCs
+   \return The number of ADCs stored for each channel
+
+   \param[out]     adcs The array to hold the decompressed ADCs
+   \param [in]    nadcs The number of elements to reserve for each
+                        selected channel, This is essentially the stride.
+   \param[in]   begTick The index of the first decoded ADC to store
+   \param[in]    nticks The maximum number of ADCs to decode.
+   \param[in]  chanMask The selected channels, bit n % 64 of
+                        chanMask[n / 64] for channel n
+
+   Only the selected channels are stored, one after the other in
+   increasing channel order, so the n'th selected channel goes to
+   adcs + n * nadcs.  The unselected channels are not decoded at all,
+   their bits being skipped by starting each selected channel at its
+   offset in the table of contents.  Selected channels that the packet
+   does not have are left untouched.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t       *adcs,
+                                    int           nadcs,
+                                    int         begTick,
+                                    int          nticks,
+                                    uint64_t const chanMask[2])
+{
+   int nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
+   if (nchannels > 128) nchannels = 128;
+
+   int ichans[128];
+   int nchans = 0;
+   for (int ichan = 0; ichan < nchannels; ichan++)
+   {
+      if ((chanMask[ichan >> 6] >> (ichan & 0x3f)) & 1) ichans[nchans++] = ichan;
+   }
+
+   DecompressCtx ctx (*this, adcs, NULL, nadcs, begTick, nticks, ichans, nchans);
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into a pseudo 2-D array of pedestal subtracted,
+           gain corrected floats
+   \return The number of values stored for each channel
+
+   \param[out]   adcs The array to hold the converted ADCs
+   \param [in]  nadcs The number of elements to reserve for each channel,
+                      This is essentially the stride.
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]    peds The pedestal of each channel
+   \param[in]   gains The gain of each channel.  If NULL, all the gains
+                      are taken as 1.
+
+   Channel n's values are (adc - peds[n]) * gains[n].  See the float
+   decompressChannels for how the conversion is fused with the decoding.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (float         *adcs,
+                                    int           nadcs,
+                                    int         begTick,
+                                    int          nticks,
+                                    float const   *peds,
+                                    float const  *gains)
+{
+   DecompressCtx ctx (*this, NULL, NULL, nadcs, begTick, nticks);
+   ctx.m_fadcs = adcs;
+   ctx.m_peds  = peds;
+   ctx.m_gains = gains;
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into a pseudo 2-D array of ADCs, optionally with
+           non-temporal stores
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array to hold the decompressed ADCs
+   \param [in]  nadcs The number of elements to reserve for each channel,
+                      This is essentially the stride.
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]  stream If true, the ADCs are stored with non-temporal
+                      stores, see the streaming decompressChannels
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t       *adcs,
+                                    int           nadcs,
+                                    int         begTick,
+                                    int          nticks,
+                                    bool         stream)
+{
+   DecompressCtx ctx (*this, adcs, NULL, nadcs, begTick, nticks);
+   ctx.m_stream = stream;
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into a pseudo 2-D array of ADCs, accumulating the
+           statistics of each channel
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array to hold the decompressed ADCs
+   \param [in]  nadcs The number of elements to reserve for each channel,
+                      This is essentially the stride.
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]   stats The statistics of each channel, channel n's ADCs
+                      being added to stats[n]
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t       *adcs,
+                                    int           nadcs,
+                                    int         begTick,
+                                    int          nticks,
+                                    AdcStats     *stats)
+{
+   DecompressCtx ctx (*this, adcs, NULL, nadcs, begTick, nticks);
+   ctx.m_stats = stats;
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+
+   \brief  Decompress into an array channel specific pointers to each array ADCs
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array pointers to each channels ADC array
+   \param [in]   iadc The index to store the first adc
+   \param[in]  nticks The maximum number of ADCs to decode.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t  *const *adcs, 
+                                    int              iadc,
+                                    int            nticks)
+{
+   return decompress (adcs, iadc, 0, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into an array channel specific pointers to each array ADCs
+   \return The number of ADCs stored for each channel
+
+   \param[out]   adcs The array pointers to each channels ADC array
+   \param [in]   iadc The index to store the first adc
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+uint32_t TpcCompressed::decompress (int16_t  *const *adcs, 
+                                    int              iadc,
+                                    int           begTick,
+                                    int            nticks)
+{
+   DecompressCtx ctx (*this, NULL, adcs, iadc, begTick, nticks);
+
+   WorkerPool::shared ().run (DecompressCtx::task, &ctx, ctx.getNTasks ());
+
+   return getNDecompressed (begTick, nticks);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress one channel
+   \return The bit position following the channel's decoded symbols.
 
-   \param[out]   adcs The array to hold the decompressed ADCs
-   \param [in]  nadcs The number of elements to reserve for each channel,
-                      This is essentially the stride.
+   \param[out]   adcs The array to receive the ADCs
+   \param[in]   ichan The channel to decompress
+   \param[in] begTick The index of the first decoded ADC to store
    \param[in]  nticks The maximum number of ADCs to decode.
+
+   This may be called concurrently for different channels.
                                                                           */
 /* ---------------------------------------------------------------------- */
-uint32_t TpcCompressed::decompress (int16_t       *adcs, 
-                                    int           nadcs,
-                                    int          nticks)
+uint32_t TpcCompressed::decompressChannel (int16_t  *adcs,
+                                           int      ichan,
+                                           int    begTick,
+                                           int     nticks) const
 {
-
-   int           nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
    int            nsamples = TpcCompressedTocTrailer::getNSamples  (m_tocTlr);
    uint32_t const *offsets = TpcCompressedTocTrailer::getOffsets   (m_tocTlr);
-   unsigned int        n64 = m_n64;
    uint64_t const     *buf = reinterpret_cast<decltype(buf)>(m_hdr);
-   uint32_t           next = (m_w64 - buf) * 64;
-   int             endTick = nticks;
-   bool            printit = false;
+   int             endTick = begTick + nticks;
+
+   return chan_decode (adcs, buf, m_n64, offsets[ichan],
+                       begTick, endTick, nsamples, false);
+}
+/* ---------------------------------------------------------------------- */
+
 
-   for (int ichan = 0; ichan < nchannels; ichan++)
-   {
-      uint32_t position = offsets[ichan]; 
 
-      ///Value = BegValue;
-      if (printit) announce (ichan, next, position);
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress a group of consecutive channels
+ 
+   \param[out]   adcs The arrays to receive the ADCs, adcs[idx] receives
+                      channel ichan + idx
+   \param[in]   ichan The first channel to decompress
+   \param[in]  nchans The number of channels to decompress
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+
+   The channels are decoded in lockstep by the selected interleaved
+   decoder, see selectDecoder.  The output is identical to that of
+   decompressChannel.  This may be called concurrently for different
+   channels.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcCompressed::decompressChannels (int16_t *const *adcs,
+                                        int            ichan,
+                                        int           nchans,
+                                        int          begTick,
+                                        int           nticks) const
+{
+   int ichans[TpcAdcsDecoder::MaxLanes];
 
-      next  = chan_decode (adcs, buf, n64, position, 0, endTick, nsamples, printit);
-      adcs += nadcs;
+   for (int idx = 0; idx < nchans; idx += TpcAdcsDecoder::MaxLanes)
+   {
+      int n = nchans - idx;
+      if (n > TpcAdcsDecoder::MaxLanes) n = TpcAdcsDecoder::MaxLanes;
+
+      for (int ilane = 0; ilane < n; ilane++) ichans[ilane] = ichan + idx + ilane;
+      decompressChannels (adcs + idx, ichans, n, begTick, nticks);
    }
 
-   ///BegValue = Value;
-   int over     = nsamples - nticks;
-   if (over >= 0) nsamples -= over;
-   return nsamples;
+   return;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -298,48 +970,132 @@ uint32_t TpcCompressed::decompress (int16_t       *adcs,
 
 /* ---------------------------------------------------------------------- *//*!
 
-   \brief  Decompress into a pseudo 2-D array of ADCs
-   \retval == true if successful
-   \retval == false if not
+   \brief  Decompress a list of channels
+ 
+   \param[out]   adcs The arrays to receive the ADCs, adcs[idx] receives
+                      channel ichans[idx]
+   \param[in]  ichans The channels to decompress
+   \param[in]  nchans The number of channels to decompress
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
 
-   \param[out]   adcs The array to hold the decompressed ADCs
-   \param [in]  nadcs The number of elements to reserve for each channel,
-                      This is essentially the stride.
+   As for the consecutive channels, the channels are decoded in lockstep
+   and the output is identical to that of decompressChannel.  Each
+   channel is located by its offset in the table of contents, so the
+   channels that are not listed cost nothing.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcCompressed::decompressChannels (int16_t *const *adcs,
+                                        int const    *ichans,
+                                        int           nchans,
+                                        int          begTick,
+                                        int           nticks) const
+{
+   TpcAdcsDecoder const    &dec = decoder ();
+   int             nsamples = TpcCompressedTocTrailer::getNSamples  (m_tocTlr);
+   uint32_t const  *offsets = TpcCompressedTocTrailer::getOffsets   (m_tocTlr);
+   uint64_t const      *buf = reinterpret_cast<decltype(buf)>(m_hdr);
+   int              endTick = begTick + nticks;
+
+   TpcAdcsDecoder::Lane lanes[TpcAdcsDecoder::MaxLanes];
+
+   for (int idx = 0; idx < nchans; idx += dec.m_nlanes)
+   {
+      int nlanes = nchans - idx;
+      if (nlanes > dec.m_nlanes) nlanes = dec.m_nlanes;
+
+      // Decode each channel's table header
+      for (int ilane = 0; ilane < nlanes; ilane++)
+      {
+         TpcAdcsDecoder::Lane &lane = lanes[ilane];
+         int               position = offsets[ichans[idx + ilane]];
+         int                  nbins;
+         int                    adc;
+         int                novrflw;
+         BFU                    bfu;
+
+         _bfu_put (bfu, buf[position>>6], position);
+         lane.m_ovrpos  = table_decode (lane.m_table, &nbins, &adc, &novrflw,
+                                        nsamples, bfu, buf, false);
+         lane.m_adcs    = adcs[idx + ilane];
+         lane.m_adc0    = adc;
+         lane.m_novrflw = novrflw;
+      }
+
+      dec.m_decode (lanes, nlanes, buf, begTick, endTick, nsamples);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress a group of consecutive channels into pedestal
+           subtracted, gain corrected floats
+ 
+   \param[out]   adcs The arrays to receive the values, adcs[idx] receives
+                      channel ichan + idx
+   \param[in]   ichan The first channel to decompress
+   \param[in]  nchans The number of channels to decompress
    \param[in] begTick The index of the first decoded ADC to store
    \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]    peds The pedestals, indexed by channel number
+   \param[in]   gains The gains, indexed by channel number.  If NULL,
+                      all the gains are taken as 1.
+
+   The channels are decoded, as by the int16_t version, into a buffer of
+   at most TpcAdcsDecoder::MaxLanes channels of one packet, small enough
+   to stay in the cache, and converted from there.  The int16_t values
+   are never written to the destination, saving the consumer a second
+   pass over it.
                                                                           */
 /* ---------------------------------------------------------------------- */
-uint32_t TpcCompressed::decompress (int16_t       *adcs, 
-                                    int           nadcs,
-                                    int         begTick,
-                                    int          nticks)
+void TpcCompressed::decompressChannels (float   *const *adcs,
+                                        int            ichan,
+                                        int           nchans,
+                                        int          begTick,
+                                        int           nticks,
+                                        float const    *peds,
+                                        float const   *gains) const
 {
+   int nadcs = getNDecompressed (begTick, nticks);
+   if (nadcs <= 0) return;
 
-   int           nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
-   int            nsamples = TpcCompressedTocTrailer::getNSamples  (m_tocTlr);
-   uint32_t const *offsets = TpcCompressedTocTrailer::getOffsets   (m_tocTlr);
-   unsigned int        n64 = m_n64;
-   uint64_t const     *buf = reinterpret_cast<decltype(buf)>(m_hdr);
-   uint32_t           next = (m_w64 - buf) * 64;
-   int             endTick = begTick + nticks;
-   bool            printit = false;
+   std::vector<int16_t> buf (static_cast<size_t>(TpcAdcsDecoder::MaxLanes) * nadcs);
+   int16_t *lanes[TpcAdcsDecoder::MaxLanes];
 
-   for (int ichan = 0; ichan < nchannels; ichan++)
+   for (int ilane = 0; ilane < TpcAdcsDecoder::MaxLanes; ilane++)
+   {
+      lanes[ilane] = buf.data () + ilane * nadcs;
+   }
+
+   for (int idx = 0; idx < nchans; idx += TpcAdcsDecoder::MaxLanes)
    {
-      uint32_t position = offsets[ichan]; 
+      int nlanes = nchans - idx;
+      if (nlanes > TpcAdcsDecoder::MaxLanes) nlanes = TpcAdcsDecoder::MaxLanes;
+
+      decompressChannels (lanes, ichan + idx, nlanes, begTick, nticks);
 
-      if (printit) announce (ichan, next, position);
+      for (int ilane = 0; ilane < nlanes; ilane++)
+      {
+         int            jchan = ichan + idx + ilane;
+         float          ped   = peds[jchan];
+         float          gain  = gains ? gains[jchan] : 1.0f;
+         float         *dst   = adcs[idx + ilane];
+         int16_t const *src   = lanes[ilane];
 
-      ///Value = BegValue;
-      next  = chan_decode (adcs, buf, n64, position, begTick, endTick, nsamples, printit);
-      adcs += nadcs;
+         for (int iadc = 0; iadc < nadcs; iadc++)
+         {
+            dst[iadc] = (src[iadc] - ped) * gain;
+         }
+      }
    }
 
-   ///BegValue = Value;
-   nsamples    -= begTick;
-   int over     = nsamples - nticks;
-   if (over >= 0) nsamples -= over;
-   return nsamples;
+   return;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -348,45 +1104,104 @@ uint32_t TpcCompressed::decompress (int16_t       *adcs,
 
 /* ---------------------------------------------------------------------- *//*!
 
+   \brief  Copies ADCs to their destination with non-temporal stores
 
-   \brief  Decompress into an array channel specific pointers to each array ADCs
-   \retval == true if successful
-   \retval == false if not
+   \param[out]   dst  The destination
+   \param[in]    src  The source
+   \param[in]  nadcs  The number of ADCs to copy
 
-   \param[out]   adcs The array pointers to each channels ADC array
-   \param [in]   iadc The index to store the first adc
+   \par
+    The ADCs before the first 16 byte boundary of the destination and
+    any after the last are stored normally.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void stream_adcs (int16_t        *dst,
+                                int16_t const  *src,
+                                int           nadcs)
+{
+   while (nadcs > 0 && (reinterpret_cast<uintptr_t>(dst) & 0xf))
+   {
+      *dst++ = *src++;
+      nadcs -= 1;
+   }
+
+   for (; nadcs >= 8; nadcs -= 8, dst += 8, src += 8)
+   {
+      __m128i v = _mm_loadu_si128 (reinterpret_cast<__m128i const *>(src));
+      _mm_stream_si128 (reinterpret_cast<__m128i *>(dst), v);
+   }
+
+   while (nadcs-- > 0) *dst++ = *src++;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress a group of consecutive channels, optionally with
+           non-temporal stores
+ 
+   \param[out]   adcs The arrays to receive the ADCs, adcs[idx] receives
+                      channel ichan + idx
+   \param[in]   ichan The first channel to decompress
+   \param[in]  nchans The number of channels to decompress
+   \param[in] begTick The index of the first decoded ADC to store
    \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]  stream If true, the ADCs are stored with non-temporal
+                      stores
+
+   The interleaved decoders store the channels a few ADCs at a time,
+   each channel in a different place, which is no pattern to stream.
+   So, as for the floats, the channels are decoded into a cache
+   resident buffer of at most TpcAdcsDecoder::MaxLanes channels and
+   then each is streamed to its destination as one contiguous run.
+   The destination then never enters the cache, which keeps it from
+   evicting what the other cores are working on.  The stores are
+   fenced before returning.
                                                                           */
 /* ---------------------------------------------------------------------- */
-uint32_t TpcCompressed::decompress (int16_t  *const *adcs, 
-                                    int              iadc,
-                                    int            nticks)
+void TpcCompressed::decompressChannels (int16_t *const *adcs,
+                                        int            ichan,
+                                        int           nchans,
+                                        int          begTick,
+                                        int           nticks,
+                                        bool          stream) const
 {
+   if (!stream)
+   {
+      decompressChannels (adcs, ichan, nchans, begTick, nticks);
+      return;
+   }
 
-   int           nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
-   int            nsamples = TpcCompressedTocTrailer::getNSamples  (m_tocTlr);
-   uint32_t const *offsets = TpcCompressedTocTrailer::getOffsets   (m_tocTlr);
-   unsigned int        n64 = m_n64;
-   uint64_t const     *buf = reinterpret_cast<decltype(buf)>(m_hdr);
-   uint32_t           next = (m_w64 - buf) * 64;
-   int             endTick = nticks;
-   bool            printit = false;
+   int nadcs = getNDecompressed (begTick, nticks);
+   if (nadcs <= 0) return;
 
-   for (int ichan = 0; ichan < nchannels; ichan++)
+   std::vector<int16_t> buf (static_cast<size_t>(TpcAdcsDecoder::MaxLanes) * nadcs);
+   int16_t *lanes[TpcAdcsDecoder::MaxLanes];
+
+   for (int ilane = 0; ilane < TpcAdcsDecoder::MaxLanes; ilane++)
+   {
+      lanes[ilane] = buf.data () + ilane * nadcs;
+   }
+
+   for (int idx = 0; idx < nchans; idx += TpcAdcsDecoder::MaxLanes)
    {
-      uint32_t position = offsets[ichan]; 
+      int nlanes = nchans - idx;
+      if (nlanes > TpcAdcsDecoder::MaxLanes) nlanes = TpcAdcsDecoder::MaxLanes;
 
-      ///Value = BegValue;
-      if (printit) announce (ichan, next, position);
+      decompressChannels (lanes, ichan + idx, nlanes, begTick, nticks);
 
-      next  = chan_decode (adcs[ichan]+iadc, buf, n64, position, 
-                           0,       endTick, nsamples, printit);
+      for (int ilane = 0; ilane < nlanes; ilane++)
+      {
+         stream_adcs (adcs[idx + ilane], lanes[ilane], nadcs);
+      }
    }
 
-   ///BegValue = Value;
-   int over     = nsamples - nticks;
-   if (over >= 0) nsamples -= over;
-   return nsamples;
+   _mm_sfence ();
+   return;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -394,43 +1209,143 @@ uint32_t TpcCompressed::decompress (int16_t  *const *adcs,
 
 /* ---------------------------------------------------------------------- *//*!
 
-   \brief  Decompress into an array channel specific pointers to each array ADCs
-   \retval == true if successful
-   \retval == false if not
-
-   \param[out]   adcs The array pointers to each channels ADC array
-   \param [in]   iadc The index to store the first adc
+   \brief  Decompress a group of consecutive channels, accumulating their
+           statistics
+ 
+   \param[out]   adcs The arrays to receive the ADCs, adcs[idx] receives
+                      channel ichan + idx
+   \param[in]   ichan The first channel to decompress
+   \param[in]  nchans The number of channels to decompress
    \param[in] begTick The index of the first decoded ADC to store
    \param[in]  nticks The maximum number of ADCs to decode.
+   \param[in]   stats The statistics, stats[idx] being those of channel
+                      ichan + idx.  These are added to, not reset.
+
+   The interleaved decoders keep their lanes' state in vector registers,
+   with no room to spare, so the statistics are not gathered by the
+   decoder itself.  Instead the channels are decoded at most
+   TpcAdcsDecoder::MaxLanes at a time, one packet's worth each, and
+   each channel's statistics are accumulated straight from its
+   destination while it is still in the cache.
                                                                           */
 /* ---------------------------------------------------------------------- */
-uint32_t TpcCompressed::decompress (int16_t  *const *adcs, 
-                                    int              iadc,
-                                    int           begTick,
-                                    int            nticks)
+void TpcCompressed::decompressChannels (int16_t *const *adcs,
+                                        int            ichan,
+                                        int           nchans,
+                                        int          begTick,
+                                        int           nticks,
+                                        AdcStats      *stats) const
 {
+   int nadcs = getNDecompressed (begTick, nticks);
+   if (nadcs <= 0) return;
 
-   int           nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
-   int            nsamples = TpcCompressedTocTrailer::getNSamples  (m_tocTlr);
-   uint32_t const *offsets = TpcCompressedTocTrailer::getOffsets   (m_tocTlr);
-   unsigned int        n64 = m_n64;
-   uint64_t const     *buf = reinterpret_cast<decltype(buf)>(m_hdr);
-   uint32_t           next = (m_w64 - buf) * 64;
-   int             endTick = begTick + nticks;
-   bool            printit = false;
-
-   for (int ichan = 0; ichan < nchannels; ichan++)
+   for (int idx = 0; idx < nchans; idx += TpcAdcsDecoder::MaxLanes)
    {
-      uint32_t position = offsets[ichan]; 
+      int nlanes = nchans - idx;
+      if (nlanes > TpcAdcsDecoder::MaxLanes) nlanes = TpcAdcsDecoder::MaxLanes;
+
+      decompressChannels (adcs + idx, ichan + idx, nlanes, begTick, nticks);
+
+      for (int ilane = 0; ilane < nlanes; ilane++)
+      {
+         stats[idx + ilane].accumulate (adcs[idx + ilane], nadcs);
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
 
-      if (printit) announce (ichan, next, position);
 
-      ///Value = BegValue;
-      next  = chan_decode (adcs[ichan] + iadc, buf, n64, position, 
-                           begTick,   endTick, nsamples, printit);
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Decompress into WibFrames, reconstructing both the headers
+           and the packed ADCs
+   \return The number of frames stored
+
+   \param[out] frames The array of WibFrames, 30 64-bit words each
+   \param[in]   itick The index of the first frame to store
+   \param[in]  nticks The maximum number of frames to store.
+
+   The headers are rebuilt from the seeds and exceptions of the header
+   record by TpcCompressedWibHdrs and the channels are decompressed, as
+   by decompress, and then packed into the frames.  The frames are those
+   of the original stream, save that their cold data checksum fields are
+   0.  Only the seeds and the words of the exception frames are kept, so
+   between exceptions the rebuilt cold data words would otherwise carry
+   the checksums of an earlier frame.  Missing channels, should the
+   packet have fewer than 128, are stored as 0.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcCompressed::decompressWibFrames (uint64_t *frames,
+                                        int        itick,
+                                        int       nticks)
+{
+   int nframes = getNDecompressed (itick, nticks);
+   if (nframes <= 0) return 0;
+
+
+   // ------------------------------------------------------------
+   // Decompress the channels, all 128 rows being present to pack
+   // ------------------------------------------------------------
+   int       nchannels = TpcCompressedTocTrailer::getNChannels (m_tocTlr);
+   int           nrows = nchannels > 128 ? nchannels : 128;
+   std::vector<int16_t> adcs (static_cast<size_t>(nrows) * nframes, 0);
+
+   decompress (adcs.data (), nframes, itick, nframes);
+
+
+   // ----------------------------------------------------------
+   // Rebuild the headers, the exceptions before itick included
+   // ----------------------------------------------------------
+   TpcCompressedWibHdrs hdrs (m_hdr);
+   hdrs.advance (itick);
+
+   uint64_t const cksums =
+            static_cast<uint64_t>(WibColdData::Mask0::CheckSums)
+         << static_cast<int>     (WibColdData::Offset0::CheckSums);
+
+   int const nwords = sizeof (WibFrame) / sizeof (uint64_t);
+   uint64_t   *frame = frames;
+   for (int iframe = 0; iframe < nframes; iframe++, frame += nwords)
+   {
+      memset       (frame, 0, sizeof (WibFrame));
+      hdrs.fill    (frame);
+      hdrs.advance (1);
+
+      // The checksums of the 2 cold data links
+      frame[ 2] &= ~cksums;
+      frame[16] &= ~cksums;
    }
 
-   ///BegValue = Value;
+   WibFrame::packAdcs128xN (reinterpret_cast<WibFrame *>(frames), nframes,
+                            adcs.data (), nframes);
+
+   return nframes;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Return the number of ADCs per channel that decompress with
+           the same \a begTick and \a nticks would return.
+   \return The number of ADCs per channel
+
+   \param[in] begTick The index of the first decoded ADC to store
+   \param[in]  nticks The maximum number of ADCs to decode.
+
+   This is computed from the table of contents, no decoding is done.
+   This allows the destinations of a sequence of packets to be laid
+   out before any of them are decompressed.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcCompressed::getNDecompressed (int begTick, int nticks) const
+{
+   int nsamples = TpcCompressedTocTrailer::getNSamples (m_tocTlr);
+
    nsamples    -= begTick;
    int over     = nsamples - nticks;
    if (over >= 0) nsamples -= over;
@@ -440,6 +1355,38 @@ uint32_t TpcCompressed::decompress (int16_t  *const *adcs,
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Set the number of threads used to decompress
+
+   \param[in] nthreads  The total number of threads, including the
+                        calling thread.  1, the default, decompresses
+                        serially in the calling thread.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcCompressed::setNThreads (int nthreads)
+{
+   WorkerPool::shared ().resize (nthreads);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Return the number of threads used to decompress
+   \return The number of threads used to decompress
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcCompressed::getNThreads ()
+{
+   return WorkerPool::shared ().getNThreads ();
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 
 /* ---------------------------------------------------------------------- */
 static int chan_decode (int16_t       *adcs,
@@ -580,6 +1527,17 @@ static int inline adcs_decode (int16_t         *adcs,
    int sympos   = ovrpos +   nobits;
    int sym      = adc;
 
+   // The table serves every symbol of the channel, so, unless it is
+   // small enough to be searched quickly, it pays to replace searching
+   // it by a direct lookup
+   APD_lut_t           lut[APD_K_LUT_SIZE];
+   APD_lut_t const   *plut = NULL;
+   if (nbins >= APD_K_LUT_MINBINS)
+   {
+      APD_lut_build (lut, table);
+      plut = lut;
+   }
+
    APD_start (&dtx, buf, sympos);
 
    for (int idy = 0; ; idy++)
@@ -599,7 +1557,8 @@ static int inline adcs_decode (int16_t         *adcs,
          break;
       }
 
-      sym = APD_decode (&dtx, table);
+      sym = plut ? APD_decode_lut (&dtx, table, plut)
+                 : APD_decode     (&dtx, table);
       if (sym == 0)
       {
          // Have overflow
@@ -654,101 +1613,149 @@ static void print_decoded (uint16_t sym, int idy)
 
 
 
-#if 0
-static int   header_decode (uint64_t *headers, uint32_t *status, uint64_t const *buf, int nbuf)
-{
-   // -------------------------------------------------------------------------------
-   // Compose the record header word
-   //    status(32) | exception count(8) | length (16) | RecType(4) | HeaderFormat(4)
-   // -------------------------------------------------------------------------------
-   uint64_t recHdr = buf[0];
-   int      hdrFmt = (recHdr >>  0) & 0xf;
-   int      recTyp = (recHdr >>  4) & 0xf;
-   int      recLen = (recHdr >>  8) & 0xffff;
-   int      excCnt = (recHdr >> 24) & 0xff;
-           *status = (recHdr >> 32);
-
-   uint16_t const *excBuf = reinterpret_cast<decltype(excBuf)>(buf + 1);
-   uint64_t const *hdrBuf = reinterpret_cast<decltype(hdrBuf)>(excBuf) + excCnt;
-   uint64_t        lastts = buf[recLen - 1];
-
-   int nhdrs   = 6;
-   uint64_t prv[6];
-   headers[0] = prv[0] = *hdrBuf++;
-   headers[1] = prv[1] = *hdrBuf++;
-   lastts     =          *hdrBuf++;
-   headers[2] = prv[2] = *hdrBuf++;
-   headers[3] = prv[3] = *hdrBuf++;
-   headers[4] = prv[4] = *hdrBuf++;
-   headers[5] = prv[5] = *hdrBuf++;
-
-   std::cout 
-   << "Header Record:"
-   <<               "Format   = " << std::setw ( 8) << std::hex <<  hdrFmt    << std::endl
-   << "              RecType  = " << std::setw ( 8) << std::hex <<  recTyp    << std::endl
-   << "              RecLen   = " << std::setw ( 8) << std::hex <<  recLen    << std::endl
-   << "              ExcCnt   = " << std::setw ( 8) << std::hex <<  excCnt    << std::endl
-   << "              Status   = " << std::setw ( 8) << std::hex << *status    << std::endl
-   << "              Wib0     = " << std::setw (16) << std::hex <<  headers[0]<< std::endl
-   << "              Wib01    = " << std::setw (16) << std::hex <<  headers[1]<< std::endl
-   << "              Cd00     = " << std::setw (16) << std::hex <<  headers[2]<< std::endl
-   << "              Cd01     = " << std::setw (16) << std::hex <<  headers[3]<< std::endl
-   << "              Cd10     = " << std::setw (16) << std::hex <<  headers[4]<< std::endl
-   << "              Cd11     = " << std::setw (16) << std::hex <<  headers[5]<< std::endl
-   << "              LastTs   = " << std::setw (16) << std::hex <<  lastts    << std::endl;
-
-
-   // Decode the exception frames
-   for (int idx = 0; idx <= 4*excCnt; idx++)
-   {
-      uint16_t exception = *excBuf++;
+/* ====================================================================== */
+/* TpcCompressedWibHdrs                                                   */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor, positioned at the first frame of the packet
+
+  \param[in] hdr  The TPC Compressed Header record
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcCompressedWibHdrs::TpcCompressedWibHdrs (pdd::record::TpcCompressedHdr
+                                                                const *hdr)
+{
+   TpcCompressedHdrBody body (hdr);
+
+   m_words[Wib0]       = body.getWib0            ();
+   m_words[Timestamp]  = body.getWibBegTimestamp ();
+   m_words[ColdData00] = body.getColdData00      ();
+   m_words[ColdData01] = body.getColdData01      ();
+   m_words[ColdData10] = body.getColdData10      ();
+   m_words[ColdData11] = body.getColdData11      ();
+
+   // Each 64-bit exception word holds 4 exceptions
+   m_exc    = body.locateExcs ();
+   m_excEnd = m_exc + 4 * body.getNExcWrds ();
+   m_hdr    = body.locateHdrs ();
+   m_hdrEnd = m_hdr + body.getNHdrWrds ();
+   m_frame  = 0;
+
+   // The seeds are the first frame's words, but honor any exception
+   advance (0);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the number of the frame of the next exception
+  \return The frame number or -1 if there are no more exceptions
+
+  \par
+   All the frames before it follow the predictions from the current
+   frame.  The list of exceptions ends either with the last exception
+   word or with a 0, a frame without a mask.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcCompressedWibHdrs::getNextException () const
+{
+   if (m_exc >= m_excEnd || *m_exc == 0) return -1;
+   return TpcCompressedHdrBody::getWibExcFrame (*m_exc);
+}
+/* ---------------------------------------------------------------------- */
+
+
 
-      if (exception == 0) break;
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Advances the header words by the predicted increments
+
+  \param[in] nframes  The number of frames to advance
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void TpcCompressedWibHdrs::predict (int nframes)
+{
+   // The convert counts are the top 16 bits, so they wrap by themselves
+   uint64_t cvtcnts = static_cast<uint64_t>(nframes) << 48;
 
-      uint16_t     frame = exception & 0xffff;
-      uint16_t      mask = exception >> 10;
-      uint64_t       hdr;
+   m_words[Timestamp]  += 25 * static_cast<uint64_t>(nframes);
+   m_words[ColdData00] += cvtcnts;
+   m_words[ColdData10] += cvtcnts;
+   m_frame             += nframes;
 
-      // Header word 0, all static fields
-      if (mask &  0x1) hdr = *hdrBuf++;
-      else             hdr =  prv[0];
-      headers[nhdrs++]     =  prv[0] = hdr;
+   return;
+}
+/* ---------------------------------------------------------------------- */
 
 
-      // Header word 1, Timestamp, increment by 25 counts
-      if (mask &  0x2) hdr = *hdrBuf++;
-      else             hdr =  prv[1] + 25;
-      headers[nhdrs++]     =  prv[1] = hdr;
 
+/* ---------------------------------------------------------------------- *//*!
 
-      // Header word 2, Cold data convert count, increment by 1
-      if (mask &  0x4) hdr = *hdrBuf++;
-      else             hdr =  prv[2] + (1LL << 48);
-      headers[nhdrs++]     =  prv[2] = hdr;
+  \brief Advances to a later frame, applying the exceptions on the way
 
+  \param[in] nframes  The number of frames to advance
 
-      // Header word 3, Cold data static fields
-      if (mask &  0x8) hdr = *hdrBuf++;
-      else             hdr = prv[3];
-      headers[nhdrs++]     = prv[3] = hdr;
+  \par
+   The cost is proportional to the number of exceptions passed, not to
+   the number of frames, so runs of frames following the predictions
+   are skipped at no cost.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcCompressedWibHdrs::advance (int nframes)
+{
+   int target = m_frame + nframes;
 
+   while (m_exc < m_excEnd && *m_exc)
+   {
+      uint16_t exception = *m_exc;
+      int          frame = TpcCompressedHdrBody::getWibExcFrame (exception);
+      if (frame > target) break;
 
-      // Header word 4, Cold data convert count, increment by 1
-      if (mask & 0x10) hdr = *hdrBuf++;
-      else             hdr = prv[4] + (1LL << 48);
-      headers[nhdrs++]     = prv[4] = hdr;
+      if (frame > m_frame) predict (frame - m_frame);
 
+      unsigned int  mask = TpcCompressedHdrBody::getWibExcMask  (exception);
+      for (int idx = 0; mask; idx++, mask >>= 1)
+      {
+         // A truncated list of header words leaves the prediction
+         if ((mask & 1) && m_hdr < m_hdrEnd) m_words[idx] = *m_hdr++;
+      }
 
-      // Header word 4, Cold data static fields
-      if (mask & 0x20) hdr = *hdrBuf++;
-      else             hdr = prv[5];
-      headers[nhdrs++]     = prv[5] = hdr;
+      m_exc += 1;
    }
 
-   return recLen;
+   predict (target - m_frame);
+   return;
 }
 /* ---------------------------------------------------------------------- */
-#endif
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Stores the current header words in a WIB frame
+
+  \param[out] frame  The 30 64-bit words of the WIB frame. Only the
+                     header words are written, the ADCs are untouched.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcCompressedWibHdrs::fill (uint64_t *frame) const
+{
+   // The WIB words, then the 2 cold data links of 14 words each
+   frame[ 0] = m_words[Wib0];
+   frame[ 1] = m_words[Timestamp];
+   frame[ 2] = m_words[ColdData00];
+   frame[ 3] = m_words[ColdData01];
+   frame[16] = m_words[ColdData10];
+   frame[17] = m_words[ColdData11];
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* TpcCompressedWibHdrs                                                   */
+/* ====================================================================== */
 
 
 
@@ -25,6 +25,7 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added getMultiChannelData, unpacking all the streams
    2016.10.06 jjr Changed method void Print () -> void print () const
    2017.08.29 jjr Created
   
@@ -34,7 +35,9 @@
 #include "dam/TpcFragmentUnpack.hh"
 #include "dam/DataFragmentUnpack.hh"
 #include "TpcStream-Impl.hh"
+#include "WorkerPool.hh"
 #include <cstddef>
+#include <atomic>
 
 
 
@@ -83,6 +86,164 @@ TpcStreamUnpack const *TpcFragmentUnpack::getStream (int istream) const
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \class FragmentPlan
+  \brief Where each stream of a fragment is to be unpacked to
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class FragmentPlan
+{
+public:
+   FragmentPlan (TpcFragmentUnpack const     *fragment,
+                 int16_t                         *adcs,
+                 int16_t                 *const *sadcs,
+                 int                            nticks,
+                 TpcFragmentUnpack::StreamStatus *status) :
+      m_fragment (fragment),
+      m_adcs     (adcs),
+      m_sadcs    (sadcs),
+      m_nticks   (nticks),
+      m_status   (status),
+      m_okay     (true)
+   {
+      return;
+   }
+
+   bool run (TpcFragmentUnpack::Executor *executor);
+
+private:
+   static void task (void *ctx, int istream);
+
+private:
+   TpcFragmentUnpack const         *m_fragment; /*!< The fragment         */
+   int16_t                             *m_adcs; /*!< Contiguous or NULL   */
+   int16_t                     *const *m_sadcs; /*!< Per stream or NULL   */
+   int                                m_nticks; /*!< Elements per channel */
+   TpcFragmentUnpack::StreamStatus   *m_status; /*!< Per stream or NULL   */
+   std::atomic<bool>                    m_okay; /*!< All streams okay     */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Unpack all the streams
+  \retval true,  if all the streams were successfully unpacked
+  \retval false, if not
+
+  \param[in] executor  The executor, if NULL, the library's pool
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool FragmentPlan::run (TpcFragmentUnpack::Executor *executor)
+{
+   int nstreams = m_fragment->getNStreams ();
+
+   if (executor) executor->run                      (task, this, nstreams);
+   else          pdd::access::WorkerPool::shared ().run (task, this, nstreams);
+
+   return m_okay;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Unpack one stream, the Executor task
+
+  \param[in]     ctx  The plan
+  \param[in] istream  The stream to unpack
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void FragmentPlan::task (void *ctx, int istream)
+{
+   FragmentPlan          *plan = reinterpret_cast<decltype (plan)>(ctx);
+   TpcStreamUnpack const  *tpc = plan->m_fragment->getStream (istream);
+   int                  nticks = plan->m_nticks;
+   int16_t               *adcs = plan->m_sadcs 
+                               ? plan->m_sadcs[istream]
+                               : plan->m_adcs + istream 
+                                              * tpc->getNChannels () * nticks;
+
+   bool    okay = tpc->getMultiChannelData (adcs, nticks);
+   if (!okay) plan->m_okay = false;
+
+   if (plan->m_status)
+   {
+      TpcFragmentUnpack::StreamStatus &status = plan->m_status[istream];
+      uint32_t                     available = tpc->getNTicks ();
+
+      uint32_t                     nunpacked = available < (uint32_t)nticks
+                                             ? available : nticks;
+
+      status.m_status    = tpc->getStatus ();
+      status.m_nticks    = available;
+      status.m_nunpacked = okay ? nunpacked : 0;
+      status.m_okay      = okay;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Unpack the trimmed data of all the streams into one 
+          contiguous array
+  \retval true,  if all the streams were successfully unpacked
+  \retval false, if not
+
+  \param[out]    adcs  The array, essentially
+                       [getNStreams () * NChannels][nticks]
+  \param[in]   nticks  The number of elements per channel
+  \param[out]  status  If not NULL, the result of each stream
+  \param[in] executor  The executor to run the streams on, if NULL,
+                       the library's pool.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcFragmentUnpack::getMultiChannelData (int16_t             *adcs,
+                                             int                 nticks,
+                                             StreamStatus       *status,
+                                             Executor         *executor) const
+{
+   FragmentPlan plan (this, adcs, NULL, nticks, status);
+   return       plan.run (executor);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Unpack the trimmed data of all the streams into per stream 
+          arrays
+  \retval true,  if all the streams were successfully unpacked
+  \retval false, if not
+
+  \param[out]    adcs  The arrays, adcs[istream] is essentially
+                       [NChannels][nticks]
+  \param[in]   nticks  The number of elements per channel
+  \param[out]  status  If not NULL, the result of each stream
+  \param[in] executor  The executor to run the streams on, if NULL,
+                       the library's pool.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcFragmentUnpack::getMultiChannelData (int16_t      *const *adcs,
+                                             int                 nticks,
+                                             StreamStatus       *status,
+                                             Executor         *executor) const
+{
+   FragmentPlan plan (this, NULL, adcs, nticks, status);
+   return       plan.run (executor);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief Routine to print at least some part of a Tpc Fragment.
@@ -26,6 +26,7 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt construct clears the derived quantities cache
    2017.10.09 jjr Moved some methods to TpcRecords-Inline.hh for better
                   performance while making them external here for external
                   users.
@@ -143,6 +144,8 @@ void TpcStream::construct (pdd::record::TpcStream const *stream)
    m_toc    = 0;
    m_packet = 0;
 
+   for (int idx = 0; idx < NCache64; idx++) m_cache[idx] = 0;
+
 
    // ----------------------------------------
    // Scan for the records in this data record
@@ -39,6 +39,25 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt transposeAndAssess hands each assessed block to the
+                  caller's Transpose hook instead of transposing it itself
+   2026.10.16 agt assessUntrimmed and assessTrimmed now also assess the
+                  compressed packets.  Their header words are expanded
+                  from the seeds and exceptions by TpcCompressedWibHdrs;
+                  the ADCs are not decompressed.
+   2026.10.16 agt Added the run length error records.  add now coalesces
+                  consecutive frames with the same errors into a Run and
+                  only keeps the per frame record if asked to.
+   2026.10.16 agt The runs of error free frames are skipped in bulk by 
+                  WibExpected::skip, using the vectorized 
+                  WibFrame::countInSequence.  Only the frames that it 
+                  stops at are evaluated one at a time.
+   2026.10.16 agt Added transposeAndAssess.  The frames are assessed and
+                  transposed block by block, so each frame is brought into
+                  the cache once rather than once for the assessment and
+                  once for the transpose.
+                  The cold data m_rsvd was never set, so ERR_M_CD_RSVD
+                  depended on whatever was on the stack.  It is now 0.
    2018.10.22 jjr Corrected printf formatting matching errors.
    2018.10.10 jjr Created
   
@@ -52,8 +71,10 @@
 #include "TpcRanges-Impl.hh"
 #include "TpcToc-Impl.hh"
 #include "TpcPacket-Impl.hh"
+#include "TpcCompressed-Impl.hh"
 
 #include <dam/access/WibFrame.hh>
+#include <dam/access/TpcCompressed.hh>
 
 #include <cstdint>
 #include <stdio.h>
@@ -78,6 +99,11 @@ public:
 
    void update ( uint64_t       timestamp,
                  uint16_t const cvtcnt[2]);
+
+   void advance (unsigned int     nframes);
+
+   unsigned int skip (pdd::access::WibFrame const *frames,
+                      unsigned int                nframes);
       
 public:
    uint64_t m_wibtimestamp; /*!< The predicted timestamp                  */
@@ -129,6 +155,156 @@ void WibExpected::update (uint64_t      timestamp,
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Skips the leading frames that have no errors, updating the
+          expected values past them
+  \return The number of frames skipped
+
+  \param[in]  frames  The frames
+  \param[in] nframes  The number of frames
+
+  \par
+   Since the error free frames produce no records, only the frame that
+   breaks the run need be evaluated by Record::evaluateAndUpdate.
+   Nothing is skipped until the predictions have been seeded.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+unsigned int WibExpected::skip (pdd::access::WibFrame const *frames,
+                                unsigned int                nframes)
+{
+   using namespace pdd::access;
+
+   if (!m_valid) return 0;
+
+   int n = WibFrame::countInSequence (frames, nframes, 
+                                      m_wibversion, m_wibid, m_wibtimestamp,
+                                      m_cvtcnt[0],  m_cvtcnt[1]);
+
+   advance (n);
+   return n;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Updates the expected values past frames that matched them
+
+  \param[in] nframes  The number of frames
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WibExpected::advance (unsigned int nframes)
+{
+   m_wibtimestamp += 25 * static_cast<uint64_t>(nframes);
+   m_cvtcnt[0]    += nframes;
+   m_cvtcnt[1]    += nframes;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Assesses the frames of a compressed packet
+  \return The number of frames in the packet
+
+  \param[in,out]   assessor  The assessor to add the error records to
+  \param[in,out]   expected  The expected values
+  \param[in,out] errSummary  The summary of the errors, updated
+  \param[in]           p64  The compressed packet
+  \param[in]           n64  Its length, in units of 64-bit words
+  \param[in]        pktNum  The packet number
+  \param[in]        smpNum  The sample number of the packet's first frame
+
+  \par
+   Only the header words are expanded, into an otherwise empty frame, so
+   the frames are evaluated exactly as those of an uncompressed packet.
+   The frames between an error free frame and the next exception follow
+   the predictions, so have no errors either, and are skipped.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static unsigned int assessCompressed (TpcStreamAssessor         *assessor,
+                                      WibExpected               *expected,
+                                      uint32_t                *errSummary,
+                                      uint64_t const                 *p64,
+                                      unsigned int                    n64,
+                                      unsigned int                 pktNum,
+                                      unsigned int                 smpNum)
+{
+   using namespace pdd::access;
+
+   TpcCompressed               cmp (p64, n64);
+   TpcCompressedTocTrailer     tlr (cmp.getTocTrailer ());
+   TpcCompressedWibHdrs       hdrs (cmp.getHdr ());
+   unsigned int            nframes = tlr.getNSamples ();
+
+   uint64_t w64[sizeof (WibFrame) / sizeof (uint64_t)] = { 0 };
+   WibFrame const          &wf = *reinterpret_cast<WibFrame const *>(w64);
+
+   unsigned int iwf = 0;
+   while (1)
+   {
+      hdrs.fill (w64);
+
+      TpcStreamAssessor::Record      rec;
+      TpcStreamAssessor::Record::Error_t 
+                         errs = rec.evaluateAndUpdate (expected, wf);
+      if (errs)
+      {
+         *errSummary |= errs;
+         rec.m_smpNum = smpNum + iwf;
+         rec.m_pktNum = pktNum;
+         rec.m_frmNum = iwf;
+         assessor->add (std::move (rec));
+      }
+
+
+      // ------------------------------------------------
+      // Skip the error free frames up to the next change
+      // ------------------------------------------------
+      unsigned int next = iwf + 1;
+      if (errs == 0)
+      {
+         int exc = hdrs.getNextException ();
+         if (exc < 0 || (unsigned int)exc > nframes) next = nframes;
+         else if ((unsigned int)exc > next)          next = exc;
+
+         expected->advance (next - iwf - 1);
+      }
+
+      if (next >= nframes) break;
+
+      hdrs.advance (next - iwf);
+      iwf = next;
+   }
+
+   return nframes;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  TpcStreamAssessor constructor
+
+   \param[in] keepRecords  If true, a record is kept for every frame in
+                           error, as well as the runs.  If false, only
+                           the runs are kept.  
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamAssessor::TpcStreamAssessor (bool keepRecords) :
+   m_keepRecords (keepRecords),
+   m_errsummary  (0)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
    \brief  TpcStreamAssessor destructor
@@ -185,12 +361,16 @@ TpcStreamAssessor::assessUntrimmed (TpcStreamUnpack const &tpcStream)
       {
          unsigned int nframes = pktDsc.getNWibFrames ();
 
-         for (unsigned int iwf = 0; iwf < nframes; ++iwf, ++wf)
+         for (unsigned int iwf = 0; iwf < nframes; ++iwf)
          {
+            // Skip, in bulk, the frames with no errors
+            iwf += expected.skip (wf + iwf, nframes - iwf);
+            if (iwf >= nframes) break;
+
             TpcStreamAssessor::Record      rec;
             TpcStreamAssessor::Record::Error_t 
                                errs = rec.evaluateAndUpdate (&expected,
-                                                             *wf);
+                                                             wf[iwf]);
             if (errs)
             {
                errSummary  |= errs;
@@ -202,6 +382,14 @@ TpcStreamAssessor::assessUntrimmed (TpcStreamUnpack const &tpcStream)
          }
          smpNum += nframes;
       }
+      else if (pktDsc.isCompressed ())
+      {
+         uint64_t const *p64 = pktBdy.getData () + pktOff;
+         unsigned int    n64 = pktDsc.getLen64 ();
+
+         smpNum += assessCompressed (this, &expected, &errSummary,
+                                     p64, n64, pktNum, smpNum);
+      }
    }
 
    m_errsummary = errSummary;
@@ -259,12 +447,16 @@ TpcStreamAssessor::assessTrimmed (TpcStreamUnpack const &tpcStream)
       {
          unsigned int nframes = pktDsc.getNWibFrames ();
 
-         for (unsigned int iwf = 0; iwf < nframes; ++iwf, ++wf)
+         for (unsigned int iwf = 0; iwf < nframes; ++iwf)
          {
+            // Skip, in bulk, the frames with no errors
+            iwf += expected.skip (wf + iwf, nframes - iwf);
+            if (iwf >= nframes) break;
+
             TpcStreamAssessor::Record      rec;
             TpcStreamAssessor::Record::Error_t 
                                errs = rec.evaluateAndUpdate (&expected,
-                                                             *wf);
+                                                             wf[iwf]);
             if (errs)
             {
                errSummary  |= errs;
@@ -276,6 +468,14 @@ TpcStreamAssessor::assessTrimmed (TpcStreamUnpack const &tpcStream)
          }
          smpNum += nframes;
       }
+      else if (pktDsc.isCompressed ())
+      {
+         uint64_t const *p64 = pktBdy.getData () + pktOff;
+         unsigned int    n64 = pktDsc.getLen64 ();
+
+         smpNum += assessCompressed (this, &expected, &errSummary,
+                                     p64, n64, pktNum, smpNum);
+      }
    }
 
    m_errsummary = errSummary;
@@ -287,16 +487,163 @@ TpcStreamAssessor::assessTrimmed (TpcStreamUnpack const &tpcStream)
    
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Transposes the ADCs of a range of WIB frames into contiguous
+          channel arrays, assessing the frames in the same pass
+  \return A bit list of the summary of all errors, 0 is no error
+
+  \param[in]    tpcStream  The TPC stream, which must be of the WibFrame
+                           data format
+  \param[in]        itick  The index of the first frame to transpose
+  \param[in]      nframes  The number of frames to transpose, already
+                           limited to what is available
+  \param[in]    transpose  Transposes a block of frames, see Transpose
+  \param[in]          ctx  The context passed to transpose
+
+  \par
+   The frames are processed in blocks small enough to stay in the L1/L2
+   cache.  Each block's headers are assessed and then the block is handed
+   to transpose, so the frames are pulled from memory once.  The records
+   are the same as those of assessUntrimmed for the same frames; the
+   sample, packet and frame numbers count from the beginning of the
+   untrimmed data.  Only the transposed frames are assessed, so the first
+   of them seeds the expected values.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamAssessor::Error_t 
+TpcStreamAssessor::transposeAndAssess (TpcStreamUnpack const &tpcStream,
+                                       int                       itick,
+                                       int                     nframes,
+                                       Transpose             transpose,
+                                       void                        *ctx)
+{
+   using namespace pdd;
+   using namespace pdd::access;
+
+   // Frames per block, a multiple of 32 keeps the transpose on its
+   // fastest kernel.  64 frames is 15 KBytes of input.
+   static const int NBlock = 64;
+
+   TpcStreamUnpack::Identifier id = tpcStream.getIdentifier ();
+   m_crate = id.getCrate ();
+   m_slot  = id.getSlot  ();
+   m_fiber = id.getFiber ();
+
+
+   // ---------------------------------------------------------
+   // As with the transpose, this relies on the frames of all
+   // the packets following one another
+   // ---------------------------------------------------------
+   TpcStream const &stream = tpcStream.getStream     ();
+   TpcToc           toc    (stream.getToc    ());
+   TpcPacket        pktRec (stream.getPacket ());
+   TpcPacketBody    pktBdy (pktRec.getRecord ());
+   TpcTocPacketDsc  pktDsc (toc.getPacketDsc (0));
+   WibFrame const  *frames = pktBdy.getWibFrames (pktDsc.getType     (),
+                                                  pktDsc.getOffset64 ())
+                           + itick;
+
+   WibExpected        expected;
+   uint32_t     errSummary = 0;
+
+   for (int iframe = 0; iframe < nframes; iframe += NBlock)
+   {
+      int              nblock = nframes - iframe;
+      if (nblock > NBlock) nblock = NBlock;
+      WibFrame const      *wf = frames + iframe;
+
+
+      // -----------------------------------------
+      // Assess the block, pulling it into cache...
+      // -----------------------------------------
+      for (int iwf = 0; iwf < nblock; ++iwf)
+      {
+         // Skip, in bulk, the frames with no errors
+         iwf += expected.skip (wf + iwf, nblock - iwf);
+         if (iwf >= nblock) break;
+
+         TpcStreamAssessor::Record      rec;
+         TpcStreamAssessor::Record::Error_t 
+                            errs = rec.evaluateAndUpdate (&expected,
+                                                          wf[iwf]);
+         if (errs)
+         {
+            unsigned int smpNum = itick + iframe + iwf;
+            errSummary  |= errs;
+            rec.m_smpNum = smpNum;
+            rec.m_pktNum = smpNum / 1024;
+            rec.m_frmNum = smpNum % 1024;
+            add (std::move (rec));
+         }
+      }
+
+
+      // ---------------------------------------
+      // ...and transpose it while it is there
+      // ---------------------------------------
+      transpose (ctx, wf, iframe, nblock);
+   }
+
+   m_errsummary = errSummary;
+
+   return errSummary;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Starts a run with its first record
+
+  \param[in] rec  The record of the first frame
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamAssessor::Run::Run (Record const &rec) :
+   m_smpNum (rec.m_smpNum),
+   m_count  (1),
+   m_errors (rec.m_errors),
+   m_pad    (0),
+   m_first  (rec),
+   m_last   (rec)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief Adds an error record
 
   \param[in] rec  The record to add
+
+  \par
+   If the record is of the frame following the last run and has the same
+   errors, it extends that run, otherwise it starts a new one.  The
+   records must be added in sample order.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void TpcStreamAssessor::add (TpcStreamAssessor::Record const &&rec)
 {
-   m_recs.push_back (rec);
+   if (m_keepRecords)
+   {
+      m_recs.push_back (rec);
+   }
+
+   if (!m_runs.empty () && m_runs.back ().extendedBy (rec))
+   {
+      Run &run    = m_runs.back ();
+      run.m_count += 1;
+      run.m_last   = rec;
+   }
+   else
+   {
+      m_runs.emplace_back (rec);
+   }
 }
 /* ---------------------------------------------------------------------- */
 
@@ -314,6 +661,7 @@ void TpcStreamAssessor::add (TpcStreamAssessor::Record const &&rec)
 void TpcStreamAssessor::reset ()
 {
    m_recs.clear ();
+   m_runs.clear ();
 }
 /* ---------------------------------------------------------------------- */
 
@@ -326,11 +674,21 @@ void TpcStreamAssessor::reset ()
 
   \param[in]   idx   The index to start the search at
   \param[in] filter  The mask of errors to filter the search on
+
+  \par
+   If the per frame records were not kept, the index is that of the
+   runs and the first record of the found run is returned.
                                                                           */
 /* ---------------------------------------------------------------------- */
 TpcStreamAssessor::Record const *
 TpcStreamAssessor::get (unsigned int idx, Error_t filter) const
 {
+   if (!m_keepRecords)
+   {
+      Run const *run = getRun (idx, filter);
+      return run ? &run->m_first : 0;
+   }
+
    auto size = m_recs.size ();
    for (; idx < size; ++idx)
    {
@@ -346,6 +704,33 @@ TpcStreamAssessor::get (unsigned int idx, Error_t filter) const
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief   Return the next run statisfying the filter
+  \return  A pointer to the found run or 0 if none
+
+  \param[in]   idx   The index to start the search at
+  \param[in] filter  The mask of errors to filter the search on
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamAssessor::Run const *
+TpcStreamAssessor::getRun (unsigned int idx, Error_t filter) const
+{
+   auto size = m_runs.size ();
+   for (; idx < size; ++idx)
+   {
+      if (m_runs[idx].m_errors & filter)
+      {
+         return &m_runs[idx];
+      }
+   }
+    
+   return 0;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief Report errors that match the filter
@@ -355,6 +740,12 @@ TpcStreamAssessor::get (unsigned int idx, Error_t filter) const
 /* ---------------------------------------------------------------------- */
 void TpcStreamAssessor::report (Error_t filter) const
 {
+   if (!m_keepRecords)
+   {
+      reportRuns (filter);
+      return;
+   }
+
    unsigned int errCnt = m_recs.size ();
 
    static const char Separator[] = 
@@ -484,6 +875,66 @@ void TpcStreamAssessor::report (Error_t filter) const
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Report the error runs that match the filter
+
+  \param[in] filter The mask of errors to filter the report on
+
+  \par
+   Each run gives the position and the values of its first and last
+   frames, so the extent of e.g. a cold data link error is seen at a
+   glance.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcStreamAssessor::reportRuns (Error_t filter) const
+{
+   static const char Separator[] = 
+           "+------------------------------------+--------------------------------+--------------------------------+";
+
+   if (m_runs.empty ())
+   {
+      printf ("WibId = %2x.%1x.%1x -- No Errors\n", m_crate, m_slot, m_fiber);
+      return;
+   }
+
+   puts   (Separator);
+   printf ("|   WIB Id = %2x.%1x.%1x   ERROR RUNS     |          FIRST FRAME           |           LAST FRAME           |\n", 
+           m_crate, m_slot, m_fiber);
+   puts   (Separator);
+   printf ("|Run# Pkt.Frame Sample  Count  Errors|       Timestamp CvtCnt0 CvtCnt1|       Timestamp CvtCnt0 CvtCnt1|\n");
+   puts   ("+---- ---.----- ------ ------ -------+---------------- ------- -------+---------------- ------- -------+");
+
+   unsigned int runNum = 0;
+   for (auto run = m_runs.begin (); run < m_runs.end (); ++runNum, ++run)
+   {
+      if ((run->m_errors & filter) == 0) continue;
+
+      Record const &first = run->m_first;
+      Record const  &last = run->m_last;
+
+      printf ("|%4u %3u.%5u %6u %6u %7.6" PRIx32 "|", 
+              runNum, first.m_pktNum, first.m_frmNum, run->m_smpNum,
+              run->m_count, run->m_errors);
+
+      printf ("%16" PRIx64 "    %4.4" PRIx16 "    %4.4" PRIx16 "|",
+              first.m_wibtimestamp, 
+              first.m_cd[0].m_cvtcnt, first.m_cd[1].m_cvtcnt);
+
+      printf ("%16" PRIx64 "    %4.4" PRIx16 "    %4.4" PRIx16 "|\n",
+              last.m_wibtimestamp, 
+              last.m_cd[0].m_cvtcnt, last.m_cd[1].m_cvtcnt);
+   }
+
+   puts   (Separator);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief Constructor of the ensuing frame predictions
@@ -537,6 +988,9 @@ TpcStreamAssessor::Record::evaluateAndUpdate (WibExpected            *expected,
       auto hdr1     = cd.getHeader1      ();
       m_cd[icd].m_errreg  = cd.getErrRegister  (hdr1);
 
+      // The reserved field no longer exists, never an error
+      m_cd[icd].m_rsvd    = 0;
+
       // --------------------------------------------------
       // These are absolute checks, so need for seed values
       // --------------------------------------------------
@@ -26,6 +26,51 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt RoiFinder::scan ends the regions of the channels absent
+                  from a compressed packet with fewer than 128 channels
+                  and does not pad the next ones back into the gap.  Its
+                  vectorized threshold test no longer saturates
+                  |adc - ped|, which missed differences beyond 32767.
+   2026.10.16 agt Replaced the getMultiChannelData(Untrimmed) variants
+                  taking an assessor, a ChannelMask, a Store or AdcStats
+                  by those taking Options.  The copies of the contiguous
+                  getMultiChannelDataBase and extractAdcs are now one
+                  routine: WibTranspose does the WIB frames, directly or
+                  as the assessor's transposition hook, and the packet
+                  loop is DecompressPlan::add.  PacketList locates the
+                  packets for all the unpacking routines.
+   2026.10.16 agt getSummary now copies the summary out of and into the
+                  TpcStream cache with memcpy instead of aliasing it and
+                  returns it by value.
+   2026.10.16 agt Added getRois(Untrimmed), the zero-suppressed unpacking
+                  into regions of interest, found by RoiFinder as each
+                  block of the stream is unpacked
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) returning each
+                  channel's AdcStats, accumulated in the unpacking pass
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) taking a Store, the
+                  streaming variants writing with non-temporal stores
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) producing pedestal
+                  subtracted, gain corrected floats in the unpacking pass
+   2026.10.16 agt Added ChannelMask and getMultiChannelData(Untrimmed)
+                  with a channel mask.  Only the selected channels are
+                  transposed or, for compressed data, decoded.
+   2026.10.16 agt Added getMultiChannelData(Untrimmed) with an assessor.
+                  The WIB frames are assessed by the assessor as they are
+                  transposed, see TpcStreamAssessor::transposeAndAssess.
+   2026.10.16 agt Added getMultiChannelData (int16_t *adcs, int nadcs).
+                  The contiguous getMultiChannelDataBase takes the channel
+                  stride, nadcs, separately from the number of ticks.
+   2026.10.16 agt The trimmed range, status, data format and number of 
+                  packets are taken from the lazily computed Summary. 
+                  Previously each of getNTicks, getTimeStamp, getRange,
+                  and getMultiChannelData redid the trimmed range search
+                  and isTpcNormal/isTpcDamaged recomputed the status.
+   2026.10.16 agt The compressed packets are decompressed in groups of
+                  TpcCompressed::getNInterleaved channels
+   2026.10.16 agt The channels of all the compressed packets in the
+                  requested range are decompressed as one batch by the
+                  shared WorkerPool, see TpcCompressed::setNThreads
+
    2018.10.20 jjr Replaced getTimestamps(Untrimmed) with getRange(Untrimmed)
                   This method adds the number of ticks in the trimmed/
                   untrimmed ranges in addition to their timestamps
@@ -75,22 +120,33 @@
 
 
 #include "dam/TpcStreamUnpack.hh"
+#include "dam/TpcStreamAssessor.hh"
 #include "dam/access/TpcCompressed.hh"
 #include "dam/records/TpcCompressed.hh"
 #include "dam/access/WibFrame.hh"
+#include "dam/access/AdcStats.hh"
 #include "TpcTrimmedRange.hh"
 #include "TpcStream-Impl.hh"
 #include "TpcRanges-Impl.hh"
 #include "TpcToc-Impl.hh"
 #include "TpcPacket-Impl.hh"
 #include "TpcCompressed-Impl.hh"
+#include "TpcCompressed-dispatch.hh"
+#include "WorkerPool.hh"
 
+#include <cstring>
 #include <string>
+#include <vector>
 #include <iostream>
 
-static inline void getTrimmed (pdd::access::TpcStream const *tpc,
-                               int                          *beg,
-                               int                       *nticks);
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static uint32_t computeStatus (pdd::access::TpcStream const &stream);
+
+static TpcStreamUnpack::DataFormatType
+       computeDataFormatType      (pdd::access::TpcStream const &stream);
 
 
 
@@ -120,11 +176,7 @@ size_t TpcStreamUnpack::getNChannels() const
 /* ---------------------------------------------------------------------- */
 size_t TpcStreamUnpack::getNTicksUntrimmed () const
 {
-   using namespace pdd;
-   record::TpcToc       const *toc = m_stream.getToc ();
-   record::TpcTocHeader const *hdr = access::TpcToc      ::getHeader      (toc);
-   int                       ndscs = access::TpcTocHeader::getNPacketDscs (hdr);
-
+   int ndscs = getSummary ().m_npkts;
    return 1024*ndscs;
 }
 /* ---------------------------------------------------------------------- */
@@ -147,11 +199,7 @@ size_t TpcStreamUnpack::getNTicksUntrimmed () const
 /* ---------------------------------------------------------------------- */
 size_t TpcStreamUnpack::getNTicks () const
 {
-   int    beg;
-   int nticks;
-   getTrimmed (&m_stream, &beg, &nticks);
-
-   return nticks;
+   return getSummary ().m_nticks;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -259,6 +307,164 @@ uint32_t TpcStreamUnpack::Identifier::getFiber () const
 
 
 
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Selects a channel
+
+  \param[in] ichan  The channel, 0-127
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcStreamUnpack::ChannelMask::set (int ichan)
+{
+   m_bits[ichan >> 6] |= 1ull << (ichan & 0x3f);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Selects a range of channels
+
+  \param[in]  ichan  The first channel of the range
+  \param[in] nchans  The number of channels in the range
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcStreamUnpack::ChannelMask::set (int ichan, int nchans)
+{
+   for (int idx = ichan; idx < ichan + nchans && idx < 128; idx++)
+   {
+      set (idx);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Deselects a channel
+
+  \param[in] ichan  The channel, 0-127
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void TpcStreamUnpack::ChannelMask::clear (int ichan)
+{
+   m_bits[ichan >> 6] &= ~(1ull << (ichan & 0x3f));
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Tests whether a channel is selected
+  \return true, if the channel is selected
+
+  \param[in] ichan  The channel, 0-127
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::ChannelMask::isSet (int ichan) const
+{
+   return (m_bits[ichan >> 6] >> (ichan & 0x3f)) & 1;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the number of selected channels
+  \return The number of selected channels.  This is the number of channel
+          arrays the masked getMultiChannelData methods fill.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int TpcStreamUnpack::ChannelMask::getNSelected () const
+{
+   return __builtin_popcountll (m_bits[0]) + __builtin_popcountll (m_bits[1]);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Unpack only the selected channels
+  \return The options
+
+  \param[in] mask  The selected channels.  It must outlive the options.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamUnpack::Options &
+TpcStreamUnpack::Options::select (ChannelMask const &mask)
+{
+   m_mask = &mask;
+   return *this;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the statistics of each channel
+  \return The options
+
+  \param[out] stats  The statistics of the 128 channels or NULL for none
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamUnpack::Options &
+TpcStreamUnpack::Options::stats (pdd::access::AdcStats *stats)
+{
+   m_stats = stats;
+   return *this;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Assess the WIB frames as they are transposed
+  \return The options
+
+  \param[in] assessor  The assessor to add the error records to or NULL
+                       for none
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamUnpack::Options &
+TpcStreamUnpack::Options::assess (TpcStreamAssessor *assessor)
+{
+   m_assessor = assessor;
+   return *this;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Store the ADCs as specified
+  \return The options
+
+  \param[in] store  How to store the ADCs
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamUnpack::Options &
+TpcStreamUnpack::Options::store (Store store)
+{
+   m_store = store;
+   return *this;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief  Extracts the stream's status
@@ -267,14 +473,30 @@ uint32_t TpcStreamUnpack::Identifier::getFiber () const
 /* ---------------------------------------------------------------------- */
 uint32_t TpcStreamUnpack::getStatus () const
 {
-   pdd::record::TpcStreamHeader  const *hdr = m_stream.getHeader ();
+   return getSummary ().m_status;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Computes the stream's status
+  \return The stream's status
+
+  \param[in] stream  The stream
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint32_t computeStatus (pdd::access::TpcStream const &stream)
+{
+   pdd::record::TpcStreamHeader  const *hdr = stream.getHeader ();
    uint32_t                          status = hdr->getStatus ();
    if (status == 0)
    {
       // Check for missing frames
       using namespace pdd::access;
 
-      pdd::record::TpcRanges const *ranges = m_stream.getRanges ();
+      pdd::record::TpcRanges const *ranges = stream.getRanges ();
       unsigned int                  bridge = TpcRanges::getBridge  (ranges);
       pdd::access::TpcRangesIndices indices (TpcRanges::getIndices (ranges),
                                                                      bridge);
@@ -298,18 +520,7 @@ uint32_t TpcStreamUnpack::getStatus () const
 /* ---------------------------------------------------------------------- */
 bool TpcStreamUnpack::isTpcNormal () const
 {
-   pdd::record::TpcStreamHeader const *hdr = m_stream.getHeader ();
-   bool tpcNormal = hdr->isTpcNormal ();
-
-   // --------------------------------------------------------------
-   // Because of a failure to correctly mark some streams as damaged
-   // perform this additional check,
-   // --------------------------------------------------------------
-   if (tpcNormal && getStatus () != 0) 
-   {
-      tpcNormal = false;
-   }
-
+   bool tpcNormal = getSummary ().m_flags & Summary::TpcNormal;
    return tpcNormal;
 }
 /* ---------------------------------------------------------------------- */
@@ -323,19 +534,7 @@ bool TpcStreamUnpack::isTpcNormal () const
 /* ---------------------------------------------------------------------- */
 bool TpcStreamUnpack::isTpcDamaged () const
 {
-   pdd::record::TpcStreamHeader const *hdr = m_stream.getHeader ();
-
-   // --------------------------------------------------------------
-   // Because of a failure to correctly mark some streams as damaged
-   // perform this additional check,
-   // --------------------------------------------------------------
-   bool tpcDamaged = hdr->isTpcDamaged ();
-
-   if (!tpcDamaged && getStatus () != 0) 
-   {
-      tpcDamaged = true;
-   }
-
+   bool tpcDamaged = getSummary ().m_flags & Summary::TpcDamaged;
    return tpcDamaged;
 }
 /* ---------------------------------------------------------------------- */
@@ -350,11 +549,29 @@ bool TpcStreamUnpack::isTpcDamaged () const
                                                                           */
 /* ---------------------------------------------------------------------- */
 TpcStreamUnpack::DataFormatType TpcStreamUnpack::getDataFormatType () const
+{
+   return static_cast<DataFormatType>(getSummary ().m_format);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Determines the stored data format
+  \return One of the enumeration DataFormatType
+
+  \param[in] stream  The stream
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static TpcStreamUnpack::DataFormatType
+       computeDataFormatType (pdd::access::TpcStream const &stream)
 {
    using namespace pdd;
    using namespace pdd::access;
+   typedef TpcStreamUnpack::DataFormatType DataFormatType;
 
-   record::TpcToc          const     *toc = m_stream.getToc           ();
+   record::TpcToc          const     *toc = stream.getToc             ();
    int                           npktDscs = TpcToc::getNPacketDscs (toc);
    record::TpcTocPacketDsc const *pktDscs = TpcToc::getPacketDscs  (toc);
 
@@ -374,6 +591,74 @@ TpcStreamUnpack::DataFormatType TpcStreamUnpack::getDataFormatType () const
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Returns the stream's summary, computing it on first use
+  \return The stream's summary
+
+  \par
+   The summary lives in the TpcStream's cache, which is cleared when the
+   TpcStream is constructed. So the trimmed range search, the status and
+   the data format are computed once per stream, no matter how many of
+   the accessors are called.  Since the first call fills the cache, it
+   should not be made concurrently from several threads.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+TpcStreamUnpack::Summary TpcStreamUnpack::getSummary () const
+{
+   using namespace pdd;
+   using namespace pdd::access;
+
+   static_assert (sizeof (Summary) <= sizeof (uint64_t) * TpcStream::NCache64,
+                  "TpcStreamUnpack::Summary does not fit in the TpcStream cache");
+
+   // ---------------------------------------------------------------
+   // The cache is raw storage, so copy the summary out of and back
+   // into it, rather than aliasing it through a pointer to a Summary.
+   // ---------------------------------------------------------------
+   Summary summary;
+   std::memcpy (&summary, m_stream.getCache (), sizeof (summary));
+   if (summary.m_flags & Summary::Valid)
+   {
+      return summary;
+   }
+
+
+   // -------------------------------------
+   // The begin and end of the trimmed data
+   // -------------------------------------
+   TpcTrimmedRange trimmed (m_stream);
+   summary.m_begTs  = trimmed.m_beg.m_wibTs;
+   summary.m_endTs  = trimmed.m_end.m_wibTs;
+   summary.m_begOff = trimmed.m_beg.m_wibOff;
+   summary.m_nticks = trimmed.m_nticks;
+
+
+   record::TpcToc       const *toc = m_stream.getToc ();
+   record::TpcTocHeader const *hdr = TpcToc      ::getHeader      (toc);
+   summary.m_npkts                = TpcTocHeader::getNPacketDscs (hdr);
+   summary.m_format               = static_cast<int8_t>
+                                    (computeDataFormatType (m_stream));
+   summary.m_status               = computeStatus (m_stream);
+
+
+   // --------------------------------------------------------------
+   // Because of a failure to correctly mark some streams as damaged
+   // also use the status to classify the stream
+   // --------------------------------------------------------------
+   record::TpcStreamHeader const *shdr = m_stream.getHeader ();
+   uint8_t                       flags = Summary::Valid;
+   if (shdr->isTpcNormal  () && summary.m_status == 0) flags |= Summary::TpcNormal;
+   if (shdr->isTpcDamaged () || summary.m_status != 0) flags |= Summary::TpcDamaged;
+   summary.m_flags = flags;
+
+   std::memcpy (m_stream.getCache (), &summary, sizeof (summary));
+   return summary;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
   \brief  Limit the number ADC tick samples to decode to what is available
@@ -436,250 +721,1282 @@ void transpose (int16_t                        *const  adcs[128],
 
 /* ---------------------------------------------------------------------- *//*!
 
-  \brief   Extracts the ADCs in the specified range
-  \retval  == true is successful
-  \retval  == false is failure
+  \class PacketList
+  \brief The packet descriptors and packets of a stream, located once for
+         the unpacking routines
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class PacketList
+{
+public:
+   explicit PacketList (pdd::access::TpcStream const *tpc);
+
+   bool isWibFrame   () const;
+   bool isCompressed () const;
+   int  limit        (int nticks, int itick) const;
+
+   pdd::access::WibFrame const *getWibFrames (int itick) const;
+   pdd::access::TpcCompressed   getPacket    (int  ipkt) const;
+
+public:
+   pdd::record::TpcTocPacketDsc const *m_dscs; /*!< The packet descriptors*/
+   int                                m_ndscs; /*!< Their number          */
+   pdd::record::TpcPacketBody   const *m_body; /*!< The packets           */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Locate the packet descriptors and packets of a stream
+
+  \param[in] tpc  The Tpc stream
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline PacketList::PacketList (pdd::access::TpcStream const *tpc)
+{
+   using namespace pdd::access;
+
+   pdd::record::TpcToc    const    *toc = tpc->getToc    ();
+   pdd::record::TpcPacket const *pktRec = tpc->getPacket ();
+
+   m_ndscs = TpcToc   ::getNPacketDscs (toc);
+   m_dscs  = TpcToc   ::getPacketDscs  (toc);
+   m_body  = TpcPacket::getBody     (pktRec);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+inline bool PacketList::isWibFrame () const
+{
+   return pdd::access::TpcTocPacketDsc::isWibFrame (m_dscs);
+}
+
+inline bool PacketList::isCompressed () const
+{
+   return pdd::access::TpcTocPacketDsc::isCompressed (m_dscs);
+}
+
+inline int PacketList::limit (int nticks, int itick) const
+{
+   return ::limit (nticks, itick, m_dscs, m_ndscs);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the WIB frames, starting at frame itick
+  \return The WIB frames
+
+  \param[in] itick  The first frame
+
+  \par
+   This relies on the frames of all the packets following one another.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline pdd::access::WibFrame const *PacketList::getWibFrames (int itick) const
+{
+   using namespace pdd::access;
+
+   int              o64 = TpcTocPacketDsc::getOffset64 (m_dscs);
+   uint64_t const  *p64 = TpcPacketBody  ::getData     (m_body) + o64;
+   return reinterpret_cast<WibFrame const *>(p64) + itick;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return a compressed packet
+  \return The compressed packet
+
+  \param[in] ipkt  The packet's index
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline pdd::access::TpcCompressed PacketList::getPacket (int ipkt) const
+{
+   using namespace pdd::access;
+
+   pdd::record::TpcTocPacketDsc const *pktDsc = m_dscs + ipkt;
+   int              o64 = TpcTocPacketDsc::getOffset64 (pktDsc);
+   uint64_t const  *p64 = TpcPacketBody  ::getData     (m_body) + o64;
+   uint64_t         n64 = TpcTocPacketDsc::getLen64    (pktDsc);
+
+   return TpcCompressed (p64, n64);
+}
+/* ---------------------------------------------------------------------- */
 
-  \param[out]  adcs  An array of essentially NChannels x NTicks where
-                     nChannels comes from getNChannels and nTicks indicates
-                     how many ticks to allocate to each array
-  \param[in] nadcs   The number of elements to allocate in each each
-                     channel array.  It can be
-                       -# larger than the number of frames. This effectively
-                          leaves some room at the end of each channel.
-                          It allows one to recall this method and append
-                          more ticks.
-                       -# smaller than the number of frames. This will
-                          limit the number of transposed frames to this
-                          value.
 
-  \param[in]    pkts  The array of TPC packets
-  \param[in] pktDscs  The array of packet descriptors
-  \param[in]   npkts  The number of packets and, by implication, the number
-                      of packet descriptors
-  \param[in]   itick  The tick number of the first sample number to be
-                      extracted. Typically this represents the first ADC
-                      value in the event window
-  \param[in]  nticks  The number of adcs to extract.  Typically this
-                      represents the number of ADCs in the event window
-                                                                          */
-/* ---------------------------------------------------------------------- */
-inline static bool extractAdcs (int16_t                               *adcs,
-                                int                                   nadcs,
-                                pdd::record::TpcPacketBody   const    *pkts,
-                                pdd::record::TpcTocPacketDsc const *pktDscs,
-                                int                                   npkts,
-                                int                                   itick,
-                                int                                  nticks)
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class DecompressPlan
+  \brief The destinations of each of a stream's compressed packets.
+
+   The destinations are laid out, using the table of contents of each
+   packet, before any packet is decompressed.  This allows the channels
+   of all the packets to be handed to the worker pool at once, as groups
+   of channels that are decoded in lockstep.  Each channel of each packet
+   writes a distinct set of ADCs, so the result is independent of the
+   number of threads.
+
+   The destinations are contiguous int16_t or float arrays or channel by
+   channel int16_t arrays.  The options apply to the contiguous int16_t
+   destinations.  If m_ichans is set, only these channels are
+   decompressed, the n'th being stored as if it were channel n.  If
+   m_stats is set, the statistics of each channel are added to
+   m_stats[channel].  If m_stream is set, and neither of the others, the
+   ADCs are written with non-temporal stores.  Since the packets are
+   decompressed concurrently, each packet accumulates its own statistics
+   and these are added together, in packet order, once all are done.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class DecompressPlan
+{
+public:
+   DecompressPlan (int16_t         *adcs,
+                   int             nadcs) :
+      m_stream    (false),
+      m_stats     (NULL),
+      m_ichans    (NULL),
+      m_nichans   (0),
+      m_adcs      (adcs),
+      m_fadcs     (NULL),
+      m_chans     (NULL),
+      m_nadcs     (nadcs),
+      m_peds      (NULL),
+      m_gains     (NULL),
+      m_nchannels (0),
+      m_ngroup    (pdd::access::TpcCompressed::getNInterleaved ())
+   {
+      return;
+   }
+
+   DecompressPlan (int16_t *const *chans) :
+      m_stream    (false),
+      m_stats     (NULL),
+      m_ichans    (NULL),
+      m_nichans   (0),
+      m_adcs      (NULL),
+      m_fadcs     (NULL),
+      m_chans     (chans),
+      m_nadcs     (0),
+      m_peds      (NULL),
+      m_gains     (NULL),
+      m_nchannels (0),
+      m_ngroup    (pdd::access::TpcCompressed::getNInterleaved ())
+   {
+      return;
+   }
+
+   DecompressPlan (float           *adcs,
+                   int             nadcs,
+                   float const     *peds,
+                   float const    *gains) :
+      m_stream    (false),
+      m_stats     (NULL),
+      m_ichans    (NULL),
+      m_nichans   (0),
+      m_adcs      (NULL),
+      m_fadcs     (adcs),
+      m_chans     (NULL),
+      m_nadcs     (nadcs),
+      m_peds      (peds),
+      m_gains     (gains),
+      m_nchannels (0),
+      m_ngroup    (pdd::access::TpcCompressed::getNInterleaved ())
+   {
+      return;
+   }
+
+   bool add (PacketList const &pkts,
+             int              itick,
+             int             nticks);
+
+   void run ();
+
+public:
+   bool                    m_stream; /*!< Store non-temporally            */
+   pdd::access::AdcStats   *m_stats; /*!< Add to the statistics, or NULL  */
+   int const              *m_ichans; /*!< The selected channels or NULL   */
+   int                    m_nichans; /*!< The number selected             */
+
+private:
+   void add (pdd::access::TpcCompressed const &cmp,
+             int                              iadc,
+             int                           begTick,
+             int                            nticks,
+             int                          nsamples);
+
+   static void task (void *ctx, int itask);
+
+private:
+   class Packet
+   {
+   public:
+      pdd::access::TpcCompressed m_cmp; /*!< The packet                   */
+      int                       m_iadc; /*!< Offset into each channel     */
+      int                    m_begTick; /*!< First tick to store          */
+      int                     m_nticks; /*!< Maximum number to store      */
+      int                   m_nsamples; /*!< The number that are stored   */
+      int                  m_nchannels; /*!< Number of channels           */
+   };
+
+   int16_t                     *m_adcs; /*!< Contigious int16_t or NULL   */
+   float                      *m_fadcs; /*!< Contigious float or NULL     */
+   int16_t             *const *m_chans; /*!< Channel-by-channel or NULL   */
+   int                         m_nadcs; /*!< Contigious channel stride    */
+   float const                 *m_peds; /*!< The pedestals, floats only   */
+   float const                *m_gains; /*!< The gains or NULL            */
+   int                     m_nchannels; /*!< Maximum channels/packet      */
+   int                        m_ngroup; /*!< Channels per task            */
+   std::vector<Packet>          m_pkts; /*!< The packets                  */
+   mutable std::vector<pdd::access::AdcStats>
+                            m_pktStats; /*!< Each packet's statistics,
+                                             m_nchannels per packet       */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief   Add the packets holding a range of ticks to the plan
+  \retval  true,  if successful
+  \retval  false, if a packet has more ticks than requested
+
+  \param[in]   pkts  The stream's packets
+  \param[in]  itick  The tick number of the first sample to be extracted.
+                     Typically this represents the first ADC value in the
+                     event window
+  \param[in] nticks  The number of ADCs to extract.  Typically this
+                     represents the number of ADCs in the event window
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool DecompressPlan::add (PacketList const &pkts,
+                          int              itick,
+                          int             nticks)
+{
+   int iadc = 0;
+   for (int ipkt = 0; ipkt < pkts.m_ndscs; ipkt++)
+   {
+      pdd::access::TpcCompressed cmp = pkts.getPacket (ipkt);
+
+      int nsamples = cmp.getNDecompressed (itick, nticks);
+
+      // DLA jan2020: Exit if decompress returns too many ticks.
+      // See https://cdcvs.fnal.gov/redmine/issues/23811.
+      if (nsamples > nticks)
+      {
+         std::cout << "DecompressPlan::add: WARNING: Too many samples decoded."
+                   << std::endl;
+         return false;
+      }
+
+      add (cmp, iadc, itick, nticks, nsamples);
+      nticks -= nsamples;
+
+      // DLA jan2020: I don't know why this is done but I carry it over
+      // from the old code.
+      if (itick && nticks > 0) itick = 0;
+
+      if (nticks <= 0) break;
+      iadc   += nsamples;
+   }
+
+   return true;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Add a packet to the plan
+
+  \param[in]      cmp  The compressed packet
+  \param[in]     iadc  The offset into each channel's array of the
+                       packet's first ADC
+  \param[in]  begTick  The first tick of the packet to store
+  \param[in]   nticks  The maximum number of ticks to store
+  \param[in] nsamples  The number of ticks that are stored
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void DecompressPlan::add (pdd::access::TpcCompressed const &cmp,
+                          int                              iadc,
+                          int                           begTick,
+                          int                            nticks,
+                          int                          nsamples)
+{
+   Packet pkt;
+   pkt.m_cmp       = cmp;
+   pkt.m_iadc      = iadc;
+   pkt.m_begTick   = begTick;
+   pkt.m_nticks    = nticks;
+   pkt.m_nsamples  = nsamples;
+   pkt.m_nchannels = pdd::access::TpcCompressedTocTrailer::
+                     getNChannels (cmp.getTocTrailer ());
+
+   // The selected channels are in increasing order, count those present
+   if (m_ichans)
+   {
+      int nchans = 0;
+      while (nchans < m_nichans && m_ichans[nchans] < pkt.m_nchannels) nchans++;
+      pkt.m_nchannels = nchans;
+   }
+
+   if (pkt.m_nchannels > m_nchannels) m_nchannels = pkt.m_nchannels;
+   m_pkts.push_back (pkt);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Decompress all the channels of all the packets
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void DecompressPlan::run ()
+{
+   int ngroups = (m_nchannels + m_ngroup - 1) / m_ngroup;
+   int ntasks  = m_pkts.size () * ngroups;
+
+   if (m_stats)
+   {
+      m_pktStats.assign (m_pkts.size () * m_nchannels,
+                         pdd::access::AdcStats ());
+   }
+
+   pdd::access::WorkerPool::shared ().run (task, this, ntasks);
+
+
+   // ------------------------------------------------
+   // Add the packets' statistics, always in the same
+   // order so the result does not depend on threading
+   // ------------------------------------------------
+   if (m_stats)
+   {
+      pdd::access::AdcStats const *pktStats = m_pktStats.data ();
+      for (Packet const &pkt : m_pkts)
+      {
+         for (int ichan = 0; ichan < pkt.m_nchannels; ichan++)
+         {
+            int chan = m_ichans ? m_ichans[ichan] : ichan;
+            m_stats[chan].add (pktStats[ichan]);
+         }
+
+         pktStats += m_nchannels;
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Decompress one group of channels of one packet, the WorkerPool
+         task
+
+  \param[in]   ctx  The plan
+  \param[in] itask  The packet and group, ipkt * ngroups + igroup
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void DecompressPlan::task (void *ctx, int itask)
+{
+   DecompressPlan const *plan = reinterpret_cast<decltype (plan)>(ctx);
+   int                ngroups = (plan->m_nchannels + plan->m_ngroup - 1)
+                              /  plan->m_ngroup;
+   int                   ipkt = itask / ngroups;
+   int                 ichan0 = itask % ngroups * plan->m_ngroup;
+   Packet const          &pkt = plan->m_pkts[ipkt];
+
+   int nchans = pkt.m_nchannels - ichan0;
+   if (nchans <= 0) return;
+   if (nchans > plan->m_ngroup) nchans = plan->m_ngroup;
+
+   if (plan->m_fadcs)
+   {
+      float *fadcs[pdd::access::TpcAdcsDecoder::MaxLanes];
+      for (int idx = 0; idx < nchans; idx++)
+      {
+         fadcs[idx] = plan->m_fadcs + (ichan0 + idx) * plan->m_nadcs
+                    + pkt.m_iadc;
+      }
+
+      pkt.m_cmp.decompressChannels (fadcs, ichan0, nchans,
+                                    pkt.m_begTick, pkt.m_nticks,
+                                    plan->m_peds,  plan->m_gains);
+      return;
+   }
+
+   int16_t *adcs[pdd::access::TpcAdcsDecoder::MaxLanes];
+   for (int idx = 0; idx < nchans; idx++)
+   {
+      int ichan = ichan0 + idx;
+      adcs[idx] = plan->m_chans ? plan->m_chans[ichan] + pkt.m_iadc
+                                : plan->m_adcs + ichan * plan->m_nadcs
+                                               + pkt.m_iadc;
+   }
+
+   pdd::access::AdcStats *stats = plan->m_stats
+                                ? plan->m_pktStats.data ()
+                                + ipkt * plan->m_nchannels + ichan0
+                                : NULL;
+
+   if (plan->m_ichans)
+   {
+      pkt.m_cmp.decompressChannels (adcs, plan->m_ichans + ichan0, nchans,
+                                    pkt.m_begTick, pkt.m_nticks);
+
+      // No decoder both selects and accumulates, but these channels
+      // were just decoded and are still in the cache
+      if (stats)
+      {
+         for (int idx = 0; idx < nchans; idx++)
+         {
+            stats[idx].accumulate (adcs[idx], pkt.m_nsamples);
+         }
+      }
+   }
+   else if (stats)
+   {
+      pkt.m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                    pkt.m_begTick, pkt.m_nticks, stats);
+   }
+   else if (plan->m_stream)
+   {
+      pkt.m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                    pkt.m_begTick, pkt.m_nticks, true);
+   }
+   else
+   {
+      pkt.m_cmp.decompressChannels (adcs, ichan0, nchans,
+                                    pkt.m_begTick, pkt.m_nticks);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class WibTranspose
+  \brief Transposes WIB frames into contiguous channel arrays, doing the
+         optional work of the unpacking options
+
+  \par
+   This is the transposition hook of TpcStreamAssessor::
+   transposeAndAssess, which calls it on each block of frames after
+   assessing it.  Without an assessor, it is called once on all the
+   frames.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class WibTranspose
+{
+public:
+   WibTranspose (int16_t                              *adcs,
+                 int                                  nadcs,
+                 TpcStreamUnpack::Options const    &options,
+                 int const                           *ichans,
+                 int                                nichans);
+
+   void run (pdd::access::WibFrame const *frames,
+             int                          iframe,
+             int                         nframes) const;
+
+   static void block (void                           *ctx,
+                      pdd::access::WibFrame const *frames,
+                      int                          iframe,
+                      int                         nframes);
+
+private:
+   int16_t                          *m_adcs; /*!< The channel arrays      */
+   int                              m_nadcs; /*!< Their stride            */
+   uint64_t const                   *m_mask; /*!< The selected channels'
+                                                  bits or NULL            */
+   pdd::access::AdcStats           *m_stats; /*!< The statistics or NULL  */
+   bool                            m_stream; /*!< Store non-temporally    */
+   int const                       *m_ichans; /*!< The selected channels  */
+   int                             m_nichans; /*!< The number selected    */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor
+
+  \param[out]    adcs  An array of essentially NChannels x nadcs, or
+                       NSelected x nadcs when channels are selected
+  \param[in]    nadcs  The number of elements in each channel array
+  \param[in]  options  The unpacking options
+  \param[in]   ichans  The selected channels, in increasing order
+  \param[in]  nichans  The number of selected channels
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline WibTranspose::WibTranspose (int16_t                              *adcs,
+                                   int                                  nadcs,
+                                   TpcStreamUnpack::Options const    &options,
+                                   int const                           *ichans,
+                                   int                                nichans) :
+   m_adcs    (adcs),
+   m_nadcs   (nadcs),
+   m_mask    (options.m_mask ? options.m_mask->getBits () : NULL),
+   m_stats   (options.m_stats),
+   m_stream  (options.m_store == TpcStreamUnpack::Store::Streaming),
+   m_ichans  (ichans),
+   m_nichans (nichans)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Transpose a run of frames
+
+  \param[in]  frames  The frames
+  \param[in]  iframe  The index of the first of these in the unpacked
+                      range, i.e. its offset in the channel arrays
+  \param[in] nframes  The number of frames
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WibTranspose::run (pdd::access::WibFrame const *frames,
+                        int                          iframe,
+                        int                         nframes) const
+{
+   using namespace pdd::access;
+
+   int16_t *adcs = m_adcs + iframe;
+
+   if (m_mask && m_stats)
+   {
+      // --------------------------------------------------------
+      // No kernel both selects and accumulates, so the selected
+      // channels are added a block at a time, while the block is
+      // still in the cache
+      // --------------------------------------------------------
+      for (int iblk = 0; iblk < nframes; iblk += AdcStats::MaxBlock)
+      {
+         int nblock = nframes - iblk;
+         if (nblock > AdcStats::MaxBlock) nblock = AdcStats::MaxBlock;
+
+         WibFrame::transposeAdcsMasked128xN (adcs   + iblk, m_nadcs,
+                                             frames + iblk, nblock, m_mask);
+         for (int idx = 0; idx < m_nichans; idx++)
+         {
+            m_stats[m_ichans[idx]].accumulate (adcs + idx * m_nadcs + iblk,
+                                               nblock);
+         }
+      }
+   }
+   else if (m_mask)
+   {
+      WibFrame::transposeAdcsMasked128xN (adcs, m_nadcs,
+                                          frames, nframes, m_mask);
+   }
+   else if (m_stats)
+   {
+      WibFrame::transposeAdcs128xN (adcs, m_nadcs, frames, nframes, m_stats);
+   }
+   else if (m_stream)
+   {
+      WibFrame::transposeAdcs128xN_stream (adcs, m_nadcs, frames, nframes);
+   }
+   else
+   {
+      WibFrame::transposeAdcs128xN (adcs, m_nadcs, frames, nframes);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The TpcStreamAssessor::Transpose hook
+
+  \param[in]     ctx  The WibTranspose
+  \param[in]  frames  The block of frames
+  \param[in]  iframe  The index of the block's first frame
+  \param[in] nframes  The number of frames in the block
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WibTranspose::block (void                           *ctx,
+                          pdd::access::WibFrame const *frames,
+                          int                          iframe,
+                          int                         nframes)
+{
+   WibTranspose const *transpose = reinterpret_cast<decltype (transpose)>(ctx);
+   transpose->run (frames, iframe, nframes);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the adc data in the specified range
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[out]     adcs  An array of essentially NChannels x nadcs where
+                        nChannels comes from getNChannels, or of
+                        NSelected x nadcs if channels are selected
+  \param[in]     nadcs  The number of elements to allocate in each each
+                        channel array.  It can be
+                         -# larger than the number of frames. This
+                            effectively leaves some room at the end of
+                            each channel.  It allows one to recall this
+                            method and append more ticks.
+                         -# smaller than the number of frames. This will
+                            limit the number of transposed frames to this
+                            value.
+  \param[in] tpcStream  The Tpc stream
+  \param[in]     itick  The beginning time sample tick
+  \param[in]    nticks  The number of ticks to extract, further limited by
+                        nadcs and the number of frames
+  \param[in]   options  The optional work, see TpcStreamUnpack::Options
+
+  \par
+   WIB frames are transposed by WibTranspose, either directly or, when
+   assessing, by the assessor a block at a time.  Compressed packets are
+   decompressed by a DecompressPlan set up from the options.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static bool getMultiChannelDataBase (int16_t                           *adcs,
+                                     int                               nadcs,
+                                     TpcStreamUnpack const        &tpcStream,
+                                     int                               itick,
+                                     int                              nticks,
+                                     TpcStreamUnpack::Options const &options)
+{
+   using namespace pdd::access;
+
+   PacketList pkts (&tpcStream.getStream ());
+
+   if (options.m_stats)
+   {
+      for (int ichan = 0; ichan < 128; ichan++) options.m_stats[ichan].reset ();
+   }
+
+   if (nticks > nadcs) nticks = nadcs;
+
+   int nframes = pkts.limit (nticks, itick);
+   if (nframes <= 0) return false;
+
+
+   // ------------------------------------------------
+   // The selected channels, in increasing order, with
+   // the n'th stored as if it were channel n
+   // ------------------------------------------------
+   int ichans[128];
+   int nchans = 0;
+   if (options.m_mask)
+   {
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         if (options.m_mask->isSet (ichan)) ichans[nchans++] = ichan;
+      }
+   }
+
+
+   if (pkts.isWibFrame ())
+   {
+      WibTranspose transpose (adcs, nadcs, options, ichans, nchans);
+
+      if (options.m_assessor)
+      {
+         options.m_assessor->transposeAndAssess (tpcStream, itick, nframes,
+                                                 WibTranspose::block,
+                                                 &transpose);
+      }
+      else
+      {
+         transpose.run (pkts.getWibFrames (itick), 0, nframes);
+      }
+   }
+   else if (pkts.isCompressed ())
+   {
+      DecompressPlan plan (adcs, nadcs);
+      plan.m_stream = options.m_store == TpcStreamUnpack::Store::Streaming;
+      plan.m_stats  = options.m_stats;
+      if (options.m_mask)
+      {
+         plan.m_ichans  = ichans;
+         plan.m_nichans = nchans;
+      }
+
+      if (!plan.add (pkts, itick, nframes)) return false;
+
+      // Decompress the channels of all the packets
+      plan.run ();
+   }
+
+   return true;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts all the adc data in the specified range as pedestal
+          subtracted, gain corrected floats
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]   adcs  An array of essentially NChannels x nadcs
+  \param[in]  nadcs  The number of elements in each channel array
+  \param[in]    tpc  The Tpc stream
+  \param[in]  itick  The beginning time sample tick
+  \param[in] nticks  The number of ticks to extract, further limited by
+                     nadcs and the number of frames
+  \param[in]   peds  The pedestal of each channel
+  \param[in]  gains  The gain of each channel or NULL
+
+  \par
+   The conversion is done by the WIB frame transposer and the compressed
+   data decoder on blocks that are still in the cache, so the int16_t
+   ADCs are never stored.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static bool getMultiChannelDataBase (float                       *adcs,
+                                     int                         nadcs,
+                                     pdd::access::TpcStream const *tpc,
+                                     int                         itick,
+                                     int                        nticks,
+                                     float const                 *peds,
+                                     float const                *gains)
+{
+   using namespace pdd::access;
+
+   PacketList pkts (tpc);
+
+   if (nticks > nadcs) nticks = nadcs;
+
+   int nframes = pkts.limit (nticks, itick);
+   if (nframes <= 0) return false;
+
+
+   if (pkts.isWibFrame ())
+   {
+      WibFrame::transposeAdcs128xN (adcs, nadcs, pkts.getWibFrames (itick),
+                                    nframes, peds, gains);
+   }
+   else if (pkts.isCompressed ())
+   {
+      DecompressPlan plan (adcs, nadcs, peds, gains);
+      if (!plan.add (pkts, itick, nframes)) return false;
+
+      // Decompress and convert the channels of all the packets
+      plan.run ();
+   }
+
+   return true;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class RoiFinder
+  \brief Finds the regions of interest of the 128 channels of a stream,
+         one block of ticks at a time
+
+  \par
+   The blocks are unpacked into a scratch array of 128 rows, each with
+   room for npre ticks of history in front of the block.  After a block
+   is scanned, the last npre ticks of each row are moved to its history
+   so that the pre-padding of a region starting near the beginning of
+   the next block is still available.  Neither the block nor the
+   history is ever larger than a packet, so the scratch array stays in
+   the cache and the ADCs are scanned straight after being unpacked.
+
+  \par
+   A region is kept open until a tick over threshold is found beyond its
+   post-padding and pre-padding or the stream ends, its ADCs being
+   copied as each block is scanned.  Each channel's regions and ADCs are
+   kept separately, so that a region can span blocks, and are gathered,
+   by channel, at the end.
+
+  \par
+   A compressed packet may have fewer than 128 channels.  The channels
+   absent from a block have no ADCs for its ticks, so a region open on
+   one is closed where its ADCs end and the pre-padding of its next
+   region does not reach back beyond where its ADCs resume.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class RoiFinder
+{
+public:
+   typedef TpcStreamUnpack::Roi Roi;
+
+public:
+   RoiFinder (int16_t const        *peds,
+              int16_t const  *thresholds,
+              int                   npre,
+              int                  npost,
+              int                 nblock);
+
+   int16_t *getBlock  ()       { return m_scratch.data () + m_npre; }
+   int      getStride () const { return m_stride; }
+
+   void     scan   (int nticks, int nchans);
+   void     finish (std::vector<Roi>     &rois,
+                    std::vector<int16_t> &samples);
+
+private:
+   class Channel
+   {
+   public:
+      Channel () :
+         m_open  (false),
+         m_beg   (0),
+         m_end   (0),
+         m_next  (0),
+         m_first (0)
+      {
+         return;
+      }
+
+   public:
+      bool                    m_open; /*!< A region is open               */
+      int                      m_beg; /*!< Its first tick                 */
+      int                      m_end; /*!< Its end tick, exclusive        */
+      int                     m_next; /*!< The next tick to be copied     */
+      int                    m_first; /*!< The first tick with ADCs since
+                                           the channel was last absent    */
+      std::vector<Roi>        m_rois; /*!< The closed regions             */
+      std::vector<int16_t> m_samples; /*!< The ADCs of all its regions    */
+   };
+
+   void hit   (Channel &chan, int ichan, int16_t const *row, int tick);
+   void copy  (Channel &chan, int16_t const *row, int end);
+   void close (Channel &chan, int ichan, int end);
+
+private:
+   int16_t const           *m_peds; /*!< The pedestals                    */
+   int16_t const     *m_thresholds; /*!< The thresholds                   */
+   int                      m_npre; /*!< Ticks of padding before          */
+   int                     m_npost; /*!< Ticks of padding after           */
+   int                    m_stride; /*!< The row stride of the scratch    */
+   int                      m_tick; /*!< The first tick of the block      */
+   int                    m_nchans; /*!< The most channels seen           */
+   std::vector<int16_t>  m_scratch; /*!< The history and block, by row    */
+   Channel            m_chans[128]; /*!< The state of each channel        */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor
+
+  \param[in]       peds  The pedestal  of each of the 128 channels
+  \param[in] thresholds  The threshold of each of the 128 channels
+  \param[in]       npre  The number of ticks of padding before a region
+  \param[in]      npost  The number of ticks of padding after  a region
+  \param[in]     nblock  The maximum number of ticks in a block
+                                                                          */
+/* ---------------------------------------------------------------------- */
+RoiFinder::RoiFinder (int16_t const        *peds,
+                      int16_t const  *thresholds,
+                      int                   npre,
+                      int                  npost,
+                      int                 nblock) :
+   m_peds       (peds),
+   m_thresholds (thresholds),
+   m_npre       (npre),
+   m_npost      (npost),
+   m_stride     (npre + nblock),
+   m_tick       (0),
+   m_nchans     (0),
+   m_scratch    (128 * (npre + nblock), 0)
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Scans the block just unpacked into getBlock
+
+  \param[in] nticks  The number of ticks in the block
+  \param[in] nchans  The number of channels in the block
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void RoiFinder::scan (int nticks, int nchans)
+{
+   if (nchans > m_nchans) m_nchans = nchans;
+
+   int16_t *row = getBlock ();
+   for (int ichan = 0; ichan < nchans; ichan++, row += m_stride)
+   {
+      Channel &chan = m_chans[ichan];
+      int16_t   ped = m_peds      [ichan];
+      int16_t   thr = m_thresholds[ichan];
+      int      itck = 0;
+
+#if defined (__SSE2__)
+      // ---------------------------------------------------------
+      // 8 ticks at a time, |adc - ped| > thr as adc > ped + thr or
+      // adc < ped - thr.  Clamping these bounds to 16 bits leaves
+      // the outcome unchanged, while a saturated |adc - ped| would
+      // miss differences beyond 32767.  Most of the ticks are
+      // quiet, so only the rare non-zero masks are looked at tick
+      // by tick.
+      // ---------------------------------------------------------
+      int hi = ped + thr;
+      int lo = ped - thr;
+      hi = hi > 32767 ? 32767 : hi < -32768 ? -32768 : hi;
+      lo = lo > 32767 ? 32767 : lo < -32768 ? -32768 : lo;
+
+      __m128i const vhi = _mm_set1_epi16 (hi);
+      __m128i const vlo = _mm_set1_epi16 (lo);
+      for (; itck + 8 <= nticks; itck += 8)
+      {
+         __m128i v = _mm_loadu_si128 (reinterpret_cast<__m128i const *>(row + itck));
+         __m128i m = _mm_or_si128    (_mm_cmpgt_epi16 (v,   vhi),
+                                      _mm_cmpgt_epi16 (vlo, v  ));
+
+         int mask  = _mm_movemask_epi8 (m) & 0x5555;
+         while (mask)
+         {
+            int idx = __builtin_ctz (mask) >> 1;
+            hit (chan, ichan, row, m_tick + itck + idx);
+            mask &= mask - 1;
+         }
+      }
+#endif
+
+      for (; itck < nticks; itck++)
+      {
+         int d = row[itck] - ped;
+         if (d > thr || -d > thr) hit (chan, ichan, row, m_tick + itck);
+      }
+
+
+      // ----------------------------------------------------
+      // Copy what the open region has in this block and keep
+      // the last npre ticks as the next block's history
+      // ----------------------------------------------------
+      if (chan.m_open)
+      {
+         int end = chan.m_end < m_tick + nticks ? chan.m_end : m_tick + nticks;
+         copy (chan, row, end);
+      }
+
+      if (m_npre)
+      {
+         memmove (row - m_npre, row + nticks - m_npre, m_npre * sizeof (*row));
+      }
+   }
+
+
+   // ------------------------------------------------------------
+   // The channels absent from this block, including those beyond
+   // the most seen so far, have no ADCs for its ticks.  Their open
+   // regions end with the ADCs copied so far.
+   // ------------------------------------------------------------
+   for (int ichan = nchans; ichan < 128; ichan++)
+   {
+      Channel &chan = m_chans[ichan];
+      if (chan.m_open) close (chan, ichan, chan.m_next);
+      chan.m_first = m_tick + nticks;
+   }
+
+   m_tick += nticks;
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Adds a tick over threshold to its channel's regions
+
+  \param[in,out] chan  The channel's state
+  \param[in]    ichan  The channel
+  \param[in]      row  The channel's row of the scratch array
+  \param[in]     tick  The tick
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void RoiFinder::hit (Channel &chan, int ichan, int16_t const *row, int tick)
 {
-   using namespace pdd;
-   std::string myname = "extractAdcs: ";
-   bool dbg = false;
-
-   if ( dbg ) {
-     std::cout << myname << "===== nadcs=" << nadcs << ", nticks=" << nticks
-               << ", itick=" << itick << ", npkts=" << npkts
-               << ", output @ " << adcs << std::endl;
-   }
-   if ( nticks <= 0 ) return false;      // dla jan 2020  (trj mar 2020)
+   int beg = tick - m_npre;
+   if (beg < chan.m_first) beg = chan.m_first;
 
-   if (access::TpcTocPacketDsc::isWibFrame (pktDscs))
+   // Extend the open region if the padding overlaps or touches it
+   if (!chan.m_open || beg > chan.m_end)
    {
-      if ( dbg ) std::cout << myname << "== Data format is WibFrame" << std::endl;
-      int              o64    = access::TpcTocPacketDsc::getOffset64 (pktDscs);
-      uint64_t const  *p64    = access::TpcPacketBody  ::getData (pkts) + o64;
-
-      pdd::access::WibFrame const *frames = reinterpret_cast<decltype(frames)>(p64)
-                                          + itick;
-      int                         nframes = nticks;
+      if (chan.m_open)
+      {
+         copy  (chan, row, chan.m_end);
+         close (chan, ichan, chan.m_end);
+      }
 
-      access::WibFrame::transposeAdcs128xN (adcs, nadcs, frames, nframes);
+      chan.m_open = true;
+      chan.m_beg  = beg;
+      chan.m_next = beg;
    }
-   else if (access::TpcTocPacketDsc::isCompressed (pktDscs))
-   {
-      if ( dbg ) std::cout << myname << "== Data format is Compressed" << std::endl;
-      pdd::record::TpcTocPacketDsc const *pktDsc = pktDscs;
 
-      unsigned int unticks = nticks;
-      for (int ipkt = 0; ipkt < npkts; pktDsc++, ipkt++)
-      {
-         if ( dbg ) std::cout << myname << "Packet " << ipkt << ": Output @ " << adcs << std::endl;
-         int              o64 = access::TpcTocPacketDsc::getOffset64 (pktDsc);
-         uint64_t const  *p64 = access::TpcPacketBody  ::getData (pkts) + o64;
-         uint64_t         n64 = access::TpcTocPacketDsc::getLen64 (pktDsc);
-
-         access::TpcCompressed cmp (p64, n64);
-
-         unsigned int nsamples;
-         if ( itick ) {
-            nsamples = cmp.decompress (adcs, nadcs, itick, nticks);
-         } else {
-            nsamples = cmp.decompress (adcs, nadcs, nticks);
-         }
+   chan.m_end = tick + m_npost + 1;
+   return;
+}
+/* ---------------------------------------------------------------------- */
 
-         if ( dbg ) std::cout << myname << "  Nsamples: " << nsamples << std::endl;
 
-         // DLA jan2020: Exit if decompress returns too many ticks.
-         // See https://cdcvs.fnal.gov/redmine/issues/23811.
-         if ( nsamples > unticks ) {
-           std::cout << myname << "WARNING: Too many samples decoded." << std::endl;
-           //break;
-           return false;
-         }
-         
-         nticks  -= nsamples;
 
-         // DLA jan2020: I don't know why this is done but I carry it over from the old code.
-         if ( itick && nticks > 0 ) {
-           if ( dbg ) std::cout << myname << "  Setting itick = 0." << std::endl;
-           itick = 0;
-         }
+/* ---------------------------------------------------------------------- *//*!
 
-         if (nticks <= 0) break;
-         adcs     += nsamples;
-      }
+  \brief Copies the open region's ADCs up to, but not including, end
+
+  \param[in,out] chan  The channel's state
+  \param[in]      row  The channel's row of the scratch array
+  \param[in]      end  The tick to copy up to
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void RoiFinder::copy (Channel &chan, int16_t const *row, int end)
+{
+   if (end > chan.m_next)
+   {
+      int16_t const *src = row + (chan.m_next - m_tick);
+      chan.m_samples.insert (chan.m_samples.end (), src, src + end - chan.m_next);
+      chan.m_next = end;
    }
 
-   return true;
+   return;
 }
 /* ---------------------------------------------------------------------- */
 
 
 
+/* ---------------------------------------------------------------------- *//*!
 
+  \brief Closes the open region, which must have been copied up to end
 
-/* ---------------------------------------------------------------------- *//*!
+  \param[in,out] chan  The channel's state
+  \param[in]    ichan  The channel
+  \param[in]      end  The region's end tick, exclusive
+                                                                          */
+/* ---------------------------------------------------------------------- */
+inline void RoiFinder::close (Channel &chan, int ichan, int end)
+{
+   Roi roi;
+   roi.m_chan     = ichan;
+   roi.m_tick     = chan.m_beg;
+   roi.m_nsamples = end - chan.m_beg;
+   roi.m_offset   = chan.m_samples.size () - roi.m_nsamples;
 
-  \brief   Extracts the ADCs in the specified range
-  \retval  == true is successful
-  \retval  == false is failure
+   chan.m_rois.push_back (roi);
+   chan.m_open = false;
 
-  \param[out]  adcs  An array of essentially NChannels x NTicks where
-                     nChannels comes from getNChannels and nTicks indicates
-                     how many ticks to allocate to each array
-  \param[in] nadcs   The number of elements to allocate in each each
-                     channel array.  It can be
-                       -# larger than the number of frames. This effectively
-                          leaves some room at the end of each channel.
-                          It allows one to recall this method and append
-                          more ticks.
-                       -# smaller than the number of frames. This will
-                          limit the number of transposed frames to this
-                          value.
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Closes the regions still open at the end of the stream and
+         gathers the regions and their ADCs, by channel
 
-  \param[in]    pkts  The array of TPC packets
-  \param[in] pktDscs  The array of packet descriptors
-  \param[in]   npkts  The number of packets and, by implication, the number
-                      of packet descriptors
-  \param[in]   itick  The tick number of the first sample number to be
-                      extracted. Typically this represents the first ADC
-                      value in the event window
-  \param[in]  nticks  The number of adcs to extract.  Typically this
-                      represents the number of ADCs in the event window
+  \param[out]    rois  The regions
+  \param[out] samples  Their ADCs
                                                                           */
 /* ---------------------------------------------------------------------- */
-inline static bool extractAdcs (int16_t        *const                 *adcs,
-                                pdd::record::TpcPacketBody   const    *pkts,
-                                pdd::record::TpcTocPacketDsc const *pktDscs,
-                                int                                   npkts,
-                                int                                   itick,
-                                int                                  nticks)
+void RoiFinder::finish (std::vector<Roi>     &rois,
+                        std::vector<int16_t> &samples)
 {
-   using namespace pdd;
+   size_t nrois    = 0;
+   size_t nsamples = 0;
 
-   if (access::TpcTocPacketDsc::isWibFrame (pktDscs))
-   {
-      transpose (adcs, npkts, pktDscs, pkts, itick, nticks);
-   }
-   else if (pdd::access::TpcTocPacketDsc::isCompressed (pktDscs))
+   for (int ichan = 0; ichan < m_nchans; ichan++)
    {
-      record::TpcTocPacketDsc const *pktDsc = pktDscs;
-      int                              iadc = 0;
+      Channel &chan = m_chans[ichan];
+      if (chan.m_open) close (chan, ichan, chan.m_next);
 
-      for (int ipkt = 0; ipkt < npkts; pktDsc++, ipkt++)
-      {
-         int              o64 = access::TpcTocPacketDsc::getOffset64 (pktDsc);
-         uint64_t const  *p64 = access::TpcPacketBody  ::getData  (pkts) + o64;
-         uint64_t         n64 = access::TpcTocPacketDsc::getLen64 (pktDsc);
+      nrois    += chan.m_rois   .size ();
+      nsamples += chan.m_samples.size ();
+   }
 
-         access::TpcCompressed cmp (p64, n64);
+   rois   .clear   ();
+   samples.clear   ();
+   rois   .reserve (nrois);
+   samples.reserve (nsamples);
 
-         int nsamples;
-         if (itick)
-         {
-            nsamples = cmp.decompress (adcs, iadc, itick, nticks);
-            nticks  -= nsamples;
-            if (nticks > 0) itick = 0;
-         }
-         else
-         {
-            nsamples = cmp.decompress (adcs, iadc, nticks);
-            nticks  -= nsamples;
-         }
+   for (int ichan = 0; ichan < m_nchans; ichan++)
+   {
+      Channel const &chan = m_chans[ichan];
+      uint32_t      base  = samples.size ();
 
-         if (nticks <= 0) break;
-         iadc  += nsamples;
+      for (Roi roi : chan.m_rois)
+      {
+         roi.m_offset += base;
+         rois.push_back (roi);
       }
+
+      samples.insert (samples.end (), chan.m_samples.begin (),
+                                      chan.m_samples.end   ());
    }
 
-   return true;
+   return;
 }
 /* ---------------------------------------------------------------------- */
 
 
 
 
-
 /* ---------------------------------------------------------------------- *//*!
 
-  \brief  Extracts all the adc data in the specified range
+  \brief  Extracts the regions of interest of the specified range
   \retval true, if successful
   \retval false, if not successful
 
-  \param[in]   adcs  An array of essentially NChannels x NTicks where
-                     nChannels comes from getNChannels and nTicks indicates
-                     how many ticks to allocate to each array
-  \param[in]    tpc  Access to the Tpc stream
-  \param[in]  itick  The beginning time sample tick
-  \param[in]  nadcs  The number of elements to allocate in each each
-                     channel array.  It can be
-                       -# larger than the number of frames. This effectively
-                          leaves some room at the end of each channel.
-                          It allows one to recall this method and append
-                          more ticks.
-                       -# smaller than the number of frames. This will
-                          limit the number of transposed frames to this
-                          value.
+  \param[out]      rois  The regions, by channel and then by tick
+  \param[out]   samples  Their ADCs
+  \param[in]        tpc  The Tpc stream
+  \param[in]      itick  The beginning time sample tick
+  \param[in]     nticks  The number of ticks to extract, further limited
+                         by the number of frames
+  \param[in]       peds  The pedestal  of each of the 128 channels
+  \param[in] thresholds  The threshold of each of the 128 channels
+  \param[in]       npre  The number of ticks of padding before a region
+  \param[in]      npost  The number of ticks of padding after  a region
+
+  \par
+   WIB frames are transposed AdcStats::MaxBlock frames at a time and
+   compressed data is decompressed a packet at a time, each block being
+   scanned for regions while it is still in the cache.
                                                                           */
 /* ---------------------------------------------------------------------- */
-static bool getMultiChannelDataBase (int16_t                     *adcs,
-                                     pdd::access::TpcStream const *tpc,
-                                     int                         itick,
-                                     int                        nticks)
+static bool getRoisBase (std::vector<TpcStreamUnpack::Roi>  &rois,
+                         std::vector<int16_t>            &samples,
+                         pdd::access::TpcStream const        *tpc,
+                         int                                itick,
+                         int                               nticks,
+                         int16_t const                      *peds,
+                         int16_t const                *thresholds,
+                         int                                 npre,
+                         int                                npost)
 {
-   using namespace pdd;
    using namespace pdd::access;
 
+   PacketList pkts (tpc);
 
-   record::TpcToc          const     *toc = tpc->getToc               ();
-   record::TpcPacket       const  *pktRec = tpc->getPacket            ();
+   rois   .clear ();
+   samples.clear ();
 
-   int                           npktDscs = TpcToc   ::getNPacketDscs    (toc);
-   record::TpcTocPacketDsc const *pktDscs = TpcToc   ::getPacketDscs     (toc);
-   record::TpcPacketBody   const    *pkts = TpcPacket::getBody        (pktRec);
+   if (npre < 0 || npost < 0) return false;
 
+   int nframes = pkts.limit (nticks, itick);
+   if (nframes <= 0) return false;
 
 
-   // ---------------------------------------------------------
-   // Loop over all the 128 channel contributors.
-   // This loop cheats in that it knows the frames from all the
-   // contributors are stored contigously.
-   // ---------------------------------------------------------
+   if (pkts.isWibFrame ())
+   {
+      WibFrame const *frames = pkts.getWibFrames (itick);
+
+      RoiFinder finder (peds, thresholds, npre, npost, AdcStats::MaxBlock);
+
+      for (int iframe = 0; iframe < nframes; iframe += AdcStats::MaxBlock)
+      {
+         int nblock = nframes - iframe;
+         if (nblock > AdcStats::MaxBlock) nblock = AdcStats::MaxBlock;
+
+         WibFrame::transposeAdcs128xN (finder.getBlock  (),
+                                       finder.getStride (),
+                                       frames + iframe, nblock);
+         finder.scan (nblock, 128);
+      }
+
+      finder.finish (rois, samples);
+   }
+   else if (pkts.isCompressed ())
+   {
+      // -------------------------------------------------------
+      // Find the packets and how many ticks each contributes,
+      // the largest of these sizing the finder's blocks
+      // -------------------------------------------------------
+      std::vector<TpcCompressed> cmps;
+      std::vector<int>           nsamples;
+      int                        begTick = itick;
+      int                        nblock  = 0;
+
+      for (int ipkt = 0; ipkt < pkts.m_ndscs && nframes > 0; ipkt++)
+      {
+         TpcCompressed cmp = pkts.getPacket (ipkt);
+
+         int n = cmp.getNDecompressed (begTick, nframes);
+         if (n > nframes) return false;
+
+         cmps    .push_back (cmp);
+         nsamples.push_back (n);
+         if (n > nblock) nblock = n;
+
+         nframes -= n;
+         if (begTick && nframes > 0) begTick = 0;
+      }
+
+      RoiFinder finder (peds, thresholds, npre, npost, nblock);
 
-   int nframes = limit (nticks, itick, pktDscs, npktDscs);
-   bool   okay = extractAdcs (adcs, nticks, pkts, pktDscs, npktDscs, itick, nframes);
-   return okay;
+      begTick = itick;
+      for (size_t ipkt = 0; ipkt < cmps.size (); ipkt++)
+      {
+         TpcCompressed &cmp = cmps[ipkt];
+         int         nchans = TpcCompressedTocTrailer::
+                              getNChannels (cmp.getTocTrailer ());
+         if (nchans > 128) nchans = 128;
+
+         cmp.decompress (finder.getBlock (), finder.getStride (),
+                         begTick, nsamples[ipkt]);
+         finder.scan    (nsamples[ipkt], nchans);
+         begTick = 0;
+      }
+
+      finder.finish (rois, samples);
+   }
+   else
+   {
+      return false;
+   }
 
+   return true;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -710,21 +2027,24 @@ static bool getMultiChannelDataBase (int16_t               *const *adcs,
                                      int                          itick,
                                      int                         nticks)
 {
-   using namespace pdd;
-   using namespace pdd::access;
-
-   record::TpcToc          const     *toc = tpc->getToc               ();
-   record::TpcPacket       const  *pktRec = tpc->getPacket            ();
+   PacketList pkts (tpc);
 
-   int                           npktDscs = TpcToc   ::getNPacketDscs    (toc);
-   record::TpcTocPacketDsc const *pktDscs = TpcToc   ::getPacketDscs     (toc);
-   record::TpcPacketBody   const    *pkts = TpcPacket::getBody        (pktRec);
+   int nframes = pkts.limit (nticks, itick);
 
+   if (pkts.isWibFrame ())
+   {
+      transpose (adcs, pkts.m_ndscs, pkts.m_dscs, pkts.m_body, itick, nframes);
+   }
+   else if (pkts.isCompressed ())
+   {
+      DecompressPlan plan (adcs);
+      if (!plan.add (pkts, itick, nframes)) return false;
 
-   int nframes = limit       (nticks, itick, pktDscs, npktDscs);
-   bool   okay = extractAdcs (adcs,    pkts, pktDscs, npktDscs, itick, nframes);
+      // Decompress the channels of all the packets
+      plan.run ();
+   }
 
-   return okay;
+   return true;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -738,23 +2058,12 @@ static bool getMultiChannelDataBase (std::vector<TpcAdcVector>      &adcs,
                                      int                            itick,
                                      int                           nticks)
 {
-   using namespace pdd;
-   using namespace pdd::access;
-
-   record::TpcToc          const     *toc = tpc->getToc   ();
-   record::TpcPacket       const  *pktRec = tpc->getPacket();
-
-   int                           npktDscs = TpcToc   ::getNPacketDscs (toc);
-   record::TpcTocPacketDsc const *pktDscs = TpcToc   ::getPacketDscs  (toc);
-   record::TpcPacketBody   const    *pkts = TpcPacket::getBody     (pktRec);
-
-
    int16_t *pAdcs[128];
 
    // -----------------------------------------------
    // Limit the number of frames to what is available
    // -----------------------------------------------
-   int nframes = limit (nticks, itick, pktDscs, npktDscs);
+   int nframes = PacketList (tpc).limit (nticks, itick);
    int  nchans = adcs.capacity ();
 
 
@@ -769,7 +2078,7 @@ static bool getMultiChannelDataBase (std::vector<TpcAdcVector>      &adcs,
    }
 
 
-   bool    okay = extractAdcs (pAdcs, pkts, pktDscs, npktDscs, itick, nframes);
+   bool    okay = getMultiChannelDataBase (pAdcs, tpc, itick, nframes);
    return  okay;
 }
 /* ---------------------------------------------------------------------- */
@@ -806,7 +2115,42 @@ bool TpcStreamUnpack::getMultiChannelDataUntrimmed (int16_t  *adcs,
    if (!isTpcNormal ()) return false;
 
 
-   bool ok = getMultiChannelDataBase (adcs, &m_stream, 0, nticks);
+   bool ok = getMultiChannelDataBase (adcs, nticks, *this, 0, nticks,
+                                      Options ());
+   return ok;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts all the untrimmed data, doing the optional work of
+          options in the same pass
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]    adcs  An array of essentially NChannels x nticks, or
+                      NSelected x nticks if channels are selected
+  \param[in]  nticks  The number of elements in each channel array, see
+                      getMultiChannelDataUntrimmed (int16_t *, int)
+  \param[in] options  The optional work, see
+                      getMultiChannelData (int16_t *, int, Options const &)
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getMultiChannelDataUntrimmed (int16_t           *adcs,
+                                                    int               nticks,
+                                                    Options const  &options) const
+{
+   // -----------------------------------
+   // Only process normal streams for now
+   // -----------------------------------
+   if (!isTpcNormal ()) return false;
+
+
+   bool ok = getMultiChannelDataBase (adcs, nticks, *this, 0, nticks,
+                                      options);
    return ok;
 }
 /* ---------------------------------------------------------------------- */
@@ -887,19 +2231,73 @@ bool TpcStreamUnpack::
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts all the untrimmed data as pedestal subtracted, gain
+          corrected floats
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]   adcs  An array of essentially NChannels x nticks
+  \param[in] nticks  The number of elements in each channel array, see
+                     getMultiChannelDataUntrimmed (int16_t *, int)
+  \param[in]   peds  The pedestal of each of the NChannels channels
+  \param[in]  gains  The gain of each channel.  If NULL, all the gains
+                     are taken as 1.
+                                                                          */
 /* ---------------------------------------------------------------------- */
-static inline void getTrimmed (pdd::access::TpcStream const *tpc,
-                               int                          *beg,
-                               int                       *nticks)
+bool TpcStreamUnpack::
+     getMultiChannelDataUntrimmed (float                 *adcs,
+                                   int                   nticks,
+                                   float const            *peds,
+                                   float const           *gains) const
 {
-   using namespace pdd;
-   using namespace pdd::access;
-   
-   TpcTrimmedRange trimmed (*tpc);
-   *beg         = trimmed.m_beg.m_wibOff;
-   *nticks      = trimmed.m_nticks;
+   // -----------------------------------
+   // Only process normal streams for now
+   // -----------------------------------
+   if (!isTpcNormal ()) return false;
 
-   return;
+
+   bool ok = getMultiChannelDataBase (adcs, nticks, &m_stream, 0, nticks,
+                                      peds, gains);
+   return ok;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the regions of interest of all the untrimmed data
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[out]      rois  The regions, see getRois
+  \param[out]   samples  Their ADCs
+  \param[in]       peds  The pedestal  of each of the 128 channels
+  \param[in] thresholds  The threshold of each of the 128 channels
+  \param[in]       npre  The number of ticks of padding before a region
+  \param[in]      npost  The number of ticks of padding after  a region
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getRoisUntrimmed (std::vector<Roi>        &rois,
+                                        std::vector<int16_t> &samples,
+                                        int16_t const           *peds,
+                                        int16_t const     *thresholds,
+                                        int                      npre,
+                                        int                     npost) const
+{
+   // -----------------------------------
+   // Only process normal streams for now
+   // -----------------------------------
+   if (!isTpcNormal ()) return false;
+
+
+   bool ok = getRoisBase (rois, samples, &m_stream, 0, -1,
+                          peds, thresholds, npre, npost);
+   return ok;
 }
 /* ---------------------------------------------------------------------- */
 
@@ -914,13 +2312,165 @@ bool TpcStreamUnpack::getMultiChannelData (int16_t *adcs) const
    // -----------------------------------
    /// if (!isTpcNormal ()) return false;
 
-   int    beg;
-   int nticks;
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, summary.m_nticks, *this,
+                                      summary.m_begOff, summary.m_nticks,
+                                      Options ());
+   return ok;
+}
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the trimmed data into channel arrays of a specified
+          size
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]   adcs  An array of essentially NChannels x nadcs
+  \param[in]  nadcs  The number of elements in each channel array. If
+                     this is larger than getNTicks, the end of each
+                     channel array is left untouched, if it is smaller
+                     only the first nadcs ticks are extracted.
+
+  \par
+   This allows the trimmed data of several streams, whose number of 
+   ticks may differ because of dropped frames, to be placed in one 
+   common array.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getMultiChannelData (int16_t *adcs, int nadcs) const
+{
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, nadcs, *this,
+                                      summary.m_begOff, summary.m_nticks,
+                                      Options ());
+   return ok;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the trimmed data into channel arrays of a specified
+          size, doing the optional work of options in the same pass
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]    adcs  An array of essentially NChannels x nadcs, or
+                      NSelected x nadcs if channels are selected
+  \param[in]   nadcs  The number of elements in each channel array, see
+                      getMultiChannelData (int16_t *, int)
+  \param[in] options  The optional work
+
+  \par
+   The options, see Options, are
+     - select, only the selected channels are unpacked and, for the most
+       part, the work is in proportion to their number.
+     - stats, the statistics of each channel, stats[n] being channel
+       n's, are reset and accumulated over the unpacked ticks.  This
+       replaces the usual pedestal and RMS pass over the unpacked array.
+     - assess, the WIB frames are assessed by the assessor, a block at a
+       time, as they are transposed.  Only the trimmed frames are
+       assessed.
+     - store, with Store::Streaming the WIB frames are transposed through
+       a cache resident tile and the compressed packets decoded into a
+       cache resident buffer, each then written to the channel arrays
+       with non-temporal stores.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getMultiChannelData (int16_t           *adcs,
+                                           int               nadcs,
+                                           Options const  &options) const
+{
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, nadcs, *this,
+                                      summary.m_begOff, summary.m_nticks,
+                                      options);
+   return ok;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the trimmed data into channel arrays of a specified
+          size as pedestal subtracted, gain corrected floats
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[in]  adcs  An array of essentially NChannels x nadcs
+  \param[in] nadcs  The number of elements in each channel array, see
+                    getMultiChannelData (int16_t *, int)
+  \param[in]  peds  The pedestal of each of the NChannels channels
+  \param[in] gains  The gain of each channel.  If NULL, all the gains
+                    are taken as 1.
+
+  \par
+   Channel n's values are (adc - peds[n]) * gains[n].  This replaces
+   unpacking to int16_t followed by a separate conversion pass over the
+   whole array.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getMultiChannelData (float                 *adcs,
+                                           int                   nadcs,
+                                           float const            *peds,
+                                           float const           *gains) const
+{
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, nadcs, &m_stream,
+                                      summary.m_begOff, summary.m_nticks,
+                                      peds, gains);
+   return ok;
+}
+/* ---------------------------------------------------------------------- */
+
+
 
-   getTrimmed (&m_stream, &beg, &nticks);
-   bool ok = getMultiChannelDataBase (adcs, &m_stream, beg, nticks);
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Extracts the regions of interest of the trimmed data
+  \retval true, if successful
+  \retval false, if not successful
+
+  \param[out]      rois  The regions, by channel and then by tick.  Their
+                         ticks are counted from the first trimmed tick.
+  \param[out]   samples  Their ADCs, one region after the other
+  \param[in]       peds  The pedestal  of each of the 128 channels
+  \param[in] thresholds  The threshold of each of the 128 channels
+  \param[in]       npre  The number of ticks of padding before a region
+  \param[in]      npost  The number of ticks of padding after  a region
+
+  \par
+   A tick of channel n is over threshold if |adc - peds[n]| >
+   thresholds[n].  Each run of these is widened by the padding, clipped
+   to the trimmed range, and runs that then overlap or touch are merged.
+   This replaces unpacking the full channels x ticks array and scanning
+   it: the stream is unpacked in blocks that are scanned while still in
+   the cache, and only the regions' ADCs are kept.  Channels that a
+   compressed stream does not have have no regions.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool TpcStreamUnpack::getRois (std::vector<Roi>        &rois,
+                               std::vector<int16_t> &samples,
+                               int16_t const           *peds,
+                               int16_t const     *thresholds,
+                               int                      npre,
+                               int                     npost) const
+{
+   Summary const  summary = getSummary ();
+   bool ok = getRoisBase (rois, samples, &m_stream,
+                          summary.m_begOff, summary.m_nticks,
+                          peds, thresholds, npre, npost);
    return ok;
 }
+/* ---------------------------------------------------------------------- */
+
 
 bool TpcStreamUnpack::getMultiChannelData (int16_t **adcs) const
 {
@@ -929,11 +2479,9 @@ bool TpcStreamUnpack::getMultiChannelData (int16_t **adcs) const
    // -----------------------------------
    /// if (!isTpcNormal ()) return false;
 
-   int    beg;
-   int nticks;
-
-   getTrimmed (&m_stream, &beg, &nticks);
-   bool ok = getMultiChannelDataBase (adcs, &m_stream, beg, nticks);
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, &m_stream, summary.m_begOff,
+                                                       summary.m_nticks);
    return ok;
 }
 
@@ -944,11 +2492,9 @@ bool TpcStreamUnpack::getMultiChannelData(std::vector<TpcAdcVector> &adcs) const
    // -----------------------------------
    //// if (!isTpcNormal ()) return false;
 
-   int    beg;
-   int nticks;
-
-   getTrimmed (&m_stream, &beg, &nticks);
-   bool ok = getMultiChannelDataBase (adcs, &m_stream, beg, nticks);
+   Summary const  summary = getSummary ();
+   bool ok = getMultiChannelDataBase (adcs, &m_stream, summary.m_begOff,
+                                                       summary.m_nticks);
    return ok;
 }
 
@@ -1061,12 +2607,7 @@ uint32_t TpcStreamUnpack::getRangeUntrimmed (size_t       *nticks,
 /* ---------------------------------------------------------------------- */
 TpcStreamUnpack::timestamp_t TpcStreamUnpack::getTimeStamp () const
 {
-   using namespace pdd;
-   using namespace pdd::access;
-
-   TpcTrimmedRange trimmed (m_stream);
-
-   timestamp_t begin = trimmed.m_beg.m_wibTs;
+   timestamp_t begin = getSummary ().m_begTs;
    return begin;
 }
 /* ---------------------------------------------------------------------- */
@@ -1097,14 +2638,11 @@ uint32_t TpcStreamUnpack::getRange (size_t      *nticks,
                                     timestamp_t  *begin,
                                     timestamp_t    *end) const
 {
-   using namespace pdd;
-   using namespace pdd::access;
-
-   TpcTrimmedRange trimmed (m_stream);
+   Summary const  summary = getSummary ();
 
-   *begin  = trimmed.m_beg.m_wibTs;
-   *end    = trimmed.m_end.m_wibTs;
-   *nticks = trimmed.m_nticks;
+   *begin  = summary.m_begTs;
+   *end    = summary.m_endTs;
+   *nticks = summary.m_nticks;
 
 
    return 0;
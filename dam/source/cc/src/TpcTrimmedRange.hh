@@ -40,6 +40,9 @@
   
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Widened Location::m_wibOff to 32 bits, taking the space
+                  of the unused reserved word.  A 16-bit offset wraps once
+                  a stream holds more than 65535 frames.
    2018.10.22 jjr Corrected getting the correct number of frames for the
                   trimmed compressed data.  It was incorrectly using 
                   getNWibFrames, which cleary does not work for compressed
@@ -93,11 +96,10 @@ public:
    public:
       uint64_t    m_wibTs; /*!< The WIB frame timestamp                   */
       uint64_t    m_tgtTs; /*!< The target timestamp                      */
-      uint16_t   m_wibOff; /*!< The offset of the frame containing or
+      uint32_t   m_wibOff; /*!< The offset of the frame containing or
                                 nearest to the target time                */
       uint16_t   m_pktNum; /*!< The beginning packet number               */
       uint16_t   m_pktOff; /*!< The beginning offset                      */
-      uint16_t     m_rsvd; /*!< Reserved for future use                   */
    };
    /* ------------------------------------------------------------------- */
 
@@ -566,7 +568,7 @@ static inline void printA (char const  *title,
 static void inline printB (char const                    *which, 
                            TpcTrimmedRange::Location const &loc)
 {
-   printf ("%7s  Displacement:%6" PRIu16
+   printf ("%7s  Displacement:%6" PRIu32
            " Pkt.Off = %4" PRIu16 ".%6" PRIu16 
            " [%15.15" PRIx64 " <= %15.15" PRIx64 " < %15.15" PRIx64 "]\n",
 
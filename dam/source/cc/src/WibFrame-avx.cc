@@ -0,0 +1,69 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-avx.cc
+ *  @brief    WibFrame ADC expansion and transposition - AVX version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt Include <immintrin.h> for the generic non-temporal store
+                  kernel
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "WibFrame-dispatch.hh"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <immintrin.h>
+
+
+namespace pdd      {
+namespace access   {
+namespace wibframe {
+namespace avx      {
+
+#define WIBFRAME_KERNELS_HH "WibFrame-avx.hh"
+#define WIBFRAME_TARGET     __attribute__ ((target ("avx")))
+#define WIBFRAME_NAME       "avx"
+#include "WibFrame-drivers.hh"
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace avx                                                   */
+} /* END: namespace wibframe                                              */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
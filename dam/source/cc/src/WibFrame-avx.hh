@@ -40,15 +40,14 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Removed the __AVX2__ check.  All the variants are now
+                  compiled into the same library and selected at load
+                  time, so this may be compiled with AVX2 enabled.
    2017.09.20 jjr Separated from WibFrame-avx2.hh
 
 \* ---------------------------------------------------------------------- */
 
 
-#ifdef __AVX2__
-#error __AVX2__ should not be defined
-#endif
-
 // -------------------------------------------------
 // !!! KLUDGE !!! 
 // --------------
@@ -0,0 +1,70 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-avx2.cc
+ *  @brief    WibFrame ADC expansion and transposition - AVX2 version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt Include <immintrin.h>, the assessment kernel is written
+                  with intrinsics
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "WibFrame-dispatch.hh"
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <immintrin.h>
+
+
+namespace pdd      {
+namespace access   {
+namespace wibframe {
+namespace avx2     {
+
+#define WIBFRAME_KERNELS_HH "WibFrame-avx2.hh"
+#define WIBFRAME_TARGET     __attribute__ ((target ("avx2")))
+#define WIBFRAME_NAME       "avx2"
+#include "WibFrame-drivers.hh"
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace avx2                                                  */
+} /* END: namespace wibframe                                              */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
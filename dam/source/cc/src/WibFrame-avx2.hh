@@ -41,6 +41,14 @@
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
    2017.09.20 jjr Separated from WibFrame.cc
+   2026.10.16 agt Reload the ymm15 shuffle pattern in expandAdcs16x8N_kernel.
+                  At -O2 this routine is called out-of-line and the
+                  vzeroupper preceeding the call cleared the upper lane,
+                  corrupting every other channel group of the transposes.
+   2026.10.16 agt Added countInSequence_kernel.  Unlike the rest of this
+                  file it is written with intrinsics, so the includer must
+                  have included <immintrin.h>.
+   2026.10.16 agt Added streamAdcs_kernel, the non-temporal stores
 
 \* ---------------------------------------------------------------------- */
 
@@ -48,6 +56,20 @@
 #define STRIDE sizeof (WibFrame)
 
 
+/*
+ | Tells WibFrame-drivers.hh that the frame assessment kernel is
+ | provided here
+*/
+#define WIBFRAME_HAS_ASSESS_KERNEL 1
+
+
+/*
+ | Tells WibFrame-drivers.hh that the non-temporal store kernel is
+ | provided here
+*/
+#define WIBFRAME_HAS_STREAM_KERNEL 1
+
+
 /* ---------------------------------------------------------------------- */
 static void print (char const *what, uint64_t d[4]) __attribute__ ((unused));
 static void print (char const *what, uint64_t d[4])
@@ -454,6 +476,13 @@ static inline void expandAdcs16x8N_kernel (int16_t         *buf,
 {
    #define TIMESAMPLE_STRIDE (4 * STRIDE / sizeof (*src))
 
+   /*
+    | Reestablish the shuffle pattern in ymm15.  When this routine is not
+    | inlined, the compiler issues a vzeroupper before the call, wiping
+    | the upper lane of the pattern loaded by the driver.
+   */
+   expandAdcs16_init_kernel ();
+
    ///printf ("Timesample_Stride = %u\n", (unsigned)TIMESAMPLE_STRIDE);
 
    for (int idx = 0; idx < n8; ++idx)
@@ -958,4 +987,173 @@ static inline void transposeAdcs16x8_kernel (int16_t  *const  *dst,
 
 }
 /* ---------------------------------------------------------------------- */
+
+
+/* ====================================================================== */
+/* BEGIN: ASSESSMENT                                                      */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Counts the leading frames that continue the expected sequence
+   \return The number of frames
+
+   \par
+    Four frames are tested at once, one per 64-bit lane.  The header,
+    timestamp and cold data header words of the four are gathered and
+    compared against the expected values, the timestamps and convert
+    counts advancing by 25 and 1 from lane to lane.  Lanes that are out
+    of sequence are located from the comparison mask, so there is no
+    need to retest the frames one at a time.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline int countInSequence_kernel (WibFrame const    *frames,
+                                          int               nframes,
+                                          uint64_t           header,
+                                          uint64_t        timestamp,
+                                          unsigned int      cvtcnt0,
+                                          unsigned int      cvtcnt1)
+                  __attribute__ ((always_inline, target ("avx2")));
+
+static inline int countInSequence_kernel (WibFrame const    *frames,
+                                          int               nframes,
+                                          uint64_t           header,
+                                          uint64_t        timestamp,
+                                          unsigned int      cvtcnt0,
+                                          unsigned int      cvtcnt1)
+{
+   // Word offsets of the WIB and cold data headers within a frame
+   static const int Cd0 = offsetof (pdd::record::WibFrame, m_coldData[0])
+                        / sizeof (uint64_t);
+   static const int Cd1 = offsetof (pdd::record::WibFrame, m_coldData[1])
+                        / sizeof (uint64_t);
+   static const long long Stride64 = sizeof (WibFrame) / sizeof (uint64_t);
+
+   uint64_t const One    = static_cast<uint64_t>(1) << CvtCntShift;
+
+   __m256i const vidx   = _mm256_setr_epi64x (0, Stride64, 2 * Stride64,
+                                              3 * Stride64);
+   __m256i const vhdr   = _mm256_set1_epi64x (header);
+   __m256i const vmask0 = _mm256_set1_epi64x (CdMask0);
+   __m256i const vmask1 = _mm256_set1_epi64x (CdMask1);
+   __m256i const vzero  = _mm256_setzero_si256 ();
+   __m256i const vdts   = _mm256_set1_epi64x (4 * 25);
+   __m256i const vdcvt  = _mm256_set1_epi64x (4 * One);
+
+   __m256i const lane   = _mm256_setr_epi64x (0, 1, 2, 3);
+   __m256i vts   = _mm256_add_epi64 (_mm256_set1_epi64x (timestamp),
+                                     _mm256_mul_epu32  (lane,
+                                     _mm256_set1_epi64x (25)));
+   __m256i vcvt0 = _mm256_add_epi64 (_mm256_set1_epi64x
+                                     (static_cast<uint64_t>(cvtcnt0) << CvtCntShift),
+                                     _mm256_slli_epi64 (lane, CvtCntShift));
+   __m256i vcvt1 = _mm256_add_epi64 (_mm256_set1_epi64x
+                                     (static_cast<uint64_t>(cvtcnt1) << CvtCntShift),
+                                     _mm256_slli_epi64 (lane, CvtCntShift));
+
+   long long const *base = reinterpret_cast<long long const *>(frames);
+
+   int iframe;
+   for (iframe = 0; iframe + 4 <= nframes; iframe += 4)
+   {
+      long long const *p = base + iframe * Stride64;
+
+      __m256i hdr  = _mm256_i64gather_epi64 (p,           vidx, 8);
+      __m256i ts   = _mm256_i64gather_epi64 (p + 1,       vidx, 8);
+      __m256i cd00 = _mm256_i64gather_epi64 (p + Cd0,     vidx, 8);
+      __m256i cd01 = _mm256_i64gather_epi64 (p + Cd0 + 1, vidx, 8);
+      __m256i cd10 = _mm256_i64gather_epi64 (p + Cd1,     vidx, 8);
+      __m256i cd11 = _mm256_i64gather_epi64 (p + Cd1 + 1, vidx, 8);
+
+      __m256i ok;
+      ok = _mm256_cmpeq_epi64 (hdr, vhdr);
+      ok = _mm256_and_si256   (ok, _mm256_cmpeq_epi64 (ts, vts));
+      ok = _mm256_and_si256   (ok, _mm256_cmpeq_epi64
+                              (_mm256_and_si256 (cd00, vmask0), vcvt0));
+      ok = _mm256_and_si256   (ok, _mm256_cmpeq_epi64
+                              (_mm256_and_si256 (cd01, vmask1), vzero));
+      ok = _mm256_and_si256   (ok, _mm256_cmpeq_epi64
+                              (_mm256_and_si256 (cd10, vmask0), vcvt1));
+      ok = _mm256_and_si256   (ok, _mm256_cmpeq_epi64
+                              (_mm256_and_si256 (cd11, vmask1), vzero));
+
+      int mask = _mm256_movemask_pd (_mm256_castsi256_pd (ok));
+      if (mask != 0xf)
+      {
+         return iframe + __builtin_ctz (~mask);
+      }
+
+      vts   = _mm256_add_epi64 (vts,   vdts);
+      vcvt0 = _mm256_add_epi64 (vcvt0, vdcvt);
+      vcvt1 = _mm256_add_epi64 (vcvt1, vdcvt);
+   }
+
+
+   // ------------------------------------
+   // The remaining, fewer than 4, frames
+   // ------------------------------------
+   timestamp     += 25 * iframe;
+   uint64_t cvt0  = static_cast<uint64_t>(cvtcnt0 + iframe) << CvtCntShift;
+   uint64_t cvt1  = static_cast<uint64_t>(cvtcnt1 + iframe) << CvtCntShift;
+
+   for (; iframe < nframes; iframe++)
+   {
+      if (!isInSequence (frames[iframe], header, timestamp, cvt0, cvt1)) break;
+
+      timestamp += 25;
+      cvt0      += One;
+      cvt1      += One;
+   }
+
+   return iframe;
+}
+/* ---------------------------------------------------------------------- */
+/* END: ASSESSMENT                                                        */
+/* ====================================================================== */
+
+
+/* ====================================================================== */
+/* BEGIN: STREAMING STORES                                                */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Copies ADCs to their destination with non-temporal stores
+
+   \param[out]   dst  The destination
+   \param[in]    src  The source
+   \param[in]  nadcs  The number of ADCs to copy
+
+   \par
+    The ADCs up to the first 32 byte boundary of the destination and
+    any after the last are stored normally.  The caller must issue an
+    sfence before the stored values are relied upon.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void streamAdcs_kernel (int16_t        *dst,
+                                      int16_t const  *src,
+                                      int           nadcs)
+                   __attribute__ ((always_inline, target ("avx2")));
+
+static inline void streamAdcs_kernel (int16_t        *dst,
+                                      int16_t const  *src,
+                                      int           nadcs)
+{
+   while (nadcs > 0 && (reinterpret_cast<uintptr_t>(dst) & 0x1f))
+   {
+      *dst++ = *src++;
+      nadcs -= 1;
+   }
+
+   for (; nadcs >= 16; nadcs -= 16, dst += 16, src += 16)
+   {
+      __m256i v = _mm256_loadu_si256 (reinterpret_cast<__m256i const *>(src));
+      _mm256_stream_si256 (reinterpret_cast<__m256i *>(dst), v);
+   }
+
+   while (nadcs-- > 0) *dst++ = *src++;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: STREAMING STORES                                                  */
+/* ====================================================================== */
+
+
 #endif
@@ -0,0 +1,95 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-avx512.cc
+ *  @brief    WibFrame ADC expansion and transposition - AVX-512 version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt Suppress gcc 12's false -Wmaybe-uninitialized reports
+                  from the AVX-512 intrinsics, they broke the -O2 builds
+   2026.10.16 agt Likewise -Wuninitialized, reported for the gathers used
+                  by the assessment kernel
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "WibFrame-dispatch.hh"
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+/*
+ | At -O2, gcc 12 reports the _mm*_undefined_* idiom used by the AVX-512
+ | extraction intrinsics, e.g. _mm512_castsi512_si256, as possibly using
+ | an uninitialized value.  The gathers, e.g. _mm512_i64gather_epi64, are
+ | reported as definitely using one.  The diagnostics are attributed to
+ | the intrinsic header, so they must be suppressed before that header
+ | is included.
+*/
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include <immintrin.h>
+
+
+/*
+ | The kernels are written with intrinsics, which can only be inlined
+ | into functions compiled for the same instruction set.  So, unlike
+ | the other variants, the kernels, not just the drivers, must be
+ | compiled for AVX-512.
+*/
+#pragma GCC push_options
+#pragma GCC target ("avx512f,avx512bw")
+
+
+namespace pdd      {
+namespace access   {
+namespace wibframe {
+namespace avx512   {
+
+#define WIBFRAME_KERNELS_HH "WibFrame-avx512.hh"
+#define WIBFRAME_TARGET
+#define WIBFRAME_NAME       "avx512"
+#include "WibFrame-drivers.hh"
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace avx512                                                */
+} /* END: namespace wibframe                                              */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+#pragma GCC pop_options
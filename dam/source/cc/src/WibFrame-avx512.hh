@@ -0,0 +1,658 @@
+// -*-Mode: C++;-*-
+
+#ifndef PDD_WIB_FRAME_AVX512_HH
+#define PDD_WIB_FRAME_AVX512_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-avx512.hh
+ *  @brief    WibFrame ADC expansion and unpacking - AVX-512 version
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  Unlike the AVX and AVX2 versions, this is written with intrinsics.
+ *  The includer must have included <immintrin.h> and must compile
+ *  these routines for avx512f and avx512bw.  Only the byte and word
+ *  instructions of AVX512BW are used, so that the Skylake-SP machines,
+ *  which lack AVX512VBMI, also benefit.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt Added countInSequence_kernel
+   2026.10.16 agt Added streamAdcs_kernel
+
+\* ---------------------------------------------------------------------- */
+
+
+#define STRIDE   sizeof (WibFrame)
+#define STRIDE64 (sizeof (WibFrame) / sizeof (uint64_t))
+
+
+/*
+ | Tells WibFrame-drivers.hh that the frame assessment kernel is
+ | provided here
+*/
+#define WIBFRAME_HAS_ASSESS_KERNEL 1
+
+
+/*
+ | Tells WibFrame-drivers.hh that the 16 channel x 16 and x 32 time sample
+ | transposers are provided here rather than being built from the x 8
+*/
+#define WIBFRAME_HAS_16xM_KERNELS 1
+
+
+/*
+ | Tells WibFrame-drivers.hh that the non-temporal store kernel is
+ | provided here
+*/
+#define WIBFRAME_HAS_STREAM_KERNEL 1
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Word gather pattern.  Places the 12 bytes holding channels 0-7
+         and the 12 bytes holding channels 8-15 of 2 source time samples
+         into each of the 4 128-bit lanes.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint16_t const Gather[32] __attribute__ ((aligned (64))) =
+{
+   // Lane 0: source a, bytes  0 - 15
+   0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+
+   // Lane 1: source a, bytes 12 - 27
+   0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d,
+
+   // Lane 2: source b, bytes  0 - 15
+   0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+
+   // Lane 3: source b, bytes 12 - 27
+   0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Byte shuffle pattern.  Places the 2 bytes containing each 12-bit
+         ADC into its 16-bit destination.
+
+   Each 6 bytes holds 4 ADCs. The low 8 bits of ADCs 0 and 1 are in bytes
+   0 and 1, their upper 4 bits are in the low nibbles of bytes 2 and 3.
+   The low 4 bits of ADCs 2 and 3 are in the high nibbles of bytes 2 and
+   3 and their upper 8 bits in bytes 4 and 5. So ADCs 0 and 1 must be
+   masked to 12 bits, ADCs 2 and 3 shifted right by 4, which is the same
+   as for the AVX2 implementation.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint8_t const Shuffle[64] __attribute__ ((aligned (64))) =
+{
+   0x00, 0x02, 0x01, 0x03, 0x02, 0x04, 0x03, 0x05,
+   0x06, 0x08, 0x07, 0x09, 0x08, 0x0a, 0x09, 0x0b,
+
+   0x00, 0x02, 0x01, 0x03, 0x02, 0x04, 0x03, 0x05,
+   0x06, 0x08, 0x07, 0x09, 0x08, 0x0a, 0x09, 0x0b,
+
+   0x00, 0x02, 0x01, 0x03, 0x02, 0x04, 0x03, 0x05,
+   0x06, 0x08, 0x07, 0x09, 0x08, 0x0a, 0x09, 0x0b,
+
+   0x00, 0x02, 0x01, 0x03, 0x02, 0x04, 0x03, 0x05,
+   0x06, 0x08, 0x07, 0x09, 0x08, 0x0a, 0x09, 0x0b
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The word indices, 0 - 31, used to build the permutation patterns
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static uint16_t const Iota[32] __attribute__ ((aligned (64))) =
+{
+   0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+   0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+   0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Nothing to do, the patterns are loaded as needed
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void expandAdcs16_init_kernel ()
+{
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Expand 16 channels for 2 time samples
+  \return The 32 expanded ADCs, the 16 channels of \a a in the lower
+          256 bits, the 16 channels of \a b in the upper 256 bits.
+
+  \param[in] a  The 3 64-bit words holding 16 12-bit ADCs
+  \param[in] b  The 3 64-bit words holding 16 12-bit ADCs
+
+   The loads are masked to exactly the 24 bytes of packed ADCs, so
+   there is no danger of reading beyond the end of the last frame.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline __m512i expandAdcs16x2_kernel (uint64_t const *a,
+                                             uint64_t const *b)
+{
+   __m512i va = _mm512_maskz_loadu_epi16 (0xfff, a);
+   __m512i vb = _mm512_maskz_loadu_epi16 (0xfff, b);
+
+   __m512i  v = _mm512_permutex2var_epi16 (va,
+                                           _mm512_load_si512 (Gather),
+                                           vb);
+
+   v = _mm512_shuffle_epi8 (v, _mm512_load_si512 (Shuffle));
+   v = _mm512_srlv_epi16   (v, _mm512_set1_epi64 (0x0004000400000000LL));
+   v = _mm512_and_si512    (v, _mm512_set1_epi16 (0x0fff));
+
+   return v;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The kernel to unpack 16 densely packet 12-bit values into
+         16 16-bit values.
+
+  \param[in] dst  The destination address
+  \param[in] src  The source address
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void expandAdcs16x1_kernel (int16_t *dst, uint64_t const *src)
+{
+   __m512i v = expandAdcs16x2_kernel (src, src);
+   _mm512_mask_storeu_epi16 (dst, 0xffff, v);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The kernel to unpack 64 densely packet 12-bit values into
+         64 16-bit values.
+
+  \param[in] dst  The destination address
+  \param[in] src  The source address
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void expandAdcs64x1_kernel (int16_t        *dst,
+                                   uint64_t const *src)
+{
+   _mm512_storeu_si512 (dst +  0, expandAdcs16x2_kernel (src + 0, src + 3));
+   _mm512_storeu_si512 (dst + 32, expandAdcs16x2_kernel (src + 6, src + 9));
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The kernel to unpack 16 densely packet 12-bit values for 4
+         time samples into  64 16-bit values.
+
+  \param[in] dst  The destination address
+  \param[in] src  The source address
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void expandAdcs16x4_kernel (int16_t        *dst,
+                                          uint64_t const *src)
+{
+   _mm512_storeu_si512 (dst +  0, expandAdcs16x2_kernel (src + 0*STRIDE64,
+                                                         src + 1*STRIDE64));
+   _mm512_storeu_si512 (dst + 32, expandAdcs16x2_kernel (src + 2*STRIDE64,
+                                                         src + 3*STRIDE64));
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Exchange one bit of the register index with one bit of the
+         word index between a pair of registers.
+
+  \param[in:out]  lo  The register with the register index bit clear
+  \param[in:out]  hi  The register with the register index bit set
+  \param[in]     bit  The word index bit to exchange.
+
+   On return, the word at index k in \a lo (\a hi) with the word index
+   bit set (clear) has been exchanged with the word at index k ^ (1 << bit)
+   in \a hi (\a lo).  Repeating this for each bit of the register index
+   paired with a bit of the word index is a transpose.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void exchange_kernel (__m512i &lo, __m512i &hi, int bit)
+{
+   __m512i    iota = _mm512_load_si512 (Iota);
+   __m512i    flip = _mm512_set1_epi16 (1 << bit);
+   __m512i    from = _mm512_set1_epi16 (0x20);
+   __mmask32  mask = _mm512_test_epi16_mask (iota, flip);
+   __m512i   other = _mm512_xor_si512      (iota, flip);
+
+   // Index bit 5 selects the word from hi
+   __m512i   idxLo = _mm512_mask_mov_epi16 (iota,  mask,
+                                            _mm512_or_si512 (other, from));
+   __m512i   idxHi = _mm512_mask_mov_epi16 (other, mask,
+                                            _mm512_or_si512 (iota,  from));
+
+   __m512i     tmp = _mm512_permutex2var_epi16 (lo, idxLo, hi);
+   hi              = _mm512_permutex2var_epi16 (lo, idxHi, hi);
+   lo              = tmp;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Expand and transpose 16 channels x 2 \a nrows time samples.
+
+  \param[out]    v The transposed ADCs, 16 / \a nrows channels per register
+  \param[in] nrows The number of registers, 4, 8 or 16
+  \param[in]   src The source for the first time sample
+
+   Register r is loaded with time samples r and r + nrows.  In terms of
+   the bits of the register and word indices, the time sample is then
+   (w4, r) and the channel (w3..w0).  Exchanging the register index
+   bits with the top word index bits below w4 moves the channel into
+   the register index.  When nrows is less than 16 the time sample is
+   left split around the low channel bits in the word index and a final
+   permutation gathers each channel's time samples together.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16xM_kernel (__m512i            *v,
+                                             int             nrows,
+                                             uint64_t const   *src)
+{
+   int nbits = nrows == 16 ? 4 : nrows == 8 ? 3 : 2;
+
+   for (int row = 0; row < nrows; row++)
+   {
+      v[row] = expandAdcs16x2_kernel (src + (row        ) * STRIDE64,
+                                      src + (row + nrows) * STRIDE64);
+   }
+
+
+   // ------------------------------------------------------
+   // Exchange register index bit i with word index bit i+4-nbits
+   // ------------------------------------------------------
+   for (int ibit = nbits - 1; ibit >= 0; --ibit)
+   {
+      int d = 1 << ibit;
+      for (int row = 0; row < nrows; row++)
+      {
+         if ((row & d) == 0) exchange_kernel (v[row], v[row | d],
+                                              ibit + 4 - nbits);
+      }
+   }
+
+
+   // ------------------------------------------------------------------
+   // Word index is now (t, c), t = time sample, c = the low channel bits
+   // Permute to (c, t) so that each channel's time samples are adjacent
+   // ------------------------------------------------------------------
+   if (nbits < 4)
+   {
+      int     tbits = nbits + 1;
+      __m512i  iota = _mm512_load_si512 (Iota);
+      __m512i   idx = _mm512_or_si512 (
+                      _mm512_slli_epi16 (_mm512_and_si512 (iota,
+                                         _mm512_set1_epi16 ((1 << tbits) - 1)),
+                                         4 - nbits),
+                      _mm512_srli_epi16 (iota, tbits));
+
+      for (int row = 0; row < nrows; row++)
+      {
+         v[row] = _mm512_permutexvar_epi16 (idx, v[row]);
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ====================================================================== */
+/* BEGIN: CONTIGIOUS TRANSPOSITION                                        */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x8_kernel (int16_t          *dst,
+                                             int            stride,
+                                             uint64_t const  *src)
+{
+   __m512i v[4];
+   transposeAdcs16xM_kernel (v, 4, src);
+
+   for (int row = 0; row < 4; row++)
+   {
+      _mm_storeu_si128 ((__m128i *)(dst + (4*row+0)*stride),
+                        _mm512_extracti32x4_epi32 (v[row], 0));
+      _mm_storeu_si128 ((__m128i *)(dst + (4*row+1)*stride),
+                        _mm512_extracti32x4_epi32 (v[row], 1));
+      _mm_storeu_si128 ((__m128i *)(dst + (4*row+2)*stride),
+                        _mm512_extracti32x4_epi32 (v[row], 2));
+      _mm_storeu_si128 ((__m128i *)(dst + (4*row+3)*stride),
+                        _mm512_extracti32x4_epi32 (v[row], 3));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x16_kernel (int16_t          *dst,
+                                              int            stride,
+                                              uint64_t const  *src)
+{
+   __m512i v[8];
+   transposeAdcs16xM_kernel (v, 8, src);
+
+   for (int row = 0; row < 8; row++)
+   {
+      _mm256_storeu_si256 ((__m256i *)(dst + (2*row+0)*stride),
+                           _mm512_castsi512_si256    (v[row]));
+      _mm256_storeu_si256 ((__m256i *)(dst + (2*row+1)*stride),
+                           _mm512_extracti64x4_epi64 (v[row], 1));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x32_kernel (int16_t          *dst,
+                                              int            stride,
+                                              uint64_t const  *src)
+{
+   __m512i v[16];
+   transposeAdcs16xM_kernel (v, 16, src);
+
+   for (int row = 0; row < 16; row++)
+   {
+      _mm512_storeu_si512 (dst + row*stride, v[row]);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: CONTIGIOUS TRANSPOSITION                                          */
+/* ====================================================================== */
+
+
+
+/* ====================================================================== */
+/* BEGIN: CHANNEL-BY-CHANNEL TRANSPOSITION                                */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x8_kernel (int16_t  *const  *dst,
+                                             int            offset,
+                                             uint64_t const  *src)
+{
+   __m512i v[4];
+   transposeAdcs16xM_kernel (v, 4, src);
+
+   for (int row = 0; row < 4; row++)
+   {
+      _mm_storeu_si128 ((__m128i *)(dst[4*row+0] + offset),
+                        _mm512_extracti32x4_epi32 (v[row], 0));
+      _mm_storeu_si128 ((__m128i *)(dst[4*row+1] + offset),
+                        _mm512_extracti32x4_epi32 (v[row], 1));
+      _mm_storeu_si128 ((__m128i *)(dst[4*row+2] + offset),
+                        _mm512_extracti32x4_epi32 (v[row], 2));
+      _mm_storeu_si128 ((__m128i *)(dst[4*row+3] + offset),
+                        _mm512_extracti32x4_epi32 (v[row], 3));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x16_kernel (int16_t  *const  *dst,
+                                              int            offset,
+                                              uint64_t const  *src)
+{
+   __m512i v[8];
+   transposeAdcs16xM_kernel (v, 8, src);
+
+   for (int row = 0; row < 8; row++)
+   {
+      _mm256_storeu_si256 ((__m256i *)(dst[2*row+0] + offset),
+                           _mm512_castsi512_si256    (v[row]));
+      _mm256_storeu_si256 ((__m256i *)(dst[2*row+1] + offset),
+                           _mm512_extracti64x4_epi64 (v[row], 1));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x32_kernel (int16_t  *const  *dst,
+                                              int            offset,
+                                              uint64_t const  *src)
+{
+   __m512i v[16];
+   transposeAdcs16xM_kernel (v, 16, src);
+
+   for (int row = 0; row < 16; row++)
+   {
+      _mm512_storeu_si512 (dst[row] + offset, v[row]);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: CHANNEL-BY-CHANNEL TRANSPOSITION                                  */
+/* ====================================================================== */
+
+
+/* ====================================================================== */
+/* BEGIN: ASSESSMENT                                                      */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Counts the leading frames that continue the expected sequence
+   \return The number of frames
+
+   \par
+    Eight frames are tested at once, one per 64-bit lane, in the same
+    manner as the AVX2 version.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline int countInSequence_kernel (WibFrame const    *frames,
+                                          int               nframes,
+                                          uint64_t           header,
+                                          uint64_t        timestamp,
+                                          unsigned int      cvtcnt0,
+                                          unsigned int      cvtcnt1)
+{
+   // Word offsets of the cold data headers within a frame
+   static const int Cd0 = offsetof (pdd::record::WibFrame, m_coldData[0])
+                        / sizeof (uint64_t);
+   static const int Cd1 = offsetof (pdd::record::WibFrame, m_coldData[1])
+                        / sizeof (uint64_t);
+
+   uint64_t const One    = static_cast<uint64_t>(1) << CvtCntShift;
+
+   __m512i const lane   = _mm512_setr_epi64 (0, 1, 2, 3, 4, 5, 6, 7);
+   __m512i const vidx   = _mm512_mul_epu32 (lane,
+                          _mm512_set1_epi64 (STRIDE64));
+   __m512i const vhdr   = _mm512_set1_epi64 (header);
+   __m512i const vmask0 = _mm512_set1_epi64 (CdMask0);
+   __m512i const vmask1 = _mm512_set1_epi64 (CdMask1);
+   __m512i const vdts   = _mm512_set1_epi64 (8 * 25);
+   __m512i const vdcvt  = _mm512_set1_epi64 (8 * One);
+
+   __m512i vts   = _mm512_add_epi64 (_mm512_set1_epi64 (timestamp),
+                                     _mm512_mul_epu32  (lane,
+                                     _mm512_set1_epi64 (25)));
+   __m512i vcvt0 = _mm512_add_epi64 (_mm512_set1_epi64
+                                     (static_cast<uint64_t>(cvtcnt0) << CvtCntShift),
+                                     _mm512_slli_epi64 (lane, CvtCntShift));
+   __m512i vcvt1 = _mm512_add_epi64 (_mm512_set1_epi64
+                                     (static_cast<uint64_t>(cvtcnt1) << CvtCntShift),
+                                     _mm512_slli_epi64 (lane, CvtCntShift));
+
+   uint64_t const *base = reinterpret_cast<uint64_t const *>(frames);
+
+   int iframe;
+   for (iframe = 0; iframe + 8 <= nframes; iframe += 8)
+   {
+      uint64_t const *p = base + iframe * STRIDE64;
+
+      __m512i hdr  = _mm512_i64gather_epi64 (vidx, p,           8);
+      __m512i ts   = _mm512_i64gather_epi64 (vidx, p + 1,       8);
+      __m512i cd00 = _mm512_i64gather_epi64 (vidx, p + Cd0,     8);
+      __m512i cd01 = _mm512_i64gather_epi64 (vidx, p + Cd0 + 1, 8);
+      __m512i cd10 = _mm512_i64gather_epi64 (vidx, p + Cd1,     8);
+      __m512i cd11 = _mm512_i64gather_epi64 (vidx, p + Cd1 + 1, 8);
+
+      __mmask8 ok;
+      ok = _mm512_cmpeq_epi64_mask       (hdr, vhdr);
+      ok = _mm512_mask_cmpeq_epi64_mask  (ok,  ts,   vts);
+      ok = _mm512_mask_cmpeq_epi64_mask  (ok,  _mm512_and_epi64 (cd00, vmask0),
+                                               vcvt0);
+      ok = _mm512_mask_testn_epi64_mask  (ok,  cd01, vmask1);
+      ok = _mm512_mask_cmpeq_epi64_mask  (ok,  _mm512_and_epi64 (cd10, vmask0),
+                                               vcvt1);
+      ok = _mm512_mask_testn_epi64_mask  (ok,  cd11, vmask1);
+
+      if (ok != 0xff)
+      {
+         return iframe + __builtin_ctz (~static_cast<unsigned int>(ok));
+      }
+
+      vts   = _mm512_add_epi64 (vts,   vdts);
+      vcvt0 = _mm512_add_epi64 (vcvt0, vdcvt);
+      vcvt1 = _mm512_add_epi64 (vcvt1, vdcvt);
+   }
+
+
+   // ------------------------------------
+   // The remaining, fewer than 8, frames
+   // ------------------------------------
+   timestamp     += 25 * iframe;
+   uint64_t cvt0  = static_cast<uint64_t>(cvtcnt0 + iframe) << CvtCntShift;
+   uint64_t cvt1  = static_cast<uint64_t>(cvtcnt1 + iframe) << CvtCntShift;
+
+   for (; iframe < nframes; iframe++)
+   {
+      if (!isInSequence (frames[iframe], header, timestamp, cvt0, cvt1)) break;
+
+      timestamp += 25;
+      cvt0      += One;
+      cvt1      += One;
+   }
+
+   return iframe;
+}
+/* ---------------------------------------------------------------------- */
+/* END: ASSESSMENT                                                        */
+/* ====================================================================== */
+
+
+/* ====================================================================== */
+/* BEGIN: STREAMING STORES                                                */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Copies ADCs to their destination with non-temporal stores
+
+   \param[out]   dst  The destination
+   \param[in]    src  The source
+   \param[in]  nadcs  The number of ADCs to copy
+
+   \par
+    The ADCs up to the first 64 byte boundary of the destination and
+    any after the last are stored normally, so each non-temporal store
+    writes a whole cache line.  The caller must issue an sfence before
+    the stored values are relied upon.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void streamAdcs_kernel (int16_t        *dst,
+                                      int16_t const  *src,
+                                      int           nadcs)
+{
+   while (nadcs > 0 && (reinterpret_cast<uintptr_t>(dst) & 0x3f))
+   {
+      *dst++ = *src++;
+      nadcs -= 1;
+   }
+
+   for (; nadcs >= 32; nadcs -= 32, dst += 32, src += 32)
+   {
+      _mm512_stream_si512 (reinterpret_cast<__m512i *>(dst),
+                           _mm512_loadu_si512 (src));
+   }
+
+   while (nadcs-- > 0) *dst++ = *src++;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: STREAMING STORES                                                  */
+/* ====================================================================== */
+
+
+#endif
@@ -0,0 +1,197 @@
+// -*-Mode: C++;-*-
+
+#ifndef PDD_WIB_FRAME_DISPATCH_HH
+#define PDD_WIB_FRAME_DISPATCH_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-dispatch.hh
+ *  @brief    WibFrame ADC expansion and transposition - the table of
+ *            kernel implementations selected at load time
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  Each instruction set variant (gen, avx, avx2, avx512) is compiled into its
+ *  own translation unit, WibFrame-<variant>.cc, and exports one of these
+ *  tables.  WibFrame.cc selects the table to use once, based on the
+ *  capabilities of the executing cpu.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt Added the avx512 variant
+   2026.10.16 agt Added the countInSequence assessment kernel
+   2026.10.16 agt Added transposeAdcsMasked128xN, the transposition of a
+                  subset of the channels
+   2026.10.16 agt Added transposeAdcs128xN_float, the transposition to
+                  pedestal subtracted, gain corrected floats
+   2026.10.16 agt Added transposeAdcs128xN_blocked, the tiled transposer
+   2026.10.16 agt Added transposeAdcs128xN_stream, the non-temporal tiled
+                  transposer
+   2026.10.16 agt Added transposeAdcs128xN_stats, the transposition that
+                  accumulates each channel's statistics
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "dam/access/WibFrame.hh"
+#include "dam/access/AdcStats.hh"
+#include <cinttypes>
+
+
+namespace pdd    {
+namespace access {
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  The set of WibFrame expansion and transposition kernels for
+          one instruction set variant.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class WibFrameKernels
+{
+public:
+   // Expand the 64 12-bit adcs of one cold data stream
+   typedef void (*Expand64x1)   (int16_t              *dst,
+                                 uint64_t const       *src);
+
+   // Expand the 128 12-bit adcs of N frames
+   typedef void (*Expand128xN)  (int16_t              *dst,
+                                 WibFrame const    *frames,
+                                 int               nframes);
+
+   // Transpose into contigious memory
+   typedef void (*Transpose)    (int16_t              *dst,
+                                 int            ndstStride,
+                                 WibFrame const    *frames,
+                                 int               nframes);
+
+   // Transpose into channel-by-channel memory
+   typedef void (*TransposeCbC) (int16_t *const       *dst,
+                                 int                offset,
+                                 WibFrame const    *frames,
+                                 int               nframes);
+
+   // Count the leading frames continuing the expected sequence
+   typedef int  (*CountInSequence) (WibFrame const    *frames,
+                                    int               nframes,
+                                    uint64_t           header,
+                                    uint64_t        timestamp,
+                                    unsigned int      cvtcnt0,
+                                    unsigned int      cvtcnt1);
+
+   // Transpose a subset of the channels into contigious memory
+   typedef void (*TransposeMasked) (int16_t              *dst,
+                                    int            ndstStride,
+                                    WibFrame const    *frames,
+                                    int               nframes,
+                                    uint64_t const chanMask[2]);
+
+   // Transpose into contigious memory as pedestal subtracted floats
+   typedef void (*TransposeFloat) (float                *dst,
+                                   int            ndstStride,
+                                   WibFrame const    *frames,
+                                   int               nframes,
+                                   float const         *peds,
+                                   float const        *gains);
+
+   // Transpose into contigious memory through an L1 resident tile
+   typedef void (*TransposeBlocked) (int16_t              *dst,
+                                     int            ndstStride,
+                                     WibFrame const    *frames,
+                                     int               nframes,
+                                     int                 ntile);
+
+   // Transpose into contigious memory, accumulating the statistics
+   typedef void (*TransposeStats) (int16_t              *dst,
+                                   int            ndstStride,
+                                   WibFrame const    *frames,
+                                   int               nframes,
+                                   AdcStats           *stats);
+
+public:
+   static WibFrameKernels const *select ();
+   static WibFrameKernels const *locate (char const *name);
+
+public:
+   char const              *m_name; /*!< The variant name, gen, avx, ... */
+   Expand64x1     m_expandAdcs64x1; /*!< 64  adcs x 1 frame              */
+   Expand128xN   m_expandAdcs128xN; /*!< 128 adcs x N frames             */
+
+   Transpose    m_transposeAdcs128xN;  /*!< Contigious, any N            */
+   Transpose    m_transposeAdcs128x8N; /*!< Contigious, multiple of  8   */
+   Transpose   m_transposeAdcs128x16N; /*!< Contigious, multiple of 16   */
+   Transpose   m_transposeAdcs128x32N; /*!< Contigious, multiple of 32   */
+
+   TransposeCbC  m_transposeAdcs128xN_cbc; /*!< Channel-by-channel, any N*/
+   TransposeCbC m_transposeAdcs128x8N_cbc; /*!< Channel-by-channel,  8N  */
+   TransposeCbC m_transposeAdcs128x16N_cbc;/*!< Channel-by-channel, 16N  */
+   TransposeCbC m_transposeAdcs128x32N_cbc;/*!< Channel-by-channel, 32N  */
+
+   CountInSequence  m_countInSequence; /*!< Frames continuing the sequence */
+
+   TransposeMasked m_transposeAdcsMasked128xN; /*!< Contigious, any N, the
+                                                    selected channels only*/
+
+   TransposeFloat m_transposeAdcs128xN_float; /*!< Contigious, any N, as
+                                                   calibrated floats      */
+   TransposeBlocked m_transposeAdcs128xN_blocked; /*!< Contigious, any N,
+                                                       through a tile     */
+   Transpose       m_transposeAdcs128xN_stream; /*!< Contigious, any N,
+                                                     non-temporal stores  */
+   TransposeStats   m_transposeAdcs128xN_stats; /*!< Contigious, any N,
+                                                     with statistics      */
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+/* The instruction set variants                                           */
+/* ---------------------------------------------------------------------- */
+namespace wibframe {
+namespace gen    { extern WibFrameKernels const Kernels; }
+namespace avx    { extern WibFrameKernels const Kernels; }
+namespace avx2   { extern WibFrameKernels const Kernels; }
+namespace avx512 { extern WibFrameKernels const Kernels; }
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+
+#endif
@@ -0,0 +1,1998 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WibFrame-drivers.hh
+ *  @brief    WibFrame ADC expansion and transposition drivers, template
+ *            implementation file
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  DUNE
+ *
+ *  @author
+ *  russell@slac.stanford.edu
+ *
+ *  @par Date created:
+ *  2026.10.16
+ * *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  This file acts as a poor man's C++ template.  It contains the drivers
+ *  that loop over the WibFrames, calling the instruction set specific
+ *  kernels.  It is included, once, by each of the variant translation
+ *  units, WibFrame-<variant>.cc, inside that variant's namespace after
+ *  defining
+ *
+ *     -# WIBFRAME_KERNELS_HH, the name of the kernel header to use
+ *     -# WIBFRAME_TARGET,     the function attribute selecting the
+ *                             instruction set the drivers are compiled
+ *                             for.  This may be empty.
+ *     -# WIBFRAME_NAME,       the name of the variant
+ *
+ *  By default, the 16 channel x 16 and x 32 time sample transposers are
+ *  built from the x 8 kernel.  A kernel header that has native versions
+ *  defines WIBFRAME_HAS_16xM_KERNELS.  Likewise, the frame assessment is
+ *  done one frame at a time, in batches of 4, unless the kernel header
+ *  defines WIBFRAME_HAS_ASSESS_KERNEL and its own countInSequence_kernel.
+ *  The non-temporal stores are done 16 bytes at a time, with SSE2,
+ *  unless it defines WIBFRAME_HAS_STREAM_KERNEL and its own
+ *  streamAdcs_kernel.  The includer must have included
+ *  <immintrin.h>.
+ *
+ *  The result is a WibFrameKernels table named Kernels.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created from WibFrame.cc so that all the instruction set
+                  variants could be placed in one library and selected at
+                  load time.  Corrected the channel-by-channel transposer
+                  remainder, it was advancing the destination pointer
+                  array rather than the offset.
+   2026.10.16 agt Allow the kernel header to supply its own 16 channel
+                  x 16 and x 32 transposers, WIBFRAME_HAS_16xM_KERNELS
+   2026.10.16 agt Added countInSequence, the assessment of a run of frames
+                  against the expected sequence, WIBFRAME_HAS_ASSESS_KERNEL
+   2026.10.16 agt Added transposeAdcsMasked128xN, which transposes only
+                  the selected channels
+   2026.10.16 agt Added transposeAdcs128xN_float, which transposes to
+                  pedestal subtracted, gain corrected floats
+   2026.10.16 agt Added transposeAdcs128xN_blocked, which stages the
+                  transposed ADCs in an L1 resident tile before storing
+                  them as contiguous runs
+   2026.10.16 agt Added transposeAdcs128xN_stream, the blocked transposer
+                  storing the tiles with non-temporal stores,
+                  WIBFRAME_HAS_STREAM_KERNEL
+   2026.10.16 agt The x 8N, x 16N and x 32N transposers take any number of
+                  frames.  The last nframes % 8 are done by transposeAdcs-
+                  128xR, replacing the frame by frame transposeAdcs128xN_
+                  kernel
+   2026.10.16 agt Added transposeAdcs128xN_stats, which accumulates each
+                  channel's AdcStats while its block of 256 time samples
+                  is still in the cache
+
+\* ---------------------------------------------------------------------- */
+
+
+#if !defined (WIBFRAME_KERNELS_HH) || !defined (WIBFRAME_TARGET) || !defined (WIBFRAME_NAME)
+#error WIBFRAME_KERNELS_HH, WIBFRAME_TARGET and WIBFRAME_NAME must be defined
+#endif
+
+
+static inline void expandAdcs16_init_kernel () __attribute__ ((always_inline));
+
+// ------------------------------
+// EXPANDERS:   Contigious Memory
+// ------------------------------
+static inline void expandAdcs16x1_kernel  (int16_t        *dst,
+                                           uint64_t const *src) __attribute__ ((always_inline));
+
+static void expandAdcs64x1_kernel  (int16_t        *dst,
+                                    uint64_t const *src);
+
+static inline void expandAdcs16x4_kernel  (int16_t        *dst,
+                                           uint64_t const *src) __attribute__ ((always_inline));
+
+
+// ------------------------------
+// TRANSPOSERS: Contigious Memory
+// ------------------------------
+static inline void transposeAdcs16x8_kernel  (int16_t        *dst,
+                                              int          offset,
+                                              uint64_t const *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x8N_kernel (int16_t        *dst,
+                                              int              n8,
+                                              int          stride,
+                                              uint64_t const *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x16_kernel (int16_t        *dst,
+                                              int          offset,
+                                              uint64_t const *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x32_kernel (int16_t        *dst,
+                                              int          offset,
+                                              uint64_t const *src) __attribute__ ((always_inline));
+
+
+
+// --------------------------------------
+// TRANSPOSERS: Channel-by-Channel Memory
+// --------------------------------------
+static inline void transposeAdcs16x8_kernel  (int16_t  *const *dst,
+                                              int           offset,
+                                              uint64_t const  *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x8N_kernel (int16_t  *const *dst,
+                                              int               n8,
+                                              int           offset,
+                                              uint64_t const  *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x16_kernel (int16_t  *const *dst,
+                                              int           offset,
+                                              uint64_t  const *src) __attribute__ ((always_inline));
+
+static inline void transposeAdcs16x32_kernel (int16_t  *const *dst,
+                                              int           offset,
+                                              uint64_t  const *src) __attribute__ ((always_inline));
+
+
+
+// ------------------------------------------------------
+// DRIVERS: These are compiled for the target instruction
+//          set and are the entries in the kernel table
+// ------------------------------------------------------
+static void expandAdcs64x1       (int16_t              *dst,
+                                  uint64_t const       *src) WIBFRAME_TARGET;
+
+static void expandAdcs128xN      (int16_t              *dst,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN   (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x8N  (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x16N (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x32N (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128xR   (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN   (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x8N  (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x16N (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128x32N (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static void transposeAdcs128xR   (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+
+static int  countInSequence      (WibFrame const    *frames,
+                                  int               nframes,
+                                  uint64_t           header,
+                                  uint64_t        timestamp,
+                                  unsigned int      cvtcnt0,
+                                  unsigned int      cvtcnt1) WIBFRAME_TARGET;
+
+static void transposeAdcsMasked128xN
+                                 (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes,
+                                  uint64_t const chanMask[2]) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN_float
+                                 (float                *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes,
+                                  float const         *peds,
+                                  float const        *gains) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN_stats
+                                 (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes,
+                                  AdcStats           *stats) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN_blocked
+                                 (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes,
+                                  int                 ntile) WIBFRAME_TARGET;
+
+static void transposeAdcs128xN_stream
+                                 (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes) WIBFRAME_TARGET;
+// ------------------------------------------------------
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The kernel table for this instruction set variant
+                                                                          */
+/* ---------------------------------------------------------------------- */
+WibFrameKernels const Kernels =
+{
+   WIBFRAME_NAME,
+   expandAdcs64x1,
+   expandAdcs128xN,
+
+   transposeAdcs128xN,
+   transposeAdcs128x8N,
+   transposeAdcs128x16N,
+   transposeAdcs128x32N,
+
+   transposeAdcs128xN,
+   transposeAdcs128x8N,
+   transposeAdcs128x16N,
+   transposeAdcs128x32N,
+
+   countInSequence,
+
+   transposeAdcsMasked128xN,
+
+   transposeAdcs128xN_float,
+
+   transposeAdcs128xN_blocked,
+   transposeAdcs128xN_stream,
+
+   transposeAdcs128xN_stats
+};
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Unpack 64 densely packet 12-bit values into 64 16-bit values.
+
+  \param[in] dst  The destination address
+  \param[in] src  The source address
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void expandAdcs64x1 (int16_t *dst, uint64_t const *src)
+{
+   expandAdcs16_init_kernel ();
+   expandAdcs64x1_kernel    (dst, src);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Expand all 128 channels 12-bit -< 16 bits for \a nframes
+
+   \param[out]     dst A pointer to an array large enough to hold
+                       128 * \a nframes 16-bit adcs.
+   \param[in]   frames The array of WibFrames
+   \param[in]  nframes The number of frames to expand
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void expandAdcs128xN (int16_t           *dst,
+                             WibFrame const *frames,
+                             int            nframes)
+{
+   expandAdcs16_init_kernel ();
+
+   for (int iframe = 0; iframe < nframes; ++iframe)
+   {
+      WibColdData const (& coldData)[2] = frames[iframe].getColdData ();
+      expandAdcs64x1_kernel (dst + 0*pdd::record::WibColdData::NAdcs,
+                             coldData[0].locateAdcs12b ());
+      expandAdcs64x1_kernel (dst + 1*pdd::record::WibColdData::NAdcs,
+                             coldData[1].locateAdcs12b ());
+      dst += 2*pdd::record::WibColdData::NAdcs;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples.
+
+   \param[in]       dst[out]  The output destination array
+   \param[in] ndstStride[in]  The number of entries of each of the 128
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN  (int16_t              *dst,
+                                 int            ndstStride,
+                                 WibFrame  const   *frames,
+                                 int               nframes)
+{
+#ifndef WIBFRAME_HAS_16xM_KERNELS
+   // --------------------------------------------------------
+   // The x 32 transposer built from the x 8 kernel stores
+   // partial cache lines.  When every channel maps onto the
+   // same cache sets these are evicted before being filled,
+   // so the transposition goes through a tile instead.
+   // --------------------------------------------------------
+   if (ndstStride % WibFrame::BlockedTransposeStride == 0)
+   {
+      transposeAdcs128xN_blocked (dst, ndstStride, frames, nframes,
+                                  WibFrame::DefTransposeTile);
+      return;
+   }
+#endif
+
+   // -------------------------------------------------
+   // The x 32 transposer picks up the remainder itself
+   // -------------------------------------------------
+   transposeAdcs128x32N (dst, ndstStride, frames, nframes);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 8 at a time.
+
+   \param[in]       dst[out]  The output destination array.
+   \param[in] ndstStride[in]  The number of entries of each of the 128
+                              arrays of transposed ADC values.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 8, see transposeAdcs128xR.
+
+   This output array should be thought of as a 2d array dst[128][ndstStride].
+   This allows each channel space for ndstStride contigous transposed
+   ADC values.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x8N (int16_t              *dst,
+                                 int            ndstStride,
+                                 WibFrame const    *frames,
+                                 int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *dst0 = dst;
+   int16_t *dst1 = dst + 64 * ndstStride;
+   int n8frames  = nframes/8;
+
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+   // ------------------------------=-----
+   // Loop over the frames in groups of 8
+   // ------------------------------------
+   for (int iframe = 0; iframe < n8frames; ++iframe)
+   {
+      uint64_t const *lclsrc0 = src0;
+      uint64_t const *lclsrc1 = src1;
+
+      int16_t        *lcldst0 = dst0;
+      int16_t        *lcldst1 = dst1;
+
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x  8 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x8_kernel (lcldst0, ndstStride, lclsrc0);
+         lcldst0 += 16*ndstStride;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x8_kernel (lcldst1, ndstStride, lclsrc1);
+         lcldst1 += 16*ndstStride;
+         lclsrc1 +=  3;
+      }
+
+      // Advance the source and destination by the 8 time frames
+      src0 += 8 * sizeof (WibFrame) / sizeof (*src0);
+      src1 += 8 * sizeof (WibFrame) / sizeof (*src1);
+
+      // Advance the destination by the same
+      dst0 += 8;
+      dst1 += 8;
+   }
+
+
+   // ------------------------------
+   // Pickup the last nframes % 8
+   // ------------------------------
+   transposeAdcs128xR (dst, ndstStride, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 16 at a time.
+
+   \param[in]       dst[out]  The output destination array.
+   \param[in] ndstStride[in]  The number of entries of each of the 128
+                              arrays of transposed ADC values.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 16, see transposeAdcs128xR.
+
+   This output array should be thought of as a 2d array dst[128][ndstStride].
+   This allows each channel space for ndstStride contigous transposed
+   ADC values.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x16N (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *dst0 = dst;
+   int16_t *dst1 = dst + 64 * ndstStride;
+
+
+   int n16frames = nframes/16;
+
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+   // ------------------------------=-----
+   // Loop over the frames in groups of 16
+   // ------------------------------------
+   for (int iframe = 0; iframe < n16frames; ++iframe)
+   {
+      uint64_t const *lclsrc0 = src0;
+      uint64_t const *lclsrc1 = src1;
+
+      int16_t        *lcldst0 = dst0;
+      int16_t        *lcldst1 = dst1;
+
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x16_kernel (lcldst0, ndstStride, lclsrc0);
+         lcldst0 += 16*ndstStride;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x16_kernel (lcldst1, ndstStride, lclsrc1);
+         lcldst1 += 16*ndstStride;
+         lclsrc1 +=  3;
+      }
+
+      // Advance the source and destination by the 16 time frames
+      src0 += 16 * sizeof (WibFrame) / sizeof (*src0);
+      src1 += 16 * sizeof (WibFrame) / sizeof (*src1);
+
+      // Advance the destination by the same
+      dst0 += 16;
+      dst1 += 16;
+   }
+
+
+   // -----------------------------------------------
+   // Pickup the remainder, 8 at a time, then the last
+   // nframes % 8
+   // -----------------------------------------------
+   int n8frames = nframes & 0x8;
+   if (n8frames)
+   {
+      int n16 = nframes & ~0xf;
+      transposeAdcs128x8N (dst + n16, ndstStride, frames + n16, n8frames);
+   }
+
+   transposeAdcs128xR (dst, ndstStride, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 32 at a time.
+
+   \param[in]       dst[out]  The output destination array.
+   \param[in] ndstStride[in]  The number of entries of each of the 128
+                              arrays of transposed ADC values.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 32, see transposeAdcs128xR.
+
+   This output array should be thought of as a 2d array dst[128][ndstStride].
+   This allows each channel space for ndstStride contigous transposed
+   ADC values.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x32N (int16_t              *dst,
+                                  int            ndstStride,
+                                  WibFrame const    *frames,
+                                  int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *dst0 = dst;
+   int16_t *dst1 = dst + 64 * ndstStride;
+
+
+   int n32frames = nframes/32;
+
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+   // ------------------------------=-----
+   // Loop over the frames in groups of 32
+   // ------------------------------------
+   for (int iframe = 0; iframe < n32frames; ++iframe)
+   {
+      uint64_t const *lclsrc0 = src0;
+      uint64_t const *lclsrc1 = src1;
+
+      int16_t        *lcldst0 = dst0;
+      int16_t        *lcldst1 = dst1;
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x 32 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x32_kernel (lcldst0, ndstStride, lclsrc0);
+         lcldst0 += 16*ndstStride;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x32_kernel (lcldst1, ndstStride, lclsrc1);
+         lcldst1 += 16*ndstStride;
+         lclsrc1 +=  3;
+      }
+
+      // Advance the source and destination by the 32 time frames
+      src0 += 32 * sizeof (WibFrame) / sizeof (*src0);
+      src1 += 32 * sizeof (WibFrame) / sizeof (*src1);
+
+      // Advance the destination by the same
+      dst0 += 32;
+      dst1 += 32;
+   }
+
+
+   // -----------------------------------------------
+   // Pickup the remainder, 8 at a time, then the last
+   // nframes % 8
+   // -----------------------------------------------
+   int n8frames = nframes & 0x18;
+   if (n8frames)
+   {
+      int n32 = nframes & ~0x1f;
+      transposeAdcs128x8N (dst + n32, ndstStride, frames + n32, n8frames);
+   }
+
+   transposeAdcs128xR (dst, ndstStride, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the last \a nframes % 8 of the 128 ADC channels
+          serviced by a WibFrame for \a nframes time samples
+
+   \param[in]       dst[out]  The output destination array of all
+                              \a nframes.
+   \param[in] ndstStride[in]  The number of entries of each of the 128
+                              arrays of transposed ADC values.
+   \param[in]     frames[in]  The array of all \a nframes WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+
+   \par
+    The vector kernels transpose 8 frames at a time.  When there are
+    at least 8 frames, the last 8 are transposed again.  Those that
+    precede the remainder have already been transposed, so they are
+    only overwritten with the same values.  Fewer than 8 frames are
+    copied into a group of 8 and transposed into a local buffer from
+    which only the wanted time samples are copied.  Either way, the
+    remainder costs about the same as a group of 8, rather than 128
+    scattered stores per frame.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xR (int16_t              *dst,
+                                int            ndstStride,
+                                WibFrame const    *frames,
+                                int               nframes)
+{
+   int rframes = nframes & 0x7;
+   if (rframes == 0) return;
+
+   if (nframes >= 8)
+   {
+      transposeAdcs128x8N (dst    + nframes - 8,
+                           ndstStride,
+                           frames + nframes - 8,
+                           8);
+      return;
+   }
+
+
+   // ----------------------------------------------------
+   // Too few frames to overlap, transpose a padded copy.
+   // The copy is made before the x 8 transposer loads the
+   // expander registers.
+   // ----------------------------------------------------
+   uint64_t pad[8 * sizeof (WibFrame) / sizeof (uint64_t)]
+            __attribute__ ((aligned (64)));
+   int16_t  buf[128 * 8] __attribute__ ((aligned (64)));
+
+   memset (pad,      0, sizeof (pad));
+   memcpy (pad, frames, rframes * sizeof (*frames));
+
+   transposeAdcs128x8N (buf, 8, reinterpret_cast<WibFrame const *>(pad), 8);
+
+   for (int ichan = 0; ichan < 128; ichan++)
+   {
+      for (int iframe = 0; iframe < rframes; iframe++)
+      {
+         dst[ichan * ndstStride + iframe] = buf[ichan * 8 + iframe];
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ====================================================================== */
+/* BEGIN: CHANNEL-BY-CHANNEL TRANSPOSERS                                  */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples.
+
+   \param[in]       dst[out]  Array of pointers to the channel-by-channel
+                              destination arrays
+   \param[in]         offset  The offset into the destination arrays to
+                              store the first transposed ADC.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN  (int16_t  *const      *dst,
+                                 int                offset,
+                                 WibFrame  const   *frames,
+                                 int               nframes)
+{
+   // -------------------------------------------------
+   // The x 32 transposer picks up the remainder itself
+   // -------------------------------------------------
+   transposeAdcs128x32N (dst, offset, frames, nframes);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 8 at a time.
+
+   \param[in]       dst[out]  Array of pointers to the channel-by-channel
+                              destination arrays
+   \param[in]         offset  The offset into the destination arrays to
+                              store the first transposed ADC.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 8, see transposeAdcs128xR.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x8N  (int16_t  *const      *dst,
+                                  int                offset,
+                                  WibFrame  const   *frames,
+                                  int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *const *dst0 = dst;
+   int16_t *const *dst1 = dst + 64;
+   int         n8frames = nframes/8;
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+
+   // ------------------------------=----
+   // Loop over the frames in groups of 8
+   // -----------------------------------
+   for (int iframe = 0; iframe < n8frames; ++iframe)
+   {
+      uint64_t const *lclsrc0 = src0;
+      uint64_t const *lclsrc1 = src1;
+
+      int16_t *const *lcldst0 = dst0;
+      int16_t *const *lcldst1 = dst1;
+
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x  8 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x8_kernel  (lcldst0, offset, lclsrc0);
+         lcldst0 += 16;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x8_kernel  (lcldst1, offset, lclsrc1);
+         lcldst1 += 16;
+         lclsrc1 +=  3;
+      }
+
+      // Advance the source and destination by the 8 time frames
+      src0   += 8 * sizeof (WibFrame) / sizeof (*src0);
+      src1   += 8 * sizeof (WibFrame) / sizeof (*src1);
+
+      // Advance the destination by the same
+      offset += 8;
+   }
+
+
+   // ------------------------------
+   // Pickup the last nframes % 8
+   // ------------------------------
+   transposeAdcs128xR (dst, offset - (nframes & ~0x7), frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 16 at a time.
+
+   \param[in]       dst[out]  Array of pointers to the channel-by-channel
+                              destination arrays
+   \param[in]         offset  The offset into the destination arrays to
+                              store the first transposed ADC.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 16, see transposeAdcs128xR.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x16N (int16_t *const       *dst,
+                                  int                offset,
+                                  WibFrame const    *frames,
+                                  int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *const *dst0 = dst;
+   int16_t *const *dst1 = dst + 64;
+
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+
+   // ------------------------------=-----
+   // Loop over the frames in groups of 16
+   // ------------------------------------
+   int n16frames = nframes/16;
+   for (int iframe = 0; iframe < n16frames; ++iframe)
+   {
+      uint64_t const *lclsrc0 = src0;
+      uint64_t const *lclsrc1 = src1;
+
+      int16_t *const *lcldst0 = dst0;
+      int16_t *const *lcldst1 = dst1;
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x16_kernel (lcldst0, offset, lclsrc0);
+         lcldst0 += 16;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x16_kernel (lcldst1, offset, lclsrc1);
+         lcldst1 += 16;
+         lclsrc1 +=  3;
+      }
+
+
+      // Advance the source and destination by the 16 time frames
+      src0   += 16 * sizeof (WibFrame) / sizeof (*src0);
+      src1   += 16 * sizeof (WibFrame) / sizeof (*src1);
+      offset += 16;
+   }
+
+
+   // -----------------------------------------------
+   // Pickup the remainder, 8 at a time, then the last
+   // nframes % 8.  The offset is now that of frame n16.
+   // -----------------------------------------------
+   int n16      = nframes & ~0xf;
+   int n8frames = nframes &  0x8;
+   if (n8frames)
+   {
+      transposeAdcs128x8N (dst, offset, frames + n16, n8frames);
+   }
+
+   transposeAdcs128xR (dst, offset - n16, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels serviced by a WibFrame for
+          \a nframes time samples, \a 32 at a time.
+
+   \param[in]       dst[out]  Array of pointers to the channel-by-channel
+                              destination arrays
+   \param[in]         offset  The offset into the destination arrays to
+                              store the first transposed ADC.
+   \param[in]     frames[in]  The array of WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+                              to transpose.  This need not be a
+                              multiple of 32, see transposeAdcs128xR.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128x32N (int16_t  *const      *dst,
+                                  int                offset,
+                                  WibFrame  const   *frames,
+                                  int               nframes)
+{
+   // ----------------------------------
+   // Locate the cold data in this frame
+   // ----------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+
+
+   // ------------------------------------------------
+   // Locate the packed data for each cold data stream
+   // ------------------------------------------------
+   uint64_t const *src0 = coldData[0].locateAdcs12b ();
+   uint64_t const *src1 = coldData[1].locateAdcs12b ();
+
+
+   // ----------------------------------------------------------------
+   // Locate where in the output data for the 2 cold data streams goes
+   // ----------------------------------------------------------------
+   int16_t *const *dst0 = dst;
+   int16_t *const *dst1 = dst + 64;
+
+
+   // ---------------------------------
+   // Initialize the expander registers
+   // ---------------------------------
+   expandAdcs16_init_kernel ();
+
+   // ------------------------------=-----
+   // Loop over the frames in groups of 32
+   // ------------------------------------
+   int n32frames = nframes/32;
+   for (int iframe = 0; iframe < n32frames; ++iframe)
+   {
+      uint64_t  const *lclsrc0 = src0;
+      uint64_t  const *lclsrc1 = src1;
+
+      int16_t  *const *lcldst0 = dst0;
+      int16_t  *const *lcldst1 = dst1;
+
+      // ----------------------------------
+      // Loop over the adcs in groups of 16
+      // ----------------------------------
+      for (int iadcs = 0; iadcs < 64; iadcs += 16)
+      {
+         // ----------------------------------------------------------------
+         // Transpose the cold data stream 0 & 1  for 16 channels x 32 times
+         // ----------------------------------------------------------------
+         transposeAdcs16x32_kernel (lcldst0, offset, lclsrc0);
+         lcldst0 += 16;
+         lclsrc0 +=  3;
+
+         transposeAdcs16x32_kernel (lcldst1, offset, lclsrc1);
+         lcldst1 += 16;
+         lclsrc1 +=  3;
+      }
+
+      // Advance the source and destination by the 32 time frames
+      src0   += 32 * sizeof (WibFrame) / sizeof (*src0);
+      src1   += 32 * sizeof (WibFrame) / sizeof (*src1);
+      offset += 32;
+   }
+
+
+   // -----------------------------------------------
+   // Pickup the remainder, 8 at a time, then the last
+   // nframes % 8.  The offset is now that of frame n32.
+   // -----------------------------------------------
+   int n32      = nframes & ~0x1f;
+   int n8frames = nframes &  0x18;
+   if (n8frames)
+   {
+      transposeAdcs128x8N (dst, offset, frames + n32, n8frames);
+   }
+
+   transposeAdcs128xR (dst, offset - n32, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the last \a nframes % 8 of the 128 ADC channels
+          serviced by a WibFrame for \a nframes time samples
+
+   \param[in]       dst[out]  Array of pointers to the channel-by-channel
+                              destination arrays
+   \param[in]         offset  The offset into the destination arrays of
+                              the first of the \a nframes
+   \param[in]     frames[in]  The array of all \a nframes WibFrames
+   \param[in]    nframes[in]  The number frames, \e i.e. time samples
+
+   \par
+    Unlike the contiguous version, the last 8 frames cannot be simply
+    transposed again in place, since the channel-by-channel kernels
+    store in units that assume the offset is a multiple of the group
+    size.  Instead they, or a padded copy of fewer than 8 frames, are
+    transposed into a local buffer from which only the remainder is
+    copied.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xR (int16_t *const       *dst,
+                                int                offset,
+                                WibFrame const    *frames,
+                                int               nframes)
+{
+   int rframes = nframes & 0x7;
+   if (rframes == 0) return;
+
+   int16_t  buf[128 * 8] __attribute__ ((aligned (64)));
+
+   if (nframes >= 8)
+   {
+      transposeAdcs128x8N (buf, 8, frames + nframes - 8, 8);
+   }
+   else
+   {
+      // -------------------------------------------------------
+      // Too few frames to overlap, transpose a padded copy with
+      // the frames placed last, as they would be when overlapping
+      // -------------------------------------------------------
+      uint64_t pad[8 * sizeof (WibFrame) / sizeof (uint64_t)]
+               __attribute__ ((aligned (64)));
+      WibFrame *padded = reinterpret_cast<WibFrame *>(pad);
+
+      memset (pad,                    0, sizeof (pad));
+      memcpy (padded + 8 - rframes, frames, rframes * sizeof (*frames));
+
+      transposeAdcs128x8N (buf, 8, padded, 8);
+   }
+
+
+   // -----------------------------------------------
+   // The remainder is the last rframes of each group
+   // -----------------------------------------------
+   int16_t const *src    = buf + 8 - rframes;
+   int            ifirst = offset + nframes - rframes;
+   for (int ichan = 0; ichan < 128; ichan++)
+   {
+      for (int iframe = 0; iframe < rframes; iframe++)
+      {
+         dst[ichan][ifirst + iframe] = src[ichan * 8 + iframe];
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: CHANNEL-BY-CHANNEL TRANSPOSERS                                    */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* BEGIN: ASSESSMENT HELPERS                                              */
+/* ---------------------------------------------------------------------- */
+// The position of the convert count in the cold data header word 0
+static const int CvtCntShift = static_cast<int>
+                              (pdd::record::WibColdData::Offset0::ConvertCount);
+
+// The assessed fields of the cold data header words: the stream errors
+// and convert count of word 0 and the error register of word 1
+static const uint64_t CdMask0 = 
+   (static_cast<uint64_t>(pdd::record::WibColdData::Mask0::StreamErr)
+ << static_cast<int>     (pdd::record::WibColdData::Offset0::StreamErr))
+ | (static_cast<uint64_t>(pdd::record::WibColdData::Mask0::ConvertCount)
+ << CvtCntShift);
+
+static const uint64_t CdMask1 = 
+    static_cast<uint64_t>(pdd::record::WibColdData::Mask1::ErrRegister)
+ << static_cast<int>     (pdd::record::WibColdData::Offset1::ErrRegister);
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Tests whether a frame is error free and continues the expected
+           sequence
+   \retval true,  if it does
+   \retval false, if it does not
+
+   \param[in]        wf  The frame
+   \param[in]    header  The expected WIB header word.  This includes the
+                         reserved and error fields, which must be 0.
+   \param[in] timestamp  The expected timestamp
+   \param[in]   cvtcnt0  The expected cold data stream 0 convert count,
+                         in the convert count position, CvtCntShift
+   \param[in]   cvtcnt1  The expected cold data stream 1 convert count,
+                         in the convert count position, CvtCntShift
+
+   \par
+    The cold data header words are masked to CdMask0 and CdMask1, the
+    fields that the TpcStreamAssessor checks.  The checksums are ignored.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline bool isInSequence (WibFrame const    &wf,
+                                 uint64_t       header,
+                                 uint64_t    timestamp,
+                                 uint64_t      cvtcnt0,
+                                 uint64_t      cvtcnt1)
+{
+   auto const &cd = wf.getColdData ();
+   uint64_t  diff = (wf.getHeader    () ^ header)
+                  | (wf.getTimestamp () ^ timestamp)
+                  | ((cd[0].getHeader0 () & CdMask0) ^ cvtcnt0)
+                  |  (cd[0].getHeader1 () & CdMask1)
+                  | ((cd[1].getHeader0 () & CdMask0) ^ cvtcnt1)
+                  |  (cd[1].getHeader1 () & CdMask1);
+   return diff == 0;
+}
+/* ---------------------------------------------------------------------- */
+/* END: ASSESSMENT HELPERS                                                */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* BEGIN: KERNELS                                                         */
+/* ---------------------------------------------------------------------- */
+#include WIBFRAME_KERNELS_HH
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ====================================================================== */
+/* BEGIN: CONTIGIOUS TRANSPOSITION                                        */
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Transpose 8N time samples for 16 channels
+
+  \param[out]   dst The destination array
+  \param[ in]    n8 The number of groups of 8 channels, \e i.e. the N in
+                    transpose16x8N
+  \param[in] offset The number of elements in on channel's destination
+                    array.
+  \param[in]    src The source array
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x8N_kernel (int16_t        *dst,
+                                              int              n8,
+                                              int          stride,
+                                              uint64_t const *src)
+{
+   for (int idx = 0; idx < n8; ++idx)
+   {
+      transposeAdcs16x8_kernel (dst, stride, src + idx * 8 * sizeof (WibFrame) / sizeof (*src));
+      dst += 8;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+#ifndef WIBFRAME_HAS_16xM_KERNELS
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x16_kernel (int16_t        *dst,
+                                              int          stride,
+                                              uint64_t const *src)
+{
+   transposeAdcs16x8N_kernel (dst, 2, stride, src);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x32_kernel (int16_t        *dst,
+                                              int          stride,
+                                              uint64_t const *src)
+{
+   transposeAdcs16x8N_kernel (dst, 4, stride, src);
+}
+/* ---------------------------------------------------------------------- */
+#endif
+/* END: CONTIGIOUS TRANSPOSITION                                          */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* BEGIN: CHANNEL-BY-CHANNEL TRANSPOSITION                                */
+/* ---------------------------------------------------------------------- *//*!
+  \brief  Transpose 8N time samples for 16 channels
+
+  \param[out]   dst Pointers to 16 arrays to receive the transposed data
+  \param[ in]    n8 The number of groups of 8 channels, \e i.e. the N in
+                    transpose16x8N
+  \param[in] offset The number of elements in on channel's destination
+                    array.
+  \param[in]    src The source array
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x8N_kernel (int16_t  *const *dst,
+                                              int               n8,
+                                              int           offset,
+                                              uint64_t const  *src)
+{
+   for (int idx = 0; idx < n8; ++idx)
+   {
+      transposeAdcs16x8_kernel (dst, offset, src);
+      src    += 8 * sizeof (WibFrame) / sizeof (*src);
+      offset += 8;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+#ifndef WIBFRAME_HAS_16xM_KERNELS
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x16_kernel (int16_t *const  *dst,
+                                              int           offset,
+                                              uint64_t const  *src)
+{
+   transposeAdcs16x8N_kernel (dst, 2, offset, src);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs16x32_kernel (int16_t *const  *dst,
+                                              int           offset,
+                                              uint64_t const  *src)
+{
+   transposeAdcs16x8N_kernel (dst, 4, offset, src);
+}
+/* ---------------------------------------------------------------------- */
+#endif
+/* END: CHANNEL-BY-CHANNEL TRANSPOSITION                                  */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* BEGIN: ASSESSMENT                                                      */
+/* ---------------------------------------------------------------------- */
+#ifndef WIBFRAME_HAS_ASSESS_KERNEL
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Counts the leading frames that continue the expected sequence
+   \return The number of frames
+
+   \par
+    The frames are tested 4 at a time, without branching between them.
+    Only the batch that breaks the sequence is retested frame by frame.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline int countInSequence_kernel (WibFrame const    *frames,
+                                          int               nframes,
+                                          uint64_t           header,
+                                          uint64_t        timestamp,
+                                          unsigned int      cvtcnt0,
+                                          unsigned int      cvtcnt1)
+{
+   uint64_t cvt0 = static_cast<uint64_t>(cvtcnt0) << CvtCntShift;
+   uint64_t cvt1 = static_cast<uint64_t>(cvtcnt1) << CvtCntShift;
+   uint64_t const One = static_cast<uint64_t>(1)  << CvtCntShift;
+
+   int iframe;
+   for (iframe = 0; iframe + 4 <= nframes; iframe += 4)
+   {
+      WibFrame const *wf = frames + iframe;
+      bool          okay = isInSequence (wf[0], header, timestamp,
+                                                cvt0,           cvt1)
+                         & isInSequence (wf[1], header, timestamp + 25,
+                                                cvt0 + One,     cvt1 + One)
+                         & isInSequence (wf[2], header, timestamp + 50,
+                                                cvt0 + 2 * One, cvt1 + 2 * One)
+                         & isInSequence (wf[3], header, timestamp + 75,
+                                                cvt0 + 3 * One, cvt1 + 3 * One);
+      if (!okay) break;
+
+      timestamp += 4 * 25;
+      cvt0      += 4 * One;
+      cvt1      += 4 * One;
+   }
+
+   for (; iframe < nframes; iframe++)
+   {
+      if (!isInSequence (frames[iframe], header, timestamp, cvt0, cvt1)) break;
+
+      timestamp += 25;
+      cvt0      += One;
+      cvt1      += One;
+   }
+
+   return iframe;
+}
+/* ---------------------------------------------------------------------- */
+#endif
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Counts the leading frames that are error free and continue the
+           expected sequence
+   \return The number of frames
+
+   \param[in]    frames  The frames
+   \param[in]   nframes  The number of frames
+   \param[in]    header  The expected WIB header word
+   \param[in] timestamp  The expected timestamp of the first frame
+   \param[in]   cvtcnt0  The expected cold data stream 0 convert count of
+                         the first frame
+   \param[in]   cvtcnt1  The expected cold data stream 1 convert count of
+                         the first frame
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static int countInSequence (WibFrame const    *frames,
+                            int               nframes,
+                            uint64_t           header,
+                            uint64_t        timestamp,
+                            unsigned int      cvtcnt0,
+                            unsigned int      cvtcnt1)
+{
+   return countInSequence_kernel (frames,    nframes, header,
+                                  timestamp, cvtcnt0, cvtcnt1);
+}
+/* ---------------------------------------------------------------------- */
+/* END: ASSESSMENT                                                        */
+/* ====================================================================== */
+
+
+
+
+/* ====================================================================== */
+/* BEGIN: MASKED TRANSPOSITION                                            */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the selected ADC channels of \a nframes time samples
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the arrays of
+                          transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+   \param[in]   chanMask  The selected channels, bit n % 64 of
+                          chanMask[n / 64] for channel n
+
+   \par
+    Only the selected channels are stored, in increasing channel order,
+    so the output should be thought of as dst[nselected][ndstStride].
+
+   \par
+    The channels are unpacked 16 at a time, the granularity of the
+    transposition kernels, and groups of 16 with no selected channel
+    are skipped.  A fully selected group is transposed directly into
+    place, a partially selected one into a local buffer from which only
+    the selected channels are copied.  Any frames beyond the last
+    multiple of 32 are expanded one frame at a time.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcsMasked128xN (int16_t              *dst,
+                                      int            ndstStride,
+                                      WibFrame const    *frames,
+                                      int               nframes,
+                                      uint64_t const chanMask[2])
+{
+   int const FrameStride = sizeof (WibFrame) / sizeof (uint64_t);
+
+   if (nframes <= 0) return;
+
+
+   // ---------------------------------------------------------------
+   // The selected channels of each group of 16 and their output rows
+   // ---------------------------------------------------------------
+   unsigned int   sel[8];
+   int16_t      *rows[8];
+   uint8_t    chans[128];
+   int            nchans = 0;
+
+   for (int igroup = 0; igroup < 8; igroup++)
+   {
+      sel[igroup]  = (chanMask[igroup >> 2] >> (16 * (igroup & 3))) & 0xffff;
+      rows[igroup] = dst + nchans * ndstStride;
+
+      for (unsigned int bits = sel[igroup]; bits; bits &= bits - 1)
+      {
+         chans[nchans++] = igroup * 16 + __builtin_ctz (bits);
+      }
+   }
+
+   if (nchans == 0) return;
+
+
+   // ----------------------------------------------------------
+   // Locate the packed data of the two cold data streams, each
+   // group of 16 channels being 3 64-bit words further along
+   // ----------------------------------------------------------
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+   uint64_t const *src[2] = { coldData[0].locateAdcs12b (),
+                              coldData[1].locateAdcs12b () };
+
+   expandAdcs16_init_kernel ();
+
+
+   // ------------------------------------
+   // Loop over the frames in groups of 32
+   // ------------------------------------
+   int n32frames = nframes & ~0x1f;
+   for (int iframe = 0; iframe < n32frames; iframe += 32)
+   {
+      for (int igroup = 0; igroup < 8; igroup++)
+      {
+         unsigned int   bits = sel[igroup];
+         if (bits == 0) continue;
+
+         uint64_t const *lclsrc = src[igroup >> 2]
+                                + 3 * (igroup & 3)
+                                + iframe * FrameStride;
+         int16_t        *lcldst = rows[igroup] + iframe;
+
+         if (bits == 0xffff)
+         {
+            transposeAdcs16x32_kernel (lcldst, ndstStride, lclsrc);
+            continue;
+         }
+
+         int16_t adcBuf[16 * 32] __attribute__ ((aligned (64)));
+         transposeAdcs16x32_kernel (adcBuf, 32, lclsrc);
+
+         for (; bits; bits &= bits - 1)
+         {
+            memcpy (lcldst, adcBuf + 32 * __builtin_ctz (bits),
+                    32 * sizeof (*adcBuf));
+            lcldst += ndstStride;
+         }
+      }
+   }
+
+
+   // --------------------------------------------------
+   // Get any remaining frames (these are less than 32),
+   // expanding all 128 channels of each.  The memcpy's
+   // above may have clobbered the expansion kernel's
+   // state, so it is initialized again.
+   // --------------------------------------------------
+   if (n32frames < nframes) expandAdcs16_init_kernel ();
+
+   for (int iframe = n32frames; iframe < nframes; iframe++)
+   {
+      WibColdData const (& cd)[2] = frames[iframe].getColdData ();
+
+      int16_t                adcBuf[128];
+      expandAdcs64x1_kernel (adcBuf+ 0, cd[0].locateAdcs12b ());
+      expandAdcs64x1_kernel (adcBuf+64, cd[1].locateAdcs12b ());
+
+      int16_t *lcldst = dst + iframe;
+      for (int idx = 0; idx < nchans; idx++)
+      {
+         lcldst[idx * ndstStride] = adcBuf[chans[idx]];
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: MASKED TRANSPOSITION                                              */
+/* ====================================================================== */
+
+
+
+/* ====================================================================== */
+/* BEGIN: FLOAT TRANSPOSITION                                             */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Converts one channel's ADCs to pedestal subtracted, gain
+          corrected floats
+
+   \param[out]  dst  The converted values
+   \param[in]   src  The ADCs
+   \param[in] nadcs  The number of ADCs
+   \param[in]   ped  The channel's pedestal
+   \param[in]  gain  The channel's gain
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void convertAdcs (float         *dst,
+                                int16_t const *src,
+                                int          nadcs,
+                                float          ped,
+                                float         gain) WIBFRAME_TARGET;
+
+static inline void convertAdcs (float         *dst,
+                                int16_t const *src,
+                                int          nadcs,
+                                float          ped,
+                                float         gain)
+{
+   for (int idx = 0; idx < nadcs; idx++)
+   {
+      dst[idx] = (src[idx] - ped) * gain;
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels of \a nframes time samples into
+          pedestal subtracted, gain corrected floats
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of converted ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+   \param[in]       peds  The 128 pedestals
+   \param[in]      gains  The 128 gains. If NULL, 1.
+
+   \par
+    Channel n's value is (adc - peds[n]) * gains[n].  The frames are
+    transposed 32 at a time into a local buffer, 8 KBytes, that stays
+    in the L1 cache while it is converted, so the int16_t values are
+    never written to memory.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN_float (float                *dst,
+                                      int            ndstStride,
+                                      WibFrame const    *frames,
+                                      int               nframes,
+                                      float const         *peds,
+                                      float const        *gains)
+{
+   int16_t adcBuf[128 * 32] __attribute__ ((aligned (64)));
+
+   for (int iframe = 0; iframe < nframes; iframe += 32)
+   {
+      int nblock = nframes - iframe;
+      if (nblock > 32) nblock = 32;
+
+      transposeAdcs128xN (adcBuf, 32, frames + iframe, nblock);
+
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         float        gain = gains ? gains[ichan] : 1.0f;
+         float     *lcldst = dst + ichan * ndstStride + iframe;
+         int16_t const *src = adcBuf + ichan * 32;
+
+         // A constant count lets the compiler vectorize the full blocks
+         if (nblock == 32) convertAdcs (lcldst, src, 32,     peds[ichan], gain);
+         else              convertAdcs (lcldst, src, nblock, peds[ichan], gain);
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: FLOAT TRANSPOSITION                                               */
+/* ====================================================================== */
+
+
+
+/* ====================================================================== */
+/* BEGIN: STATISTICS TRANSPOSITION                                        */
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels of \a nframes time samples,
+          accumulating the statistics of each channel
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+   \param[in,out]  stats  The 128 channels' statistics, added to
+
+   \par
+    The frames are transposed AdcStats::MaxBlock, 256, at a time.  Each
+    channel's 256 time samples are added to its statistics straight
+    after, while the 128 pieces, 64 KBytes, are still in the L2 cache.
+    The statistics then cost no more memory traffic than the
+    transposition itself.  Smaller blocks fit in L1, but the per block
+    cost of the horizontal sums then outweighs the saving.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN_stats (int16_t              *dst,
+                                      int            ndstStride,
+                                      WibFrame const    *frames,
+                                      int               nframes,
+                                      AdcStats           *stats)
+{
+   for (int iframe = 0; iframe < nframes; iframe += AdcStats::MaxBlock)
+   {
+      int nblock = nframes - iframe;
+      if (nblock > AdcStats::MaxBlock) nblock = AdcStats::MaxBlock;
+
+      transposeAdcs128x32N (dst + iframe, ndstStride, frames + iframe, nblock);
+
+      int16_t const *src = dst + iframe;
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         stats[ichan].accumulate (src, nblock);
+         src += ndstStride;
+      }
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: STATISTICS TRANSPOSITION                                          */
+/* ====================================================================== */
+
+
+
+/* ====================================================================== */
+/* BEGIN: BLOCKED TRANSPOSITION                                           */
+#ifndef WIBFRAME_HAS_STREAM_KERNEL
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Copies ADCs to their destination with non-temporal stores
+
+   \param[out]   dst  The destination
+   \param[in]    src  The source
+   \param[in]  nadcs  The number of ADCs to copy
+
+   \par
+    The ADCs up to the first 16 byte boundary of the destination and
+    any after the last are stored normally.  The caller must issue an
+    sfence before the stored values are relied upon.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void streamAdcs_kernel (int16_t        *dst,
+                                      int16_t const  *src,
+                                      int           nadcs)
+{
+   while (nadcs > 0 && (reinterpret_cast<uintptr_t>(dst) & 0xf))
+   {
+      *dst++ = *src++;
+      nadcs -= 1;
+   }
+
+   for (; nadcs >= 8; nadcs -= 8, dst += 8, src += 8)
+   {
+      __m128i v = _mm_loadu_si128 (reinterpret_cast<__m128i const *>(src));
+      _mm_stream_si128 (reinterpret_cast<__m128i *>(dst), v);
+   }
+
+   while (nadcs-- > 0) *dst++ = *src++;
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+#endif
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels of \a nframes time samples,
+          staging them in a tile of \a ntile time samples
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+   \param[in]      ntile  The number of time samples in a tile. This
+                          is rounded down to a multiple of 32 and
+                          limited to WibFrame::MaxTransposeTile.
+   \param[in]     stream  If true, the tiles are stored with
+                          non-temporal stores
+
+   \par
+    The direct transposers store each group of 32 time samples as 128
+    separate 64 byte pieces, \a ndstStride * 2 bytes apart.  For long
+    windows each of these is on a different page and, when the stride
+    is a multiple of 4 KBytes, in the same cache set, so the stores miss
+    the TLB and evict each other's partially written lines.  Here the 32
+    time sample groups are transposed into a tile that stays in the
+    cache.  Only when the tile is full are the 128 channels stored, each
+    as one contiguous run of \a ntile time samples.  While one tile is
+    filled, the frames of the next are prefetched.
+
+   \par
+    The contiguous runs are also what makes non-temporal stores
+    worthwhile, each filling whole cache lines of the destination.
+
+   \par
+    The frames beyond the last multiple of 32 are transposed directly.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void transposeAdcs128xN_tiled (int16_t              *dst,
+                                             int            ndstStride,
+                                             WibFrame const    *frames,
+                                             int               nframes,
+                                             int                 ntile,
+                                             bool               stream)
+                   __attribute__ ((always_inline)) WIBFRAME_TARGET;
+
+static inline void transposeAdcs128xN_tiled (int16_t              *dst,
+                                             int            ndstStride,
+                                             WibFrame const    *frames,
+                                             int               nframes,
+                                             int                 ntile,
+                                             bool               stream)
+{
+   int const FrameStride = sizeof (WibFrame) / sizeof (uint64_t);
+   int const     MaxTile = WibFrame::MaxTransposeTile;
+
+   int16_t tile[128 * MaxTile] __attribute__ ((aligned (64)));
+
+   if (nframes <= 0) return;
+
+   ntile &= ~0x1f;
+   if      (ntile > MaxTile) ntile = MaxTile;
+   else if (ntile <      32) ntile = 32;
+
+
+   WibColdData const (& coldData)[2] = frames->getColdData ();
+   uint64_t const *src[2] = { coldData[0].locateAdcs12b (),
+                              coldData[1].locateAdcs12b () };
+
+
+   // -------------------------------------------------
+   // Loop over the tiles, the last may be partially
+   // filled, but always with a multiple of 32 frames
+   // -------------------------------------------------
+   int n32frames = nframes & ~0x1f;
+   for (int iframe = 0; iframe < n32frames; iframe += ntile)
+   {
+      int nblock = n32frames - iframe;
+      if (nblock > ntile) nblock = ntile;
+
+
+      // -----------------------------------------------------------
+      // The stores of the previous tile may have used the registers
+      // the expansion relies on, so they are initialized each time
+      // -----------------------------------------------------------
+      expandAdcs16_init_kernel ();
+
+      for (int iblock = 0; iblock < nblock; iblock += 32)
+      {
+         // ----------------------------------------------------
+         // Prefetch the corresponding 32 frames of the next tile
+         // ----------------------------------------------------
+         char const *pf = reinterpret_cast<char const *>
+                          (frames + iframe + iblock + ntile);
+         if (iframe + iblock + ntile + 32 <= nframes)
+         {
+            for (int ioff = 0; ioff < 32 * (int)sizeof (WibFrame); ioff += 64)
+            {
+               __builtin_prefetch (pf + ioff, 0, 3);
+            }
+         }
+
+         for (int igroup = 0; igroup < 8; igroup++)
+         {
+            uint64_t const *lclsrc = src[igroup >> 2]
+                                   + 3 * (igroup & 3)
+                                   + (iframe + iblock) * FrameStride;
+
+            transposeAdcs16x32_kernel (tile + igroup * 16 * ntile + iblock,
+                                       ntile,
+                                       lclsrc);
+         }
+      }
+
+
+      // -----------------------------------------------
+      // Store the tile, one contiguous run per channel
+      // -----------------------------------------------
+      int16_t const *lclsrc = tile;
+      int16_t       *lcldst = dst + iframe;
+      for (int ichan = 0; ichan < 128; ichan++)
+      {
+         if (stream) streamAdcs_kernel (lcldst, lclsrc, nblock);
+         else        memcpy (lcldst, lclsrc, nblock * sizeof (*lcldst));
+         lclsrc += ntile;
+         lcldst += ndstStride;
+      }
+   }
+
+
+   // ----------------------------------------------
+   // Get any remaining frames (these are less than
+   // 32) directly, the multiples of 8 first
+   // ----------------------------------------------
+   int n8frames = nframes & 0x18;
+   if (n8frames)
+   {
+      transposeAdcs128x8N (dst    + n32frames,
+                           ndstStride,
+                           frames + n32frames,
+                           n8frames);
+   }
+
+   transposeAdcs128xR (dst, ndstStride, frames, nframes);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels of \a nframes time samples,
+          staging them in a tile of \a ntile time samples
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+   \param[in]      ntile  The number of time samples in a tile
+
+   \par
+    See transposeAdcs128xN_tiled.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN_blocked (int16_t              *dst,
+                                        int            ndstStride,
+                                        WibFrame const    *frames,
+                                        int               nframes,
+                                        int                 ntile)
+{
+   transposeAdcs128xN_tiled (dst, ndstStride, frames, nframes, ntile, false);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief Transposes the 128 ADC channels of \a nframes time samples,
+          storing them with non-temporal stores
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames to transpose
+
+   \par
+    The output bypasses the caches, so it does not evict the working
+    set of whatever runs alongside.  It is meant for output that is
+    consumed much later.  The stores are fenced before returning.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static void transposeAdcs128xN_stream (int16_t              *dst,
+                                       int            ndstStride,
+                                       WibFrame const    *frames,
+                                       int               nframes)
+{
+   transposeAdcs128xN_tiled (dst, ndstStride, frames, nframes,
+                             WibFrame::DefTransposeTile, true);
+   _mm_sfence ();
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: BLOCKED TRANSPOSITION                                             */
+/* ====================================================================== */
+/* END: KERNELS                                                           */
+/* ====================================================================== */
@@ -40,6 +40,10 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt expandAdcs16x1_kernel now copies the expanded ADCs into
+                  the int16_t destination rather than storing through a
+                  uint64_t pointer.  The aliasing violation allowed gcc -O2
+                  to treat the destination as never written.
    2018.10.23 jjr Had to remove the inline from expandAdcs64x1_kernel. 
                   The gcc optimizer optimized it right out of existence.
    2017.09.20 jjr Separated from WibFrame.cc
@@ -210,7 +214,7 @@ static inline uint64_t expandC_F (uint64_t w2)
 /* ---------------------------------------------------------------------- */
 static inline void expandAdcs16x1_kernel (int16_t *dst, uint64_t const *src)
 {
-   uint64_t *dst64 = reinterpret_cast<uint64_t *>(dst);
+   uint64_t dst64[4];
 
    uint64_t w0 = *src++;  
    dst64[0]    = expand0_3 (w0);
@@ -222,6 +226,12 @@ static inline void expandAdcs16x1_kernel (int16_t *dst, uint64_t const *src)
    dst64[2]    = expand8_B (w2, w1);
    dst64[3]    = expandC_F (w2);
 
+   // ------------------------------------------------------
+   // Copy, rather than store through a uint64_t *, so the
+   // compiler knows the int16_t destination is being written
+   // ------------------------------------------------------
+   memcpy (dst, dst64, sizeof (dst64));
+
 /*
    for (int idx = 0; idx < 16; idx++)
    {
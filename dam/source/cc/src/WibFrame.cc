@@ -37,6 +37,23 @@
 
    DATE       WHO WHAT
    ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Added the transposeAdcs128xN that accumulates AdcStats
+   2026.10.16 agt The x 8N, x 16N and x 32N transposers no longer require
+                  a multiple of 8, 16 or 32 frames
+   2026.10.16 agt Added transposeAdcs128xN_stream
+   2026.10.16 agt Added transposeAdcs128xN_blocked
+   2026.10.16 agt Added the float transposeAdcs128xN
+   2026.10.16 agt Added transposeAdcsMasked128xN
+   2026.10.16 agt Added packAdcs128xN
+   2026.10.16 agt Added countInSequence
+   2026.10.16 agt Added the avx512 variant, preferred when the cpu
+                  supports AVX512F and AVX512BW
+   2026.10.16 agt Moved the kernels and drivers to WibFrame-drivers.hh.
+                  The gen, avx and avx2 variants are now each compiled
+                  into the library and the best one for the executing
+                  cpu is selected at load time.  The environment variable
+                  PDD_WIBFRAME_KERNELS can be used to override this
+                  choice.
    2018.10.23 jjr Had to remove the inline from expandAdcs64x1_kernel. 
                   The gcc optimizer optimized it right out of existence.
    2017.10.05 jjr Added transposeAdcs128xN. These are methods that optimize
@@ -53,85 +70,186 @@
 \* ---------------------------------------------------------------------- */
 
 
+
+
 #include "dam/access/WibFrame.hh"
+#include "WibFrame-dispatch.hh"
 #include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 
 namespace pdd    {
 namespace access {
 
 
-static inline void expandAdcs16_init_kernel () __attribute__ ((always_inline));
+/* ====================================================================== */
+/* BEGIN: KERNEL SELECTION                                                */
+/* ---------------------------------------------------------------------- *//*!
+
+  \var   Kernels
+  \brief The kernels in use.
+
+   This is set when the library is loaded.  Should a WibFrame method be
+   called by some other static initializer before this happens, the
+   selection is made then.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static WibFrameKernels const *Kernels = WibFrameKernels::select ();
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the kernels in use, selecting them if necessary
+  \return The kernels in use
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline WibFrameKernels const &kernels ()
+{
+   WibFrameKernels const *k = Kernels;
+   if (k == NULL) Kernels = k = WibFrameKernels::select ();
+   return *k;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Test whether the executing cpu supports the AVX-512 kernels
+  \retval true,  if AVX512F and AVX512BW are both supported
+  \retval false, otherwise
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline bool avx512 ()
+{
+   return __builtin_cpu_supports ("avx512f")
+       && __builtin_cpu_supports ("avx512bw");
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Locate the kernels by name
+  \return Pointer to the kernels if \a name is known and supported on
+          the executing cpu, else NULL.
+
+  \param[in] name The name of the kernels, gen, avx, avx2 or avx512
+                                                                          */
+/* ---------------------------------------------------------------------- */
+WibFrameKernels const *WibFrameKernels::locate (char const *name)
+{
+   __builtin_cpu_init ();
+
+   if (strcmp (name, wibframe::gen::Kernels.m_name) == 0)
+   {
+      return &wibframe::gen::Kernels;
+   }
+
+   if (strcmp (name, wibframe::avx::Kernels.m_name) == 0)
+   {
+      if (__builtin_cpu_supports ("avx"))  return &wibframe::avx::Kernels;
+      return NULL;
+   }
 
-// ------------------------------
-// EXPANDERS:   Contigious Memory
-// ------------------------------
-static inline void expandAdcs16x1_kernel  (int16_t        *dst,
-                                           uint64_t const *src) __attribute__ ((always_inline));
+   if (strcmp (name, wibframe::avx2::Kernels.m_name) == 0)
+   {
+      if (__builtin_cpu_supports ("avx2")) return &wibframe::avx2::Kernels;
+      return NULL;
+   }
 
-static void expandAdcs64x1_kernel  (int16_t        *dst, 
-                                    uint64_t const *src);
+   if (strcmp (name, wibframe::avx512::Kernels.m_name) == 0)
+   {
+      if (avx512 ()) return &wibframe::avx512::Kernels;
+      return NULL;
+   }
 
-static inline void expandAdcs16x4_kernel  (int16_t        *dst, 
-                                           uint64_t const *src) __attribute__ ((always_inline));
+   return NULL;
+}
+/* ---------------------------------------------------------------------- */
 
 
-// ------------------------------
-// TRANSPOSERS: Contigious Memory
-// ------------------------------
-static inline void transposeAdcs128xN_kernel (int16_t              *dst,
-                                              int            ndstStride,
-                                              WibFrame const    *frames,
-                                              int               nframes) __attribute__ ((always_inline));
 
-static inline void transposeAdcs16x8_kernel  (int16_t        *dst, 
-                                              int          offset, 
-                                              uint64_t const *src) __attribute__ ((always_inline));
+/* ---------------------------------------------------------------------- *//*!
 
-static inline void transposeAdcs16x8_kernel  (int16_t        *dst, 
-                                              int          offset, 
-                                              uint64_t const *src) __attribute__ ((always_inline));
+  \brief  Select the kernels best suited to the executing cpu
+  \return The selected kernels
 
-static inline void transposeAdcs16x8N_kernel (int16_t        *dst, 
-                                              int              n8,
-                                              int          stride, 
-                                              uint64_t const *src) __attribute__ ((always_inline));
+   If the environment variable PDD_WIBFRAME_KERNELS is set to one of
+   gen, avx, avx2 or avx512 and that variant is supported by the
+   executing cpu, it is used.  Otherwise the most capable supported
+   variant is used.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+WibFrameKernels const *WibFrameKernels::select ()
+{
+   char const *name = getenv ("PDD_WIBFRAME_KERNELS");
+   if (name)
+   {
+      WibFrameKernels const *k = locate (name);
+      if (k) return k;
 
-static inline void transposeAdcs16x16_kernel (int16_t        *dst, 
-                                              int          offset, 
-                                              uint64_t const *src) __attribute__ ((always_inline));
+      fprintf (stderr,
+               "PDD_WIBFRAME_KERNELS=%s is not a supported variant, "
+               "ignoring\n",
+               name);
+   }
 
-static inline void transposeAdcs16x32_kernel (int16_t        *dst, 
-                                              int          offset, 
-                                              uint64_t const *src) __attribute__ ((always_inline));
+   __builtin_cpu_init ();
+   if (avx512 ())                       return &wibframe::avx512::Kernels;
+   if (__builtin_cpu_supports ("avx2")) return &wibframe::avx2::Kernels;
+   if (__builtin_cpu_supports ("avx" )) return &wibframe::avx::Kernels;
 
+   return &wibframe::gen::Kernels;
+}
+/* ---------------------------------------------------------------------- */
 
 
-// --------------------------------------
-// TRANSPOSERS: Channel-by-Channel Memory
-// --------------------------------------
-static inline void transposeAdcs128xN_kernel (int16_t *const       *dst,
-                                              WibFrame const    *frames,
-                                              int               nframes) __attribute__ ((always_inline));
 
-static inline void transposeAdcs16x8_kernel  (int16_t  *const *dst, 
-                                              int           offset, 
-                                              uint64_t const  *src) __attribute__ ((always_inline));
+/* ---------------------------------------------------------------------- *//*!
 
-static inline void transposeAdcs16x8N_kernel (int16_t  *const *dst, 
-                                              int               n8,
-                                              int           offset, 
-                                              uint64_t const  *src) __attribute__ ((always_inline));
+  \brief  Return the name of the kernels in use
+  \return The name of the kernels in use, gen, avx, avx2 or avx512
+                                                                          */
+/* ---------------------------------------------------------------------- */
+char const *WibFrame::getKernels ()
+{
+   return kernels ().m_name;
+}
+/* ---------------------------------------------------------------------- */
 
-static inline void transposeAdcs16x16_kernel (int16_t  *const *dst, 
-                                              int           offset, 
-                                              uint64_t  const *src) __attribute__ ((always_inline));
 
-static inline void transposeAdcs16x32_kernel (int16_t  *const *dst, 
-                                              int           offset, 
-                                              uint64_t  const *src) __attribute__ ((always_inline));
-     
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Override the selection of the kernels
+  \retval true,  if successful
+  \retval false, if \a name is not a known variant or is not supported
+                 by the executing cpu. The selection is left unchanged.
+
+  \param[in] name The name of the kernels, gen, avx, avx2 or avx512
+
+   This is intended for testing and benchmarking.  It should not be
+   called while any other thread is using the WibFrame methods.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+bool WibFrame::selectKernels (char const *name)
+{
+   WibFrameKernels const *k = WibFrameKernels::locate (name);
+   if (k == NULL) return false;
+
+   Kernels = k;
+   return true;
+}
+/* ---------------------------------------------------------------------- */
+/* END: KERNEL SELECTION                                                  */
+/* ====================================================================== */
+
 
 
 /* ---------------------------------------------------------------------- *//*!
@@ -145,9 +263,7 @@ static inline void transposeAdcs16x32_kernel (int16_t  *const *dst,
 /* ---------------------------------------------------------------------- */
 void  WibFrame::expandAdcs128x1 (int16_t *dst) const
 {
-   WibColdData const (& coldData)[2] = getColdData ();
-   coldData[0].expandAdcs64x1 (dst + 0*pdd::record::WibColdData::NAdcs);
-   coldData[1].expandAdcs64x1 (dst + 1*pdd::record::WibColdData::NAdcs);
+   kernels ().m_expandAdcs128xN (dst, this, 1);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -165,28 +281,73 @@ void  WibFrame::expandAdcs128xN (int16_t           *dst,
                                  WibFrame const *frames, 
                                  int            nframes)
 {
-   for (int iframe = 0; iframe < nframes; ++iframe)
-   {
-      frames[iframe].expandAdcs128x1 (dst);
-      dst += 2*pdd::record::WibColdData::NAdcs;
-   }
+   kernels ().m_expandAdcs128xN (dst, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
 
 
 
+/* ---------------------------------------------------------------------- *//*!
+
+   \brief  Counts the leading frames that are error free and continue the
+           expected sequence
+   \return The number of such frames. The first frame that is not, if
+           any, is frames[returned value]
+
+   \param[in]    frames  The array of WibFrames
+   \param[in]   nframes  The number of frames
+   \param[in]   version  The expected WIB version
+   \param[in]        id  The expected WIB id, crate.slot.fiber
+   \param[in] timestamp  The expected timestamp of the first frame.  Each
+                         following frame is expected to be 25 later.
+   \param[in]   cvtcnt0  The expected convert count of cold data stream 0
+                         of the first frame.  Each following frame is
+                         expected to be 1 more, modulo 16 bits.
+   \param[in]   cvtcnt1  Likewise for cold data stream 1
+
+   \par
+    The comma character must be K28.5 and the WIB reserved and error
+    fields, the cold data stream errors and error registers must be 0. 
+    The checksums are not checked.  This is the vectorized form of the checks
+    made by TpcStreamAssessor::Record::evaluateAndUpdate; a frame passing
+    it would be found to have no errors.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int WibFrame::countInSequence (WibFrame const    *frames,
+                               int               nframes,
+                               unsigned int      version,
+                               unsigned int           id,
+                               uint64_t        timestamp,
+                               unsigned int      cvtcnt0,
+                               unsigned int      cvtcnt1)
+{
+   // The whole of the expected header word, the reserved and error
+   // fields being 0
+   uint64_t header = static_cast<uint64_t>(K28::K28_5)
+                   | static_cast<uint64_t>(version)
+                  << static_cast<int>     (Offset0::Version)
+                   | static_cast<uint64_t>(id)
+                  << static_cast<int>     (Offset0::Id);
+
+   return kernels ().m_countInSequence (frames,    nframes, header,
+                                        timestamp, cvtcnt0, cvtcnt1);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
           \a nframes time samples.
 
-   \param[in]       dst[out]  Array of pointers to the channel-by-channel
-                              destination arrays 
+   \param[in]       dst[out]  The output destination array.
    \param[in] ndstStride[in]  The number of entries of each of the 128
+                              arrays of transposed ADC values.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void WibFrame::transposeAdcs128xN  (int16_t              *dst,
@@ -194,32 +355,7 @@ void WibFrame::transposeAdcs128xN  (int16_t              *dst,
                                     WibFrame  const   *frames,
                                     int               nframes)
 {
-   transposeAdcs128x32N (dst, ndstStride, frames, nframes);
-
-   // -----------------------------
-   // Pickup the remainder
-   // Still must be a multiple of 8
-   // -----------------------------
-   int mframes = nframes & 0x1f; 
-   if (mframes)
-   {
-      int n32  = nframes & ~0x1f;
-      dst     += n32;
-      frames  += n32;
-      transposeAdcs128x8N (dst, ndstStride, frames, mframes);
-   }
-
-
-   // Get any remaining frames (this must be less than 8) 
-   int rframes = mframes & 0x7;
-   if (rframes)
-   {
-      dst    += mframes - rframes;
-      frames += mframes - rframes;
-      transposeAdcs128xN_kernel (dst, ndstStride, frames, rframes);
-   }
-   
-
+   kernels ().m_transposeAdcs128xN (dst, ndstStride, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -230,14 +366,16 @@ void WibFrame::transposeAdcs128xN  (int16_t              *dst,
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 16.
+          \a nframes time samples, \a 8 at a time.
 
    \param[in]       dst[out]  The output destination array. 
    \param[in] ndstStride[in]  The number of entries of each of the 128
                               arrays of transposed ADC values.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.  This need not be a
+                              multiple of 8, the remainder is
+                              transposed at the same speed.
 
    This output array should be thought of as a 2d array dst[128][ndstStride].
    This allows each channel space for ndstStride contigous transposed
@@ -249,72 +387,7 @@ void WibFrame::transposeAdcs128x8N (int16_t              *dst,
                                     WibFrame const    *frames,
                                     int               nframes)
 {
-   //puts ("transposeAcs128x16");
-
-
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *dst0 = dst;
-   int16_t *dst1 = dst + 64 * ndstStride;
-   int n8frames  = nframes/8;
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-   // ------------------------------=-----
-   // Loop over the frames in groups of 8
-   // ------------------------------------
-   for (int iframe = 0; iframe < n8frames; ++iframe)
-   { 
-      uint64_t const *lclsrc0 = src0;
-      uint64_t const *lclsrc1 = src1;
-
-      int16_t        *lcldst0 = dst0;
-      int16_t        *lcldst1 = dst1;
-
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x8_kernel (lcldst0, ndstStride, lclsrc0);
-         lcldst0 += 16*ndstStride;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x8_kernel (lcldst1, ndstStride, lclsrc1);
-         lcldst1 += 16*ndstStride;
-         lclsrc1 +=  3;
-      }
-
-      // Advance the source and destination by the 8 time frames
-      src0 += 8 * sizeof (WibFrame) / sizeof (*src0);
-      src1 += 8 * sizeof (WibFrame) / sizeof (*src1);
-
-      // Advance the destination by the same 
-      dst0 += 8;
-      dst1 += 8;
-   }
-
+   kernels ().m_transposeAdcs128x8N (dst, ndstStride, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -325,14 +398,16 @@ void WibFrame::transposeAdcs128x8N (int16_t              *dst,
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 16.
+          \a nframes time samples, \a 16 at a time.
 
    \param[in]       dst[out]  The output destination array. 
    \param[in] ndstStride[in]  The number of entries of each of the 128
                               arrays of transposed ADC values.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.  This need not be a
+                              multiple of 16, the remainder is
+                              transposed at the same speed.
 
    This output array should be thought of as a 2d array dst[128][ndstStride].
    This allows each channel space for ndstStride contigous transposed
@@ -344,90 +419,26 @@ void WibFrame::transposeAdcs128x16N (int16_t              *dst,
                                      WibFrame const    *frames,
                                      int               nframes)
 {
-   //puts ("transposeAcs128x16");
-
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *dst0 = dst;
-   int16_t *dst1 = dst + 64 * ndstStride;
-
-
-   int n16frames = nframes/16;
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-   // ------------------------------=-----
-   // Loop over the frames in groups of 16
-   // ------------------------------------
-   for (int iframe = 0; iframe < n16frames; ++iframe)
-   { 
-      uint64_t const *lclsrc0 = src0;
-      uint64_t const *lclsrc1 = src1;
-
-      int16_t        *lcldst0 = dst0;
-      int16_t        *lcldst1 = dst1;
-
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x16_kernel (lcldst0, ndstStride, lclsrc0);
-         lcldst0 += 16*ndstStride;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x16_kernel (lcldst1, ndstStride, lclsrc1);
-         lcldst1 += 16*ndstStride;
-         lclsrc1 +=  3;
-      }
-
-      // Advance the source and destination by the 8 time frames
-      src0 += 16 * sizeof (WibFrame) / sizeof (*src0);
-      src1 += 16 * sizeof (WibFrame) / sizeof (*src1);
-
-      // Advance the destination by the same 
-      dst0 += 16;
-      dst1 += 16;
-   }
-
+   kernels ().m_transposeAdcs128x16N (dst, ndstStride, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
 
 
+
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 32.
+          \a nframes time samples, \a 32 at a time.
 
    \param[in]       dst[out]  The output destination array. 
    \param[in] ndstStride[in]  The number of entries of each of the 128
                               arrays of transposed ADC values.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 32.
+                              to transpose.  This need not be a
+                              multiple of 32, the remainder is
+                              transposed at the same speed.
 
    This output array should be thought of as a 2d array dst[128][ndstStride].
    This allows each channel space for ndstStride contigous transposed
@@ -439,71 +450,7 @@ void WibFrame::transposeAdcs128x32N (int16_t              *dst,
                                      WibFrame const    *frames,
                                      int               nframes)
 {
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *dst0 = dst;
-   int16_t *dst1 = dst + 64 * ndstStride;
-
-
-   int n32frames = nframes/32;
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-   // ------------------------------=-----
-   // Loop over the frames in groups of 32
-   // ------------------------------------
-   for (int iframe = 0; iframe < n32frames; ++iframe)
-   { 
-      uint64_t const *lclsrc0 = src0;
-      uint64_t const *lclsrc1 = src1;
-
-      int16_t        *lcldst0 = dst0;
-      int16_t        *lcldst1 = dst1;
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 32 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x32_kernel (lcldst0, ndstStride, lclsrc0);
-         lcldst0 += 16*ndstStride;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x32_kernel (lcldst1, ndstStride, lclsrc1);
-         lcldst1 += 16*ndstStride;
-         lclsrc1 +=  3;
-      }
-
-      // Advance the source and destination by the 8 time frames
-      src0 += 32 * sizeof (WibFrame) / sizeof (*src0);
-      src1 += 32 * sizeof (WibFrame) / sizeof (*src1);
-
-      // Advance the destination by the same 
-      dst0 += 32;
-      dst1 += 32;
-   }
-
+   kernels ().m_transposeAdcs128x32N (dst, ndstStride, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -515,7 +462,7 @@ void WibFrame::transposeAdcs128x32N (int16_t              *dst,
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 8.
+          \a nframes time samples.
 
    \param[in]       dst[out]  Array of pointers to the channel-by-channel
                               destination arrays 
@@ -523,7 +470,7 @@ void WibFrame::transposeAdcs128x32N (int16_t              *dst,
                               store the first transposed ADC.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void WibFrame::transposeAdcs128xN  (int16_t  *const  dst[128],
@@ -531,32 +478,7 @@ void WibFrame::transposeAdcs128xN  (int16_t  *const  dst[128],
                                     WibFrame  const   *frames,
                                     int               nframes)
 {
-   transposeAdcs128x32N (dst, offset, frames, nframes);
-
-   // -----------------------------
-   // Pickup the remainder
-   // Still must be a multiple of 8
-   // -----------------------------
-   int mframes = nframes & 0x1f; 
-   if (mframes)
-   {
-      int n32  = nframes & ~0x1f;
-      offset  += n32;
-      frames  += n32;
-      transposeAdcs128x8N (dst, offset, frames, mframes);
-   }
-
-
-   // Get any remaining frames (this must be less than 8) 
-   int rframes = mframes & 0x7;
-   if (rframes)
-   {
-      dst    += mframes - rframes;
-      frames += mframes - rframes;
-      transposeAdcs128xN_kernel (dst, frames, rframes);
-   }
-
-
+   kernels ().m_transposeAdcs128xN_cbc (dst, offset, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -567,7 +489,7 @@ void WibFrame::transposeAdcs128xN  (int16_t  *const  dst[128],
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 8.
+          \a nframes time samples, \a 8 at a time.
 
    \param[in]       dst[out]  Array of pointers to the channel-by-channel
                               destination arrays 
@@ -575,7 +497,9 @@ void WibFrame::transposeAdcs128xN  (int16_t  *const  dst[128],
                               store the first transposed ADC.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.  This need not be a
+                              multiple of 8, the remainder is
+                              transposed at the same speed.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void WibFrame::transposeAdcs128x8N  (int16_t  *const  dst[128],
@@ -583,69 +507,7 @@ void WibFrame::transposeAdcs128x8N  (int16_t  *const  dst[128],
                                      WibFrame  const   *frames,
                                      int               nframes)
 {
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *const *dst0 = dst;
-   int16_t *const *dst1 = dst + 64;
-   int         n8frames = nframes/8;
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-
-   // ------------------------------=----
-   // Loop over the frames in groups of 8
-   // -----------------------------------
-   for (int iframe = 0; iframe < n8frames; ++iframe)
-   { 
-      uint64_t const *lclsrc0 = src0;
-      uint64_t const *lclsrc1 = src1;
-
-      int16_t *const *lcldst0 = dst0;
-      int16_t *const *lcldst1 = dst1;
-
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x8_kernel  (lcldst0, offset, lclsrc0);
-         lcldst0 += 16;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x8_kernel  (lcldst1, offset, lclsrc1);
-         lcldst1 += 16;
-         lclsrc1 +=  3;
-      }
-
-      // Advance the source and destination by the 16 time frames
-      src0   += 8 * sizeof (WibFrame) / sizeof (*src0);
-      src1   += 8 * sizeof (WibFrame) / sizeof (*src1);
-
-      // Advance the destination by the same 
-      offset += 8;
-   }
-
+   kernels ().m_transposeAdcs128x8N_cbc (dst, offset, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -656,7 +518,7 @@ void WibFrame::transposeAdcs128x8N  (int16_t  *const  dst[128],
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 16.
+          \a nframes time samples, \a 16 at a time.
 
    \param[in]       dst[out]  Array of pointers to the channel-by-channel
                               destination arrays 
@@ -664,7 +526,9 @@ void WibFrame::transposeAdcs128x8N  (int16_t  *const  dst[128],
                               store the first transposed ADC.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 16.
+                              to transpose.  This need not be a
+                              multiple of 16, the remainder is
+                              transposed at the same speed.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void WibFrame::transposeAdcs128x16N (int16_t *const   dst[128],
@@ -672,69 +536,7 @@ void WibFrame::transposeAdcs128x16N (int16_t *const   dst[128],
                                      WibFrame const    *frames,
                                      int               nframes)
 {
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *const *dst0 = dst;
-   int16_t *const *dst1 = dst + 64;
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-
-   // ------------------------------=-----
-   // Loop over the frames in groups of 16
-   // ------------------------------------
-   int n16frames = nframes/16;
-   for (int iframe = 0; iframe < n16frames; ++iframe)
-   { 
-      uint64_t const *lclsrc0 = src0;
-      uint64_t const *lclsrc1 = src1;
-
-      int16_t *const *lcldst0 = dst0;
-      int16_t *const *lcldst1 = dst1;
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 16 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x16_kernel (lcldst0, offset, lclsrc0);
-         lcldst0 += 16;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x16_kernel (lcldst1, offset, lclsrc1);
-         lcldst1 += 16;
-         lclsrc1 +=  3;
-      }
-
-
-      // Advance the source and destination by the 16 time frames
-      src0   += 16 * sizeof (WibFrame) / sizeof (*src0);
-      src1   += 16 * sizeof (WibFrame) / sizeof (*src1);
-      offset += 16;
-
-   }
-
+   kernels ().m_transposeAdcs128x16N_cbc (dst, offset, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
@@ -743,7 +545,7 @@ void WibFrame::transposeAdcs128x16N (int16_t *const   dst[128],
 /* ---------------------------------------------------------------------- *//*!
 
    \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.  nframes must be a multiple of 32.
+          \a nframes time samples, \a 32 at a time.
 
    \param[in]       dst[out]  Array of pointers to the channel-by-channel
                               destination arrays 
@@ -751,11 +553,9 @@ void WibFrame::transposeAdcs128x16N (int16_t *const   dst[128],
                               store the first transposed ADC.
    \param[in]     frames[in]  The array of WibFrames
    \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose.  This must a multiple of 32.
-
-   This output array should be thought of as a 2d array dst[128][ndstStride].
-   This allows each channel space for ndstStride contigous transposed
-   ADC values.
+                              to transpose.  This need not be a
+                              multiple of 32, the remainder is
+                              transposed at the same speed.
                                                                           */
 /* ---------------------------------------------------------------------- */
 void WibFrame::transposeAdcs128x32N (int16_t  *const  dst[128],
@@ -763,298 +563,248 @@ void WibFrame::transposeAdcs128x32N (int16_t  *const  dst[128],
                                      WibFrame  const   *frames,
                                      int               nframes)
 {
-   // ----------------------------------
-   // Locate the cold data in this frame
-   // ----------------------------------
-   WibColdData const (& coldData)[2] = frames->getColdData ();
-
-
-   // ------------------------------------------------
-   // Locate the packed data for each cold data stream
-   // ------------------------------------------------
-   uint64_t const *src0 = coldData[0].locateAdcs12b ();
-   uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
-
-   // ----------------------------------------------------------------
-   // Locate where in the output data for the 2 cold data streams goes
-   // ----------------------------------------------------------------
-   int16_t *const *dst0 = dst;
-   int16_t *const *dst1 = dst + 64;
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-   // ------------------------------=-----
-   // Loop over the frames in groups of 16
-   // ------------------------------------
-   int n32frames = nframes/32;
-   for (int iframe = 0; iframe < n32frames; ++iframe)
-   { 
-      uint64_t  const *lclsrc0 = src0;
-      uint64_t  const *lclsrc1 = src1;
-
-      int16_t  *const *lcldst0 = dst0;
-      int16_t  *const *lcldst1 = dst1;
-
-      // ----------------------------------
-      // Loop over the adcs in groups of 16
-      // ----------------------------------
-      for (int iadcs = 0; iadcs < 64; iadcs += 16)
-      {
-         // ----------------------------------------------------------------
-         // Transpose the cold data stream 0 & 1  for 16 channels x 32 times
-         // ----------------------------------------------------------------
-         transposeAdcs16x32_kernel (lcldst0, offset, lclsrc0);
-         lcldst0 += 16;
-         lclsrc0 +=  3;
-
-         transposeAdcs16x32_kernel (lcldst1, offset, lclsrc1);
-         lcldst1 += 16;
-         lclsrc1 +=  3;
-      }
-
-      // Advance the source and destination by the 32 time frames
-      src0   += 32 * sizeof (WibFrame) / sizeof (*src0);
-      src1   += 32 * sizeof (WibFrame) / sizeof (*src1);
-      offset += 32;
-   }
-
+   kernels ().m_transposeAdcs128x32N_cbc (dst, offset, frames, nframes);
    return;
 }
 /* ---------------------------------------------------------------------- */
-/* END: CHANNEL-BY-CHANNEL TRANSPOSERS                                  */
+/* END: CHANNEL-BY-CHANNEL TRANSPOSERS                                    */
 /* ====================================================================== */
 
 
 
 
-#ifdef __AVX2__
-#include "WibFrame-avx2.hh"
-#elif defined (__AVX__)
-#include "WibFrame-avx.hh"
-#else
-#include "WibFrame-gen.hh"
-#endif
-
-#include <string.h>
-
+/* ====================================================================== */
+/* BEGIN: MASKED TRANSPOSITION                                            */
 /* ---------------------------------------------------------------------- *//*!
 
-  \brief The kernel to unpack 64 densely packet 12-bit values into 
-         64 16-bit values.
-
-  \param[in] dst  The destination address
-  \param[in] src  The source address
+   \brief  Transposes the selected ADC channels of \a nframes time
+           samples
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the arrays of
+                          transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames, \e i.e. time samples
+                          to transpose.
+   \param[in]   chanMask  The selected channels, bit n % 64 of
+                          chanMask[n / 64] for channel n
+
+   \par
+    Only the selected channels are stored, in increasing channel order.
+    The output should be thought of as a 2d array dst[nselected][ndstStride]
+    where nselected is the number of bits set in chanMask.
                                                                           */
 /* ---------------------------------------------------------------------- */
-void WibColdData::expandAdcs64x1 (int16_t              *dst,
-                                  uint64_t const (&src)[12])
+void WibFrame::transposeAdcsMasked128xN (int16_t              *dst,
+                                         int            ndstStride,
+                                         WibFrame const    *frames,
+                                         int               nframes,
+                                         uint64_t const chanMask[2])
 {
-   expandAdcs16_init_kernel ();
-   expandAdcs64x1_kernel    (dst, reinterpret_cast<uint64_t const *>(&src));
+   kernels ().m_transposeAdcsMasked128xN (dst,    ndstStride,
+                                          frames, nframes, chanMask);
+   return;
 }
 /* ---------------------------------------------------------------------- */
+/* END: MASKED TRANSPOSITION                                              */
+/* ====================================================================== */
 
 
 
-
+/* ====================================================================== */
+/* BEGIN: FLOAT TRANSPOSITION                                             */
 /* ---------------------------------------------------------------------- *//*!
 
-   \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.
-
-
-   \param[in]       dst[out]  The output destination array. 
-   \param[in] ndstStride[in]  The number of entries of each of the 128
-                              arrays of transposed ADC values.
-   \param[in]     frames[in]  The array of WibFrames
-   \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose. 
-
-   This output array should be thought of as a 2d array dst[128][ndstStride].
-   This allows each channel space for ndstStride contigous transposed
-   ADC values.
+   \brief  Transposes the 128 ADC channels serviced by a WibFrame for
+           \a nframes time samples into pedestal subtracted, gain
+           corrected floats
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of converted ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames, \e i.e. time samples
+                          to transpose.
+   \param[in]       peds  The pedestals of the 128 channels
+   \param[in]      gains  The gains of the 128 channels.  If NULL, all
+                          the gains are taken as 1.
+
+   \par
+    Channel n's value is (adc - peds[n]) * gains[n].
                                                                           */
 /* ---------------------------------------------------------------------- */
-static void transposeAdcs128xN_kernel (int16_t              *dst,
-                                       int            ndstStride,
-                                       WibFrame const    *frames,
-                                       int               nframes)
+void WibFrame::transposeAdcs128xN (float                *dst,
+                                   int            ndstStride,
+                                   WibFrame const    *frames,
+                                   int               nframes,
+                                   float const         *peds,
+                                   float const        *gains)
 {
-   //puts ("transposeAcs128xXN_kernel);
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
-
-   for (int iframe = 0; iframe < nframes;  iframe++)
-   {
-      // ----------------------------------
-      // Locate the cold data in this frame
-      // ----------------------------------
-      WibColdData const (& coldData)[2] = frames[iframe].getColdData ();
-
-
-      // ------------------------------------------------
-      // Locate the packed data for each cold data stream
-      // ------------------------------------------------
-      uint64_t const *src0 = coldData[0].locateAdcs12b ();
-      uint64_t const *src1 = coldData[1].locateAdcs12b ();
-
+   kernels ().m_transposeAdcs128xN_float (dst,    ndstStride,
+                                          frames, nframes, peds, gains);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+/* END: FLOAT TRANSPOSITION                                               */
+/* ====================================================================== */
 
-      // ------------------------------
-      // Decode into a local Adc buffer
-      // ------------------------------ 
-      int16_t                adcBuf[128];
-      expandAdcs64x1_kernel (adcBuf+ 0, src0);
-      expandAdcs64x1_kernel (adcBuf+64, src1);
 
 
-      // ---------------------------------------------------------------
-      // Copy the decoded channel ordered Adcs into sample ordered array
-      // ---------------------------------------------------------------
-      for (int idx = 0; idx < 128; idx++)
-      {
-         int chnOffset           = idx * ndstStride;
-         dst[chnOffset + iframe] = adcBuf[idx];
-      }
-   } 
-   
+/* ====================================================================== */
+/* BEGIN: STATISTICS TRANSPOSITION                                        */
+/* ---------------------------------------------------------------------- *//*!
 
+   \brief  Transposes the 128 ADC channels serviced by a WibFrame for
+           \a nframes time samples, accumulating each channel's
+           statistics
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames, \e i.e. time samples
+                          to transpose.
+   \param[in,out]   stats The statistics of the 128 channels, channel
+                          n's ADCs being added to stats[n]
+
+   \par
+    The statistics are added to, so that a channel can be accumulated
+    over several calls.  Reset them first to start afresh.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WibFrame::transposeAdcs128xN (int16_t              *dst,
+                                   int            ndstStride,
+                                   WibFrame const    *frames,
+                                   int               nframes,
+                                   AdcStats           *stats)
+{
+   kernels ().m_transposeAdcs128xN_stats (dst,    ndstStride,
+                                          frames, nframes, stats);
    return;
 }
 /* ---------------------------------------------------------------------- */
+/* END: STATISTICS TRANSPOSITION                                          */
+/* ====================================================================== */
 
 
 
-
+/* ====================================================================== */
+/* BEGIN: BLOCKED TRANSPOSITION                                           */
 /* ---------------------------------------------------------------------- *//*!
 
-  \brief  Transpose 8N time samples for 16 channels
-
-  \param[out]   dst The destination array
-  \param[ in]    n8 The number of groups of 8 channels, \e i.e. the N in
-                    transpose16x8N
-  \param[in] offset The number of elements in on channel's destination
-                    array.
-  \param[in]    src The source array
+   \brief  Transposes the 128 ADC channels serviced by a WibFrame for
+           \a nframes time samples, staging them in an L1 resident tile
+
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames, \e i.e. time samples
+                          to transpose.
+   \param[in]      ntile  The number of time samples in a tile, rounded
+                          down to a multiple of 32 and limited to
+                          MaxTransposeTile.  If 0, DefTransposeTile.
                                                                           */
 /* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x8N_kernel (int16_t        *dst, 
-                                              int              n8,
-                                              int          stride,
-                                              uint64_t const *src)
+void WibFrame::transposeAdcs128xN_blocked (int16_t              *dst,
+                                           int            ndstStride,
+                                           WibFrame const    *frames,
+                                           int               nframes,
+                                           int                 ntile)
 {
-   for (int idx = 0; idx < n8; ++idx)
-   {
-      transposeAdcs16x8_kernel (dst, stride, src + idx * 8 * sizeof (WibFrame) / sizeof (*src));
-      dst += 8;
-   }
+   if (ntile <= 0) ntile = DefTransposeTile;
 
+   kernels ().m_transposeAdcs128xN_blocked (dst,    ndstStride,
+                                            frames, nframes, ntile);
    return;
 }
 /* ---------------------------------------------------------------------- */
 
 
 
-/* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x16_kernel (int16_t        *dst, 
-                                              int          stride, 
-                                              uint64_t const *src)
-{
-   transposeAdcs16x8N_kernel (dst, 2, stride, src);
-}
-/* ---------------------------------------------------------------------- */
+/* ---------------------------------------------------------------------- *//*!
 
+   \brief  Transposes the 128 ADC channels serviced by a WibFrame for
+           \a nframes time samples, storing them with non-temporal stores
 
+   \param[out]       dst  The output destination array
+   \param[in] ndstStride  The number of entries of each of the 128
+                          arrays of transposed ADC values.
+   \param[in]     frames  The array of WibFrames
+   \param[in]    nframes  The number of frames, \e i.e. time samples
+                          to transpose.
 
+   \par
+    The output is written around the caches, so it is not there when
+    read back, but neither has it evicted anyone else's data.  The
+    stores are fenced before returning.
+                                                                          */
 /* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x32_kernel (int16_t        *dst, 
-                                              int          stride, 
-                                              uint64_t const *src)
+void WibFrame::transposeAdcs128xN_stream (int16_t              *dst,
+                                          int            ndstStride,
+                                          WibFrame const    *frames,
+                                          int               nframes)
 {
-   transposeAdcs16x8N_kernel (dst, 4, stride, src);
+   kernels ().m_transposeAdcs128xN_stream (dst, ndstStride, frames, nframes);
+   return;
 }
 /* ---------------------------------------------------------------------- */
-/* END: CONTIGIOUS TRANSPOSITION                                          */
+/* END: BLOCKED TRANSPOSITION                                             */
 /* ====================================================================== */
 
 
 
-
-
 /* ====================================================================== */
-/* BEGIN: CHANNEL-BY-CHANNEL TRANSPOSITION                                */
+/* BEGIN: PACKERS                                                         */
 /* ---------------------------------------------------------------------- *//*!
 
-   \brief Transposes the 128 ADC channels serviced by a WibFrame for
-          \a nframes time samples.
+  \brief  Packs 4 12-bit ADCs into the 48-bit pattern used by the cold
+          data links
+  \return The 48 packed bits, right justified
 
-
-   \param[in]       dst[out]  The output destination array. 
-   \param[in] ndstStride[in]  The number of entries of each of the 128
-                              arrays of transposed ADC values.
-   \param[in]     frames[in]  The array of WibFrames
-   \param[in]    nframes[in]  The number frames, \e i.e. time samples
-                              to transpose. 
-
-   This output array should be thought of as a 2d array dst[128][ndstStride].
-   This allows each channel space for ndstStride contigous transposed
-   ADC values.
+  \param[in] a  The ADC of the first  channel
+  \param[in] b  The ADC of the second channel
+  \param[in] c  The ADC of the third  channel
+  \param[in] d  The ADC of the fourth channel
                                                                           */
 /* ---------------------------------------------------------------------- */
-static void transposeAdcs128xN_kernel (int16_t *const       *dst,
-                                       WibFrame const    *frames,
-                                       int               nframes)
+static inline uint64_t pack48 (uint64_t a, uint64_t b, uint64_t c, uint64_t d)
 {
-   //puts ("transposeAcs128xXN);
-
-
-   // ---------------------------------
-   // Initialize the expander registers
-   // ---------------------------------
-   expandAdcs16_init_kernel ();
-
+   return ((a >> 0) & 0xff) <<  0 | ((b >> 0) & 0xff) <<  8
+        | ((a >> 8) & 0x0f) << 16 | ((c >> 0) & 0x0f) << 20
+        | ((b >> 8) & 0x0f) << 24 | ((d >> 0) & 0x0f) << 28
+        | ((c >> 4) & 0xff) << 32 | ((d >> 4) & 0xff) << 40;
+}
+/* ---------------------------------------------------------------------- */
 
-   for (int iframe = 0; iframe < nframes;  iframe++)
-   {
-      // ----------------------------------
-      // Locate the cold data in this frame
-      // ----------------------------------
-      WibColdData const (& coldData)[2] = frames[iframe].getColdData ();
 
 
-      // ------------------------------------------------
-      // Locate the packed data for each cold data stream
-      // ------------------------------------------------
-      uint64_t const *src0 = coldData[0].locateAdcs12b ();
-      uint64_t const *src1 = coldData[1].locateAdcs12b ();
+/* ---------------------------------------------------------------------- *//*!
 
+  \brief Packs 16 consecutive channels of 1 time sample into 3 64-bit
+         words, the inverse of the expansion kernels
 
-      // -----------------------------
-      // Decode into a local Adc buffer
-      // ----------------------------- 
-      int16_t                adcBuf[128];
-      expandAdcs64x1_kernel (adcBuf+ 0, src0);
-      expandAdcs64x1_kernel (adcBuf+64, src1);
+  \param[out]    dst  The 3 destination words
+  \param[in]     src  The ADC of the first channel
+  \param[in] nstride  The distance between the ADCs of consecutive
+                      channels
+                                                                          */
+/* ---------------------------------------------------------------------- */
+static inline void pack16 (uint64_t *dst, int16_t const *src, int nstride)
+{
+   uint64_t g[4];
 
+   for (int igrp = 0; igrp < 4; igrp++, src += 4 * nstride)
+   {
+      g[igrp] = pack48 (static_cast<uint16_t>(src[0 * nstride]),
+                        static_cast<uint16_t>(src[1 * nstride]),
+                        static_cast<uint16_t>(src[2 * nstride]),
+                        static_cast<uint16_t>(src[3 * nstride]));
+   }
 
-      // ---------------------------------------------------------------
-      // Copy the decoded channel ordered Adcs into sample ordered array
-      // ---------------------------------------------------------------
-      for (int idx = 0; idx < 128; idx++)
-      {
-         dst[idx][iframe] = adcBuf[idx];
-      }
-   } 
-   
+   dst[0] = (g[0]      ) | (g[1] << 48);
+   dst[1] = (g[1] >> 16) | (g[2] << 32);
+   dst[2] = (g[2] >> 32) | (g[3] << 16);
 
    return;
 }
@@ -1063,55 +813,73 @@ static void transposeAdcs128xN_kernel (int16_t *const       *dst,
 
 
 /* ---------------------------------------------------------------------- *//*!
-  \brief  Transpose 8N time samples for 16 channels
-
-  \param[out]   dst Pointers to 16 arrays to receive the transposed data
-  \param[ in]    n8 The number of groups of 8 channels, \e i.e. the N in
-                    transpose16x8N
-  \param[in] offset The number of elements in on channel's destination
-                    array.
-  \param[in]    src The source array
+
+   \brief Packs the 128 ADC channels of \a nframes time samples into
+          WibFrames, the inverse of the contiguous memory transposers.
+
+   \param[out]    frames  The array of WibFrames. Only the ADC words are
+                          written, the WIB and cold data headers are
+                          untouched.
+   \param[in]    nframes  The number of frames, \e i.e. time samples, to
+                          pack.
+   \param[in]        src  The source array
+   \param[in] nsrcStride  The number of entries of each of the 128 arrays
+                          of ADC values.
+
+   The source array should be thought of as a 2d array src[128][nsrcStride],
+   the same layout the transposers produce.  Only the low 12 bits of
+   each ADC are kept.  Each frame reads 1 ADC from each of 128 channels,
+   but consecutive frames read consecutive ADCs, so the cache lines
+   fetched for one frame serve the following ones.
                                                                           */
 /* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x8N_kernel (int16_t  *const *dst, 
-                                              int               n8,
-                                              int           offset,
-                                              uint64_t const  *src)
+void WibFrame::packAdcs128xN (WibFrame           *frames,
+                              int                nframes,
+                              int16_t const         *src,
+                              int             nsrcStride)
 {
-   for (int idx = 0; idx < n8; ++idx)
+   for (int iframe = 0; iframe < nframes; iframe++)
    {
-      transposeAdcs16x8_kernel (dst, offset, src);
-      src    += 8 * sizeof (WibFrame) / sizeof (*src);
-      offset += 8;
+      WibColdData (&colddata)[2] = frames[iframe].getColdData ();
+
+      // Channels 0-63 are on cold data link 0, 64-127 on link 1
+      for (int ilink = 0; ilink < 2; ilink++)
+      {
+         uint64_t     (&adcs)[12] = colddata[ilink].locateAdcs12b ();
+         int16_t const      *chns = src + 64 * ilink * nsrcStride + iframe;
+
+         for (int igrp = 0; igrp < 4; igrp++)
+         {
+            pack16 (adcs + 3 * igrp, chns + 16 * igrp * nsrcStride,
+                    nsrcStride);
+         }
+      }
    }
 
    return;
 }
 /* ---------------------------------------------------------------------- */
+/* END: PACKERS                                                           */
+/* ====================================================================== */
 
 
 
-/* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x16_kernel (int16_t *const  *dst, 
-                                              int           offset,
-                                              uint64_t const  *src)
-{
-   transposeAdcs16x8N_kernel (dst, 2, offset, src);
-}
-/* ---------------------------------------------------------------------- */
-
+/* ---------------------------------------------------------------------- *//*!
 
+  \brief The kernel to unpack 64 densely packet 12-bit values into 
+         64 16-bit values.
 
+  \param[in] dst  The destination address
+  \param[in] src  The source address
+                                                                          */
 /* ---------------------------------------------------------------------- */
-static inline void transposeAdcs16x32_kernel (int16_t *const  *dst, 
-                                              int           offset, 
-                                              uint64_t const  *src)
+void WibColdData::expandAdcs64x1 (int16_t              *dst,
+                                  uint64_t const (&src)[12])
 {
-   transposeAdcs16x8N_kernel (dst, 4, offset, src);
+   kernels ().m_expandAdcs64x1 (dst, reinterpret_cast<uint64_t const *>(&src));
+   return;
 }
 /* ---------------------------------------------------------------------- */
-/* END: CONTIGIOUS TRANSPOSITION                                          */
-/* ====================================================================== */
 /*   END: IMPLEMENTATION: class WibFrame                                  */
 } /* END: namespace access                                                */
 } /* END: namespace pdd                                                   */
@@ -0,0 +1,286 @@
+// -*-Mode: C++;-*-
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WorkerPool.cc
+ *  @brief    A simple pool of worker threads that executes a set of
+ *            independent, indexed tasks
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  pdd
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt A new worker starts at the generation current when it
+                  was created.  It started at 0, so after a run it would
+                  drain a stale generation, racing with the next run.
+
+\* ---------------------------------------------------------------------- */
+
+
+#include "WorkerPool.hh"
+
+
+namespace pdd    {
+namespace access {
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Constructor
+
+  \param[in] nthreads The total number of threads, including the caller
+                      of run, to use.  A value of 1 or less executes
+                      all tasks in the calling thread.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+WorkerPool::WorkerPool (int nthreads) :
+   m_task       (0),
+   m_ctx        (0),
+   m_ntasks     (0),
+   m_next       (0),
+   m_generation (0),
+   m_busy       (0),
+   m_quit       (false)
+{
+   resize (nthreads);
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- */
+WorkerPool::~WorkerPool ()
+{
+   stop ();
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the pool shared by the library
+  \return The shared pool.
+
+   This pool starts with 1 thread, \e i.e. everything is executed
+   serially in the caller, until it is resized.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+WorkerPool &WorkerPool::shared ()
+{
+   static WorkerPool Shared (1);
+   return Shared;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Change the number of threads
+
+  \param[in] nthreads The total number of threads, including the caller
+                      of run, to use.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WorkerPool::resize (int nthreads)
+{
+   std::lock_guard<std::mutex> run (m_runLock);
+
+   stop ();
+
+   // ------------------------------------------------------
+   // The workers must wait for the next run, not the last.
+   // ------------------------------------------------------
+   unsigned int generation;
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_quit     = false;
+      generation = m_generation;
+   }
+
+   for (int idx = 1; idx < nthreads; idx++)
+   {
+      m_threads.push_back (std::thread (&WorkerPool::work, this, generation));
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief  Return the total number of threads, including the caller
+  \return The total number of threads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+int WorkerPool::getNThreads () const
+{
+   return m_threads.size () + 1;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Execute \a task for each task index 0 to \a ntasks - 1
+
+  \param[in]   task The task
+  \param[in]    ctx The context passed to the task
+  \param[in] ntasks The number of tasks
+
+   This returns only after all the tasks have completed.  If the pool
+   is already in use, e.g. by another thread or by a task that itself
+   calls run, the tasks are executed serially in the calling thread.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WorkerPool::run (Task task, void *ctx, int ntasks)
+{
+   std::unique_lock<std::mutex> run (m_runLock, std::try_to_lock);
+
+   if (!run.owns_lock () || m_threads.empty () || ntasks <= 1)
+   {
+      for (int itask = 0; itask < ntasks; itask++) task (ctx, itask);
+      return;
+   }
+
+
+   // ---------------------------------------
+   // Publish the tasks and wake the workers
+   // ---------------------------------------
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_task    = task;
+      m_ctx     = ctx;
+      m_ntasks  = ntasks;
+      m_next    = 0;
+      m_busy    = m_threads.size ();
+      m_generation++;
+   }
+   m_work.notify_all ();
+
+
+   // ---------------------------------------
+   // Help out, then wait for the stragglers
+   // ---------------------------------------
+   drain ();
+
+   std::unique_lock<std::mutex> lock (m_lock);
+   while (m_busy) m_done.wait (lock);
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Claim and execute tasks until there are none left
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WorkerPool::drain ()
+{
+   int itask;
+   while ((itask = m_next.fetch_add (1)) < m_ntasks)
+   {
+      m_task (m_ctx, itask);
+   }
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief The worker thread's loop
+
+  \param[in] generation  The generation when the worker was created.  It
+                         waits for the next one.
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WorkerPool::work (unsigned int generation)
+{
+   while (1)
+   {
+      {
+         std::unique_lock<std::mutex> lock (m_lock);
+         while (!m_quit && generation == m_generation) m_work.wait (lock);
+         if (m_quit) return;
+         generation = m_generation;
+      }
+
+      drain ();
+
+      {
+         std::lock_guard<std::mutex> lock (m_lock);
+         m_busy -= 1;
+      }
+      m_done.notify_one ();
+   }
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \brief Stop and join all the worker threads
+                                                                          */
+/* ---------------------------------------------------------------------- */
+void WorkerPool::stop ()
+{
+   {
+      std::lock_guard<std::mutex> lock (m_lock);
+      m_quit = true;
+   }
+   m_work.notify_all ();
+
+   for (auto &thread : m_threads) thread.join ();
+   m_threads.clear ();
+
+   return;
+}
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
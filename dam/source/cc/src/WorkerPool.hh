@@ -0,0 +1,123 @@
+// -*-Mode: C++;-*-
+
+#ifndef PDD_WORKERPOOL_HH
+#define PDD_WORKERPOOL_HH
+
+/* ---------------------------------------------------------------------- *//*!
+ *
+ *  @file     WorkerPool.hh
+ *  @brief    A simple pool of worker threads that executes a set of
+ *            independent, indexed tasks
+ *  @verbatim
+ *                               Copyright 2026
+ *                                    by
+ *
+ *                       The Board of Trustees of the
+ *                    Leland Stanford Junior University.
+ *                           All rights reserved.
+ *
+ *  @endverbatim
+ *
+ *  @par Facility:
+ *  pdd
+ *
+ *  @author
+ *  <agent@local>
+ *
+ *  @par Date created:
+ *  <2026/10/16>
+ *
+ * @par Credits:
+ * SLAC
+ *
+ * @par
+ *  The pool is intended for fan-out/fan-in style parallelism, e.g.
+ *  decompressing the channels of a packet.  The caller hands the pool
+ *  ntasks task indices, the workers and the caller each claim indices
+ *  until all are done, then run returns.  The tasks must be independent,
+ *  i.e. write disjoint outputs.  The results are then independent of
+ *  the number of threads and the order the tasks were executed in.
+ *
+\* ---------------------------------------------------------------------- */
+
+
+
+/* ---------------------------------------------------------------------- *\
+
+   HISTORY
+   -------
+
+   DATE       WHO WHAT
+   ---------- --- ---------------------------------------------------------
+   2026.10.16 agt Created
+   2026.10.16 agt work takes the generation to start from
+
+\* ---------------------------------------------------------------------- */
+
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace pdd    {
+namespace access {
+
+
+/* ---------------------------------------------------------------------- *//*!
+
+  \class WorkerPool
+  \brief A pool of threads executing a set of indexed tasks
+                                                                          */
+/* ---------------------------------------------------------------------- */
+class WorkerPool
+{
+public:
+   // The task, called once for each itask = 0, ntasks - 1
+   typedef void (*Task) (void *ctx, int itask);
+
+public:
+   WorkerPool (int nthreads = 1);
+  ~WorkerPool ();
+
+public:
+   static WorkerPool &shared      ();
+
+   void               resize      (int nthreads);
+   int                getNThreads () const;
+   void               run         (Task task, void *ctx, int ntasks);
+
+private:
+   void               work        (unsigned int generation);
+   void               drain       ();
+   void               stop        ();
+
+private:
+   WorkerPool (WorkerPool const &)            = delete;
+   WorkerPool &operator = (WorkerPool const &) = delete;
+
+private:
+   std::mutex                  m_runLock; /*!< Serializes run          */
+   std::mutex                     m_lock; /*!< Protects the following  */
+   std::condition_variable        m_work; /*!< Signals a new generation*/
+   std::condition_variable        m_done; /*!< Signals a worker is done*/
+   std::vector<std::thread>    m_threads; /*!< The workers             */
+   Task                           m_task; /*!< The current task        */
+   void                           *m_ctx; /*!< Its context             */
+   int                         m_ntasks; /*!< Its number of tasks      */
+   std::atomic<int>              m_next; /*!< Next task index to claim */
+   unsigned int            m_generation; /*!< Incremented each run     */
+   int                           m_busy; /*!< Number of workers active */
+   bool                          m_quit; /*!< Workers should exit      */
+};
+/* ---------------------------------------------------------------------- */
+
+
+/* ---------------------------------------------------------------------- */
+} /* END: namespace access                                                */
+} /* END: namespace pdd                                                   */
+/* ====================================================================== */
+
+#endif
@@ -29,6 +29,12 @@
  *
  * DATE     WHO WHAT
  * -------- --- ---------------------------------------------------------
+ * 10.16.26 jjr The renormalization shifts out all the settled bits at once
+ *              and takes in the input bits a word at a time with
+ *              add_input_bits, rather than looping one bit at a time
+ * 10.16.26 jjr Added apd_decode_lut, decoding with a symbol lookup table.
+ *              The body of apd_decode is now the inline decode, shared
+ *              by both
  * 08.20.18 jjr Remove attempt to realign the input buffer to 64-bits.
  *              This cannot be done.  The data is stored as a big-endian
  *              bit stream place in uint64_t's.  If it was little-endian
@@ -84,6 +90,32 @@ do                                                                        \
 
 
 
+/* INPUT N BITS, N <= APD_K_IOBUF_BITS - 1, RIGHT JUSTIFIED. */
+#define add_input_bits(_v, _n, _in, _buffer, _bits_to_go)                 \
+do                                                                        \
+{   _bits_to_go -= (_n);                                                  \
+    if (_bits_to_go >= 0)                                                 \
+    {                                                                     \
+        _v = (_buffer >> _bits_to_go) & (((APD_iobuf_t)1 << (_n)) - 1);  \
+    }                                                                     \
+    else                                                                  \
+    {                                                                     \
+        /* Take what is left, then the rest from the next buffer */       \
+        int _more = -_bits_to_go;                                         \
+        _v  = _buffer & (((APD_iobuf_t)1 << ((_n) - _more)) - 1);         \
+        _v <<= _more;                                                     \
+                                                                          \
+        _buffer =  apd_load (_in);                                        \
+        _in     = _in + sizeof (APD_iobuf_t);                             \
+                                                                          \
+        _bits_to_go = APD_K_IOBUF_BITS - _more;                           \
+        _v         |= _buffer >> _bits_to_go;                             \
+    }                                                                     \
+} while (0)
+/* ---------------------------------------------------------------------- */
+
+
+
 
 
 /* ---------------------------------------------------------------------- */
@@ -159,8 +191,14 @@ int  apd_bdecompress (uint8_t             *out,
 
 
 /* ---------------------------------------------------------------------- */
-extern unsigned int apd_decode (APD_dtx             *dtx,
-                                APD_table_t const *table)
+/* If lut is non-NULL the symbol is found with it, otherwise by searching */
+/* the table.  Since this is forced inline with a constant lut, the      */
+/* choice is made at compile time.                                        */
+/* ---------------------------------------------------------------------- */
+static __inline __attribute__ ((always_inline))
+unsigned int decode (APD_dtx             *dtx,
+                     APD_table_t const *table,
+                     APD_lut_t   const   *lut)
 {
     uint32_t          cum;
     int            symbol;
@@ -178,7 +216,8 @@ extern unsigned int apd_decode (APD_dtx             *dtx,
     range  = (hi - lo) + 1;
     cum    = scale_m1 (value - lo + 1, range);
     table  = table + 1;
-    symbol = lookup_bot (cum, table, cnt);
+    symbol = lut ? lookup_lut (cum, table, cnt, lut)
+                 : lookup_bot (cum, table, cnt);
 
 
 
@@ -192,50 +231,19 @@ extern unsigned int apd_decode (APD_dtx             *dtx,
     lo = scale_lo (lo, range, table[symbol  ]);
 
     APD_dumpStatement (int value_save = value;)
-    int nbits      = 0;
-    while (1)
-    {
-        /* Loop to get rid of bits. */
-
-        // printf ("Val = %x Lo:Hi = [%8.8x,%8.8x)\n", value, lo, hi);
-
-        if      (hi <  APC_K_HALF)
-        {
-            /* Expand low half.         */
-            /* nothing */
-        }
-        else if (lo >= APC_K_HALF)
-        {
-            /* Expand high half, subtract offset to top.*/
-            value -= APC_K_HALF;
-            lo    -= APC_K_HALF;
-            hi    -= APC_K_HALF;
-        }
-        else if (lo >= APC_K_Q1 && hi < APC_K_Q3)
-        {
-            /* Expand middle half, subtract offset to middle*/
-            value -= APC_K_Q1;
-            lo    -= APC_K_Q1;
-            hi    -= APC_K_Q1;
-        }
-        else
-        {
-            /* Otherwise exit loop.     */
-            break;
-        }
-
-        /* Scale up code range.     */
-        lo <<= 1;
-        hi <<= 1;
-        hi  |= 1;
-
-        lo &= APC_M_CV_ALL;
-        hi &= APC_M_CV_ALL;
-
-        nbits += 1;
-        /* Move in next input bit.  */
-        add_input_bit(value, in, buffer, bits_to_go);
-    }
+
+    /*
+     | Renormalize, shifting out all the settled bits at once.  The value
+     | undergoes the same subtractions and shifts as lo, so value - lo
+     | only accumulates the input bits. Modulo the code width, the new
+     | value is lo + ((value - lo) << nbits) + the next nbits input bits.
+    */
+    APD_cv_t      diff = value - lo;
+    int          nbits = renormalize (&lo, &hi);
+    APD_iobuf_t   bits;
+
+    add_input_bits (bits, nbits, in, buffer, bits_to_go);
+    value = (lo + (diff << nbits) + bits) & APC_M_CV_ALL;
 
     APD_dumpStatement
     (
@@ -259,6 +267,29 @@ extern unsigned int apd_decode (APD_dtx             *dtx,
 
 
 
+/* ---------------------------------------------------------------------- */
+extern unsigned int apd_decode (APD_dtx             *dtx,
+                                APD_table_t const *table)
+{
+    return decode (dtx, table, 0);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
+/* ---------------------------------------------------------------------- */
+extern unsigned int apd_decode_lut (APD_dtx             *dtx,
+                                    APD_table_t const *table,
+                                    APD_lut_t   const   *lut)
+{
+    return decode (dtx, table, lut);
+}
+/* ---------------------------------------------------------------------- */
+
+
+
+
 /* ---------------------------------------------------------------------- */
 #ifdef apd_finish     /* This routine is the same in both cases           */
 /* ---------------------------------------------------------------------- */
@@ -81,6 +81,9 @@ fi
 echo "build type: $BUILDTYPE"
 
 # -- gen, avx, or avx2
+# -- The qualifier only names the product.  The library is always built for
+# -- the generic target; it selects the kernels for the executing cpu when
+# -- it is loaded, so every qualifier gets the same build.
 
 echo "simd qualifier: $SIMDQUALIFIER"
 
@@ -125,6 +128,7 @@ if [ `uname` = Darwin ]; then
   FLAVOR=`ups flavor -2`
   LINDAR=darwin
 fi
+BUILDTARGET=x86_64-gen-${LINDAR}
 
 touch ${PRODUCT_NAME} || exit 1
 rm -rf ${PRODUCT_NAME} || exit 1
@@ -304,14 +308,14 @@ make clean || exit 1
 echo $MYNAME Copying libararies...
 if [ $BUILDTYPE = prof ]; then
   echo "Making optimized version"
-  make CC=${COMPILERCOMMAND} CXX=${COMPILERCOMMAND} LD=${COMPILERCOMMAND} PROD=1 target=x86_64-${SIMDQUALIFIER}-${LINDAR} || exit 1
+  make CC=${COMPILERCOMMAND} CXX=${COMPILERCOMMAND} LD=${COMPILERCOMMAND} PROD=1 target=${BUILDTARGET} || exit 1
 else
   echo "Making debug version"
-  make CC=${COMPILERCOMMAND} CXX=${COMPILERCOMMAND} LD=${COMPILERCOMMAND} target=x86_64-${SIMDQUALIFIER}-${LINDAR} || exit 1
+  make CC=${COMPILERCOMMAND} CXX=${COMPILERCOMMAND} LD=${COMPILERCOMMAND} target=${BUILDTARGET} || exit 1
 fi
 
 echo $MYNAME Copying binaries...
-cp -R -L ${PKGDIR}/install/x86_64-${SIMDQUALIFIER}-${LINDAR}/bin/* ${CURDIR}/${PRODUCT_NAME}/${VERSION}/${FLAVOR}-${QUAL}-${SIMDQUALIFIER}-${BUILDTYPE}/bin
+cp -R -L ${PKGDIR}/install/${BUILDTARGET}/bin/* ${CURDIR}/${PRODUCT_NAME}/${VERSION}/${FLAVOR}-${QUAL}-${SIMDQUALIFIER}-${BUILDTYPE}/bin
 
 # JJ builds a program called "reader" which probably shouldn't be in the user's PATH.  Rename it if it exists
 
@@ -322,7 +326,7 @@ fi
 # in the case of the shared libraries, we want to only copy the libraries once, and make new symlinks with relative paths
 
 echo $MYNAME Copying libararies...
-cd ${PKGDIR}/dam/export/x86_64-${SIMDQUALIFIER}-${LINDAR}/lib
+cd ${PKGDIR}/dam/export/${BUILDTARGET}/lib
 for LIBFILE in $( ls ); do
 	  if [ -h ${LIBFILE} ]; then
 	    TMPVAR=`readlink ${LIBFILE}`
@@ -332,7 +336,7 @@ for LIBFILE in $( ls ); do
 	  fi
 done
 
-cp -R -L ${PKGDIR}/install/x86_64-${SIMDQUALIFIER}-${LINDAR}/include/* ${CURDIR}/${PRODUCT_NAME}/${VERSION}/include || exit 1
+cp -R -L ${PKGDIR}/install/${BUILDTARGET}/include/* ${CURDIR}/${PRODUCT_NAME}/${VERSION}/include || exit 1
 
 # assemble the UPS product and declare it
 
@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/DataFragmentUnpack.hh
\ No newline at end of file
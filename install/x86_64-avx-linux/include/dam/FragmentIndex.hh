@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/FragmentIndex.hh
\ No newline at end of file
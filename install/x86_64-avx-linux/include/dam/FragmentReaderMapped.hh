@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/FragmentReaderMapped.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/FragmentPipeline.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/FragmentReader.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/dam/source/cc/dam/FragmentReaderAsync.hh
\ No newline at end of file
@@ -20,8 +20,14 @@
 # although nothing prohibits that.
 #
 # METHOD:
-# The /proc/cpuinfo file is scanned by grep for the 'flags' line.
-# This line is captured and then scanned for the supported options.
+# The library is built only for the generic target.  The instruction
+# set specific kernels are compiled into it and the best one for the
+# executing cpu is selected at load time, so the capability is always
+# 'gen'.  To force a particular set of kernels, e.g. for benchmarking,
+# set the environment variable PDD_WIBFRAME_KERNELS.
+#
+# Originally the /proc/cpuinfo file was scanned by grep for the 'flags'
+# line and an avx or avx2 build selected from the supported options.
 #
 # FYI:
 # At one time this was done using a executable. This works, but 
@@ -40,6 +46,9 @@
 #
 #       When  Who   What
 # ----------  ---   -----------------------------------------------------
+# 2026.10.16  agt   Always return the generic, 'gen', directory.  The cpu
+#                   specific kernels are selected by the library itself.
+#
 # 2017.10.28  jjr   Added support for the MAC
 #
 # ----------------------------------------------------------------------
@@ -57,43 +66,17 @@ os=`uname -s`
 ### --------------------------------------
 if [ ${os} == "Linux" ]; then
       os="linux"
-     ### ------------------------------------------------------------
-     ### Get the supported advanced options
-     ### ------------------------------------------------------------
-     ### Scan /proc/cpuinfo for the first occurance of the flags line
-     ### ------------------------------------------------------------
-    flags=`grep -m1 "^flags" /proc/cpuinfo`
-
 else 
      if [ ${os} == "Darwin" ]; then
-          
          os="darwin"
-         flags=`sysctl machdep.cpu.features`
-
      fi
 fi
 
-### -------------
-### Look for avx2
-### -------------
-x=`grep " avx2 " <<< ${flags}`
-if [ $? -eq 0 ]; then
-    opt=avx2
-else
-    ### ------------
-    ### Look for avx
-    ### ------------
-    x=`grep " avx " <<< ${flags}`
-
-    if [ $? -eq 0 ]; then
-        opt=avx
-    else
-        ### ------------------
-        ### Default to generic
-        ### ------------------
-        opt=gen
-    fi
-fi
+### -------------------------------------------------------------
+### There is only the generic build, the library selects the best
+### kernels for this cpu when it is loaded
+### -------------------------------------------------------------
+opt=gen
 
 ### ---------------------------------------------------------
 ### Construct the machine-capability-os specific subdirectory
@@ -14,9 +14,9 @@
 #                  if the installation directory has been placed 
 #                  somewhere other than the standard place or if,
 #                  for testing, purposes, one wishes to use images
-#                  and libraries other than these.  An example would
-#                  be to test avx code on a machine that normally 
-#                  runs avx2 code.
+#                  and libraries other than these.  To test, e.g.,
+#                  the avx kernels on a machine that normally runs
+#                  the avx2 kernels, set PDD_WIBFRAME_KERNELS instead.
 #
 # AUTHOR:
 # jjrussell
@@ -42,21 +42,20 @@
 #
 # Where
 #      machine: The result of a "uname -m"
-#          opt: The result of executing a capabilties program 
+#          opt: Always 'gen'.  There is only the generic build, the
+#               library selects the kernels for the executing cpu
+#               when it is loaded.
 #           os: The non-capitalized version of "uname -s"
 #
-# The tricky one is locating and exectuing the capabilities program.
-# This program is assume located in 
-#
-#      <root>/install/<machine>-gen-<os>/bin/capabilities
-#
-# i.e the generic directory. This program will return the 'opt' string
-# appropriate for this machine.
+# The directory name is returned by installation_spec_dir.sh.
 #
 # HISTORY
 #
 #       When  Who   What
 # ----------  ---   -----------------------------------------------------
+# 2026.10.16  agt   The installation directory is always the generic one,
+#                   <machine>-gen-<os>.
+#
 # 2017.10.29  jjr   On the MAC, readlink returns an empty string if the
 #                   the file is not a symbolic link.  If an empty string
 #                   is returned, the original file name is used.